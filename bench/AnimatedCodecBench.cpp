@@ -0,0 +1,58 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "AnimatedCodecBench.h"
+#include "SkCodec.h"
+
+AnimatedCodecBench::AnimatedCodecBench(SkString baseName, SkData* encoded, bool reusePriorFrame)
+    : fData(SkRef(encoded))
+    , fReusePriorFrame(reusePriorFrame)
+    , fNextFrame(0)
+{
+    fName.printf("AnimatedCodec_%s_%s", baseName.c_str(),
+                 reusePriorFrame ? "PriorFrame" : "Independent");
+}
+
+const char* AnimatedCodecBench::onGetName() {
+    return fName.c_str();
+}
+
+bool AnimatedCodecBench::isSuitableFor(Backend backend) {
+    return kNonRendering_Backend == backend;
+}
+
+void AnimatedCodecBench::onDelayedSetup() {
+    fCodec.reset(SkCodec::NewFromData(fData));
+    fFrameInfo = fCodec->getFrameInfo();
+
+    fInfo = fCodec->getInfo().makeColorType(kN32_SkColorType);
+    if (kUnpremul_SkAlphaType == fInfo.alphaType()) {
+        fInfo = fInfo.makeAlphaType(kPremul_SkAlphaType);
+    }
+
+    fPixelStorage.reset(fInfo.getSafeSize(fInfo.minRowBytes()));
+}
+
+void AnimatedCodecBench::onDraw(int n, SkCanvas* canvas) {
+    SkCodec::Options options;
+    for (int i = 0; i < n; i++) {
+        const size_t frame = fNextFrame;
+        fNextFrame = (fNextFrame + 1) % fFrameInfo.size();
+
+        // The dst holds the last frame we decoded.
+        const size_t lastFrame = (frame + fFrameInfo.size() - 1) % fFrameInfo.size();
+        options.fFrameIndex = frame;
+        options.fHasPriorFrame = fReusePriorFrame &&
+                                 fFrameInfo[frame].fRequiredFrame == lastFrame;
+#ifdef SK_DEBUG
+        const SkCodec::Result result =
+#endif
+        fCodec->getPixels(fInfo, fPixelStorage.get(), fInfo.minRowBytes(), &options, nullptr,
+                          nullptr);
+        SkASSERT(result == SkCodec::kSuccess || result == SkCodec::kIncompleteInput);
+    }
+}
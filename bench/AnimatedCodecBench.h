@@ -0,0 +1,49 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef AnimatedCodecBench_DEFINED
+#define AnimatedCodecBench_DEFINED
+
+#include "Benchmark.h"
+#include "SkCodec.h"
+#include "SkData.h"
+#include "SkImageInfo.h"
+#include "SkRefCnt.h"
+#include "SkString.h"
+
+#include <vector>
+
+/**
+ *  Time decoding the frames of an animated image, one frame per loop, in display order.
+ *
+ *  When reusing the prior frame, each decode blends onto the frame left in the dst
+ *  by the last one, like a player would.  Otherwise every frame decodes the frames
+ *  it depends on as well.
+ */
+class AnimatedCodecBench : public Benchmark {
+public:
+    // Calls encoded->ref()
+    AnimatedCodecBench(SkString basename, SkData* encoded, bool reusePriorFrame);
+
+protected:
+    const char* onGetName() override;
+    bool isSuitableFor(Backend backend) override;
+    void onDraw(int n, SkCanvas* canvas) override;
+    void onDelayedSetup() override;
+
+private:
+    SkString                        fName;
+    SkAutoTUnref<SkData>            fData;
+    const bool                      fReusePriorFrame;
+    SkAutoTDelete<SkCodec>          fCodec;         // Set in onDelayedSetup.
+    std::vector<SkCodec::FrameInfo> fFrameInfo;     // Set in onDelayedSetup.
+    SkImageInfo                     fInfo;          // Set in onDelayedSetup.
+    SkAutoMalloc                    fPixelStorage;  // Set in onDelayedSetup.
+    size_t                          fNextFrame;
+    typedef Benchmark INHERITED;
+};
+#endif // AnimatedCodecBench_DEFINED
@@ -12,11 +12,20 @@
 
 BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
         SkColorType colorType, uint32_t sampleSize, const SkIRect& subset)
+    : BitmapRegionDecoderBench(baseName, encoded, colorType, sampleSize, SkTArray<Region>(),
+                               SkBitmapRegionDecoder::kAndroidCodec_Strategy)
+{
+    fRegions.push_back({ subset, sampleSize });
+}
+
+BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
+        SkColorType colorType, uint32_t sampleSize, const SkTArray<Region>& regions,
+        SkBitmapRegionDecoder::Strategy strategy)
     : fBRD(nullptr)
     , fData(SkRef(encoded))
     , fColorType(colorType)
-    , fSampleSize(sampleSize)
-    , fSubset(subset)
+    , fRegions(regions)
+    , fStrategy(strategy)
 {
     // Choose a useful name for the color type
     const char* colorName = color_type_to_str(colorType);
@@ -25,6 +34,9 @@ BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData*
     if (1 != sampleSize) {
         fName.appendf("_%.3f", 1.0f / (float) sampleSize);
     }
+    if (SkBitmapRegionDecoder::kAndroidCodecTiled_Strategy == strategy) {
+        fName.append("_tiled");
+    }
 }
 
 const char* BitmapRegionDecoderBench::onGetName() {
@@ -36,12 +48,15 @@ bool BitmapRegionDecoderBench::isSuitableFor(Backend backend) {
 }
 
 void BitmapRegionDecoderBench::onDelayedSetup() {
-    fBRD.reset(SkBitmapRegionDecoder::Create(fData, SkBitmapRegionDecoder::kAndroidCodec_Strategy));
+    fBRD.reset(SkBitmapRegionDecoder::Create(fData, fStrategy));
 }
 
 void BitmapRegionDecoderBench::onDraw(int n, SkCanvas* canvas) {
     for (int i = 0; i < n; i++) {
-        SkBitmap bm;
-        SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, fColorType, false));
+        for (const Region& region : fRegions) {
+            SkBitmap bm;
+            SkAssertResult(fBRD->decodeRegion(&bm, nullptr, region.fSubset, region.fSampleSize,
+                                              fColorType, false));
+        }
     }
 }
@@ -14,6 +14,7 @@
 #include "SkImageInfo.h"
 #include "SkRefCnt.h"
 #include "SkString.h"
+#include "SkTArray.h"
 
 /**
  *  Benchmark Android's BitmapRegionDecoder for a particular colorType, sampleSize, and subset.
@@ -23,10 +24,21 @@
  */
 class BitmapRegionDecoderBench : public Benchmark {
 public:
+    struct Region {
+        SkIRect  fSubset;
+        uint32_t fSampleSize;
+    };
+
     // Calls encoded->ref()
     BitmapRegionDecoderBench(const char* basename, SkData* encoded, SkColorType colorType,
             uint32_t sampleSize, const SkIRect& subset);
 
+    // Decodes each region in turn, like a viewer panning or zooming over the image.
+    // Calls encoded->ref()
+    BitmapRegionDecoderBench(const char* basename, SkData* encoded, SkColorType colorType,
+            uint32_t sampleSize, const SkTArray<Region>& regions,
+            SkBitmapRegionDecoder::Strategy strategy);
+
 protected:
     const char* onGetName() override;
     bool isSuitableFor(Backend backend) override;
@@ -38,8 +50,8 @@ private:
     SkAutoTDelete<SkBitmapRegionDecoder>           fBRD;
     SkAutoTUnref<SkData>                           fData;
     const SkColorType                              fColorType;
-    const uint32_t                                 fSampleSize;
-    const SkIRect                                  fSubset;
+    SkTArray<Region>                               fRegions;
+    const SkBitmapRegionDecoder::Strategy          fStrategy;
     typedef Benchmark INHERITED;
 };
 #endif // BitmapRegionDecoderBench_DEFINED
@@ -208,3 +208,111 @@ void ColorCodecBench::onDraw(int n, SkCanvas*) {
         }
     }
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SkColorSpace_Base.h"
+#include "SkRandom.h"
+
+// Times SkColorSpaceXform::apply() on its own, for each kind of src profile we know how to
+// build without an image: named sRGB and 2.2 (the fast paths), linear and exponential gammas,
+// and whatever the monitor profile uses, against 8888 and F16 dsts.
+class ColorXformBench : public Benchmark {
+public:
+    enum Src {
+        kSRGB_Src,
+        k2Dot2_Src,
+        kLinear_Src,
+        kExponential_Src,
+        kMonitor_Src,
+    };
+
+    ColorXformBench(Src src, SkColorType dstColorType, SkAlphaType dstAlphaType)
+        : fSrc(src)
+        , fDstColorType(dstColorType)
+        , fDstAlphaType(dstAlphaType)
+    {
+        static const char* kSrcNames[] = { "srgb", "2dot2", "linear", "exponential", "monitor" };
+        fName.printf("ColorXform_%s_to_%s_%s", kSrcNames[src],
+                     kRGBA_F16_SkColorType == dstColorType ? "f16" : "8888",
+                     kPremul_SkAlphaType == dstAlphaType ? "premul" : "opaque");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return kNonRendering_Backend == backend; }
+
+    void onDelayedSetup() override {
+        sk_sp<SkColorSpace> srgb = SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named);
+        const SkMatrix44& toXYZ = srgb->xyz();
+
+        sk_sp<SkColorSpace> srcSpace;
+        switch (fSrc) {
+            case kSRGB_Src:
+                srcSpace = srgb;
+                break;
+            case k2Dot2_Src:
+                srcSpace = SkColorSpace::NewRGB(SkColorSpace::k2Dot2Curve_GammaNamed, toXYZ);
+                break;
+            case kLinear_Src:
+                srcSpace = SkColorSpace::NewRGB(SkColorSpace::kLinear_GammaNamed, toXYZ);
+                break;
+            case kExponential_Src: {
+                float gammas[3] = { 1.8f, 1.8f, 1.8f };
+                srcSpace = SkColorSpace_Base::NewRGB(gammas, toXYZ);
+                break;
+            }
+            case kMonitor_Src: {
+                sk_sp<SkData> data = SkData::MakeFromFileName(
+                        GetResourcePath("monitor_profiles/HP_ZR30w.icc").c_str());
+                srcSpace = data ? SkColorSpace::NewICC(data->data(), data->size()) : nullptr;
+                break;
+            }
+        }
+        if (!srcSpace) {
+            srcSpace = srgb;
+        }
+        fXform = SkColorSpaceXform::New(srcSpace, srgb);
+        SkASSERT(fXform);
+
+        SkRandom rand;
+        for (int i = 0; i < kPixels; i++) {
+            fSrcPixels[i] = (kPremul_SkAlphaType == fDstAlphaType) ? rand.nextU()
+                                                                   : rand.nextU() | 0xFF000000;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            fXform->apply(fDstPixels, fSrcPixels, kPixels, fDstColorType, fDstAlphaType);
+        }
+    }
+
+private:
+    static constexpr int kPixels = 1024;
+
+    Src                                fSrc;
+    SkColorType                        fDstColorType;
+    SkAlphaType                        fDstAlphaType;
+    SkString                           fName;
+    std::unique_ptr<SkColorSpaceXform> fXform;
+    uint32_t                           fSrcPixels[kPixels];
+    uint64_t                           fDstPixels[kPixels];
+
+    typedef Benchmark INHERITED;
+};
+
+#define DEF_XFORM_BENCHES(src)                                                                 \
+    DEF_BENCH(return new ColorXformBench(ColorXformBench::src, kN32_SkColorType,               \
+                                         kOpaque_SkAlphaType);)                                \
+    DEF_BENCH(return new ColorXformBench(ColorXformBench::src, kN32_SkColorType,               \
+                                         kPremul_SkAlphaType);)                                \
+    DEF_BENCH(return new ColorXformBench(ColorXformBench::src, kRGBA_F16_SkColorType,          \
+                                         kPremul_SkAlphaType);)
+
+DEF_XFORM_BENCHES(kSRGB_Src)
+DEF_XFORM_BENCHES(k2Dot2_Src)
+DEF_XFORM_BENCHES(kLinear_Src)
+DEF_XFORM_BENCHES(kExponential_Src)
+DEF_XFORM_BENCHES(kMonitor_Src)
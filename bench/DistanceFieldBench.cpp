@@ -0,0 +1,82 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkDistanceFieldGen.h"
+#include "SkString.h"
+#include "SkTemplates.h"
+
+// Distance fields for a run of glyph-sized masks, generated one at a time or as one batch.
+class DistanceFieldBench : public Benchmark {
+    static const int kCount = 32;
+    static const int kSize = 48;
+
+    SkString               fName;
+    SkDistanceFieldMethod  fMethod;
+    bool                   fBatched;
+    SkAutoTMalloc<uint8_t> fImages;
+    SkAutoTMalloc<uint8_t> fFields;
+    SkDistanceFieldRequest fRequests[kCount];
+
+public:
+    DistanceFieldBench(SkDistanceFieldMethod method, bool batched)
+        : fMethod(method), fBatched(batched) {
+        fName.printf("distancefield_%s%s",
+                     kExact_SkDistanceFieldMethod == method ? "exact" : "approximate",
+                     batched ? "_batch" : "");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        const size_t fieldSize = SkComputeDistanceFieldSize(kSize, kSize);
+        fImages.reset(kCount*kSize*kSize);
+        fFields.reset(kCount*fieldSize);
+        for (int i = 0; i < kCount; ++i) {
+            // rings of varying thickness, roughly like the strokes of a glyph
+            uint8_t* image = fImages.get() + i*kSize*kSize;
+            const float outer = 0.45f*kSize, inner = outer - 2 - i%8;
+            for (int y = 0; y < kSize; ++y) {
+                for (int x = 0; x < kSize; ++x) {
+                    float d = SkScalarSqrt(SkScalarSquare(x - 0.5f*kSize) +
+                                           SkScalarSquare(y - 0.5f*kSize));
+                    float coverage = SkTMin(outer - d, d - inner) + 0.5f;
+                    image[y*kSize + x] = SkScalarRoundToInt(255*SkScalarPin(coverage, 0, 1));
+                }
+            }
+            fRequests[i] = { fFields.get() + i*fieldSize, image, kSize, kSize, kSize,
+                             SkMask::kA8_Format };
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int loop = 0; loop < loops; ++loop) {
+            if (fBatched) {
+                SkGenerateDistanceFields(fRequests, kCount, fMethod);
+            } else {
+                for (const SkDistanceFieldRequest& r : fRequests) {
+                    SkGenerateDistanceFieldFromA8Image(r.fDistanceField, r.fImage,
+                                                       r.fWidth, r.fHeight, r.fRowBytes,
+                                                       fMethod);
+                }
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new DistanceFieldBench(kApproximate_SkDistanceFieldMethod, false); )
+DEF_BENCH( return new DistanceFieldBench(kApproximate_SkDistanceFieldMethod, true); )
+DEF_BENCH( return new DistanceFieldBench(kExact_SkDistanceFieldMethod, false); )
+DEF_BENCH( return new DistanceFieldBench(kExact_SkDistanceFieldMethod, true); )
@@ -8,6 +8,7 @@
 #include "Benchmark.h"
 #include "Resources.h"
 #include "SkBitmap.h"
+#include "SkCanvas.h"
 #include "SkData.h"
 #include "SkImageEncoder.h"
 
@@ -79,3 +80,57 @@ DEF_BENCH(return new EncodeBench("color_wheel.jpg", SkImageEncoder::kPNG_Type, 9
 // TODO: What is the appropriate quality to use to benchmark WEBP encodes?
 DEF_BENCH(return new EncodeBench("mandrill_512.png", SkImageEncoder::kWEBP_Type, 90));
 DEF_BENCH(return new EncodeBench("color_wheel.jpg", SkImageEncoder::kWEBP_Type, 90));
+
+// Large PNG exports, with the encoder's strip parallelism and zlib level swept.
+class PNGEncodeBench : public Benchmark {
+public:
+    PNGEncodeBench(const char* filename, int size, int threads, int level)
+        : fFilename(filename)
+        , fSize(size)
+    {
+        fOptions.fThreadCount = threads;
+        fOptions.fZLibLevel = level;
+        fName.printf("Encode_PNG_%s_%d_threads%d_level%d", filename, size, threads, level);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        // Scale a photo up to the export size, so that rows are not trivially compressible.
+        SkBitmap src;
+        if (!GetResourceAsBitmap(fFilename, &src)) {
+            return;
+        }
+        fBitmap.allocN32Pixels(fSize, fSize, true);
+        SkCanvas canvas(fBitmap);
+        canvas.drawBitmapRect(src, SkRect::MakeIWH(fSize, fSize), nullptr);
+        fEncoder.reset(CreatePNGImageEncoder(fOptions));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkAutoTUnref<SkData> data(fEncoder->encodeData(fBitmap, 100));
+            SkASSERT(data);
+        }
+    }
+
+private:
+    const char*                   fFilename;
+    const int                     fSize;
+    SkPNGEncoderOptions           fOptions;
+    SkString                      fName;
+    SkBitmap                      fBitmap;
+    SkAutoTDelete<SkImageEncoder> fEncoder;
+};
+
+#define DEF_PNG_ENCODE_BENCHES(threads)                                                   \
+    DEF_BENCH(return new PNGEncodeBench("mandrill_512.png", 4096, threads, 1));            \
+    DEF_BENCH(return new PNGEncodeBench("mandrill_512.png", 4096, threads, 6));            \
+    DEF_BENCH(return new PNGEncodeBench("mandrill_512.png", 4096, threads, 9));
+
+DEF_PNG_ENCODE_BENCHES(1)
+DEF_PNG_ENCODE_BENCHES(2)
+DEF_PNG_ENCODE_BENCHES(4)
+DEF_PNG_ENCODE_BENCHES(8)
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "Resources.h"
+#include "SkCommandLineFlags.h"
+#include "SkFontMgr.h"
+#include "SkFontMgr_custom.h"
+#include "SkString.h"
+
+#include <stdio.h>
+
+DEFINE_string(fontMgrDir, "", "Directory of fonts for FontMgrCustomBench. "
+                              "Defaults to the resource fonts.");
+DEFINE_string(fontMgrIndex, "/tmp/fontmgr_custom_bench.index",
+              "Index file written and read by FontMgrCustomBench.");
+
+// Startup cost of the directory font manager, either opening every font or reading the index
+// written by an earlier manager.
+class FontMgrCustomBench : public Benchmark {
+    SkString fName;
+    SkString fDir;
+    bool     fIndexed;
+public:
+    FontMgrCustomBench(bool indexed) : fIndexed(indexed) {
+        fName.printf("fontmgr_custom_%s", indexed ? "indexed" : "scan");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fDir = FLAGS_fontMgrDir.isEmpty() ? GetResourcePath("fonts")
+                                          : SkString(FLAGS_fontMgrDir[0]);
+        if (fIndexed) {
+            remove(FLAGS_fontMgrIndex[0]);
+            sk_sp<SkFontMgr> mgr(SkFontMgr_New_Custom_Directory(fDir.c_str(),
+                                                                FLAGS_fontMgrIndex[0]));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const char* indexPath = fIndexed ? FLAGS_fontMgrIndex[0] : nullptr;
+        for (int i = 0; i < loops; i++) {
+            sk_sp<SkFontMgr> mgr(SkFontMgr_New_Custom_Directory(fDir.c_str(), indexPath));
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new FontMgrCustomBench(false); )
+DEF_BENCH( return new FontMgrCustomBench(true); )
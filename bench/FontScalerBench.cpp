@@ -7,10 +7,12 @@
 
 #include "Benchmark.h"
 #include "SkCanvas.h"
+#include "SkGlyphCache.h"
 #include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkRandom.h"
 #include "SkString.h"
+#include "SkTaskGroup.h"
 
 class FontScalerBench : public Benchmark {
     SkString fName;
@@ -46,7 +48,102 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Like FontScalerBench, but scales each size's glyphs on its own thread, to measure how well
+// glyph generation for different strikes runs in parallel.
+class FontScalerMTBench : public Benchmark {
+    SkString fName;
+    SkString fText;
+    bool     fDoLCD;
+public:
+    FontScalerMTBench(bool doLCD)  {
+        fName.printf("fontscaler_%s_mt", doLCD ? "lcd" : "aa");
+        fText.set("abcdefghijklmnopqrstuvwxyz01234567890");
+        fDoLCD = doLCD;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setLCDRenderText(fDoLCD);
+
+        for (int i = 0; i < loops; i++) {
+            SkGraphics::PurgeFontCache();
+
+            SkTaskGroup().batch(16, [&](int index) {
+                SkPaint sizedPaint(paint);
+                sizedPaint.setTextSize(SkIntToScalar(9 + index));
+                SkAutoGlyphCacheNoGamma autoCache(sizedPaint, nullptr, nullptr);
+                SkGlyphCache* cache = autoCache.getCache();
+                for (size_t c = 0; c < fText.size(); c++) {
+                    const SkGlyph& glyph = cache->getUnicharMetrics(fText[c]);
+                    cache->findImage(glyph);
+                }
+            });
+        }
+    }
+private:
+    typedef Benchmark INHERITED;
+};
+
+// Fills a cold cache with every glyph's image, either one glyph at a time or in one batch.
+class FontScalerGlyphsBench : public Benchmark {
+    SkString fName;
+    SkString fText;
+    bool     fBatch;
+public:
+    FontScalerGlyphsBench(bool batch)  {
+        fName.printf("fontscaler_glyphs%s", batch ? "_batch" : "");
+        fText.set("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ01234567890");
+        fBatch = batch;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+
+        SkAutoTArray<const SkGlyph*> glyphs(fText.size());
+        for (int i = 0; i < loops; i++) {
+            SkGraphics::PurgeFontCache();
+
+            for (int ps = 9; ps <= 24; ps += 2) {
+                paint.setTextSize(SkIntToScalar(ps));
+                SkAutoGlyphCacheNoGamma autoCache(paint, nullptr, nullptr);
+                SkGlyphCache* cache = autoCache.getCache();
+                for (size_t c = 0; c < fText.size(); c++) {
+                    glyphs[c] = &cache->getUnicharMetrics(fText[c]);
+                    if (!fBatch) {
+                        cache->findImage(*glyphs[c]);
+                    }
+                }
+                if (fBatch) {
+                    cache->findImages(glyphs.get(), fText.size());
+                }
+            }
+        }
+    }
+private:
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH(return new FontScalerBench(false);)
 DEF_BENCH(return new FontScalerBench(true);)
+DEF_BENCH(return new FontScalerMTBench(false);)
+DEF_BENCH(return new FontScalerMTBench(true);)
+DEF_BENCH(return new FontScalerGlyphsBench(false);)
+DEF_BENCH(return new FontScalerGlyphsBench(true);)
@@ -9,17 +9,33 @@
 #include "SkBitmap.h"
 #include "SkMipMap.h"
 
+static const char* ct_name(SkColorType ct) {
+    switch (ct) {
+        case kRGB_565_SkColorType:   return "565";
+        case kARGB_4444_SkColorType: return "4444";
+        case kAlpha_8_SkColorType:   return "a8";
+        case kGray_8_SkColorType:    return "g8";
+        case kRGBA_F16_SkColorType:  return "f16";
+        default:                     return "8888";
+    }
+}
+
 class MipMapBench: public Benchmark {
     SkBitmap fBitmap;
     SkString fName;
     const int fW, fH;
     SkSourceGammaTreatment fTreatment;
+    SkColorType fCT;
 
 public:
-    MipMapBench(int w, int h, SkSourceGammaTreatment treatment)
-        : fW(w), fH(h), fTreatment(treatment)
+    MipMapBench(int w, int h, SkSourceGammaTreatment treatment,
+                SkColorType ct = kN32_SkColorType)
+        : fW(w), fH(h), fTreatment(treatment), fCT(ct)
     {
         fName.printf("mipmap_build_%dx%d_%d_gamma", w, h, static_cast<int>(treatment));
+        if (kN32_SkColorType != ct) {
+            fName.appendf("_%s", ct_name(ct));
+        }
     }
 
 protected:
@@ -31,8 +47,16 @@ protected:
 
     void onDelayedSetup() override {
         SkImageInfo info = SkImageInfo::MakeS32(fW, fH, kPremul_SkAlphaType);
+        if (kN32_SkColorType != fCT) {
+            info = SkImageInfo::Make(fW, fH, fCT, kRGB_565_SkColorType == fCT ?
+                                     kOpaque_SkAlphaType : kPremul_SkAlphaType);
+        }
         fBitmap.allocPixels(info);
-        fBitmap.eraseColor(SK_ColorWHITE);  // so we don't read uninitialized memory
+        // so we don't read uninitialized memory
+        SkPixmap pm;
+        if (fBitmap.peekPixels(&pm)) {
+            pm.erase(SkColor4f::FromColor(SK_ColorWHITE));
+        }
     }
 
     void onDraw(int loops, SkCanvas*) override {
@@ -53,3 +77,23 @@ DEF_BENCH( return new MipMapBench(512, 511, SkSourceGammaTreatment::kIgnore); )
 DEF_BENCH( return new MipMapBench(511, 512, SkSourceGammaTreatment::kIgnore); )
 DEF_BENCH( return new MipMapBench(512, 512, SkSourceGammaTreatment::kIgnore); )
 DEF_BENCH( return new MipMapBench(512, 512, SkSourceGammaTreatment::kRespect); )
+
+// Every format SkMipMap knows how to filter.
+DEF_BENCH( return new MipMapBench(511, 511, SkSourceGammaTreatment::kIgnore,
+                                  kRGB_565_SkColorType); )
+DEF_BENCH( return new MipMapBench(511, 511, SkSourceGammaTreatment::kIgnore,
+                                  kARGB_4444_SkColorType); )
+DEF_BENCH( return new MipMapBench(511, 511, SkSourceGammaTreatment::kIgnore,
+                                  kAlpha_8_SkColorType); )
+DEF_BENCH( return new MipMapBench(511, 511, SkSourceGammaTreatment::kIgnore,
+                                  kGray_8_SkColorType); )
+DEF_BENCH( return new MipMapBench(511, 511, SkSourceGammaTreatment::kIgnore,
+                                  kRGBA_F16_SkColorType); )
+DEF_BENCH( return new MipMapBench(512, 512, SkSourceGammaTreatment::kIgnore,
+                                  kRGBA_F16_SkColorType); )
+
+// Large enough that the first level is split into bands across SkTaskGroup threads.
+DEF_BENCH( return new MipMapBench(2048, 2048, SkSourceGammaTreatment::kIgnore); )
+DEF_BENCH( return new MipMapBench(2048, 2048, SkSourceGammaTreatment::kRespect); )
+DEF_BENCH( return new MipMapBench(2048, 2047, SkSourceGammaTreatment::kIgnore,
+                                  kRGBA_F16_SkColorType); )
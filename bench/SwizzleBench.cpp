@@ -6,7 +6,11 @@
  */
 
 #include "Benchmark.h"
+#include "SkCodec.h"
 #include "SkOpts.h"
+#include "SkString.h"
+#include "SkSwizzler.h"
+#include "SkTemplates.h"
 
 class SwizzleBench : public Benchmark {
 public:
@@ -37,3 +41,97 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+
+class Swizzle565Bench : public Benchmark {
+public:
+    Swizzle565Bench(const char* name, SkOpts::Swizzle_565 fn) : fName(name), fFn(fn) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName; }
+    void onDraw(int loops, SkCanvas*) override {
+        static const int K = 1023;
+        uint16_t dst[K];
+        uint32_t src[K];
+        while (loops --> 0) {
+            fFn(dst, src, K);
+        }
+    }
+private:
+    const char* fName;
+    SkOpts::Swizzle_565 fFn;
+};
+
+DEF_BENCH(return new Swizzle565Bench("SkOpts::RGB_to_565", SkOpts::RGB_to_565));
+DEF_BENCH(return new Swizzle565Bench("SkOpts::BGR_to_565", SkOpts::BGR_to_565));
+DEF_BENCH(return new Swizzle565Bench("SkOpts::gray_to_565", SkOpts::gray_to_565));
+DEF_BENCH(return new Swizzle565Bench("SkOpts::inverted_CMYK_to_565",
+                                     SkOpts::inverted_CMYK_to_565));
+
+// Drives a whole SkSwizzler row, so the per-conversion dispatch and sampling are measured too.
+class SkSwizzlerBench : public Benchmark {
+public:
+    SkSwizzlerBench(const char* name, SkEncodedInfo::Color color, int bitsPerComponent,
+                    SkColorType colorType, int sampleX)
+        : fEncodedInfo(SkEncodedInfo::Make(color, SkEncodedInfo::kOpaque_Alpha,
+                                           bitsPerComponent))
+        , fColorType(colorType)
+        , fSampleX(sampleX)
+    {
+        fName.printf("SkSwizzler_%s_%d", name, sampleX);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < 256; i++) {
+            fColorTable[i] = SkPackARGB32(0xFF, i, 255 - i, i / 2);
+        }
+        const SkImageInfo info = SkImageInfo::Make(kWidth, 1, fColorType, kOpaque_SkAlphaType);
+        fSwizzler.reset(SkSwizzler::CreateSwizzler(fEncodedInfo, fColorTable, info,
+                                                   SkCodec::Options()));
+        fSwizzler->setSampleX(fSampleX);
+        fSrc.reset(4 * kWidth);
+        fDst.reset(4 * kWidth);
+        for (int i = 0; i < 4 * kWidth; i++) {
+            fSrc[i] = i * 7;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            fSwizzler->swizzle(fDst.get(), fSrc.get());
+        }
+    }
+
+private:
+    static const int kWidth = 1023;
+
+    SkString                  fName;
+    const SkEncodedInfo       fEncodedInfo;
+    const SkColorType         fColorType;
+    const int                 fSampleX;
+    SkPMColor                 fColorTable[256];
+    SkAutoTDelete<SkSwizzler> fSwizzler;
+    SkAutoTMalloc<uint8_t>    fSrc;
+    SkAutoTMalloc<uint8_t>    fDst;
+};
+
+#define SWIZZLER_BENCHES(name, color, bits, colorType)                                        \
+    DEF_BENCH(return new SkSwizzlerBench(name, SkEncodedInfo::color, bits, colorType, 1));    \
+    DEF_BENCH(return new SkSwizzlerBench(name, SkEncodedInfo::color, bits, colorType, 2));    \
+    DEF_BENCH(return new SkSwizzlerBench(name, SkEncodedInfo::color, bits, colorType, 4));
+
+SWIZZLER_BENCHES("bit_to_n32",      kGray_Color,         1, kN32_SkColorType)
+SWIZZLER_BENCHES("bit_to_565",      kGray_Color,         1, kRGB_565_SkColorType)
+SWIZZLER_BENCHES("gray_to_n32",     kGray_Color,         8, kN32_SkColorType)
+SWIZZLER_BENCHES("gray_to_565",     kGray_Color,         8, kRGB_565_SkColorType)
+SWIZZLER_BENCHES("index2_to_n32",   kPalette_Color,      2, kN32_SkColorType)
+SWIZZLER_BENCHES("index4_to_565",   kPalette_Color,      4, kRGB_565_SkColorType)
+SWIZZLER_BENCHES("index_to_n32",    kPalette_Color,      8, kN32_SkColorType)
+SWIZZLER_BENCHES("index_to_565",    kPalette_Color,      8, kRGB_565_SkColorType)
+SWIZZLER_BENCHES("rgb_to_n32",      kRGB_Color,          8, kN32_SkColorType)
+SWIZZLER_BENCHES("rgb_to_565",      kRGB_Color,          8, kRGB_565_SkColorType)
+SWIZZLER_BENCHES("bgr_to_565",      kBGR_Color,          8, kRGB_565_SkColorType)
+SWIZZLER_BENCHES("cmyk_to_n32",     kInvertedCMYK_Color, 8, kN32_SkColorType)
+SWIZZLER_BENCHES("cmyk_to_565",     kInvertedCMYK_Color, 8, kRGB_565_SkColorType)
@@ -14,6 +14,7 @@
 #include "SkString.h"
 #include "SkTemplates.h"
 #include "SkTypeface.h"
+#include "SkUtils.h"
 
 enum FontQuality {
     kBW,
@@ -175,3 +176,79 @@ DEF_BENCH( return new TextBench(STR, 16, 0x88FF0000, kBW, true); )
 
 DEF_BENCH( return new TextBench(STR, 16, 0xFF000000, kBW, true, true); )
 DEF_BENCH( return new TextBench(STR, 16, 0xFF000000, kAA, false, true); )
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const char gParagraph[] =
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut "
+    "labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco "
+    "laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in reprehenderit in "
+    "voluptate velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint occaecat "
+    "cupidatat non proident, sunt in culpa qui officia deserunt mollit anim id est laborum. "
+    "Z\xC3\xBCrich, S\xC3\xA3o Paulo, \xC3\x85lesund, \xCE\x91\xCE\xB8\xCE\xAE\xCE\xBD\xCE\xB1 "
+    "and \xE6\x9D\xB1\xE4\xBA\xAC are cities.";
+
+// Measuring a paragraph, as text layout does for every line it breaks, in each text encoding.
+class ParagraphMeasureBench : public Benchmark {
+    SkPaint             fPaint;
+    SkString            fName;
+    SkAutoTMalloc<char> fText;
+    size_t              fLength;
+public:
+    ParagraphMeasureBench(SkPaint::TextEncoding encoding) : fLength(0) {
+        fPaint.setTextSize(SkIntToScalar(12));
+        fPaint.setTextEncoding(encoding);
+        static const char* gEncodingNames[] = { "utf8", "utf16", "utf32" };
+        SkASSERT(encoding < SK_ARRAY_COUNT(gEncodingNames));
+        fName.printf("text_measure_paragraph_%s", gEncodingNames[encoding]);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        const size_t utf8Length = strlen(gParagraph);
+        SkAutoTMalloc<SkUnichar> unichars(utf8Length);
+        const int count = SkUTF8_ToUnichars(gParagraph, utf8Length, unichars.get());
+
+        switch (fPaint.getTextEncoding()) {
+            case SkPaint::kUTF8_TextEncoding:
+                fText.reset(utf8Length);
+                memcpy(fText.get(), gParagraph, utf8Length);
+                fLength = utf8Length;
+                break;
+            case SkPaint::kUTF16_TextEncoding: {
+                fText.reset(count * 2 * sizeof(uint16_t));
+                uint16_t* utf16 = reinterpret_cast<uint16_t*>(fText.get());
+                for (int i = 0; i < count; ++i) {
+                    fLength += SkUTF16_FromUnichar(unichars[i], utf16 + fLength);
+                }
+                fLength *= sizeof(uint16_t);
+                break;
+            }
+            default:
+                fText.reset(count * sizeof(SkUnichar));
+                memcpy(fText.get(), unichars.get(), count * sizeof(SkUnichar));
+                fLength = count * sizeof(SkUnichar);
+                break;
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkRect bounds;
+        for (int i = 0; i < loops; i++) {
+            fPaint.measureText(fText.get(), fLength, &bounds);
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new ParagraphMeasureBench(SkPaint::kUTF8_TextEncoding); )
+DEF_BENCH( return new ParagraphMeasureBench(SkPaint::kUTF16_TextEncoding); )
+DEF_BENCH( return new ParagraphMeasureBench(SkPaint::kUTF32_TextEncoding); )
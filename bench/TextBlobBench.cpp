@@ -20,10 +20,22 @@
 
 /*
  * A trivial test which benchmarks the performance of a textblob with a single run.
+ *
+ * On raster, redrawing the blob in place or moved by whole pixels reuses the glyph placement
+ * kept in SkTextBlobRasterCache; moving it by a fraction of a pixel each time misses the cache.
  */
 class TextBlobBench : public Benchmark {
 public:
-    TextBlobBench() {}
+    enum Move {
+        kNone_Move,
+        kWholePixel_Move,
+        kSubpixel_Move,
+    };
+
+    TextBlobBench(Move move) : fMove(move) {
+        static const char* kSuffixes[] = { "", "_wholepixel", "_subpixel" };
+        fName.printf("TextBlobBench%s", kSuffixes[move]);
+    }
 
 protected:
     void onDelayedSetup() override {
@@ -48,19 +60,31 @@ protected:
     }
 
     const char* onGetName() override {
-        return "TextBlobBench";
+        return fName.c_str();
     }
 
     void onDraw(int loops, SkCanvas* canvas) override {
         SkPaint paint;
 
-        // To ensure maximum caching, we just redraw the blob at the same place everytime
         for (int i = 0; i < loops; i++) {
-            canvas->drawTextBlob(fBlob, 0, 0, paint);
+            switch (fMove) {
+                case kNone_Move:
+                    // To ensure maximum caching, we just redraw the blob at the same place
+                    canvas->drawTextBlob(fBlob, 0, 0, paint);
+                    break;
+                case kWholePixel_Move:
+                    canvas->drawTextBlob(fBlob, SkIntToScalar(i & 63), 0, paint);
+                    break;
+                case kSubpixel_Move:
+                    canvas->drawTextBlob(fBlob, (i & 0xffff) / 65536.0f, 0, paint);
+                    break;
+            }
         }
     }
 
 private:
+    SkString                        fName;
+    Move                            fMove;
 
     SkAutoTUnref<const SkTextBlob>  fBlob;
     SkTDArray<uint16_t>             fGlyphs;
@@ -69,4 +93,6 @@ private:
     typedef Benchmark INHERITED;
 };
 
-DEF_BENCH( return new TextBlobBench(); )
+DEF_BENCH( return new TextBlobBench(TextBlobBench::kNone_Move); )
+DEF_BENCH( return new TextBlobBench(TextBlobBench::kWholePixel_Move); )
+DEF_BENCH( return new TextBlobBench(TextBlobBench::kSubpixel_Move); )
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkChecksum.h"
+#include "SkFontMgr.h"
+#include "SkPaint.h"
+#include "SkString.h"
+#include "SkTArray.h"
+#include "SkTaskGroup.h"
+#include "SkTypefaceCache.h"
+#include "../src/fonts/SkRandomScalerContext.h"
+
+static bool find_by_id(SkTypeface* face, void* ctx) {
+    return face->uniqueID() == *static_cast<SkFontID*>(ctx);
+}
+
+// Many threads looking up typefaces in the global SkTypefaceCache at once, either by scanning
+// all of them or by only looking at those with the wanted hash.
+class TypefaceCacheBench : public Benchmark {
+    static const int kTypefaceCount = 512;
+    static const int kThreadCount = 8;
+    static const int kLookupsPerThread = 64;
+
+    SkString                    fName;
+    bool                        fHashed;
+    SkTArray<sk_sp<SkTypeface>> fTypefaces;
+
+public:
+    TypefaceCacheBench(bool hashed) : fHashed(hashed) {
+        fName.printf("typeface_cache_find_%s_mt", hashed ? "hashed" : "linear");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        sk_sp<SkTypeface> proxy(SkTypeface::MakeDefault());
+        SkPaint paint;
+        for (int i = 0; i < kTypefaceCount; i++) {
+            fTypefaces.push_back(sk_make_sp<SkRandomTypeface>(proxy, paint, false));
+            SkTypeface* face = fTypefaces.back().get();
+            if (fHashed) {
+                SkTypefaceCache::Add(face, SkChecksum::Mix(face->uniqueID()));
+            } else {
+                SkTypefaceCache::Add(face);
+            }
+        }
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        fTypefaces.reset();
+        SkTypefaceCache::PurgeAll();
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkTaskGroup().batch(kThreadCount, [&](int thread) {
+                for (int j = 0; j < kLookupsPerThread; j++) {
+                    int index = (thread * 131 + j * 37) % kTypefaceCount;
+                    SkFontID id = fTypefaces[index]->uniqueID();
+                    sk_sp<SkTypeface> found(fHashed
+                        ? SkTypefaceCache::FindByProcAndRef(SkChecksum::Mix(id), find_by_id, &id)
+                        : SkTypefaceCache::FindByProcAndRef(find_by_id, &id));
+                    SkASSERT(found);
+                }
+            });
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+// Many threads matching families and styles with the default font manager at once.
+class FontMgrMatchBench : public Benchmark {
+    static const int kThreadCount = 8;
+
+    sk_sp<SkFontMgr>   fMgr;
+    SkTArray<SkString> fFamilies;
+
+public:
+    FontMgrMatchBench() {}
+
+protected:
+    const char* onGetName() override { return "fontmgr_match_family_style_mt"; }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fMgr.reset(SkFontMgr::RefDefault());
+        for (int i = 0; i < fMgr->countFamilies(); i++) {
+            fMgr->getFamilyName(i, &fFamilies.push_back());
+        }
+        // Also ask for a family the manager does not have.
+        fFamilies.push_back(SkString("NonExistentFamily"));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        static const SkFontStyle gStyles[] = {
+            SkFontStyle::FromOldStyle(SkTypeface::kNormal),
+            SkFontStyle::FromOldStyle(SkTypeface::kBold),
+            SkFontStyle::FromOldStyle(SkTypeface::kItalic),
+            SkFontStyle::FromOldStyle(SkTypeface::kBoldItalic),
+        };
+        for (int i = 0; i < loops; i++) {
+            SkTaskGroup().batch(kThreadCount, [&](int thread) {
+                for (int j = 0; j < fFamilies.count(); j++) {
+                    const SkString& family = fFamilies[(thread + j) % fFamilies.count()];
+                    const SkFontStyle& style = gStyles[(thread + j) % SK_ARRAY_COUNT(gStyles)];
+                    sk_sp<SkTypeface> face(fMgr->matchFamilyStyle(family.c_str(), style));
+                }
+            });
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new TypefaceCacheBench(false); )
+DEF_BENCH( return new TypefaceCacheBench(true); )
+DEF_BENCH( return new FontMgrMatchBench(); )
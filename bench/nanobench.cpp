@@ -10,6 +10,7 @@
 #include "nanobench.h"
 
 #include "AndroidCodecBench.h"
+#include "AnimatedCodecBench.h"
 #include "Benchmark.h"
 #include "BitmapRegionDecoderBench.h"
 #include "CodecBench.h"
@@ -568,6 +569,8 @@ public:
                       , fCurrentUseMPD(0)
                       , fCurrentCodec(0)
                       , fCurrentAndroidCodec(0)
+                      , fCurrentAnimatedCodec(0)
+                      , fCurrentAnimatedMode(0)
                       , fCurrentBRDImage(0)
                       , fCurrentColorImage(0)
                       , fCurrentColorType(0)
@@ -825,6 +828,28 @@ public:
             fCurrentColorType = 0;
         }
 
+        // Run AnimatedCodecBenches, with and without reusing the prior frame
+        for (; fCurrentAnimatedCodec < fImages.count(); fCurrentAnimatedCodec++) {
+            fSourceType = "image";
+            fBenchType = "skcodec";
+            const SkString& path = fImages[fCurrentAnimatedCodec];
+            if (SkCommandLineFlags::ShouldSkip(FLAGS_match, path.c_str())) {
+                continue;
+            }
+            SkAutoTUnref<SkData> encoded(SkData::NewFromFileName(path.c_str()));
+            SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(encoded));
+            if (!codec || codec->getFrameCount() < 2) {
+                continue;
+            }
+
+            if (fCurrentAnimatedMode < 2) {
+                const bool reusePriorFrame = 0 == fCurrentAnimatedMode++;
+                return new AnimatedCodecBench(SkOSPath::Basename(path.c_str()), encoded,
+                                              reusePriorFrame);
+            }
+            fCurrentAnimatedMode = 0;
+        }
+
         // Run AndroidCodecBenches
         const int sampleSizes[] = { 2, 4, 8 };
         for (; fCurrentAndroidCodec < fImages.count(); fCurrentAndroidCodec++) {
@@ -869,6 +894,8 @@ public:
         //     All use cases we are aware of only scale by powers of two.
         //     PNG decodes use the indicated sampling strategy regardless of the sample size, so
         //         these tests are sufficient to provide good coverage of our scaling options.
+        // Viewers also pan and zoom, revisiting parts of the image they have already decoded, so
+        // we benchmark those access patterns both with and without the tile cache.
         const uint32_t brdSampleSizes[] = { 1, 2, 4, 8, 16 };
         const uint32_t minOutputSize = 512;
         for (; fCurrentBRDImage < fImages.count(); fCurrentBRDImage++) {
@@ -882,7 +909,7 @@ public:
 
             while (fCurrentColorType < fColorTypes.count()) {
                 while (fCurrentSampleSize < (int) SK_ARRAY_COUNT(brdSampleSizes)) {
-                    while (fCurrentSubsetType <= kLastSingle_SubsetType) {
+                    while (fCurrentSubsetType <= kLast_SubsetType) {
 
                         SkAutoTUnref<SkData> encoded(SkData::NewFromFileName(path.c_str()));
                         const SkColorType colorType = fColorTypes[fCurrentColorType];
@@ -924,6 +951,42 @@ public:
                                 subset = SkIRect::MakeXYWH(width - subsetSize,
                                         height - subsetSize, subsetSize, subsetSize);
                                 break;
+                            case kTranslate_SubsetType:
+                            case kTiledTranslate_SubsetType: {
+                                // Pan diagonally by a quarter of the output at a time.
+                                basename.append("_Translate");
+                                SkTArray<BitmapRegionDecoderBench::Region> regions;
+                                for (int i = 0; i < 16; i++) {
+                                    const int offset = i * subsetSize / 4;
+                                    regions.push_back({ SkIRect::MakeXYWH(
+                                            SkTMin(offset, width - (int) subsetSize),
+                                            SkTMin(offset, height - (int) subsetSize),
+                                            subsetSize, subsetSize), sampleSize });
+                                }
+                                return new BitmapRegionDecoderBench(basename.c_str(),
+                                        encoded.get(), colorType, sampleSize, regions,
+                                        kTiledTranslate_SubsetType == currentSubsetType ?
+                                        SkBitmapRegionDecoder::kAndroidCodecTiled_Strategy :
+                                        SkBitmapRegionDecoder::kAndroidCodec_Strategy);
+                            }
+                            case kZoom_SubsetType:
+                            case kTiledZoom_SubsetType: {
+                                // Zoom out and back in around the middle of the image.
+                                basename.append("_Zoom");
+                                SkTArray<BitmapRegionDecoderBench::Region> regions;
+                                for (uint32_t zoom : { 1, 2, 4, 2 }) {
+                                    const int size = SkTMin(zoom * subsetSize,
+                                                            (uint32_t) SkTMin(width, height));
+                                    regions.push_back({ SkIRect::MakeXYWH((width - size) / 2,
+                                            (height - size) / 2, size, size),
+                                            zoom * sampleSize });
+                                }
+                                return new BitmapRegionDecoderBench(basename.c_str(),
+                                        encoded.get(), colorType, sampleSize, regions,
+                                        kTiledZoom_SubsetType == currentSubsetType ?
+                                        SkBitmapRegionDecoder::kAndroidCodecTiled_Strategy :
+                                        SkBitmapRegionDecoder::kAndroidCodec_Strategy);
+                            }
                             default:
                                 SkASSERT(false);
                         }
@@ -979,15 +1042,17 @@ public:
 
 private:
     enum SubsetType {
-        kTopLeft_SubsetType     = 0,
-        kTopRight_SubsetType    = 1,
-        kMiddle_SubsetType      = 2,
-        kBottomLeft_SubsetType  = 3,
-        kBottomRight_SubsetType = 4,
-        kTranslate_SubsetType   = 5,
-        kZoom_SubsetType        = 6,
-        kLast_SubsetType        = kZoom_SubsetType,
-        kLastSingle_SubsetType  = kBottomRight_SubsetType,
+        kTopLeft_SubsetType        = 0,
+        kTopRight_SubsetType       = 1,
+        kMiddle_SubsetType         = 2,
+        kBottomLeft_SubsetType     = 3,
+        kBottomRight_SubsetType    = 4,
+        kTranslate_SubsetType      = 5,
+        kZoom_SubsetType           = 6,
+        kTiledTranslate_SubsetType = 7,
+        kTiledZoom_SubsetType      = 8,
+        kLast_SubsetType           = kTiledZoom_SubsetType,
+        kLastSingle_SubsetType     = kBottomRight_SubsetType,
     };
 
     const BenchRegistry* fBenches;
@@ -1012,6 +1077,8 @@ private:
     int fCurrentUseMPD;
     int fCurrentCodec;
     int fCurrentAndroidCodec;
+    int fCurrentAnimatedCodec;
+    int fCurrentAnimatedMode;
     int fCurrentBRDImage;
     int fCurrentColorImage;
     int fCurrentColorType;
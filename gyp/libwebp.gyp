@@ -277,6 +277,7 @@
                 'link_settings': {
                   'libraries': [
                     '-lwebp',
+                    '-lwebpdemux',
                   ],
                 },
               },
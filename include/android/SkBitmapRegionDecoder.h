@@ -21,7 +21,9 @@ class SkBitmapRegionDecoder {
 public:
 
     enum Strategy {
-        kAndroidCodec_Strategy, // Uses SkAndroidCodec for scaling and subsetting
+        kAndroidCodec_Strategy,      // Uses SkAndroidCodec for scaling and subsetting
+        kAndroidCodecTiled_Strategy, // Also keeps decoded tiles in SkResourceCache, so
+                                     // overlapping regions only decode the missing tiles
     };
 
     /*
@@ -18,7 +18,10 @@
 #include "SkTypes.h"
 #include "SkYUVSizeInfo.h"
 
+#include <vector>
+
 class SkColorSpace;
+class SkColorSpaceXform;
 class SkData;
 class SkPngChunkReader;
 class SkSampler;
@@ -250,6 +253,9 @@ public:
         Options()
             : fZeroInitialized(kNo_ZeroInitialized)
             , fSubset(NULL)
+            , fFrameIndex(0)
+            , fHasPriorFrame(false)
+            , fConvertColorSpace(false)
         {}
 
         ZeroInitialized fZeroInitialized;
@@ -271,6 +277,41 @@ public:
          *  to getScanlines().
          */
         SkIRect*        fSubset;
+
+        /**
+         *  The frame to decode.
+         *
+         *  Only meaningful for multi-frame images, and only supported by getPixels().
+         *  Must be less than getFrameCount().
+         */
+        size_t          fFrameIndex;
+
+        /**
+         *  If true, the dst already contains fFrameIndex's required frame (as
+         *  reported by getFrameInfo()), fully composited, so the codec only
+         *  needs to decode fFrameIndex and blend it on top.  This makes
+         *  sequential playback cost one frame per call.
+         *
+         *  If false, the codec first decodes the required frame (which in turn
+         *  may need its own required frame) into the dst.
+         *
+         *  Ignored for frames that do not depend on a prior frame.  When true,
+         *  fZeroInitialized is ignored, and fConvertColorSpace must not
+         *  require a conversion.
+         */
+        bool            fHasPriorFrame;
+
+        /**
+         *  If false (the default), the color space of the info passed to
+         *  getPixels() or startScanlineDecode() is ignored, and the pixels keep
+         *  the colors of the encoded image (described by getColorSpace()).
+         *
+         *  If true, and both the info and the encoded image have a color space,
+         *  the decoded colors are converted to the info's color space.  This is
+         *  only supported for RGBA_8888, BGRA_8888 and RGBA_F16 dsts, and is the
+         *  only way to decode to RGBA_F16.
+         */
+        bool            fConvertColorSpace;
     };
 
     /**
@@ -300,6 +341,10 @@ public:
      *  If info is not kIndex8_SkColorType, then the last two parameters may be NULL. If ctableCount
      *  is not null, it will be set to 0.
      *
+     *  If info has a color space, the image has an embedded color space, and the two differ,
+     *  the pixels are converted to info's color space as they are decoded.  This requires info
+     *  to be kRGBA_8888, kBGRA_8888 or kRGBA_F16 (which is always converted, and is linear).
+     *
      *  If a scanline decode is in progress, scanline mode will end, requiring the client to call
      *  startScanlineDecode() in order to return to decoding scanlines.
      *
@@ -314,14 +359,79 @@ public:
      */
     Result getPixels(const SkImageInfo& info, void* pixels, size_t rowBytes);
 
+    /**
+     *  Return the number of frames in the image.
+     *
+     *  May require reading through the stream to find them all, which will
+     *  end any scanline decode in progress.
+     */
+    size_t getFrameCount() {
+        return this->onGetFrameCount();
+    }
+
+    /**
+     *  The required frame of a frame that can be decoded on its own.
+     */
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    /**
+     *  What happens to a frame's pixels before the next frame is drawn.
+     */
+    enum DisposalMethod {
+        /**
+         *  The frame is left in place, and the next frame is drawn on top.
+         */
+        kKeep_DisposalMethod,
+        /**
+         *  The frame's rectangle is cleared to the background before the
+         *  next frame is drawn.
+         */
+        kRestoreBGColor_DisposalMethod,
+        /**
+         *  The frame's rectangle is restored to what it was before the frame
+         *  was drawn.
+         */
+        kRestorePrevious_DisposalMethod,
+    };
+
+    /**
+     *  Information about one frame of a multi-frame image.
+     */
+    struct FrameInfo {
+        /**
+         *  The frame that must be in the dst before this frame is blended
+         *  on top, or kNone if this frame can be decoded on its own.
+         */
+        size_t         fRequiredFrame;
+
+        /**
+         *  Number of milliseconds to show this frame.
+         */
+        size_t         fDuration;
+
+        DisposalMethod fDisposalMethod;
+    };
+
+    /**
+     *  Return info about the frames in the image, in display order.
+     *
+     *  May require reading through the stream to find them all, which will
+     *  end any scanline decode in progress.  For single-frame images this
+     *  returns an empty vector.
+     */
+    std::vector<FrameInfo> getFrameInfo() {
+        return this->onGetFrameInfo();
+    }
+
     /**
      *  If decoding to YUV is supported, this returns true.  Otherwise, this
      *  returns false and does not modify any of the parameters.
      *
      *  @param sizeInfo   Output parameter indicating the sizes and required
      *                    allocation widths of the Y, U, and V planes.
-     *  @param colorSpace Output parameter.  If non-NULL this is set to kJPEG,
-     *                    otherwise this is ignored.
+     *  @param colorSpace Output parameter.  If non-NULL this is set to the
+     *                    color space of the planes (kJPEG for JPEGs, kRec601
+     *                    for WebPs), otherwise this is ignored.
      */
     bool queryYUV8(SkYUVSizeInfo* sizeInfo, SkYUVColorSpace* colorSpace) const {
         if (nullptr == sizeInfo) {
@@ -372,7 +482,9 @@ public:
      *  @param dstInfo Info of the destination. If the dimensions do not match
      *      those of getInfo, this implies a scale.
      *  @param options Contains decoding options, including if memory is zero
-     *      initialized.
+     *      initialized.  Scanline decodes only decode the first frame of a
+     *      multi-frame image, so a non-zero fFrameIndex returns
+     *      kUnimplemented.
      *  @param ctable A pointer to a color table.  When dstInfo.colorType() is
      *      kIndex8, this should be non-NULL and have enough storage for 256
      *      colors.  The color table will be populated after decoding the palette.
@@ -554,6 +666,14 @@ protected:
                                SkPMColor ctable[], int* ctableCount,
                                int* rowsDecoded) = 0;
 
+    virtual size_t onGetFrameCount() {
+        return 1;
+    }
+
+    virtual std::vector<FrameInfo> onGetFrameInfo() {
+        return std::vector<FrameInfo>();
+    }
+
     virtual bool onQueryYUV8(SkYUVSizeInfo*, SkYUVColorSpace*) const {
         return false;
     }
@@ -670,6 +790,25 @@ private:
     SkCodec::Options            fOptions;
     int                         fCurrScanline;
 
+    // Converts decoded scanlines to the color space the client asked for, or nullptr if
+    // the client wants the encoded colors (or did not set fConvertColorSpace).  When non-null,
+    // fDstInfo describes the RGBA_8888 pixels we ask the subclass for, and fXformInfo describes
+    // what the client gets.
+    sk_sp<SkColorSpaceXform>    fColorXform;
+    SkImageInfo                 fXformInfo;
+
+    /**
+     *  Returns the xform needed to give the client pixels in dstInfo's color space, or
+     *  nullptr if no conversion is necessary or options.fConvertColorSpace is false.  If an
+     *  xform is returned, decodeInfo is set to the info to decode into before the conversion.
+     */
+    sk_sp<SkColorSpaceXform> makeColorXform(const SkImageInfo& dstInfo, const Options& options,
+                                            SkImageInfo* decodeInfo) const;
+
+    void applyColorXform(const SkColorSpaceXform*, const SkImageInfo& dstInfo, void* dst,
+                         size_t dstRowBytes, const void* src, size_t srcRowBytes, int width,
+                         int count) const;
+
     /**
      *  Return whether these dimensions are supported as a scale.
      *
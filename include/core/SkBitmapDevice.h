@@ -114,6 +114,9 @@ protected:
     virtual void drawPosText(const SkDraw&, const void* text, size_t len,
                              const SkScalar pos[], int scalarsPerPos,
                              const SkPoint& offset, const SkPaint& paint) override;
+    void drawTextBlobRun(const SkDraw&, const SkTextBlob*, int runIndex,
+                         const SkTextBlobRunIterator&, SkScalar x, SkScalar y,
+                         const SkPaint& paint) override;
     virtual void drawVertices(const SkDraw&, SkCanvas::VertexMode, int vertexCount,
                               const SkPoint verts[], const SkPoint texs[],
                               const SkColor colors[], SkXfermode* xmode,
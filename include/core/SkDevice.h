@@ -22,6 +22,7 @@ struct SkIRect;
 class SkMatrix;
 class SkMetaData;
 class SkRegion;
+class SkTextBlobRunIterator;
 class GrRenderTarget;
 
 class SK_API SkBaseDevice : public SkRefCnt {
@@ -255,6 +256,11 @@ protected:
     // default implementation unrolls the blob runs.
     virtual void drawTextBlob(const SkDraw&, const SkTextBlob*, SkScalar x, SkScalar y,
                               const SkPaint& paint, SkDrawFilter* drawFilter);
+    // Draws run 'runIndex' of the blob, whose font has already been applied to the paint.
+    // default implementation calls drawText or drawPosText.
+    virtual void drawTextBlobRun(const SkDraw&, const SkTextBlob*, int runIndex,
+                                 const SkTextBlobRunIterator&, SkScalar x, SkScalar y,
+                                 const SkPaint& paint);
     // default implementation calls drawVertices
     virtual void drawPatch(const SkDraw&, const SkPoint cubics[12], const SkColor colors[4],
                            const SkPoint texCoords[4], SkXfermode* xmode, const SkPaint& paint);
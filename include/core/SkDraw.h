@@ -23,6 +23,8 @@ class SkMatrix;
 class SkPath;
 class SkRegion;
 class SkRasterClip;
+class SkTextBlob;
+class SkTextBlobRunIterator;
 struct SkDrawProcs;
 struct SkRect;
 class SkRRect;
@@ -68,6 +70,12 @@ public:
     void    drawPosText(const char text[], size_t byteLength,
                         const SkScalar pos[], int scalarsPerPosition,
                         const SkPoint& offset, const SkPaint& paint) const;
+    /**
+     *  Draws one run of a text blob, as drawText() or drawPosText() would, but keeps where its
+     *  glyphs were placed in SkTextBlobRasterCache, to reuse when the blob is drawn again.
+     */
+    void    drawTextBlobRun(const SkTextBlob*, int runIndex, const SkTextBlobRunIterator&,
+                            SkScalar x, SkScalar y, const SkPaint&) const;
     void    drawVertices(SkCanvas::VertexMode mode, int count,
                          const SkPoint vertices[], const SkPoint textures[],
                          const SkColor colors[], SkXfermode* xmode,
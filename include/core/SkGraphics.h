@@ -72,6 +72,14 @@ public:
      */
     static int SetFontCacheCountLimit(int count);
 
+    /**
+     *  Set a directory in which the font cache keeps copies of its strikes (glyph metrics and
+     *  images for a typeface + pointSize + matrix), so later processes can map them instead of
+     *  rasterizing the glyphs again. Strikes are written when they are purged from the cache,
+     *  e.g. by PurgeFontCache(). Pass nullptr to stop using the directory (the default).
+     */
+    static void SetFontCacheDirectory(const char* dir);
+
     /**
      *  For debugging purposes, this will attempt to purge the font cache. It
      *  does not change the limit, but will cause subsequent font measures and
@@ -131,6 +139,7 @@ public:
      *  Applications with command line options may pass optional state, such
      *  as cache sizes, here, for instance:
      *  font-cache-limit=12345678
+     *  mipmap-async-build=1
      *
      *  The flags format is name=value[;name=value...] with no spaces.
      *  This format is subject to change.
@@ -110,6 +110,51 @@ DECLARE_ENCODER_CREATOR(PNGImageEncoder);
 DECLARE_ENCODER_CREATOR(KTXImageEncoder);
 DECLARE_ENCODER_CREATOR(WEBPImageEncoder);
 
+/**
+ *  Knobs for the libpng based encoder.  The defaults match what libpng picks on its own.
+ */
+struct SkPNGEncoderOptions {
+    /**
+     *  The row filters the encoder may choose from.  These match libpng's PNG_FILTER_ values.
+     *  When more than one is allowed, each row uses the one that is likely to compress best.
+     */
+    enum FilterFlag {
+        kNone_FilterFlag  = 0x08,
+        kSub_FilterFlag   = 0x10,
+        kUp_FilterFlag    = 0x20,
+        kAvg_FilterFlag   = 0x40,
+        kPaeth_FilterFlag = 0x80,
+        kAll_FilterFlag   = kNone_FilterFlag | kSub_FilterFlag | kUp_FilterFlag |
+                            kAvg_FilterFlag | kPaeth_FilterFlag,
+    };
+
+    enum ZLibStrategy {
+        kDefault_ZLibStrategy,
+        kFiltered_ZLibStrategy,
+        kHuffmanOnly_ZLibStrategy,
+        kRLE_ZLibStrategy,
+        kFixed_ZLibStrategy,
+    };
+
+    int          fFilterFlags  = kAll_FilterFlag;
+
+    /** zlib compression level, 0 (store) to 9 (smallest). */
+    int          fZLibLevel    = 6;
+
+    ZLibStrategy fZLibStrategy = kDefault_ZLibStrategy;
+
+    /**
+     *  When this is greater than 1, large images are split into row strips that are filtered
+     *  and deflated concurrently on the SkTaskGroup thread pool, this many at a time, and
+     *  then joined into a single zlib stream.  Each strip is primed with the tail of the
+     *  previous one as its dictionary, so the output is only slightly larger than a serial
+     *  encode.
+     */
+    int          fThreadCount  = 1;
+};
+
+SkImageEncoder* CreatePNGImageEncoder(const SkPNGEncoderOptions&);
+
 #if defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
 DECLARE_ENCODER_CREATOR(PNGImageEncoder_CG);
 #endif
@@ -80,6 +80,10 @@ bool    sk_exists(const char *path, SkFILE_Flags = (SkFILE_Flags)0);
 // Returns true if a directory exists at this path.
 bool    sk_isdir(const char *path);
 
+// Returns true if a file exists at this path, and sets its size and the time it was last
+// modified, in seconds since the epoch.
+bool    sk_stat(const char* path, size_t* size, int64_t* modified);
+
 // Have we reached the end of the file?
 int sk_feof(FILE *);
 
@@ -15,6 +15,12 @@ class SkFontMgr;
 /** Create a custom font manager which scans a given directory for font files. */
 SK_API SkFontMgr* SkFontMgr_New_Custom_Directory(const char* dir);
 
+/** Create a custom font manager which scans a given directory for font files, and remembers
+ *  what it found in the file at indexPath. Later managers using the same index only open the
+ *  fonts whose path, size or modification time are not in the index.
+ */
+SK_API SkFontMgr* SkFontMgr_New_Custom_Directory(const char* dir, const char* indexPath);
+
 /** Create a custom font manager that contains no built-in fonts. */
 SK_API SkFontMgr* SkFontMgr_New_Custom_Empty();
 
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkImagePrefetcher_DEFINED
+#define SkImagePrefetcher_DEFINED
+
+#include "SkImage.h"
+#include "SkRefCnt.h"
+#include "SkTemplates.h"
+
+class SkPicture;
+class SkTaskGroup;
+
+/** \class SkImagePrefetcher
+
+    Decodes lazily generated images (e.g. from SkImage::MakeFromEncoded) on background
+    threads, so the results are already in the resource cache when they are first drawn
+    to a raster canvas, rather than being decoded on the drawing thread.
+*/
+class SK_API SkImagePrefetcher : SkNoncopyable {
+public:
+    SkImagePrefetcher();
+
+    /**
+     *  Waits for any outstanding decodes.
+     */
+    ~SkImagePrefetcher();
+
+    /**
+     *  Queues the image to be decoded.  Images that are not lazily generated have nothing
+     *  to prefetch and are ignored.
+     */
+    void prefetch(sk_sp<SkImage>);
+
+    /**
+     *  Queues every image the picture draws, including those in nested pictures.
+     */
+    void prefetch(const SkPicture*);
+
+    /**
+     *  Blocks until every image queued so far has been decoded (or failed to decode).
+     */
+    void wait();
+
+    struct Stats {
+        int fPrefetched;    // Images decoded ahead of time.
+        int fAlreadyCached; // Prefetches that found the image already decoded.
+        int fHits;          // Raster draws that found the image already decoded.
+        int fMisses;        // Raster draws that had to decode synchronously.
+    };
+
+    /**
+     *  Process-wide counts, covering every lazily generated image, prefetched or not.
+     */
+    static Stats GetStats();
+    static void ResetStats();
+
+private:
+    SkAutoTDelete<SkTaskGroup> fTasks;
+};
+
+#endif
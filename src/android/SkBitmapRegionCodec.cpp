@@ -9,13 +9,83 @@
 #include "SkBitmapRegionCodec.h"
 #include "SkBitmapRegionDecoderPriv.h"
 #include "SkCodecPriv.h"
+#include "SkConfig8888.h"
+#include "SkNextID.h"
 #include "SkPixelRef.h"
+#include "SkResourceCache.h"
 
-SkBitmapRegionCodec::SkBitmapRegionCodec(SkAndroidCodec* codec)
+// Tiles are this many pixels square in the sampled image.
+static const int kTileSize = 256;
+
+namespace {
+static unsigned gTileKeyNamespaceLabel;
+
+static uint64_t make_shared_id(uint32_t tileCacheID) {
+    uint64_t sharedID = SkSetFourByteTag('b', 'r', 'd', 't');
+    return (sharedID << 32) | tileCacheID;
+}
+
+struct TileKey : public SkResourceCache::Key {
+public:
+    TileKey(uint32_t tileCacheID, int tileX, int tileY, int sampleSize, const SkImageInfo& info)
+        : fTileCacheID(tileCacheID)
+        , fTileX(tileX)
+        , fTileY(tileY)
+        , fSampleSize(sampleSize)
+        , fColorType(info.colorType())
+        , fAlphaType(info.alphaType())
+    {
+        this->init(&gTileKeyNamespaceLabel, make_shared_id(tileCacheID),
+                   sizeof(fTileCacheID) + sizeof(fTileX) + sizeof(fTileY) + sizeof(fSampleSize) +
+                   sizeof(fColorType) + sizeof(fAlphaType));
+    }
+
+    const uint32_t fTileCacheID;
+    const int32_t  fTileX;
+    const int32_t  fTileY;
+    const int32_t  fSampleSize;
+    const int32_t  fColorType;
+    const int32_t  fAlphaType;
+};
+
+struct TileRec : public SkResourceCache::Rec {
+    TileRec(const TileKey& key, const SkBitmap& tile) : fKey(key), fTile(tile) {}
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(fKey) + fTile.getSize(); }
+
+    const char* getCategory() const override { return "region-tile"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override {
+        return fTile.pixelRef()->diagnostic_only_getDiscardable();
+    }
+
+    static bool Finder(const SkResourceCache::Rec& baseRec, void* contextTile) {
+        const TileRec& rec = static_cast<const TileRec&>(baseRec);
+        SkBitmap* result = (SkBitmap*)contextTile;
+
+        *result = rec.fTile;
+        result->lockPixels();
+        return SkToBool(result->getPixels());
+    }
+
+private:
+    TileKey  fKey;
+    SkBitmap fTile;
+};
+} // namespace
+
+SkBitmapRegionCodec::SkBitmapRegionCodec(SkAndroidCodec* codec, bool cacheTiles)
     : INHERITED(codec->getInfo().width(), codec->getInfo().height())
     , fCodec(codec)
+    , fTileCacheID(cacheTiles ? SkNextID::ImageID() : 0)
 {}
 
+SkBitmapRegionCodec::~SkBitmapRegionCodec() {
+    if (fTileCacheID) {
+        SkResourceCache::PostPurgeSharedID(make_shared_id(fTileCacheID));
+    }
+}
+
 bool SkBitmapRegionCodec::decodeRegion(SkBitmap* bitmap, SkBRDAllocator* allocator,
         const SkIRect& desiredSubset, int sampleSize, SkColorType prefColorType,
         bool requireUnpremul) {
@@ -107,6 +177,13 @@ bool SkBitmapRegionCodec::decodeRegion(SkBitmap* bitmap, SkBRDAllocator* allocat
         memset(pixels, 0, bytes);
     }
 
+    // Tiles are shared between requests, so they cannot carry a per-request color table.
+    void* dst = bitmap->getAddr(scaledOutX, scaledOutY);
+    if (fTileCacheID && kIndex_8_SkColorType != dstColorType) {
+        return this->decodeTiles(SkPixmap(decodeInfo, dst, bitmap->rowBytes()), subset,
+                                 sampleSize);
+    }
+
     // Decode into the destination bitmap
     SkAndroidCodec::AndroidOptions options;
     options.fSampleSize = sampleSize;
@@ -114,7 +191,6 @@ bool SkBitmapRegionCodec::decodeRegion(SkBitmap* bitmap, SkBRDAllocator* allocat
     options.fColorPtr = colors;
     options.fColorCount = &maxColors;
     options.fZeroInitialized = zeroInit;
-    void* dst = bitmap->getAddr(scaledOutX, scaledOutY);
 
     SkCodec::Result result = fCodec->getAndroidPixels(decodeInfo, dst, bitmap->rowBytes(),
             &options);
@@ -131,6 +207,111 @@ bool SkBitmapRegionCodec::decodeRegion(SkBitmap* bitmap, SkBRDAllocator* allocat
     return true;
 }
 
+bool SkBitmapRegionCodec::decodeTiles(const SkPixmap& dst, const SkIRect& subset,
+        int sampleSize) {
+    // Find the output in the sampled image.  When the subset does not start on a multiple
+    // of sampleSize, this is the closest match whose samples we can share with other regions.
+    const SkISize size = fCodec->getInfo().dimensions();
+    const int sampledWidth = get_scaled_dimension(size.width(), sampleSize);
+    const int sampledHeight = get_scaled_dimension(size.height(), sampleSize);
+    const SkIRect dstBounds = SkIRect::MakeXYWH(
+            SkTMin(subset.x() / sampleSize, sampledWidth - dst.width()),
+            SkTMin(subset.y() / sampleSize, sampledHeight - dst.height()),
+            dst.width(), dst.height());
+    SkASSERT(dstBounds.x() >= 0 && dstBounds.y() >= 0);
+
+    const int firstTileX = dstBounds.left() / kTileSize;
+    const int lastTileX = (dstBounds.right() - 1) / kTileSize;
+    const int firstTileY = dstBounds.top() / kTileSize;
+    const int lastTileY = (dstBounds.bottom() - 1) / kTileSize;
+    const size_t bpp = dst.info().bytesPerPixel();
+
+    SkAutoTArray<SkBitmap> tiles(lastTileX - firstTileX + 1);
+    for (int tileY = firstTileY; tileY <= lastTileY; tileY++) {
+        // Decode the span of missing tiles in this row at once.  Starting the decoder is the
+        // expensive part, and tiles in the middle of the span are usually missing too.
+        int firstMissing = -1;
+        int lastMissing = -1;
+        for (int tileX = firstTileX; tileX <= lastTileX; tileX++) {
+            SkBitmap* tile = &tiles[tileX - firstTileX];
+            tile->reset();
+            TileKey key(fTileCacheID, tileX, tileY, sampleSize, dst.info());
+            if (!SkResourceCache::Find(key, TileRec::Finder, tile)) {
+                if (firstMissing < 0) {
+                    firstMissing = tileX;
+                }
+                lastMissing = tileX;
+            }
+        }
+        if (firstMissing >= 0 && !this->decodeTileRow(dst.info(), sampleSize, tileY,
+                firstMissing, lastMissing, &tiles[firstMissing - firstTileX])) {
+            return false;
+        }
+
+        for (int tileX = firstTileX; tileX <= lastTileX; tileX++) {
+            const SkBitmap& tile = tiles[tileX - firstTileX];
+            const SkIRect tileBounds = SkIRect::MakeXYWH(tileX * kTileSize, tileY * kTileSize,
+                                                         tile.width(), tile.height());
+            SkIRect overlap;
+            if (!overlap.intersect(tileBounds, dstBounds)) {
+                continue;
+            }
+            SkRectMemcpy(dst.writable_addr(overlap.x() - dstBounds.x(),
+                                           overlap.y() - dstBounds.y()), dst.rowBytes(),
+                         tile.getAddr(overlap.x() - tileBounds.x(), overlap.y() - tileBounds.y()),
+                         tile.rowBytes(), overlap.width() * bpp, overlap.height());
+        }
+    }
+    return true;
+}
+
+bool SkBitmapRegionCodec::decodeTileRow(const SkImageInfo& info, int sampleSize, int tileY,
+        int firstTileX, int lastTileX, SkBitmap tiles[]) {
+    const SkISize size = fCodec->getInfo().dimensions();
+    const int srcTileSize = kTileSize * sampleSize;
+    SkIRect subset = SkIRect::MakeLTRB(firstTileX * srcTileSize, tileY * srcTileSize,
+                                       SkTMin(size.width(), (lastTileX + 1) * srcTileSize),
+                                       SkTMin(size.height(), (tileY + 1) * srcTileSize));
+    const SkISize spanSize = fCodec->getSampledSubsetDimensions(sampleSize, subset);
+
+    SkBitmap span;
+    if (!span.tryAllocPixels(info.makeWH(spanSize.width(), spanSize.height()))) {
+        SkCodecPrintf("Error: Could not allocate pixels.\n");
+        return false;
+    }
+
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = sampleSize;
+    options.fSubset = &subset;
+    SkCodec::Result result = fCodec->getAndroidPixels(span.info(), span.getPixels(),
+            span.rowBytes(), &options);
+    if (SkCodec::kSuccess != result && SkCodec::kIncompleteInput != result) {
+        SkCodecPrintf("Error: Could not get pixels.\n");
+        return false;
+    }
+
+    const size_t bpp = info.bytesPerPixel();
+    for (int tileX = firstTileX; tileX <= lastTileX; tileX++) {
+        const int x = (tileX - firstTileX) * kTileSize;
+        SkBitmap* tile = &tiles[tileX - firstTileX];
+        tile->setInfo(span.info().makeWH(SkTMin(kTileSize, span.width() - x), span.height()));
+        if (!tile->tryAllocPixels(SkResourceCache::GetAllocator(), nullptr)) {
+            SkCodecPrintf("Error: Could not allocate pixels.\n");
+            return false;
+        }
+        SkRectMemcpy(tile->getPixels(), tile->rowBytes(), span.getAddr(x, 0), span.rowBytes(),
+                     tile->width() * bpp, tile->height());
+        tile->setImmutable();
+
+        // Leave incomplete tiles out of the cache, in case more of the data shows up later.
+        if (SkCodec::kSuccess == result) {
+            TileKey key(fTileCacheID, tileX, tileY, sampleSize, info);
+            SkResourceCache::Add(new TileRec(key, *tile));
+        }
+    }
+    return true;
+}
+
 bool SkBitmapRegionCodec::conversionSupported(SkColorType colorType) {
     return conversion_possible(fCodec->getInfo().makeColorType(colorType), fCodec->getInfo());
 }
@@ -17,8 +17,14 @@ public:
 
     /*
      * Takes ownership of pointer to codec
+     *
+     * If cacheTiles is true, regions are assembled from fixed tiles of the sampled image,
+     * which are kept in SkResourceCache.  Regions that do not start on a multiple of the
+     * sample size may then pick neighboring samples from a direct decode.
      */
-    SkBitmapRegionCodec(SkAndroidCodec* codec);
+    SkBitmapRegionCodec(SkAndroidCodec* codec, bool cacheTiles = false);
+
+    ~SkBitmapRegionCodec() override;
 
     bool decodeRegion(SkBitmap* bitmap, SkBRDAllocator* allocator,
                       const SkIRect& desiredSubset, int sampleSize,
@@ -30,7 +36,22 @@ public:
 
 private:
 
+    /*
+     * Fill dst, which holds the given subset sampled by sampleSize, from cached tiles,
+     * decoding any tiles that are missing.
+     */
+    bool decodeTiles(const SkPixmap& dst, const SkIRect& subset, int sampleSize);
+
+    /*
+     * Decode tiles [firstTileX, lastTileX] of tile row tileY in a single pass and add
+     * them to the cache.  tiles[i] is set to tile firstTileX + i.
+     */
+    bool decodeTileRow(const SkImageInfo& info, int sampleSize, int tileY, int firstTileX,
+                       int lastTileX, SkBitmap tiles[]);
+
     SkAutoTDelete<SkAndroidCodec> fCodec;
+    // Identifies our tiles in SkResourceCache, or 0 if we do not cache tiles.
+    const uint32_t                fTileCacheID;
 
     typedef SkBitmapRegionDecoder INHERITED;
 
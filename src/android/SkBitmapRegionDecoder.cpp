@@ -21,7 +21,8 @@ SkBitmapRegionDecoder* SkBitmapRegionDecoder::Create(
         SkStreamRewindable* stream, Strategy strategy) {
     SkAutoTDelete<SkStreamRewindable> streamDeleter(stream);
     switch (strategy) {
-        case kAndroidCodec_Strategy: {
+        case kAndroidCodec_Strategy:
+        case kAndroidCodecTiled_Strategy: {
             SkAutoTDelete<SkAndroidCodec> codec =
                     SkAndroidCodec::NewFromStream(streamDeleter.release());
             if (nullptr == codec) {
@@ -39,7 +40,8 @@ SkBitmapRegionDecoder* SkBitmapRegionDecoder::Create(
                     return nullptr;
             }
 
-            return new SkBitmapRegionCodec(codec.release());
+            return new SkBitmapRegionCodec(codec.release(),
+                                           kAndroidCodecTiled_Strategy == strategy);
         }
         default:
             SkASSERT(false);
@@ -8,6 +8,7 @@
 #include "SkBmpRLECodec.h"
 #include "SkCodecPriv.h"
 #include "SkColorPriv.h"
+#include "SkOpts.h"
 #include "SkStream.h"
 
 /*
@@ -107,13 +108,14 @@ SkCodec::Result SkBmpRLECodec::onGetPixels(const SkImageInfo& dstInfo,
 
         // To avoid segmentation faults on bad pixel data, fill the end of the
         // color table with black.  This is the same the behavior as the
-        // chromium decoder.
-        for (; i < maxColors; i++) {
+        // chromium decoder.  SkOpts::index_to_565() may convert all 256
+        // entries at once, so our own table is always full size.
+        for (; i < 256; i++) {
             colorTable[i] = SkPackARGB32NoCheck(0xFF, 0, 0, 0);
         }
 
         // Set the color table
-        fColorTable.reset(new SkColorTable(colorTable, maxColors));
+        fColorTable.reset(new SkColorTable(colorTable, 256));
     }
 
     // Check that we have not read past the pixel array offset
@@ -197,35 +199,59 @@ size_t SkBmpRLECodec::checkForMoreData() {
 }
 
 /*
- * Set an RLE pixel using the color table
+ * Set a run of RLE pixels using the color table
  */
-void SkBmpRLECodec::setPixel(void* dst, size_t dstRowBytes,
-                             const SkImageInfo& dstInfo, uint32_t x, uint32_t y,
-                             uint8_t index) {
-    if (dst && is_coord_necessary(x, fSampleX, dstInfo.width())) {
-        // Set the row
-        uint32_t row = this->getDstRow(y, dstInfo.height());
+void SkBmpRLECodec::setPixels(void* dst, size_t dstRowBytes,
+                              const SkImageInfo& dstInfo, uint32_t x, uint32_t y,
+                              const uint8_t* indices, int count) {
+    SkASSERT(count <= 256);
+    if (!dst || count <= 0) {
+        return;
+    }
 
-        // Set the pixel based on destination color type
-        const int dstX = get_dst_coord(x, fSampleX);
-        switch (dstInfo.colorType()) {
-            case kRGBA_8888_SkColorType:
-            case kBGRA_8888_SkColorType: {
-                SkPMColor* dstRow = SkTAddOffset<SkPMColor>(dst, row * (int) dstRowBytes);
-                dstRow[dstX] = fColorTable->operator[](index);
-                break;
-            }
-            case kRGB_565_SkColorType: {
-                uint16_t* dstRow = SkTAddOffset<uint16_t>(dst, row * (int) dstRowBytes);
-                dstRow[dstX] = SkPixel32ToPixel16(fColorTable->operator[](index));
-                break;
-            }
-            default:
-                // This case should not be reached.  We should catch an invalid
-                // color type when we check that the conversion is possible.
-                SkASSERT(false);
-                break;
+    // Find the first source pixel in the run that survives sampling, and gather the indices
+    // we keep, so the whole run can be expanded at once.
+    uint8_t sampled[256];
+    int dstX = x;
+    if (fSampleX > 1) {
+        const int startX = get_start_coord(fSampleX);
+        int srcX = SkTMax<int>(x, startX);
+        srcX += (fSampleX - (srcX - startX) % fSampleX) % fSampleX;
+        const int skip = srcX - x;
+        if (skip >= count) {
+            return;
+        }
+        dstX = get_dst_coord(srcX, fSampleX);
+        count = (count - skip + fSampleX - 1) / fSampleX;
+        for (int i = 0; i < count; i++) {
+            sampled[i] = indices[skip + i * fSampleX];
         }
+        indices = sampled;
+    }
+    count = SkTMin(count, dstInfo.width() - dstX);
+    if (count <= 0) {
+        return;
+    }
+
+    // Set the pixels based on destination color type
+    const uint32_t row = this->getDstRow(y, dstInfo.height());
+    switch (dstInfo.colorType()) {
+        case kRGBA_8888_SkColorType:
+        case kBGRA_8888_SkColorType: {
+            SkPMColor* dstRow = SkTAddOffset<SkPMColor>(dst, row * (int) dstRowBytes);
+            SkOpts::index_to_8888(dstRow + dstX, indices, count, fColorTable->readColors());
+            break;
+        }
+        case kRGB_565_SkColorType: {
+            uint16_t* dstRow = SkTAddOffset<uint16_t>(dst, row * (int) dstRowBytes);
+            SkOpts::index_to_565(dstRow + dstX, indices, count, fColorTable->readColors());
+            break;
+        }
+        default:
+            // This case should not be reached.  We should catch an invalid
+            // color type when we check that the conversion is possible.
+            SkASSERT(false);
+            break;
     }
 }
 
@@ -422,40 +448,39 @@ int SkBmpRLECodec::decodeRows(const SkImageInfo& info, void* dst, size_t dstRowB
                         }
                     }
                     // Set numPixels number of pixels
-                    while (numPixels > 0) {
-                        switch(this->bitsPerPixel()) {
-                            case 4: {
-                                SkASSERT(fCurrRLEByte < fRLEBytes);
-                                uint8_t val = fStreamBuffer.get()[fCurrRLEByte++];
-                                setPixel(dst, dstRowBytes, dstInfo, x++,
-                                        y, val >> 4);
-                                numPixels--;
-                                if (numPixels != 0) {
-                                    setPixel(dst, dstRowBytes, dstInfo,
-                                            x++, y, val & 0xF);
-                                    numPixels--;
-                                }
-                                break;
+                    const uint8_t* src = fStreamBuffer.get() + fCurrRLEByte;
+                    switch(this->bitsPerPixel()) {
+                        case 4: {
+                            SkASSERT(fCurrRLEByte + (numPixels - 1) / 2 < fRLEBytes);
+                            uint8_t indices[256];
+                            for (int i = 0; i < numPixels; i++) {
+                                indices[i] = (i & 1) ? src[i >> 1] & 0xF : src[i >> 1] >> 4;
                             }
-                            case 8:
-                                SkASSERT(fCurrRLEByte < fRLEBytes);
-                                setPixel(dst, dstRowBytes, dstInfo, x++,
-                                        y, fStreamBuffer.get()[fCurrRLEByte++]);
-                                numPixels--;
-                                break;
-                            case 24: {
-                                SkASSERT(fCurrRLEByte + 2 < fRLEBytes);
-                                uint8_t blue = fStreamBuffer.get()[fCurrRLEByte++];
-                                uint8_t green = fStreamBuffer.get()[fCurrRLEByte++];
-                                uint8_t red = fStreamBuffer.get()[fCurrRLEByte++];
+                            setPixels(dst, dstRowBytes, dstInfo, x, y, indices, numPixels);
+                            fCurrRLEByte += (numPixels + 1) / 2;
+                            x += numPixels;
+                            break;
+                        }
+                        case 8:
+                            SkASSERT(fCurrRLEByte + numPixels - 1 < fRLEBytes);
+                            setPixels(dst, dstRowBytes, dstInfo, x, y, src, numPixels);
+                            fCurrRLEByte += numPixels;
+                            x += numPixels;
+                            break;
+                        case 24:
+                            SkASSERT(fCurrRLEByte + 3 * numPixels - 1 < fRLEBytes);
+                            for (int i = 0; i < numPixels; i++) {
+                                uint8_t blue = src[3*i + 0];
+                                uint8_t green = src[3*i + 1];
+                                uint8_t red = src[3*i + 2];
                                 setRGBPixel(dst, dstRowBytes, dstInfo,
                                             x++, y, red, green, blue);
-                                numPixels--;
                             }
-                            default:
-                                SkASSERT(false);
-                                return y;
-                        }
+                            fCurrRLEByte += 3 * numPixels;
+                            break;
+                        default:
+                            SkASSERT(false);
+                            return y;
                     }
                     // Skip a byte if necessary to maintain alignment
                     if (!SkIsAlign2(rowBytes)) {
@@ -501,9 +526,13 @@ int SkBmpRLECodec::decodeRows(const SkImageInfo& info, void* dst, size_t dstRowB
                 }
 
                 // Set the indicated number of pixels
-                for (int which = 0; x < endX; x++) {
-                    setPixel(dst, dstRowBytes, dstInfo, x, y, indices[which]);
-                    which = !which;
+                if (x < endX) {
+                    uint8_t run[256];
+                    for (int i = 0; i < endX - x; i++) {
+                        run[i] = indices[i & 1];
+                    }
+                    setPixels(dst, dstRowBytes, dstInfo, x, y, run, endX - x);
+                    x = endX;
                 }
             }
         }
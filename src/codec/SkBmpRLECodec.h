@@ -72,11 +72,11 @@ private:
     size_t checkForMoreData();
 
     /*
-     * Set an RLE pixel using the color table
+     * Set a run of up to 256 RLE pixels starting at x using the color table
      */
-    void setPixel(void* dst, size_t dstRowBytes,
-                  const SkImageInfo& dstInfo, uint32_t x, uint32_t y,
-                  uint8_t index);
+    void setPixels(void* dst, size_t dstRowBytes,
+                   const SkImageInfo& dstInfo, uint32_t x, uint32_t y,
+                   const uint8_t* indices, int count);
     /*
      * Set an RLE24 pixel from R, G, B values
      */
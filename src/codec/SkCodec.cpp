@@ -9,6 +9,7 @@
 #include "SkCodec.h"
 #include "SkCodecPriv.h"
 #include "SkColorSpace.h"
+#include "SkColorSpaceXform.h"
 #include "SkData.h"
 #include "SkGifCodec.h"
 #include "SkIcoCodec.h"
@@ -114,6 +115,8 @@ SkCodec* SkCodec::NewFromData(SkData* data, SkPngChunkReader* reader) {
     return NewFromStream(new SkMemoryStream(data), reader);
 }
 
+constexpr size_t SkCodec::kNone;
+
 SkCodec::SkCodec(int width, int height, const SkEncodedInfo& info, SkStream* stream,
         sk_sp<SkColorSpace> colorSpace, Origin origin)
     : fEncodedInfo(info)
@@ -129,6 +132,55 @@ SkCodec::SkCodec(int width, int height, const SkEncodedInfo& info, SkStream* str
 
 SkCodec::~SkCodec() {}
 
+sk_sp<SkColorSpaceXform> SkCodec::makeColorXform(const SkImageInfo& dstInfo,
+                                                 const Options& options,
+                                                 SkImageInfo* decodeInfo) const {
+    SkColorSpace* srcSpace = fColorSpace.get();
+    SkColorSpace* dstSpace = dstInfo.colorSpace();
+    if (!options.fConvertColorSpace || !srcSpace || !dstSpace) {
+        return nullptr;
+    }
+
+    switch (dstInfo.colorType()) {
+        case kRGBA_8888_SkColorType:
+        case kBGRA_8888_SkColorType:
+            if (srcSpace == dstSpace || (srcSpace->gammaNamed() == dstSpace->gammaNamed() &&
+                                         SkColorSpace::kNonStandard_GammaNamed !=
+                                                 srcSpace->gammaNamed() &&
+                                         srcSpace->xyz() == dstSpace->xyz() &&
+                                         !as_CSB(srcSpace)->colorLUT())) {
+                return nullptr;
+            }
+            break;
+        case kRGBA_F16_SkColorType:
+            // No subclass can decode to F16, so we always go through the xform.
+            break;
+        default:
+            return nullptr;
+    }
+
+    sk_sp<SkColorSpaceXform> xform =
+            SkColorSpaceXform::FindOrNew(sk_ref_sp(srcSpace), sk_ref_sp(dstSpace));
+    if (xform) {
+        // The xform expects unpremultiplied RGBA, and premultiplies on the way out.
+        const SkAlphaType at = (kPremul_SkAlphaType == dstInfo.alphaType())
+                             ? kUnpremul_SkAlphaType : dstInfo.alphaType();
+        *decodeInfo = dstInfo.makeColorType(kRGBA_8888_SkColorType).makeAlphaType(at);
+    }
+    return xform;
+}
+
+void SkCodec::applyColorXform(const SkColorSpaceXform* xform, const SkImageInfo& dstInfo,
+                              void* dst, size_t dstRowBytes, const void* src, size_t srcRowBytes,
+                              int width, int count) const {
+    for (int y = 0; y < count; y++) {
+        xform->apply(dst, (const uint32_t*) src, width, dstInfo.colorType(),
+                     dstInfo.alphaType());
+        dst = SkTAddOffset<void>(dst, dstRowBytes);
+        src = SkTAddOffset<const void>(src, srcRowBytes);
+    }
+}
+
 bool SkCodec::rewindIfNeeded() {
     if (!fStream) {
         // Some codecs do not have a stream, but they hold others that do. They
@@ -195,17 +247,40 @@ SkCodec::Result SkCodec::getPixels(const SkImageInfo& info, void* pixels, size_t
         }
     }
 
+    if (options->fFrameIndex > 0 && options->fFrameIndex >= this->getFrameCount()) {
+        return kInvalidParameters;
+    }
+
     // FIXME: Support subsets somehow? Note that this works for SkWebpCodec
     // because it supports arbitrary scaling/subset combinations.
     if (!this->dimensionsSupported(info.dimensions())) {
         return kInvalidScale;
     }
 
+    // If the client asked to convert to a different color space, the subclass decodes RGBA_8888
+    // first.
+    // 8888 dsts are converted in place, F16 dsts need somewhere else to decode to.
+    SkImageInfo decodeInfo = info;
+    void* decodePixels = pixels;
+    size_t decodeRowBytes = rowBytes;
+    SkAutoTMalloc<uint32_t> decodeStorage;
+    sk_sp<SkColorSpaceXform> xform = this->makeColorXform(info, *options, &decodeInfo);
+    if (xform && options->fHasPriorFrame && options->fFrameIndex > 0) {
+        // The prior frame in the dst has already been converted, so there is nothing to
+        // blend the new frame with before the conversion.
+        return kInvalidConversion;
+    }
+    if (xform && kRGBA_F16_SkColorType == info.colorType()) {
+        decodeRowBytes = decodeInfo.minRowBytes();
+        decodeStorage.reset(decodeInfo.getSafeSize(decodeRowBytes) / sizeof(uint32_t));
+        decodePixels = decodeStorage.get();
+    }
+
     // On an incomplete decode, the subclass will specify the number of scanlines that it decoded
     // successfully.
     int rowsDecoded = 0;
-    const Result result = this->onGetPixels(info, pixels, rowBytes, *options, ctable, ctableCount,
-            &rowsDecoded);
+    const Result result = this->onGetPixels(decodeInfo, decodePixels, decodeRowBytes, *options,
+            ctable, ctableCount, &rowsDecoded);
 
     if ((kIncompleteInput == result || kSuccess == result) && ctableCount) {
         SkASSERT(*ctableCount >= 0 && *ctableCount <= 256);
@@ -217,8 +292,13 @@ SkCodec::Result SkCodec::getPixels(const SkImageInfo& info, void* pixels, size_t
     // their own.  They indicate that all of the memory has been filled by
     // setting rowsDecoded equal to the height.
     if (kIncompleteInput == result && rowsDecoded != info.height()) {
-        this->fillIncompleteImage(info, pixels, rowBytes, options->fZeroInitialized, info.height(),
-                rowsDecoded);
+        this->fillIncompleteImage(decodeInfo, decodePixels, decodeRowBytes,
+                options->fZeroInitialized, info.height(), rowsDecoded);
+    }
+
+    if (xform && (kSuccess == result || kIncompleteInput == result)) {
+        this->applyColorXform(xform.get(), info, pixels, rowBytes, decodePixels, decodeRowBytes,
+                              info.width(), info.height());
     }
 
     return result;
@@ -253,6 +333,9 @@ SkCodec::Result SkCodec::startScanlineDecode(const SkImageInfo& dstInfo,
     Options optsStorage;
     if (nullptr == options) {
         options = &optsStorage;
+    } else if (options->fFrameIndex > 0) {
+        // Only getPixels() can blend frames.
+        return kUnimplemented;
     } else if (options->fSubset) {
         SkIRect size = SkIRect::MakeSize(dstInfo.dimensions());
         if (!size.contains(*options->fSubset)) {
@@ -271,14 +354,19 @@ SkCodec::Result SkCodec::startScanlineDecode(const SkImageInfo& dstInfo,
         return kInvalidScale;
     }
 
-    const Result result = this->onStartScanlineDecode(dstInfo, *options, ctable, ctableCount);
+    SkImageInfo decodeInfo = dstInfo;
+    sk_sp<SkColorSpaceXform> xform = this->makeColorXform(dstInfo, *options, &decodeInfo);
+
+    const Result result = this->onStartScanlineDecode(decodeInfo, *options, ctable, ctableCount);
     if (result != SkCodec::kSuccess) {
         return result;
     }
 
     fCurrScanline = 0;
-    fDstInfo = dstInfo;
+    fDstInfo = decodeInfo;
     fOptions = *options;
+    fColorXform = std::move(xform);
+    fXformInfo = dstInfo;
     return kSuccess;
 }
 
@@ -296,11 +384,27 @@ int SkCodec::getScanlines(void* dst, int countLines, size_t rowBytes) {
         return 0;
     }
 
-    const int linesDecoded = this->onGetScanlines(dst, countLines, rowBytes);
+    void* decodeDst = dst;
+    size_t decodeRowBytes = rowBytes;
+    SkAutoTMalloc<uint32_t> decodeStorage;
+    const int width = fOptions.fSubset ? fOptions.fSubset->width() : fDstInfo.width();
+    if (fColorXform && kRGBA_F16_SkColorType == fXformInfo.colorType()) {
+        decodeRowBytes = fDstInfo.minRowBytes();
+        decodeStorage.reset(countLines * fDstInfo.width());
+        decodeDst = decodeStorage.get();
+    }
+
+    const int linesDecoded = this->onGetScanlines(decodeDst, countLines, decodeRowBytes);
     if (linesDecoded < countLines) {
-        this->fillIncompleteImage(this->dstInfo(), dst, rowBytes, this->options().fZeroInitialized,
-                countLines, linesDecoded);
+        this->fillIncompleteImage(this->dstInfo(), decodeDst, decodeRowBytes,
+                this->options().fZeroInitialized, countLines, linesDecoded);
+    }
+
+    if (fColorXform) {
+        this->applyColorXform(fColorXform.get(), fXformInfo, dst, rowBytes, decodeDst,
+                              decodeRowBytes, width, countLines);
     }
+
     fCurrScanline += countLines;
     return linesDecoded;
 }
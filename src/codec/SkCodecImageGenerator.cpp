@@ -64,3 +64,48 @@ bool SkCodecImageGenerator::onGetYUV8Planes(const SkYUVSizeInfo& sizeInfo, void*
             return false;
     }
 }
+
+// Only JPEG scales in the decoder itself, by dropping DCT coefficients, which filters like a
+// box filter.  Other codecs can only sample, which drops whole pixels and would alias in the
+// filtered draws that ask for scaled pixels.
+static bool scales_natively(SkCodec* codec) {
+    return kJPEG_SkEncodedFormat == codec->getEncodedFormat();
+}
+
+// JPEG scales by eighths.
+static const int kScaleDenominator = 8;
+
+bool SkCodecImageGenerator::onComputeScaledDimensions(SkScalar scale, SupportedSizes* sizes) {
+    SkASSERT(scale > 0 && scale <= 1);
+    if (!scales_natively(fCodec)) {
+        return false;
+    }
+
+    // Rounding up gives the smallest supported size that is still at least as large as the
+    // requested one, so drawing it never has to upscale.
+    const int num = SkTPin(SkScalarCeilToInt(scale * kScaleDenominator), 1, kScaleDenominator);
+    sizes->fSizes[0] = fCodec->getScaledDimensions((float) num / kScaleDenominator);
+    sizes->fSizes[1] = fCodec->getScaledDimensions((float) SkTMax(num - 1, 1) /
+                                                   kScaleDenominator);
+    return !sizes->fSizes[0].isEmpty() && !sizes->fSizes[1].isEmpty();
+}
+
+bool SkCodecImageGenerator::onGenerateScaledPixels(const SkISize& scaledSize,
+                                                   const SkIPoint& scaledOrigin,
+                                                   const SkPixmap& scaledPixels) {
+    // Only whole images can be decoded scaled.
+    if (scaledOrigin.x() || scaledOrigin.y() ||
+            scaledPixels.info().dimensions() != scaledSize || !scales_natively(fCodec)) {
+        return false;
+    }
+
+    // The codec rejects sizes it cannot scale to natively.
+    switch (fCodec->getPixels(scaledPixels.info(), scaledPixels.writable_addr(),
+                              scaledPixels.rowBytes())) {
+        case SkCodec::kSuccess:
+        case SkCodec::kIncompleteInput:
+            return true;
+        default:
+            return false;
+    }
+}
@@ -30,6 +30,10 @@ protected:
 
     bool onGetYUV8Planes(const SkYUVSizeInfo&, void* planes[3]) override;
 
+    bool onComputeScaledDimensions(SkScalar scale, SupportedSizes*) override;
+
+    bool onGenerateScaledPixels(const SkISize&, const SkIPoint&, const SkPixmap&) override;
+
 private:
     /*
      * Takes ownership of codec
@@ -11,6 +11,7 @@
 #include "SkGifCodec.h"
 #include "SkStream.h"
 #include "SkSwizzler.h"
+#include "SkTaskGroup.h"
 #include "SkUtils.h"
 
 #include "gif_lib.h"
@@ -93,6 +94,97 @@ static uint32_t find_trans_index(const SavedImage& image) {
     return SK_MaxU32;
 }
 
+/*
+ * Reads an extension.  If it is a graphics control extension, sets the timing,
+ * disposal and transparent index of the image that follows it.
+ */
+static bool read_extension(GifFileType* gif, SkCodec::FrameInfo* info, uint32_t* transIndex) {
+    int32_t extFunction;
+    GifByteType* extData;
+    if (GIF_ERROR == DGifGetExtension(gif, &extFunction, &extData)) {
+        return false;
+    }
+
+    // A graphics control extension holds a packed byte, the delay time in hundredths
+    // of a second (little endian), and the transparent index.
+    if (GRAPHICS_EXT_FUNC_CODE == extFunction && nullptr != extData && extData[0] >= 4) {
+        switch ((extData[1] >> 2) & 7) {
+            case 2:
+                info->fDisposalMethod = SkCodec::kRestoreBGColor_DisposalMethod;
+                break;
+            case 3:
+                info->fDisposalMethod = SkCodec::kRestorePrevious_DisposalMethod;
+                break;
+            default:
+                // Unspecified, do not dispose, and the reserved values.
+                info->fDisposalMethod = SkCodec::kKeep_DisposalMethod;
+                break;
+        }
+        info->fDuration = (extData[2] | (extData[3] << 8)) * 10;
+        *transIndex = (extData[1] & 1) ? extData[4] : SK_MaxU32;
+    }
+
+    while (nullptr != extData) {
+        if (GIF_ERROR == DGifGetExtensionNext(gif, &extData)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Skips the image data that follows an image descriptor
+ */
+static bool skip_image_data(GifFileType* gif) {
+    int32_t codeSize;
+    GifByteType* codeBlock;
+    if (GIF_ERROR == DGifGetCode(gif, &codeSize, &codeBlock)) {
+        return false;
+    }
+    while (nullptr != codeBlock) {
+        if (GIF_ERROR == DGifGetCodeNext(gif, &codeBlock)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Reads through extensions to the next image descriptor, and reads it
+ */
+static bool read_next_image_desc(GifFileType* gif) {
+    SkCodec::FrameInfo info;
+    uint32_t transIndex;
+    GifRecordType recordType;
+    do {
+        if (GIF_ERROR == DGifGetRecordType(gif, &recordType)) {
+            return false;
+        }
+        if (IMAGE_DESC_RECORD_TYPE == recordType) {
+            return GIF_ERROR != DGifGetImageDesc(gif);
+        }
+        if (EXTENSION_RECORD_TYPE == recordType && !read_extension(gif, &info, &transIndex)) {
+            return false;
+        }
+    } while (TERMINATE_RECORD_TYPE != recordType);
+    return false;
+}
+
+/*
+ * Restore previous frames leave nothing behind, so a frame is drawn on top of
+ * the most recent frame before it that is not restored to the previous one.
+ */
+template <typename Frames>
+static size_t prior_frame(const Frames& frames, size_t index) {
+    while (index > 0) {
+        index--;
+        if (SkCodec::kRestorePrevious_DisposalMethod != frames[index].fInfo.fDisposalMethod) {
+            return index;
+        }
+    }
+    return SkCodec::kNone;
+}
+
 inline uint32_t ceil_div(uint32_t a, uint32_t b) {
     return (a + b - 1) / b;
 }
@@ -251,9 +343,18 @@ SkGifCodec::SkGifCodec(int width, int height, const SkEncodedInfo& info, SkStrea
     // there is a valid background color.
     , fFillIndex(0)
     , fFrameIsSubset(frameIsSubset)
+    , fFramesScanned(false)
     , fSwizzler(NULL)
     , fColorTable(NULL)
-{}
+{
+    Frame& first = fFrames.push_back();
+    first.fRect = frameRect;
+    first.fTransIndex = transIndex;
+    first.fOffset = 0;
+    first.fInfo.fRequiredFrame = kNone;
+    first.fInfo.fDuration = 0;
+    first.fInfo.fDisposalMethod = kKeep_DisposalMethod;
+}
 
 bool SkGifCodec::onRewind() {
     GifFileType* gifOut = nullptr;
@@ -266,6 +367,135 @@ bool SkGifCodec::onRewind() {
     return true;
 }
 
+bool SkGifCodec::rewindToFirstFrame() {
+    return this->stream()->rewind() && this->onRewind();
+}
+
+void SkGifCodec::scanFrames() {
+    if (fFramesScanned) {
+        return;
+    }
+    fFramesScanned = true;
+
+    SkStream* stream = this->stream();
+    if (!stream->rewind()) {
+        return;
+    }
+
+    // Walk the stream with a separate GifFileType.  Only the image descriptors and
+    // extensions are read; the image data is skipped without decompressing it.
+    {
+        SkAutoTCallVProc<GifFileType, CloseGif> gif(open_gif(stream));
+        if (nullptr == gif) {
+            return;
+        }
+
+        const FrameInfo defaultInfo = { kNone, 0, kKeep_DisposalMethod };
+        FrameInfo info = defaultInfo;
+        uint32_t transIndex = SK_MaxU32;
+        int frameCount = 0;
+        GifRecordType recordType;
+        do {
+            const size_t offset = stream->hasPosition() ? stream->getPosition() : 0;
+            if (GIF_ERROR == DGifGetRecordType(gif, &recordType)) {
+                break;
+            }
+            if (IMAGE_DESC_RECORD_TYPE == recordType) {
+                if (GIF_ERROR == DGifGetImageDesc(gif)) {
+                    break;
+                }
+                const GifImageDesc& desc = gif->Image;
+                Frame& frame = frameCount < fFrames.count() ? fFrames[frameCount]
+                                                            : fFrames.push_back();
+                frame.fRect.setXYWH(desc.Left, desc.Top, desc.Width, desc.Height);
+                frame.fTransIndex = transIndex;
+                frame.fOffset = offset;
+                frame.fInfo = info;
+                frameCount++;
+
+                // A graphics control extension only applies to the image that follows it.
+                info = defaultInfo;
+                transIndex = SK_MaxU32;
+                if (!skip_image_data(gif)) {
+                    break;
+                }
+            } else if (EXTENSION_RECORD_TYPE == recordType) {
+                if (!read_extension(gif, &info, &transIndex)) {
+                    break;
+                }
+            }
+        } while (TERMINATE_RECORD_TYPE != recordType);
+    }
+
+    const SkIRect bounds = SkIRect::MakeSize(this->getInfo().dimensions());
+    int maxWidth = this->getInfo().width();
+    for (int i = 0; i < fFrames.count(); i++) {
+        Frame& frame = fFrames[i];
+        maxWidth = SkTMax(maxWidth, frame.fRect.width());
+
+        const size_t prior = prior_frame(fFrames, i);
+        if (kNone == prior || (frame.fRect.contains(bounds) && frame.fTransIndex >= 256)) {
+            // Nothing shows through this frame.
+            frame.fInfo.fRequiredFrame = kNone;
+        } else if (kRestoreBGColor_DisposalMethod == fFrames[prior].fInfo.fDisposalMethod) {
+            // Whatever the prior frame covered is cleared, so this frame is drawn on
+            // top of what the prior frame was drawn on top of.
+            frame.fInfo.fRequiredFrame = fFrames[prior].fRect.contains(bounds)
+                                       ? kNone : fFrames[prior].fInfo.fRequiredFrame;
+        } else {
+            frame.fInfo.fRequiredFrame = prior;
+        }
+    }
+
+    // Later frames may be wider than the logical screen.
+    if (maxWidth > this->getInfo().width()) {
+        fSrcBuffer.reset(new uint8_t[maxWidth]);
+    }
+
+    this->rewindToFirstFrame();
+}
+
+bool SkGifCodec::seekToFrame(size_t index) {
+    if (0 == index) {
+        return true;
+    }
+
+    SkStream* stream = this->stream();
+    if (stream->hasPosition() && stream->seek(fFrames[index].fOffset)) {
+        return read_next_image_desc(fGif);
+    }
+
+    for (size_t i = 0; i < index; i++) {
+        if (!skip_image_data(fGif) || !read_next_image_desc(fGif)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SkGifCodec::setFrame(size_t index) {
+    const Frame& frame = fFrames[index];
+    fFrameRect = frame.fRect;
+    fTransIndex = frame.fTransIndex;
+    fFrameIsSubset = !fFrameRect.contains(SkIRect::MakeSize(this->getInfo().dimensions()));
+}
+
+size_t SkGifCodec::onGetFrameCount() {
+    this->scanFrames();
+    return fFrames.count();
+}
+
+std::vector<SkCodec::FrameInfo> SkGifCodec::onGetFrameInfo() {
+    this->scanFrames();
+    std::vector<FrameInfo> result;
+    if (fFrames.count() > 1) {
+        for (const Frame& frame : fFrames) {
+            result.push_back(frame.fInfo);
+        }
+    }
+    return result;
+}
+
 SkCodec::Result SkGifCodec::ReadUpToFirstImage(GifFileType* gif, uint32_t* transIndex) {
     // Use this as a container to hold information about any gif extension
     // blocks.  This generally stores transparency and animation instructions.
@@ -289,27 +519,10 @@ SkCodec::Result SkGifCodec::ReadUpToFirstImage(GifFileType* gif, uint32_t* trans
             case IMAGE_DESC_RECORD_TYPE: {
                 *transIndex = find_trans_index(saveExt);
 
-                // FIXME: Gif files may have multiple images stored in a single
-                //        file.  This is most commonly used to enable
-                //        animations.  Since we are leaving animated gifs as a
-                //        TODO, we will return kSuccess after decoding the
-                //        first image in the file.  This is the same behavior
-                //        as SkImageDecoder_libgif.
-                //
-                //        Most times this works pretty well, but sometimes it
-                //        doesn't.  For example, I have an animated test image
-                //        where the first image in the file is 1x1, but the
-                //        subsequent images are meaningful.  This currently
-                //        displays the 1x1 image, which is not ideal.  Right
-                //        now I am leaving this as an issue that will be
-                //        addressed when we implement animated gifs.
-                //
-                //        It is also possible (not explicitly disallowed in the
-                //        specification) that gif files provide multiple
-                //        images in a single file that are all meant to be
-                //        displayed in the same frame together.  I will
-                //        currently leave this unimplemented until I find a
-                //        test case that expects this behavior.
+                // Gif files may have multiple images stored in a single
+                // file, most commonly to enable animations.  The logical
+                // screen's dimensions are based on this first image, and
+                // scanFrames() finds the rest when a client asks for them.
                 return kSuccess;
             }
             // Extensions are used to specify special properties of the image
@@ -389,6 +602,7 @@ void SkGifCodec::initializeColorTable(const SkImageInfo& dstInfo, SkPMColor* inp
         int* inputColorCount) {
     // Set up our own color table
     const uint32_t maxColors = 256;
+    fFillIndex = 0;
     SkPMColor colorPtr[256];
     if (NULL != inputColorCount) {
         // We set the number of colors to maxColors in order to ensure
@@ -464,9 +678,11 @@ SkCodec::Result SkGifCodec::prepareToDecode(const SkImageInfo& dstInfo, SkPMColo
 
 void SkGifCodec::initializeSwizzler(const SkImageInfo& dstInfo, const Options& opts) {
     const SkPMColor* colorPtr = get_color_ptr(fColorTable.get());
-    const SkIRect* frameRect = fFrameIsSubset ? &fFrameRect : nullptr;
+    // Later frames may hang off the right or bottom of the logical screen.
+    SkIRect frameRect = fFrameRect;
+    const bool visible = frameRect.intersect(SkIRect::MakeSize(this->getInfo().dimensions()));
     fSwizzler.reset(SkSwizzler::CreateSwizzler(this->getEncodedInfo(), colorPtr, dstInfo, opts,
-            frameRect));
+            fFrameIsSubset && visible ? &frameRect : nullptr));
     SkASSERT(fSwizzler);
 }
 
@@ -483,31 +699,173 @@ SkCodec::Result SkGifCodec::onGetPixels(const SkImageInfo& dstInfo,
                                         SkPMColor* inputColorPtr,
                                         int* inputColorCount,
                                         int* rowsDecoded) {
-    Result result = this->prepareToDecode(dstInfo, inputColorPtr, inputColorCount, opts);
+    if (dstInfo.dimensions() != this->getInfo().dimensions()) {
+        return gif_error("Scaling not supported.\n", kInvalidScale);
+    }
+
+    if (opts.fFrameIndex > 0) {
+        this->scanFrames();
+    }
+    return this->decodeFrame(opts.fFrameIndex, dstInfo, dst, dstRowBytes, opts, inputColorPtr,
+            inputColorCount, rowsDecoded);
+}
+
+SkCodec::Result SkGifCodec::decodeFrame(size_t index, const SkImageInfo& dstInfo, void* dst,
+        size_t dstRowBytes, const Options& opts, SkPMColor* inputColorPtr,
+        int* inputColorCount, int* rowsDecoded) {
+    const size_t requiredFrame = fFrames[index].fInfo.fRequiredFrame;
+    const bool blend = kNone != requiredFrame;
+    if (blend) {
+        if (kIndex_8_SkColorType == dstInfo.colorType()) {
+            // Each frame may have its own color table, so their indices cannot be mixed.
+            return gif_error("Cannot blend frames into kIndex8.\n", kInvalidConversion);
+        }
+
+        if (!opts.fHasPriorFrame) {
+            Result result = this->decodeFrame(requiredFrame, dstInfo, dst, dstRowBytes, opts,
+                    inputColorPtr, inputColorCount, rowsDecoded);
+            if (kSuccess != result) {
+                return result;
+            }
+            if (!this->rewindToFirstFrame()) {
+                return kCouldNotRewind;
+            }
+        }
+
+        // Every row holds the prior frame, so there is nothing left to fill in if this
+        // frame turns out to be incomplete.
+        *rowsDecoded = dstInfo.height();
+    }
+
+    if (!this->seekToFrame(index)) {
+        return gif_error("Could not find frame.\n", kIncompleteInput);
+    }
+    this->setFrame(index);
+
+    Options frameOpts(opts);
+    if (blend) {
+        frameOpts.fZeroInitialized = kNo_ZeroInitialized;
+    }
+    Result result = this->prepareToDecode(dstInfo, inputColorPtr, inputColorCount, frameOpts);
     if (kSuccess != result) {
         return result;
     }
 
-    if (dstInfo.dimensions() != this->getInfo().dimensions()) {
-        return gif_error("Scaling not supported.\n", kInvalidScale);
+    const SkIRect bounds = SkIRect::MakeSize(dstInfo.dimensions());
+    if (!blend) {
+        if (fFrameIsSubset) {
+            // Fill the background
+            SkSampler::Fill(dstInfo, dst, dstRowBytes, this->getFillValue(dstInfo.colorType()),
+                    opts.fZeroInitialized);
+        }
+    } else {
+        const size_t prior = prior_frame(fFrames, index);
+        SkIRect priorRect = fFrames[prior].fRect;
+        if (kRestoreBGColor_DisposalMethod == fFrames[prior].fInfo.fDisposalMethod &&
+                priorRect.intersect(bounds)) {
+            // SkSampler::Fill() treats rows as contiguous, so fill the rectangle a row at a
+            // time to leave the pixels beside it alone.
+            const SkImageInfo fillInfo = dstInfo.makeWH(priorRect.width(), 1);
+            const uint32_t fillValue = this->getFillValue(dstInfo.colorType());
+            for (int y = priorRect.top(); y < priorRect.bottom(); y++) {
+                void* fillDst = SkTAddOffset<void>(dst, y * dstRowBytes +
+                                                        priorRect.left() * dstInfo.bytesPerPixel());
+                SkSampler::Fill(fillInfo, fillDst, dstRowBytes, fillValue, kNo_ZeroInitialized);
+            }
+        }
     }
 
-    // Initialize the swizzler
-    if (fFrameIsSubset) {
-        // Fill the background
-        SkSampler::Fill(dstInfo, dst, dstRowBytes, this->getFillValue(dstInfo.colorType()),
-                opts.fZeroInitialized);
+    SkIRect visibleRect = fFrameRect;
+    if (!visibleRect.intersect(bounds)) {
+        return kSuccess;
+    }
+
+    // When blending, pixels using the transparent index let the prior frame show through.
+    const bool skipTransparent = blend && fTransIndex < 256;
+    if (!skipTransparent && fFrameRect.height() >= 2 * kRowsPerBatch) {
+        return this->decodeRowsInBatches(dst, dstRowBytes, bounds.bottom(),
+                                         blend ? nullptr : rowsDecoded);
     }
 
+    const size_t bytesPerPixel = dstInfo.bytesPerPixel();
+    SkAutoTMalloc<uint8_t> blendRow(skipTransparent ? dstInfo.minRowBytes() : 0);
+
     // Iterate over rows of the input
     for (int y = fFrameRect.top(); y < fFrameRect.bottom(); y++) {
         if (!this->readRow()) {
-            *rowsDecoded = y;
+            if (!blend) {
+                *rowsDecoded = y;
+            }
+            return gif_error("Could not decode line.\n", kIncompleteInput);
+        }
+        const int outputY = this->outputScanline(y);
+        if (outputY >= bounds.bottom()) {
+            continue;
+        }
+        void* dstRow = SkTAddOffset<void>(dst, dstRowBytes * outputY);
+        if (!skipTransparent) {
+            fSwizzler->swizzle(dstRow, fSrcBuffer.get());
+            continue;
+        }
+
+        fSwizzler->swizzle(blendRow.get(), fSrcBuffer.get());
+        const uint8_t* src = fSrcBuffer.get();
+        for (int x = visibleRect.left(); x < visibleRect.right(); x++) {
+            if (fTransIndex != src[x - fFrameRect.left()]) {
+                memcpy(SkTAddOffset<void>(dstRow, x * bytesPerPixel),
+                       blendRow.get() + x * bytesPerPixel, bytesPerPixel);
+            }
+        }
+    }
+    return kSuccess;
+}
+
+SkCodec::Result SkGifCodec::decodeRowsInBatches(void* dst, size_t dstRowBytes, int dstHeight,
+                                                int* rowsDecoded) {
+    // LZW decoding is inherently serial, but expanding indices is not, so swizzle each
+    // batch of rows on another thread while the next batch is decoded.  Two batches of
+    // indices are enough to keep both threads busy.
+    const int srcWidth = fFrameRect.width();
+    SkAutoTMalloc<uint8_t> indices(2 * kRowsPerBatch * srcWidth);
+    int outputRows[2][kRowsPerBatch];
+    SkTaskGroup tg;
+
+    int y = fFrameRect.top();
+    for (int batch = 0; y < fFrameRect.bottom(); batch = !batch) {
+        uint8_t* src = indices.get() + batch * kRowsPerBatch * srcWidth;
+        int* outputY = outputRows[batch];
+        const int batchEnd = SkTMin(y + kRowsPerBatch, fFrameRect.bottom());
+        int count = 0;
+        bool success = true;
+        for (; y < batchEnd; y++, count++) {
+            if (GIF_ERROR == DGifGetLine(fGif, src + count * srcWidth, srcWidth)) {
+                success = false;
+                break;
+            }
+            outputY[count] = this->outputScanline(y);
+        }
+
+        // The task using the other buffer must finish before we refill it next time around.
+        tg.wait();
+        SkSwizzler* swizzler = fSwizzler.get();
+        tg.add([=]() {
+            for (int i = 0; i < count; i++) {
+                if (outputY[i] < dstHeight) {
+                    swizzler->swizzle(SkTAddOffset<void>(dst, dstRowBytes * outputY[i]),
+                                      src + i * srcWidth);
+                }
+            }
+        });
+
+        if (!success) {
+            tg.wait();
+            if (rowsDecoded) {
+                *rowsDecoded = y;
+            }
             return gif_error("Could not decode line.\n", kIncompleteInput);
         }
-        void* dstRow = SkTAddOffset<void>(dst, dstRowBytes * this->outputScanline(y));
-        fSwizzler->swizzle(dstRow, fSrcBuffer.get());
     }
+    tg.wait();
     return kSuccess;
 }
 
@@ -520,6 +878,7 @@ uint32_t SkGifCodec::onGetFillValue(SkColorType colorType) const {
 
 SkCodec::Result SkGifCodec::onStartScanlineDecode(const SkImageInfo& dstInfo,
         const SkCodec::Options& opts, SkPMColor inputColorPtr[], int* inputColorCount) {
+    this->setFrame(0);
     return this->prepareToDecode(dstInfo, inputColorPtr, inputColorCount, opts);
 }
 
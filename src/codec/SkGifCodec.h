@@ -10,6 +10,7 @@
 #include "SkColorTable.h"
 #include "SkImageInfo.h"
 #include "SkSwizzler.h"
+#include "SkTArray.h"
 
 struct GifFileType;
 struct SavedImage;
@@ -70,13 +71,25 @@ protected:
 
     int onOutputScanline(int inputScanline) const override;
 
+    size_t onGetFrameCount() override;
+
+    std::vector<FrameInfo> onGetFrameInfo() override;
+
 private:
 
+    struct Frame {
+        // Unclipped, in the coordinates of the logical screen.
+        SkIRect   fRect;
+        uint32_t  fTransIndex;
+        // Stream position of the frame's image separator, when the stream has positions.
+        size_t    fOffset;
+        FrameInfo fInfo;
+    };
+
     /*
-     * A gif can contain multiple image frames.  We will only decode the first
-     * frame.  This function reads up to the first image frame, processing
-     * transparency and/or animation information that comes before the image
-     * data.
+     * A gif can contain multiple image frames.  This function reads up to the
+     * first image frame, processing transparency and/or animation information
+     * that comes before the image data.  Later frames are found by scanFrames().
      *
      * @param gif        Pointer to the library type that manages the gif decode
      * @param transIndex This call will set the transparent index based on the
@@ -143,6 +156,50 @@ private:
      */
     bool readRow();
 
+    /*
+     * Reads through the whole stream once, recording the rectangle, timing,
+     * disposal and stream offset of every frame, and works out which prior
+     * frame each one depends on.  Leaves the codec rewound to the first frame.
+     *
+     * Only the first call does any work.
+     */
+    void scanFrames();
+
+    /*
+     * Rewinds the stream and reads up to the first frame's image data.
+     */
+    bool rewindToFirstFrame();
+
+    /*
+     * Moves from the first frame's image data to the image data of frame
+     * index, seeking straight to it if the stream allows.
+     */
+    bool seekToFrame(size_t index);
+
+    /*
+     * Makes index the frame that the swizzler, color table and scanline
+     * helpers describe.
+     */
+    void setFrame(size_t index);
+
+    /*
+     * Decodes frame index into the dst, first decoding its required frame
+     * unless opts.fHasPriorFrame.  Expects the codec to be at the first frame.
+     */
+    Result decodeFrame(size_t index, const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+            const Options& opts, SkPMColor* inputColorPtr, int* inputColorCount,
+            int* rowsDecoded);
+
+    /*
+     * Decodes the rows of the current frame straight into dst, overlapping
+     * LZW decoding with swizzling on another thread.  Sets rowsDecoded, if
+     * non-null, on incomplete input.
+     */
+    Result decodeRowsInBatches(void* dst, size_t dstRowBytes, int dstHeight, int* rowsDecoded);
+
+    // Number of rows decoded before handing them off to be swizzled.
+    static constexpr int kRowsPerBatch = 16;
+
     Result onStartScanlineDecode(const SkImageInfo& dstInfo, const Options& opts,
                    SkPMColor inputColorPtr[], int* inputColorCount) override;
 
@@ -194,10 +251,13 @@ private:
 
     SkAutoTCallVProc<GifFileType, CloseGif> fGif; // owned
     SkAutoTDeleteArray<uint8_t>             fSrcBuffer;
-    const SkIRect                           fFrameRect;
-    const uint32_t                          fTransIndex;
+    // The frame being decoded.  The first frame, unless getPixels() asked for another.
+    SkIRect                                 fFrameRect;
+    uint32_t                                fTransIndex;
     uint32_t                                fFillIndex;
-    const bool                              fFrameIsSubset;
+    bool                                    fFrameIsSubset;
+    SkTArray<Frame, true>                   fFrames;
+    bool                                    fFramesScanned;
     SkAutoTDelete<SkSwizzler>               fSwizzler;
     SkAutoTUnref<SkColorTable>              fColorTable;
 
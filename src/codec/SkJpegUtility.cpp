@@ -14,6 +14,22 @@
  */
 static void sk_init_source(j_decompress_ptr dinfo) {
     skjpeg_source_mgr* src = (skjpeg_source_mgr*) dinfo->src;
+    SkStream* stream = src->fStream;
+    const void* base = stream->getMemoryBase();
+    if (base && stream->hasPosition() && stream->hasLength() &&
+            stream->getPosition() <= stream->getLength()) {
+        // The stream is already in memory (e.g. an mmapped SkData), so let libjpeg read it in
+        // place rather than copying it through fBuffer.  Consume the stream, so any further
+        // fill or skip finds it exhausted, exactly as if we had read it all.
+        const size_t position = stream->getPosition();
+        const size_t remaining = stream->getLength() - position;
+        if (remaining == stream->skip(remaining)) {
+            src->next_input_byte = (const JOCTET*) base + position;
+            src->bytes_in_buffer = remaining;
+            return;
+        }
+    }
+
     src->next_input_byte = (const JOCTET*) src->fBuffer;
     src->bytes_in_buffer = 0;
 }
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "SkBitmapScaler.h"
 #include "SkCodec.h"
 #include "SkCodecPriv.h"
 #include "SkMath.h"
@@ -135,6 +136,78 @@ SkCodec::Result SkSampledCodec::onGetAndroidPixels(const SkImageInfo& info, void
 }
 
 
+// Map a subset of an image with dimensions srcSize onto the same image scaled to dstSize.
+// Edges are rounded to the nearest pixel, so the result is off by at most half a pixel.
+static SkIRect scale_subset(const SkIRect& subset, const SkISize& srcSize, const SkISize& dstSize) {
+    auto scale = [](int x, int dst, int src) {
+        return SkToInt(((int64_t) x * dst + src / 2) / src);
+    };
+    return SkIRect::MakeLTRB(scale(subset.left(),   dstSize.width(),  srcSize.width()),
+                             scale(subset.top(),    dstSize.height(), srcSize.height()),
+                             scale(subset.right(),  dstSize.width(),  srcSize.width()),
+                             scale(subset.bottom(), dstSize.height(), srcSize.height()));
+}
+
+int SkSampledCodec::getNativeScaleNumerator(const SkImageInfo& info, const SkIRect& subset,
+        int nativeSampleSize) const {
+    // Only JPEG supports scaling by arbitrary eighths, and SkBitmapScaler only resizes N32.
+    if (this->codec()->getEncodedFormat() != kJPEG_SkEncodedFormat ||
+            kN32_SkColorType != info.colorType()) {
+        return 0;
+    }
+
+    const SkISize size = this->codec()->getInfo().dimensions();
+    for (int num = 1; num * nativeSampleSize < 8; num++) {
+        const SkISize scaledSize = this->codec()->getScaledDimensions(num / 8.0f);
+        const SkIRect scaledSubset = scale_subset(subset, size, scaledSize);
+        if (scaledSubset.width() >= info.width() && scaledSubset.height() >= info.height()) {
+            return num;
+        }
+    }
+    return 0;
+}
+
+SkCodec::Result SkSampledCodec::nativeScaleThenResize(const SkImageInfo& info, void* pixels,
+        size_t rowBytes, const AndroidOptions& options, int scaleNumerator) {
+    const SkISize size = this->codec()->getInfo().dimensions();
+    const SkISize nativeSize = this->codec()->getScaledDimensions(scaleNumerator / 8.0f);
+    const SkIRect nativeSubset = scale_subset(options.fSubset ? *options.fSubset
+                                                              : SkIRect::MakeSize(size),
+                                              size, nativeSize);
+
+    // The scanline decoder only needs to be aware of subsetting in the x-dimension.
+    SkIRect scanlineSubset = SkIRect::MakeXYWH(nativeSubset.x(), 0, nativeSubset.width(),
+                                               nativeSize.height());
+    SkCodec::Options codecOptions;
+    codecOptions.fSubset = &scanlineSubset;
+    SkCodec::Result result = this->codec()->startScanlineDecode(
+            info.makeWH(nativeSize.width(), nativeSize.height()), &codecOptions,
+            options.fColorPtr, options.fColorCount);
+    if (SkCodec::kSuccess != result) {
+        return result;
+    }
+
+    if (!this->codec()->skipScanlines(nativeSubset.y())) {
+        this->codec()->fillIncompleteImage(info, pixels, rowBytes, options.fZeroInitialized,
+                info.height(), 0);
+        return SkCodec::kIncompleteInput;
+    }
+
+    const SkImageInfo nativeInfo = info.makeWH(nativeSubset.width(), nativeSubset.height());
+    const size_t nativeRowBytes = nativeInfo.minRowBytes();
+    SkAutoTMalloc<uint8_t> storage(nativeInfo.getSafeSize(nativeRowBytes));
+    const int decodedLines = this->codec()->getScanlines(storage.get(), nativeInfo.height(),
+                                                         nativeRowBytes);
+
+    // getScanlines() has already filled any rows it could not decode.
+    if (!SkBitmapScaler::Resize(SkPixmap(info, pixels, rowBytes),
+                                SkPixmap(nativeInfo, storage.get(), nativeRowBytes),
+                                SkBitmapScaler::RESIZE_BOX)) {
+        return SkCodec::kInvalidScale;
+    }
+    return decodedLines == nativeInfo.height() ? SkCodec::kSuccess : SkCodec::kIncompleteInput;
+}
+
 SkCodec::Result SkSampledCodec::sampledDecode(const SkImageInfo& info, void* pixels,
         size_t rowBytes, const AndroidOptions& options) {
     // We should only call this function when sampling.
@@ -149,6 +222,13 @@ SkCodec::Result SkSampledCodec::sampledDecode(const SkImageInfo& info, void* pix
     int nativeSampleSize;
     SkISize nativeSize = this->accountForNativeScaling(&sampleSize, &nativeSampleSize);
 
+    const SkIRect fullSubset = SkIRect::MakeSize(this->codec()->getInfo().dimensions());
+    const int scaleNumerator = this->getNativeScaleNumerator(info,
+            options.fSubset ? *options.fSubset : fullSubset, nativeSampleSize);
+    if (scaleNumerator) {
+        return this->nativeScaleThenResize(info, pixels, rowBytes, options, scaleNumerator);
+    }
+
     // Check if there is a subset.
     SkIRect subset;
     int subsetY = 0;
@@ -55,6 +55,23 @@ private:
     SkCodec::Result sampledDecode(const SkImageInfo& info, void* pixels, size_t rowBytes,
             const AndroidOptions& options);
 
+    /**
+     *  fCodec may be able to scale by n/8 for any n (JPEG can).  Return the smallest n
+     *  that still covers the requested (subset) dimensions, or 0 if sampling after
+     *  nativeSampleSize would decode no more pixels.
+     */
+    int getNativeScaleNumerator(const SkImageInfo& info, const SkIRect& subset,
+            int nativeSampleSize) const;
+
+    /**
+     *  This fulfills the same contract as onGetAndroidPixels().
+     *
+     *  Let fCodec scale by scaleNumerator/8, decoding only the rows and columns that
+     *  cover the subset, then resize to the exact requested dimensions.
+     */
+    SkCodec::Result nativeScaleThenResize(const SkImageInfo& info, void* pixels, size_t rowBytes,
+            const AndroidOptions& options, int scaleNumerator);
+
     typedef SkAndroidCodec INHERITED;
 };
 #endif // SkSampledCodec_DEFINED
@@ -150,6 +150,97 @@ static void swizzle_bit_to_565(
 #undef RGB565_BLACK
 #undef RGB565_WHITE
 
+// Row-batched versions of the bit and small index procs, for when we are not sampling.
+// Rather than tracking a bit index for every pixel, these unpack a whole source byte at a
+// time, handing each index to lookup().
+template <int kBpp, typename T, typename Lookup>
+static void unpack_indices(T* SK_RESTRICT dst, const uint8_t* SK_RESTRICT src, int width,
+                           int bitOffset, Lookup lookup) {
+    constexpr int kPerByte = 8 / kBpp;
+    constexpr uint8_t kMask = (1 << kBpp) - 1;
+
+    // Finish the partial first byte.  Offsets are always a whole number of pixels.
+    src += bitOffset / 8;
+    int bitIndex = bitOffset % 8;
+    for (; bitIndex != 0 && width > 0; width--) {
+        *dst++ = lookup((*src >> (8 - kBpp - bitIndex)) & kMask);
+        bitIndex += kBpp;
+        if (8 == bitIndex) {
+            bitIndex = 0;
+            src++;
+        }
+    }
+
+    for (; width >= kPerByte; width -= kPerByte) {
+        const uint8_t byte = *src++;
+        for (int i = 0; i < kPerByte; i++) {
+            dst[i] = lookup((byte >> (8 - kBpp * (i + 1))) & kMask);
+        }
+        dst += kPerByte;
+    }
+
+    for (int i = 0; i < width; i++) {
+        dst[i] = lookup((*src >> (8 - kBpp * (i + 1))) & kMask);
+    }
+}
+
+template <typename T, typename Lookup>
+static void unpack_indices(T* dst, const uint8_t* src, int width, int bpp, int bitOffset,
+                           Lookup lookup) {
+    switch (bpp) {
+        case 1:  unpack_indices<1>(dst, src, width, bitOffset, lookup); break;
+        case 2:  unpack_indices<2>(dst, src, width, bitOffset, lookup); break;
+        default: unpack_indices<4>(dst, src, width, bitOffset, lookup); break;
+    }
+}
+
+static void fast_swizzle_bit_to_grayscale(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor* /*ctable*/) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    unpack_indices<1>((uint8_t*) dst, src, width, offset,
+                      [](uint8_t bit) -> uint8_t { return bit ? 0xFF : 0; });
+}
+
+static void fast_swizzle_bit_to_index(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor* /*ctable*/) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    unpack_indices<1>((uint8_t*) dst, src, width, offset, [](uint8_t bit) { return bit; });
+}
+
+static void fast_swizzle_bit_to_n32(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor* /*ctable*/) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    unpack_indices<1>((SkPMColor*) dst, src, width, offset,
+                      [](uint8_t bit) { return bit ? SK_ColorWHITE : SK_ColorBLACK; });
+}
+
+static void fast_swizzle_bit_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor* /*ctable*/) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    unpack_indices<1>((uint16_t*) dst, src, width, offset,
+                      [](uint8_t bit) -> uint16_t { return bit ? 0xFFFF : 0; });
+}
+
 // kIndex1, kIndex2, kIndex4
 
 static void swizzle_small_index_to_index(
@@ -215,6 +306,46 @@ static void swizzle_small_index_to_n32(
     }
 }
 
+static void fast_swizzle_small_index_to_index(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    unpack_indices((uint8_t*) dst, src, width, bpp, offset, [](uint8_t index) { return index; });
+}
+
+static void fast_swizzle_small_index_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    // There are at most 16 colors, so convert them once up front.
+    uint16_t ctable565[16];
+    for (int i = 0; i < (1 << bpp); i++) {
+        ctable565[i] = SkPixel32ToPixel16(ctable[i]);
+    }
+    unpack_indices((uint16_t*) dst, src, width, bpp, offset,
+                   [&ctable565](uint8_t index) { return ctable565[index]; });
+}
+
+static void fast_swizzle_small_index_to_n32(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    unpack_indices((SkPMColor*) dst, src, width, bpp, offset,
+                   [ctable](uint8_t index) { return ctable[index]; });
+}
+
 // kIndex
 
 static void swizzle_index_to_n32(
@@ -256,6 +387,28 @@ static void swizzle_index_to_565(
     }
 }
 
+static void fast_swizzle_index_to_n32(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::index_to_8888((uint32_t*) dst, src + offset, width, ctable);
+}
+
+static void fast_swizzle_index_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::index_to_565((uint16_t*) dst, src + offset, width, ctable);
+}
+
 // kGray
 
 static void swizzle_gray_to_n32(
@@ -295,6 +448,17 @@ static void swizzle_gray_to_565(
     }
 }
 
+static void fast_swizzle_gray_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::gray_to_565((uint16_t*) dst, src + offset, width);
+}
+
 // kGrayAlpha
 
 static void swizzle_grayalpha_to_n32_unpremul(
@@ -362,6 +526,17 @@ static void swizzle_bgr_to_565(
     }
 }
 
+static void fast_swizzle_bgr_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::BGR_to_565((uint16_t*) dst, src + offset, width);
+}
+
 // kRGB
 
 static void swizzle_rgb_to_rgba(
@@ -422,6 +597,17 @@ static void swizzle_rgb_to_565(
     }
 }
 
+static void fast_swizzle_rgb_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::RGB_to_565((uint16_t*) dst, src + offset, width);
+}
+
 // kRGBA
 
 static void swizzle_rgba_to_rgba_premul(
@@ -609,6 +795,17 @@ static void swizzle_cmyk_to_565(
     }
 }
 
+static void fast_swizzle_cmyk_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::inverted_CMYK_to_565((uint16_t*) dst, src + offset, width);
+}
+
 template <SkSwizzler::RowProc proc>
 void SkSwizzler::SkipLeadingGrayAlphaZerosThen(
         void* dst, const uint8_t* src, int width,
@@ -690,15 +887,19 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                             case kRGBA_8888_SkColorType:
                             case kBGRA_8888_SkColorType:
                                 proc = &swizzle_bit_to_n32;
+                                fastProc = &fast_swizzle_bit_to_n32;
                                 break;
                             case kIndex_8_SkColorType:
                                 proc = &swizzle_bit_to_index;
+                                fastProc = &fast_swizzle_bit_to_index;
                                 break;
                             case kRGB_565_SkColorType:
                                 proc = &swizzle_bit_to_565;
+                                fastProc = &fast_swizzle_bit_to_565;
                                 break;
                             case kGray_8_SkColorType:
                                 proc = &swizzle_bit_to_grayscale;
+                                fastProc = &fast_swizzle_bit_to_grayscale;
                                 break;
                             default:
                                 return nullptr;
@@ -717,6 +918,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                                 break;
                             case kRGB_565_SkColorType:
                                 proc = &swizzle_gray_to_565;
+                                fastProc = &fast_swizzle_gray_to_565;
                                 break;
                             default:
                                 return nullptr;
@@ -767,12 +969,15 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                             case kRGBA_8888_SkColorType:
                             case kBGRA_8888_SkColorType:
                                 proc = &swizzle_small_index_to_n32;
+                                fastProc = &fast_swizzle_small_index_to_n32;
                                 break;
                             case kRGB_565_SkColorType:
                                 proc = &swizzle_small_index_to_565;
+                                fastProc = &fast_swizzle_small_index_to_565;
                                 break;
                             case kIndex_8_SkColorType:
                                 proc = &swizzle_small_index_to_index;
+                                fastProc = &fast_swizzle_small_index_to_index;
                                 break;
                             default:
                                 return nullptr;
@@ -786,10 +991,12 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                                     proc = &swizzle_index_to_n32_skipZ;
                                 } else {
                                     proc = &swizzle_index_to_n32;
+                                    fastProc = &fast_swizzle_index_to_n32;
                                 }
                                 break;
                             case kRGB_565_SkColorType:
                                 proc = &swizzle_index_to_565;
+                                fastProc = &fast_swizzle_index_to_565;
                                 break;
                             case kIndex_8_SkColorType:
                                 proc = &sample1;
@@ -815,6 +1022,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_rgb_to_565;
+                        fastProc = &fast_swizzle_rgb_to_565;
                         break;
                     default:
                         return nullptr;
@@ -879,6 +1087,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_bgr_to_565;
+                        fastProc = &fast_swizzle_bgr_to_565;
                         break;
                     default:
                         return nullptr;
@@ -958,6 +1167,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_cmyk_to_565;
+                        fastProc = &fast_swizzle_cmyk_to_565;
                         break;
                     default:
                         return nullptr;
@@ -969,15 +1179,21 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
     }
 
     int srcBPP;
+    bool srcIsBitPacked = false;
     const int dstBPP = SkColorTypeBytesPerPixel(dstInfo.colorType());
     if (preSwizzled) {
         srcBPP = dstBPP;
     } else {
         // Store bpp in bytes if it is an even multiple, otherwise use bits
         uint8_t bitsPerPixel = encodedInfo.bitsPerPixel();
-        srcBPP = SkIsAlign8(bitsPerPixel) ? bitsPerPixel / 8 : bitsPerPixel;
+        srcIsBitPacked = !SkIsAlign8(bitsPerPixel);
+        srcBPP = srcIsBitPacked ? bitsPerPixel : bitsPerPixel / 8;
     }
 
+    // When the fast proc just copies, the slow proc is already the cheapest way to sample.
+    const bool gatherSamples = fastProc && !srcIsBitPacked && srcBPP <= 4 &&
+                               &copy != fastProc && &SkipLeading8888ZerosThen<copy> != fastProc;
+
     int srcOffset = 0;
     int srcWidth = dstInfo.width();
     int dstOffset = 0;
@@ -994,15 +1210,17 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
         srcWidth = frame->width();
     }
 
-    return new SkSwizzler(fastProc, proc, ctable, srcOffset, srcWidth, dstOffset, dstWidth,
-            srcBPP, dstBPP);
+    return new SkSwizzler(fastProc, proc, gatherSamples, ctable, srcOffset, srcWidth, dstOffset,
+            dstWidth, srcBPP, dstBPP);
 }
 
-SkSwizzler::SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcOffset,
-        int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP)
+SkSwizzler::SkSwizzler(RowProc fastProc, RowProc proc, bool gatherSamples,
+        const SkPMColor* ctable, int srcOffset, int srcWidth, int dstOffset, int dstWidth,
+        int srcBPP, int dstBPP)
     : fFastProc(fastProc)
     , fSlowProc(proc)
     , fActualProc(fFastProc ? fFastProc : fSlowProc)
+    , fGatherSamples(gatherSamples)
     , fColorTable(ctable)
     , fSrcOffset(srcOffset)
     , fDstOffset(dstOffset)
@@ -1026,9 +1244,8 @@ int SkSwizzler::onSetSampleX(int sampleX) {
     fSwizzleWidth = get_scaled_dimension(fSrcWidth, sampleX);
     fAllocatedWidth = get_scaled_dimension(fDstWidth, sampleX);
 
-    // The optimized swizzler functions do not support sampling.  Sampled swizzles
-    // are already fast because they skip pixels.  We haven't seen a situation
-    // where speeding up sampling has a significant impact on total decode time.
+    // The optimized swizzler functions do not support sampling directly.  Where it
+    // pays off, swizzle() gathers the sampled pixels into batches for them instead.
     if (1 == fSampleX && fFastProc) {
         fActualProc = fFastProc;
     } else {
@@ -1040,6 +1257,52 @@ int SkSwizzler::onSetSampleX(int sampleX) {
 
 void SkSwizzler::swizzle(void* dst, const uint8_t* SK_RESTRICT src) {
     SkASSERT(nullptr != dst && nullptr != src);
+    if (fSampleX > 1 && fGatherSamples) {
+        this->gatherSamplesThenSwizzle(dst, src);
+        return;
+    }
     fActualProc(SkTAddOffset<void>(dst, fDstOffsetBytes), src, fSwizzleWidth, fSrcBPP,
             fSampleX * fSrcBPP, fSrcOffsetUnits, fColorTable);
 }
+
+template <typename T>
+static void gather(uint8_t* dst, const uint8_t* src, int count, int deltaSrc) {
+    for (int i = 0; i < count; i++) {
+        memcpy(dst + i * sizeof(T), src, sizeof(T));
+        src += deltaSrc;
+    }
+}
+
+void SkSwizzler::gatherSamplesThenSwizzle(void* dst, const uint8_t* SK_RESTRICT src) {
+    SkASSERT(fSrcBPP <= 4);
+
+    static constexpr int kBatchSize = 64;
+    uint8_t batch[kBatchSize * 4];
+
+    const int deltaSrc = fSampleX * fSrcBPP;
+    src += fSrcOffsetUnits;
+    dst = SkTAddOffset<void>(dst, fDstOffsetBytes);
+    for (int x = 0; x < fSwizzleWidth; x += kBatchSize) {
+        const int count = SkTMin(kBatchSize, fSwizzleWidth - x);
+        switch (fSrcBPP) {
+            case 1:
+                gather<uint8_t>(batch, src, count, deltaSrc);
+                break;
+            case 2:
+                gather<uint16_t>(batch, src, count, deltaSrc);
+                break;
+            case 4:
+                gather<uint32_t>(batch, src, count, deltaSrc);
+                break;
+            default:
+                for (int i = 0; i < count; i++) {
+                    memcpy(batch + i * fSrcBPP, src + i * deltaSrc, fSrcBPP);
+                }
+                break;
+        }
+
+        fFastProc(dst, batch, count, fSrcBPP, fSrcBPP, 0, fColorTable);
+        src += count * deltaSrc;
+        dst = SkTAddOffset<void>(dst, count * fDstBPP);
+    }
+}
@@ -108,6 +108,9 @@ private:
     // The actual RowProc we are using.  This depends on if fFastProc is non-NULL and
     // whether or not we are sampling.
     RowProc             fActualProc;
+    // If true, sampled rows are gathered into contiguous batches and converted by
+    // fFastProc, rather than converted a pixel at a time by fSlowProc.
+    const bool          fGatherSamples;
 
     const SkPMColor*    fColorTable;      // Unowned pointer
 
@@ -195,8 +198,10 @@ private:
                                           //     fBPP is bitsPerPixel
     const int           fDstBPP;          // Bytes per pixel for the destination color type
 
-    SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcOffset,
-            int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
+    SkSwizzler(RowProc fastProc, RowProc proc, bool gatherSamples, const SkPMColor* ctable,
+            int srcOffset, int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
+
+    void gatherSamplesThenSwizzle(void* dst, const uint8_t* SK_RESTRICT src);
 
     int onSetSampleX(int) override;
 
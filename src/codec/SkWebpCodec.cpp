@@ -6,6 +6,9 @@
  */
 
 #include "SkCodecPriv.h"
+#include "SkColorPriv.h"
+#include "SkSampler.h"
+#include "SkStreamPriv.h"
 #include "SkWebpCodec.h"
 #include "SkTemplates.h"
 
@@ -18,6 +21,7 @@
 // If moving libwebp out of skia source tree, path for webp headers must be
 // updated accordingly. Here, we enforce using local copy in webp sub-directory.
 #include "webp/decode.h"
+#include "webp/demux.h"
 #include "webp/encode.h"
 
 bool SkWebpCodec::IsWebp(const void* buf, size_t bytesRead) {
@@ -28,6 +32,24 @@ bool SkWebpCodec::IsWebp(const void* buf, size_t bytesRead) {
     return bytesRead >= 14 && !memcmp(bytes, "RIFF", 4) && !memcmp(&bytes[8], "WEBPVP", 6);
 }
 
+static void delete_stream(const void*, void* stream) {
+    delete static_cast<SkStream*>(stream);
+}
+
+// Returns the rest of the stream as SkData.  If the stream is already in memory (e.g. an
+// mmapped SkData), the SkData shares that memory and takes ownership of the stream.
+static sk_sp<SkData> stream_as_data(SkAutoTDelete<SkStream>& stream) {
+    const uint8_t* base = static_cast<const uint8_t*>(stream->getMemoryBase());
+    if (base && stream->hasPosition() && stream->hasLength() &&
+            stream->getPosition() <= stream->getLength()) {
+        // Read the position and length before the arguments release the stream.
+        const size_t position = stream->getPosition();
+        const size_t length = stream->getLength() - position;
+        return SkData::MakeWithProc(base + position, length, delete_stream, stream.release());
+    }
+    return SkCopyStreamToData(stream.get());
+}
+
 // Parse headers of RIFF container, and check for valid Webp (VP8) content.
 // NOTE: This calls peek instead of read, since onGetPixels will need these
 // bytes again.
@@ -101,6 +123,19 @@ SkCodec* SkWebpCodec::NewFromStream(SkStream* stream) {
     }
 
     SkEncodedInfo info = SkEncodedInfo::Make(color, alpha, 8);
+    if (features.has_animation) {
+        // The frames of an animation are found by the demuxer, which needs all of the data.
+        sk_sp<SkData> data = stream_as_data(streamDeleter);
+        if (!data) {
+            return nullptr;
+        }
+        WebPData webpData = { data->bytes(), data->size() };
+        WebPDemuxer* demux = WebPDemux(&webpData);
+        if (!demux) {
+            return nullptr;
+        }
+        return new SkWebpCodec(features.width, features.height, info, std::move(data), demux);
+    }
     return new SkWebpCodec(features.width, features.height, info, streamDeleter.release());
 }
 
@@ -187,6 +222,18 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
         return kInvalidConversion;
     }
 
+    if (fDemux) {
+        // Frames are blended on the full size canvas.
+        if (options.fSubset) {
+            return kUnimplemented;
+        }
+        if (dstInfo.dimensions() != this->getInfo().dimensions()) {
+            return kInvalidScale;
+        }
+        return this->decodeFrame(options.fFrameIndex, dstInfo, dst, rowBytes, options,
+                                 rowsDecoded);
+    }
+
     WebPDecoderConfig config;
     if (0 == WebPInitDecoderConfig(&config)) {
         // ABI mismatch.
@@ -253,12 +300,40 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
         return kInvalidInput;
     }
 
+    const Result result = this->decodeIncrementally(idec);
+    if (kIncompleteInput == result) {
+        WebPIDecGetRGB(idec, rowsDecoded, NULL, NULL, NULL);
+    }
+    return result;
+}
+
+SkCodec::Result SkWebpCodec::decodeIncrementally(WebPIDecoder* idec) {
+    SkStream* stream = this->stream();
+    const uint8_t* base = static_cast<const uint8_t*>(stream->getMemoryBase());
+    if (base && stream->hasPosition() && stream->hasLength() &&
+            stream->getPosition() <= stream->getLength()) {
+        // The stream is already in memory, so let libwebp decode it in place rather than
+        // copying it in with WebPIAppend.  WebPIUpdate() requires the memory to outlive idec,
+        // which the stream does.
+        const size_t position = stream->getPosition();
+        const size_t remaining = stream->getLength() - position;
+        if (remaining == stream->skip(remaining)) {
+            switch (WebPIUpdate(idec, base + position, remaining)) {
+                case VP8_STATUS_OK:
+                    return kSuccess;
+                case VP8_STATUS_SUSPENDED:
+                    return kIncompleteInput;
+                default:
+                    return kInvalidInput;
+            }
+        }
+    }
+
     SkAutoTMalloc<uint8_t> storage(BUFFER_SIZE);
     uint8_t* buffer = storage.get();
     while (true) {
-        const size_t bytesRead = stream()->read(buffer, BUFFER_SIZE);
+        const size_t bytesRead = stream->read(buffer, BUFFER_SIZE);
         if (0 == bytesRead) {
-            WebPIDecGetRGB(idec, rowsDecoded, NULL, NULL, NULL);
             return kIncompleteInput;
         }
 
@@ -274,7 +349,258 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
     }
 }
 
+bool SkWebpCodec::onQueryYUV8(SkYUVSizeInfo* sizeInfo, SkYUVColorSpace* colorSpace) const {
+    // Only lossy, opaque stills are stored as YUV.  Everything else would be converted
+    // to YUV just so the client could convert it back.
+    if (fDemux || SkEncodedInfo::kYUV_Color != this->getEncodedInfo().color()) {
+        return false;
+    }
+
+    // VP8 always subsamples chroma by two in each direction.
+    const int width = this->getInfo().width();
+    const int height = this->getInfo().height();
+    sizeInfo->fSizes[SkYUVSizeInfo::kY].set(width, height);
+    sizeInfo->fSizes[SkYUVSizeInfo::kU].set((width + 1) / 2, (height + 1) / 2);
+    sizeInfo->fSizes[SkYUVSizeInfo::kV].set((width + 1) / 2, (height + 1) / 2);
+    // Like SkJpegCodec, recommend rows padded to a multiple of 8 bytes.
+    sizeInfo->fWidthBytes[SkYUVSizeInfo::kY] = SkAlign8(width);
+    sizeInfo->fWidthBytes[SkYUVSizeInfo::kU] = SkAlign8((width + 1) / 2);
+    sizeInfo->fWidthBytes[SkYUVSizeInfo::kV] = SkAlign8((width + 1) / 2);
+
+    if (colorSpace) {
+        // VP8 uses studio swing BT.601.
+        *colorSpace = kRec601_SkYUVColorSpace;
+    }
+    return true;
+}
+
+SkCodec::Result SkWebpCodec::onGetYUV8Planes(const SkYUVSizeInfo& sizeInfo, void* planes[3]) {
+    SkYUVSizeInfo defaultInfo;
+    if (!this->onQueryYUV8(&defaultInfo, nullptr) ||
+            sizeInfo.fSizes[SkYUVSizeInfo::kY] != defaultInfo.fSizes[SkYUVSizeInfo::kY] ||
+            sizeInfo.fSizes[SkYUVSizeInfo::kU] != defaultInfo.fSizes[SkYUVSizeInfo::kU] ||
+            sizeInfo.fSizes[SkYUVSizeInfo::kV] != defaultInfo.fSizes[SkYUVSizeInfo::kV] ||
+            sizeInfo.fWidthBytes[SkYUVSizeInfo::kY] < defaultInfo.fWidthBytes[SkYUVSizeInfo::kY] ||
+            sizeInfo.fWidthBytes[SkYUVSizeInfo::kU] < defaultInfo.fWidthBytes[SkYUVSizeInfo::kU] ||
+            sizeInfo.fWidthBytes[SkYUVSizeInfo::kV] < defaultInfo.fWidthBytes[SkYUVSizeInfo::kV]) {
+        return kInvalidInput;
+    }
+
+    WebPDecoderConfig config;
+    if (0 == WebPInitDecoderConfig(&config)) {
+        // ABI mismatch.
+        return kInvalidInput;
+    }
+
+    // Free any memory associated with the buffer. Must be called last, so we declare it first.
+    SkAutoTCallVProc<WebPDecBuffer, WebPFreeDecBuffer> autoFree(&(config.output));
+
+    // Have libwebp write its planes straight into ours, skipping its own conversion to RGB.
+    WebPYUVABuffer& yuva = config.output.u.YUVA;
+    config.output.colorspace = MODE_YUV;
+    config.output.is_external_memory = 1;
+    yuva.y = (uint8_t*) planes[SkYUVSizeInfo::kY];
+    yuva.u = (uint8_t*) planes[SkYUVSizeInfo::kU];
+    yuva.v = (uint8_t*) planes[SkYUVSizeInfo::kV];
+    yuva.y_stride = (int) sizeInfo.fWidthBytes[SkYUVSizeInfo::kY];
+    yuva.u_stride = (int) sizeInfo.fWidthBytes[SkYUVSizeInfo::kU];
+    yuva.v_stride = (int) sizeInfo.fWidthBytes[SkYUVSizeInfo::kV];
+    yuva.y_size = sizeInfo.fWidthBytes[SkYUVSizeInfo::kY] *
+                  sizeInfo.fSizes[SkYUVSizeInfo::kY].height();
+    yuva.u_size = sizeInfo.fWidthBytes[SkYUVSizeInfo::kU] *
+                  sizeInfo.fSizes[SkYUVSizeInfo::kU].height();
+    yuva.v_size = sizeInfo.fWidthBytes[SkYUVSizeInfo::kV] *
+                  sizeInfo.fSizes[SkYUVSizeInfo::kV].height();
+
+    SkAutoTCallVProc<WebPIDecoder, WebPIDelete> idec(WebPIDecode(nullptr, 0, &config));
+    if (!idec) {
+        return kInvalidInput;
+    }
+    return this->decodeIncrementally(idec);
+}
+
+// Blends unpremultiplied src over unpremultiplied dst.  Alpha is in the same place in both
+// 8888 byte orders, and the color channels are all treated alike.
+static uint32_t blend_unpremul(uint32_t src, uint32_t dst) {
+    const unsigned srcA = SkGetPackedA32(src);
+    if (255 == srcA) {
+        return src;
+    }
+    if (0 == srcA) {
+        return dst;
+    }
+
+    const unsigned dstA = SkMulDiv255Round(SkGetPackedA32(dst), 255 - srcA);
+    const unsigned outA = srcA + dstA;
+    uint32_t result = outA << SK_A32_SHIFT;
+    for (int shift : { SK_R32_SHIFT, SK_G32_SHIFT, SK_B32_SHIFT }) {
+        const unsigned s = (src >> shift) & 0xFF;
+        const unsigned d = (dst >> shift) & 0xFF;
+        result |= ((s * srcA + d * dstA + outA / 2) / outA) << shift;
+    }
+    return result;
+}
+
+SkCodec::Result SkWebpCodec::decodeFrame(size_t index, const SkImageInfo& dstInfo, void* dst,
+                                         size_t rowBytes, const Options& options,
+                                         int* rowsDecoded) {
+    if (index >= (size_t) fFrames.count()) {
+        return kInvalidInput;
+    }
+    const Frame& frame = fFrames[index];
+    const size_t requiredFrame = frame.fInfo.fRequiredFrame;
+    const SkIRect bounds = SkIRect::MakeSize(dstInfo.dimensions());
+    if (kNone == requiredFrame) {
+        // The frame is drawn on a transparent canvas.
+        if (!frame.fRect.contains(bounds)) {
+            SkSampler::Fill(dstInfo, dst, rowBytes, 0, options.fZeroInitialized);
+        }
+    } else {
+        if (!options.fHasPriorFrame) {
+            Result result = this->decodeFrame(requiredFrame, dstInfo, dst, rowBytes, options,
+                                              rowsDecoded);
+            if (kSuccess != result) {
+                return result;
+            }
+        }
+
+        // Every row holds the prior frame, so there is nothing left to fill in if this
+        // frame turns out to be incomplete.
+        *rowsDecoded = dstInfo.height();
+
+        const Frame& prior = fFrames[index - 1];
+        SkIRect priorRect = prior.fRect;
+        if (kRestoreBGColor_DisposalMethod == prior.fInfo.fDisposalMethod &&
+                priorRect.intersect(bounds)) {
+            void* clearDst = SkTAddOffset<void>(dst, priorRect.top() * rowBytes +
+                                                     priorRect.left() * sizeof(uint32_t));
+            SkSampler::Fill(dstInfo.makeWH(priorRect.width(), priorRect.height()), clearDst,
+                            rowBytes, 0, kNo_ZeroInitialized);
+        }
+    }
+
+    WebPIterator iter;
+    if (!WebPDemuxGetFrame(fDemux, (int) index + 1, &iter)) {
+        return kInvalidInput;
+    }
+    SkAutoTCallVProc<WebPIterator, WebPDemuxReleaseIterator> autoIter(&iter);
+
+    WebPDecoderConfig config;
+    if (0 == WebPInitDecoderConfig(&config)) {
+        // ABI mismatch.
+        return kInvalidInput;
+    }
+
+    // Free any memory associated with the buffer. Must be called last, so we declare it first.
+    SkAutoTCallVProc<WebPDecBuffer, WebPFreeDecBuffer> autoFree(&(config.output));
+
+    // Frames that are blended with a prior frame are decoded on their own first.
+    const bool blend = frame.fBlend && kNone != requiredFrame;
+    const SkImageInfo frameInfo = dstInfo.makeWH(frame.fRect.width(), frame.fRect.height());
+    SkAutoTMalloc<uint32_t> frameStorage;
+    void* frameDst;
+    size_t frameRowBytes;
+    if (blend) {
+        frameRowBytes = frameInfo.minRowBytes();
+        frameStorage.reset(frameInfo.getSafeSize(frameRowBytes) / sizeof(uint32_t));
+        frameDst = frameStorage.get();
+    } else {
+        frameRowBytes = rowBytes;
+        frameDst = SkTAddOffset<void>(dst, frame.fRect.top() * rowBytes +
+                                           frame.fRect.left() * sizeof(uint32_t));
+    }
+
+    const bool premultiply = dstInfo.alphaType() == kPremul_SkAlphaType;
+    config.output.colorspace = webp_decode_mode(dstInfo.colorType(), premultiply);
+    config.output.u.RGBA.rgba = (uint8_t*) frameDst;
+    config.output.u.RGBA.stride = (int) frameRowBytes;
+    config.output.u.RGBA.size = frameInfo.getSafeSize(frameRowBytes);
+    config.output.is_external_memory = 1;
+
+    switch (WebPDecode(iter.fragment.bytes, iter.fragment.size, &config)) {
+        case VP8_STATUS_OK:
+            break;
+        case VP8_STATUS_NOT_ENOUGH_DATA:
+            return kIncompleteInput;
+        default:
+            return kInvalidInput;
+    }
+
+    if (blend) {
+        for (int y = 0; y < frame.fRect.height(); y++) {
+            const uint32_t* src = SkTAddOffset<const uint32_t>(frameDst, y * frameRowBytes);
+            uint32_t* dstRow = SkTAddOffset<uint32_t>(dst, (frame.fRect.top() + y) * rowBytes) +
+                               frame.fRect.left();
+            for (int x = 0; x < frame.fRect.width(); x++) {
+                dstRow[x] = premultiply ? SkPMSrcOver(src[x], dstRow[x])
+                                        : blend_unpremul(src[x], dstRow[x]);
+            }
+        }
+    }
+    return kSuccess;
+}
+
+size_t SkWebpCodec::onGetFrameCount() {
+    return fDemux ? fFrames.count() : 1;
+}
+
+std::vector<SkCodec::FrameInfo> SkWebpCodec::onGetFrameInfo() {
+    std::vector<FrameInfo> result;
+    if (fFrames.count() > 1) {
+        for (const Frame& frame : fFrames) {
+            result.push_back(frame.fInfo);
+        }
+    }
+    return result;
+}
+
+void SkWebpCodec::DeleteDemux(WebPDemuxer* demux) {
+    WebPDemuxDelete(demux);
+}
+
 SkWebpCodec::SkWebpCodec(int width, int height, const SkEncodedInfo& info, SkStream* stream)
     // The spec says an unmarked image is sRGB, so we return that space here.
     // TODO: Add support for parsing ICC profiles from webps.
-    : INHERITED(width, height, info, stream, SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named)) {}
+    : INHERITED(width, height, info, stream, SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named))
+    , fDemux(nullptr) {}
+
+SkWebpCodec::SkWebpCodec(int width, int height, const SkEncodedInfo& info, sk_sp<SkData> data,
+                         WebPDemuxer* demux)
+    : INHERITED(width, height, info, new SkMemoryStream(data),
+                SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named))
+    , fData(std::move(data))
+    , fDemux(demux)
+{
+    const SkIRect bounds = SkIRect::MakeSize(this->getInfo().dimensions());
+    const uint32_t frameCount = WebPDemuxGetI(demux, WEBP_FF_FRAME_COUNT);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        WebPIterator iter;
+        if (!WebPDemuxGetFrame(demux, i + 1, &iter)) {
+            break;
+        }
+        Frame& frame = fFrames.push_back();
+        frame.fRect.setXYWH(iter.x_offset, iter.y_offset, iter.width, iter.height);
+        frame.fBlend = WEBP_MUX_BLEND == iter.blend_method && iter.has_alpha;
+        frame.fInfo.fDuration = iter.duration;
+        frame.fInfo.fDisposalMethod = WEBP_MUX_DISPOSE_BACKGROUND == iter.dispose_method
+                                    ? kRestoreBGColor_DisposalMethod : kKeep_DisposalMethod;
+        const bool opaque = !iter.has_alpha || WEBP_MUX_NO_BLEND == iter.blend_method;
+        WebPDemuxReleaseIterator(&iter);
+
+        // Frames that cover the canvas, with nothing to show through, stand alone.
+        if (0 == i || (frame.fRect.contains(bounds) && opaque)) {
+            frame.fInfo.fRequiredFrame = kNone;
+            continue;
+        }
+
+        const Frame& prior = fFrames[i - 1];
+        if (kRestoreBGColor_DisposalMethod == prior.fInfo.fDisposalMethod) {
+            // Whatever the prior frame covered is cleared, so this frame is drawn on top
+            // of what the prior frame was drawn on top of.
+            frame.fInfo.fRequiredFrame = prior.fRect.contains(bounds)
+                                       ? kNone : prior.fInfo.fRequiredFrame;
+        } else {
+            frame.fInfo.fRequiredFrame = i - 1;
+        }
+    }
+}
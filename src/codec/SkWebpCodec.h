@@ -10,11 +10,15 @@
 
 #include "SkCodec.h"
 #include "SkColorSpace.h"
+#include "SkData.h"
 #include "SkEncodedFormat.h"
 #include "SkImageInfo.h"
+#include "SkTArray.h"
 #include "SkTypes.h"
 
 class SkStream;
+struct WebPDemuxer;
+struct WebPIDecoder;
 
 static const size_t WEBP_VP8_HEADER_SIZE = 30;
 
@@ -33,9 +37,53 @@ protected:
     bool onDimensionsSupported(const SkISize&) override;
 
     bool onGetValidSubset(SkIRect* /* desiredSubset */) const override;
+
+    size_t onGetFrameCount() override;
+
+    std::vector<FrameInfo> onGetFrameInfo() override;
+
+    bool onQueryYUV8(SkYUVSizeInfo* sizeInfo, SkYUVColorSpace* colorSpace) const override;
+
+    Result onGetYUV8Planes(const SkYUVSizeInfo& sizeInfo, void* planes[3]) override;
 private:
+    struct Frame {
+        SkIRect   fRect;
+        // Whether the frame is alpha blended with what is under it, rather than replacing it.
+        bool      fBlend;
+        FrameInfo fInfo;
+    };
+
     SkWebpCodec(int width, int height, const SkEncodedInfo&, SkStream*);
 
+    /*
+     * Creates a codec for an animation.  Takes ownership of demux, which reads from data.
+     */
+    SkWebpCodec(int width, int height, const SkEncodedInfo&, sk_sp<SkData> data,
+                WebPDemuxer* demux);
+
+    /*
+     * Decodes frame index of an animation into the dst, first decoding its
+     * required frame unless opts.fHasPriorFrame.
+     */
+    Result decodeFrame(size_t index, const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                       const Options& opts, int* rowsDecoded);
+
+    /*
+     * Feeds the rest of the stream to idec until it finishes decoding.
+     */
+    Result decodeIncrementally(WebPIDecoder* idec);
+
+    /*
+     * Used in a SkAutoTCallVProc
+     */
+    static void DeleteDemux(WebPDemuxer* demux);
+
+    // Animations are demuxed from the whole encoded image, rather than decoded
+    // incrementally from the stream.  Both are empty for still images.
+    sk_sp<SkData>                                fData;
+    SkAutoTCallVProc<WebPDemuxer, DeleteDemux>   fDemux;
+    SkTArray<Frame, true>                        fFrames;
+
     typedef SkCodec INHERITED;
 };
 #endif // SkWebpCodec_DEFINED
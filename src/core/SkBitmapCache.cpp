@@ -9,8 +9,11 @@
 #include "SkImage.h"
 #include "SkResourceCache.h"
 #include "SkMipMap.h"
+#include "SkMutex.h"
 #include "SkPixelRef.h"
 #include "SkRect.h"
+#include "SkTaskGroup.h"
+#include "SkTDArray.h"
 
 /**
  *  Use this for bitmapcache and mipmapcache entries.
@@ -309,3 +312,75 @@ const SkMipMap* SkMipMapCache::AddAndRef(const SkBitmap& src, SkSourceGammaTreat
     }
     return mipmap;
 }
+
+namespace {
+struct PendingMipMap {
+    uint32_t    fGenID;
+    uint32_t    fSrcGammaTreatment;
+    SkIRect     fBounds;
+
+    bool operator==(const PendingMipMap& other) const {
+        return fGenID == other.fGenID && fSrcGammaTreatment == other.fSrcGammaTreatment &&
+               fBounds == other.fBounds;
+    }
+};
+}
+
+SK_DECLARE_STATIC_MUTEX(gAsyncMipMapMutex);
+static bool gAsyncMipMapBuild;
+static SkTDArray<PendingMipMap>* gPendingMipMaps;   // guarded by gAsyncMipMapMutex
+static SkTaskGroup* gAsyncMipMapTasks;              // guarded by gAsyncMipMapMutex
+
+bool SkMipMapCache::SetAsyncBuild(bool enabled) {
+    return sk_atomic_exchange(&gAsyncMipMapBuild, enabled, sk_memory_order_relaxed);
+}
+
+bool SkMipMapCache::IsAsyncBuild() {
+    return sk_atomic_load(&gAsyncMipMapBuild, sk_memory_order_relaxed);
+}
+
+void SkMipMapCache::AddAsync(const SkBitmap& src, SkSourceGammaTreatment treatment) {
+    if (!src.pixelRef()) {
+        return;
+    }
+    const PendingMipMap pending = {
+        src.getGenerationID(), static_cast<uint32_t>(treatment), get_bounds_from_bitmap(src)
+    };
+
+    SkTaskGroup* tasks;
+    {
+        SkAutoMutexAcquire am(gAsyncMipMapMutex);
+        if (!gPendingMipMaps) {
+            // Both live until exit.  SkTaskGroup::Enabler waits for the builds before it shuts
+            // down its threads.
+            gPendingMipMaps = new SkTDArray<PendingMipMap>;
+            gAsyncMipMapTasks = SkTaskGroup::NewGlobal();
+        }
+        if (gPendingMipMaps->find(pending) >= 0) {
+            return;
+        }
+        *gPendingMipMaps->append() = pending;
+        tasks = gAsyncMipMapTasks;
+    }
+
+    // The task's copy of src keeps the pixelRef (and so the pixels) alive until we're done.
+    tasks->add([src, treatment, pending]() {
+        SkSafeUnref(SkMipMapCache::AddAndRef(src, treatment));
+
+        SkAutoMutexAcquire am(gAsyncMipMapMutex);
+        int index = gPendingMipMaps->find(pending);
+        SkASSERT(index >= 0);
+        gPendingMipMaps->removeShuffle(index);
+    });
+}
+
+void SkMipMapCache::WaitForAsyncBuilds() {
+    SkTaskGroup* tasks;
+    {
+        SkAutoMutexAcquire am(gAsyncMipMapMutex);
+        tasks = gAsyncMipMapTasks;
+    }
+    if (tasks) {
+        tasks->wait();
+    }
+}
@@ -76,6 +76,26 @@ public:
                                       SkResourceCache* localCache = nullptr);
     static const SkMipMap* AddAndRef(const SkBitmap& src, SkSourceGammaTreatment,
                                      SkResourceCache* localCache = nullptr);
+
+    /**
+     *  When async builds are enabled, a caller that misses in FindAndRef() may call AddAsync()
+     *  instead of AddAndRef(), and draw at a lower quality until the mipmap shows up in the
+     *  (global) cache. Only building the mipmap is deferred: the caller still decodes the
+     *  source, which it needs for the lower quality draw anyway. Returns the previous setting.
+     *  Off by default.
+     */
+    static bool SetAsyncBuild(bool enabled);
+    static bool IsAsyncBuild();
+
+    /**
+     *  Schedule a build of src's mipmap on an SkTaskGroup thread, unless one is already pending.
+     *  If SkTaskGroups are not enabled the build happens before this returns.
+     */
+    static void AddAsync(const SkBitmap& src, SkSourceGammaTreatment);
+
+    // Block until all builds started by AddAsync() have landed in the cache.
+    // SkGraphics::PurgeResourceCache() calls this first, so that no build lands after it.
+    static void WaitForAsyncBuilds();
 };
 
 #endif
@@ -146,6 +146,9 @@ bool SkDefaultBitmapControllerState::processHQRequest(const SkBitmapProvider& pr
     return true;
 }
 
+// Smaller images build their mipmaps quickly enough that it isn't worth a low quality frame.
+static const int64_t kAsyncMipMapMinPixels = 512 * 512;
+
 /*
  *  Modulo internal errors, this should always succeed *if* the matrix is downscaling
  *  (in this case, we have the inverse, so it succeeds if fInvMatrix is upscaling)
@@ -166,13 +169,60 @@ bool SkDefaultBitmapControllerState::processMediumRequest(const SkBitmapProvider
     }
 
     if (invScaleSize.width() > SK_Scalar1 || invScaleSize.height() > SK_Scalar1) {
+        // How much smaller than the provider's image the bitmap we mip (or draw) is.
+        SkSize srcScale = SkSize::Make(SK_Scalar1, SK_Scalar1);
         fCurrMip.reset(SkMipMapCache::FindAndRef(provider.makeCacheDesc(), fSrcGammaTreatment));
+        if (nullptr == fCurrMip.get()) {
+            // Rather than decoding at full size just to filter it down, ask the decoder for
+            // something closer to the size we will draw.  Decoders only scale in coarse steps
+            // (JPEG stops at 1/8), so the decode may still be much larger than that.
+            const SkScalar scale = SkScalarInvert(SkTMin(invScaleSize.width(),
+                                                         invScaleSize.height()));
+            SkBitmap scaled;
+            if (provider.asScaledBitmap(&scaled, scale)) {
+                srcScale.set(SkIntToScalar(scaled.width()) / provider.width(),
+                             SkIntToScalar(scaled.height()) / provider.height());
+                if (invScaleSize.width() * srcScale.width() <= 2 &&
+                    invScaleSize.height() * srcScale.height() <= 2) {
+                    // At most 2x too large, which bilerp handles about as well as the first
+                    // mip level would.
+                    fResultBitmap = scaled;
+                    fResultBitmap.lockPixels();
+                    if (nullptr == fResultBitmap.getPixels()) {
+                        return false;
+                    }
+                    fInvMatrix.postScale(srcScale.width(), srcScale.height());
+                    return true;
+                }
+                // Too large to draw directly, so mip the smaller decode instead of a full one.
+                fCurrMip.reset(SkMipMapCache::FindAndRef(SkBitmapCacheDesc::Make(scaled),
+                                                         fSrcGammaTreatment));
+                if (nullptr == fCurrMip.get()) {
+                    fCurrMip.reset(SkMipMapCache::AddAndRef(scaled, fSrcGammaTreatment));
+                }
+                if (nullptr == fCurrMip.get()) {
+                    return false;
+                }
+                invScaleSize.set(invScaleSize.width() * srcScale.width(),
+                                 invScaleSize.height() * srcScale.height());
+            }
+        }
         if (nullptr == fCurrMip.get()) {
             SkBitmap orig;
             if (!provider.asBitmap(&orig)) {
                 return false;
             }
-            fCurrMip.reset(SkMipMapCache::AddAndRef(orig, fSrcGammaTreatment));
+            if (SkMipMapCache::IsAsyncBuild() &&
+                sk_64_mul(orig.width(), orig.height()) >= kAsyncMipMapMinPixels) {
+                // Draw at low quality from orig this time, and pick up the mipmap on a later
+                // draw. Only the build is async. If SkTaskGroups are not enabled it has already
+                // finished.
+                SkMipMapCache::AddAsync(orig, fSrcGammaTreatment);
+                fCurrMip.reset(SkMipMapCache::FindAndRef(provider.makeCacheDesc(),
+                                                         fSrcGammaTreatment));
+            } else {
+                fCurrMip.reset(SkMipMapCache::AddAndRef(orig, fSrcGammaTreatment));
+            }
             if (nullptr == fCurrMip.get()) {
                 return false;
             }
@@ -187,7 +237,8 @@ bool SkDefaultBitmapControllerState::processMediumRequest(const SkBitmapProvider
         SkMipMap::Level level;
         if (fCurrMip->extractLevel(scale, &level)) {
             const SkSize& invScaleFixup = level.fScale;
-            fInvMatrix.postScale(invScaleFixup.width(), invScaleFixup.height());
+            fInvMatrix.postScale(srcScale.width() * invScaleFixup.width(),
+                                 srcScale.height() * invScaleFixup.height());
 
             // todo: if we could wrap the fCurrMip in a pixelref, then we could just install
             //       that here, and not need to explicitly track it ourselves.
@@ -349,6 +349,12 @@ void SkBitmapDevice::drawPosText(const SkDraw& draw, const void* text, size_t le
     draw.drawPosText((const char*)text, len, xpos, scalarsPerPos, offset, paint);
 }
 
+void SkBitmapDevice::drawTextBlobRun(const SkDraw& draw, const SkTextBlob* blob, int runIndex,
+                                     const SkTextBlobRunIterator& it, SkScalar x, SkScalar y,
+                                     const SkPaint& paint) {
+    draw.drawTextBlobRun(blob, runIndex, it, x, y, paint);
+}
+
 void SkBitmapDevice::drawVertices(const SkDraw& draw, SkCanvas::VertexMode vmode,
                                   int vertexCount,
                                   const SkPoint verts[], const SkPoint textures[],
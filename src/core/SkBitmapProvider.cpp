@@ -6,6 +6,7 @@
  */
 
 #include "SkBitmapProvider.h"
+#include "SkImageCacherator.h"
 #include "SkImage_Base.h"
 #include "SkPixelRef.h"
 
@@ -83,3 +84,11 @@ bool SkBitmapProvider::asBitmap(SkBitmap* bm) const {
         return true;
     }
 }
+
+bool SkBitmapProvider::asScaledBitmap(SkBitmap* bm, SkScalar scale) const {
+    if (!fImage) {
+        return false;
+    }
+    SkImageCacherator* cacher = as_IB(fImage)->peekCacherator();
+    return cacher && cacher->lockAsScaledBitmap(bm, scale, fImage);
+}
@@ -37,6 +37,11 @@ public:
     // ... cause a decode and cache, or gpu-readback
     bool asBitmap(SkBitmap*) const;
 
+    // For lazily decoded images that will be drawn scaled down by scale, returns a (cached)
+    // decode at the nearest size the decoder supports that is no smaller than that.
+    // Returns false if there is no such decode, in which case call asBitmap().
+    bool asScaledBitmap(SkBitmap*, SkScalar scale) const;
+
 private:
     SkBitmap fBitmap;
     SkAutoTUnref<const SkImage> fImage;
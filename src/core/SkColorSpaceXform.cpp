@@ -8,6 +8,9 @@
 #include "SkColorPriv.h"
 #include "SkColorSpace_Base.h"
 #include "SkColorSpaceXform.h"
+#include "SkHalf.h"
+#include "SkMutex.h"
+#include "SkNx.h"
 #include "SkOpts.h"
 
 static inline bool compute_gamut_xform(SkMatrix44* srcToDst, const SkMatrix44& srcToXYZ,
@@ -74,6 +77,63 @@ std::unique_ptr<SkColorSpaceXform> SkColorSpaceXform::New(const sk_sp<SkColorSpa
     return std::unique_ptr<SkColorSpaceXform>(new SkDefaultXform(srcSpace, srcToDst, dstSpace));
 }
 
+static constexpr int kXformCacheCount = 16;
+
+struct XformCacheEntry {
+    sk_sp<SkColorSpace>      fSrc;
+    sk_sp<SkColorSpace>      fDst;
+    sk_sp<SkColorSpaceXform> fXform;
+};
+
+SK_DECLARE_STATIC_MUTEX(gXformCacheMutex);
+static XformCacheEntry* gXformCache;     // Leaked.  Guarded by gXformCacheMutex.
+static int gXformCacheNext;
+
+// The entries hold refs on their color spaces, so comparing pointers is safe.
+static sk_sp<SkColorSpaceXform> find_cached_xform(SkColorSpace* src, SkColorSpace* dst) {
+    gXformCacheMutex.assertHeld();
+    if (!gXformCache) {
+        gXformCache = new XformCacheEntry[kXformCacheCount];
+    }
+    for (int i = 0; i < kXformCacheCount; i++) {
+        const XformCacheEntry& entry = gXformCache[i];
+        if (entry.fXform && src == entry.fSrc.get() && dst == entry.fDst.get()) {
+            return entry.fXform;
+        }
+    }
+    return nullptr;
+}
+
+sk_sp<SkColorSpaceXform> SkColorSpaceXform::FindOrNew(const sk_sp<SkColorSpace>& srcSpace,
+                                                      const sk_sp<SkColorSpace>& dstSpace) {
+    if (!srcSpace || !dstSpace) {
+        return nullptr;
+    }
+
+    {
+        SkAutoMutexAcquire lock(gXformCacheMutex);
+        if (sk_sp<SkColorSpaceXform> cached = find_cached_xform(srcSpace.get(), dstSpace.get())) {
+            return cached;
+        }
+    }
+
+    sk_sp<SkColorSpaceXform> xform(SkColorSpaceXform::New(srcSpace, dstSpace).release());
+    if (!xform) {
+        return nullptr;
+    }
+
+    SkAutoMutexAcquire lock(gXformCacheMutex);
+    if (sk_sp<SkColorSpaceXform> cached = find_cached_xform(srcSpace.get(), dstSpace.get())) {
+        return cached;
+    }
+    XformCacheEntry& entry = gXformCache[gXformCacheNext];
+    gXformCacheNext = (gXformCacheNext + 1) % kXformCacheCount;
+    entry.fSrc = srcSpace;
+    entry.fDst = dstSpace;
+    entry.fXform = xform;
+    return xform;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 static void build_src_to_dst(float srcToDstArray[12], const SkMatrix44& srcToDstMatrix) {
@@ -111,10 +171,26 @@ static void build_src_to_dst(float srcToDstArray[12], const SkMatrix44& srcToDst
 #endif
 }
 
+static void build_src_to_dst_rgba(float srcToDstArray[16], const SkMatrix44& srcToDstMatrix) {
+    // Build the following row major matrix, always in RGBA order:
+    //   rR gR bR 0
+    //   rG gG bG 0
+    //   rB gB bB 0
+    //   rT gT bT 0
+    // where the last row is the translation.
+    for (int i = 0; i < 4; i++) {
+        srcToDstArray[4*i + 0] = srcToDstMatrix.getFloat(i, 0);
+        srcToDstArray[4*i + 1] = srcToDstMatrix.getFloat(i, 1);
+        srcToDstArray[4*i + 2] = srcToDstMatrix.getFloat(i, 2);
+        srcToDstArray[4*i + 3] = 0.0f;
+    }
+}
+
 template <SkColorSpace::GammaNamed Src, SkColorSpace::GammaNamed Dst>
 SkFastXform<Src, Dst>::SkFastXform(const SkMatrix44& srcToDst)
 {
     build_src_to_dst(fSrcToDst, srcToDst);
+    build_src_to_dst_rgba(fSrcToDstRGBA, srcToDst);
 }
 
 template <>
@@ -544,6 +620,8 @@ SkDefaultXform::SkDefaultXform(const sk_sp<SkColorSpace>& srcSpace, const SkMatr
     : fColorLUT(sk_ref_sp((SkColorLookUpTable*) as_CSB(srcSpace)->colorLUT()))
     , fSrcToDst(srcToDst)
 {
+    build_src_to_dst_rgba(fSrcToDstRGBA, srcToDst);
+
     // Build tables to transform src gamma to linear.
     switch (srcSpace->gammaNamed()) {
         case SkColorSpace::kSRGB_GammaNamed:
@@ -689,21 +767,6 @@ SkDefaultXform::SkDefaultXform(const sk_sp<SkColorSpace>& srcSpace, const SkMatr
     }
 }
 
-static float byte_to_float(uint8_t byte) {
-    return ((float) byte) * (1.0f / 255.0f);
-}
-
-// Clamp to the 0-1 range.
-static float clamp_normalized_float(float v) {
-    if (v > 1.0f) {
-        return 1.0f;
-    } else if ((v < 0.0f) || (v != v)) {
-        return 0.0f;
-    } else {
-        return v;
-    }
-}
-
 static void interp_3d_clut(float dst[3], float src[3], const SkColorLookUpTable* colorLUT) {
     // Call the src components x, y, and z.
     uint8_t maxX = colorLUT->fGridPoints[0] - 1;
@@ -743,7 +806,12 @@ static void interp_3d_clut(float dst[3], float src[3], const SkColorLookUpTable*
     const int n111 = n110 + n001;
 
     // Base ptr into the table.
-    float* ptr = &colorLUT->fTable[ix*n001 + iy*n010 + iz*n100];
+    const float* ptr = &colorLUT->fTable[ix*n001 + iy*n010 + iz*n100];
+
+    // Each grid point holds all three output components, so we interpolate them together,
+    // one per lane.  We can't load 4 floats at a time since that would read past the end of
+    // the table at the last grid point.
+    auto p = [ptr](int n) { return Sk4f(ptr[n], ptr[n + 1], ptr[n + 2], 0.0f); };
 
     // The code below performs a tetrahedral interpolation for each of the three
     // dst components.  Once the tetrahedron containing the interpolation point is
@@ -757,97 +825,252 @@ static void interp_3d_clut(float dst[3], float src[3], const SkColorLookUpTable*
     // tetrahedral code requires more branches but less computation.  The
     // SampleICC library provides an option for the client to choose either
     // tetrahedral or trilinear.
-    for (int i = 0; i < 3; i++) {
-        if (diffZ < diffY) {
-            if (diffZ < diffX) {
-                dst[i] = (ptr[n000] + diffZ * (ptr[n110] - ptr[n010]) +
-                                      diffY * (ptr[n010] - ptr[n000]) +
-                                      diffX * (ptr[n111] - ptr[n110]));
-            } else if (diffY < diffX) {
-                dst[i] = (ptr[n000] + diffZ * (ptr[n111] - ptr[n011]) +
-                                      diffY * (ptr[n011] - ptr[n001]) +
-                                      diffX * (ptr[n001] - ptr[n000]));
-            } else {
-                dst[i] = (ptr[n000] + diffZ * (ptr[n111] - ptr[n011]) +
-                                      diffY * (ptr[n010] - ptr[n000]) +
-                                      diffX * (ptr[n011] - ptr[n010]));
-            }
+    Sk4f result;
+    if (diffZ < diffY) {
+        if (diffZ < diffX) {
+            result = p(n000) + diffZ * (p(n110) - p(n010)) +
+                               diffY * (p(n010) - p(n000)) +
+                               diffX * (p(n111) - p(n110));
+        } else if (diffY < diffX) {
+            result = p(n000) + diffZ * (p(n111) - p(n011)) +
+                               diffY * (p(n011) - p(n001)) +
+                               diffX * (p(n001) - p(n000));
         } else {
-            if (diffZ < diffX) {
-                dst[i] = (ptr[n000] + diffZ * (ptr[n101] - ptr[n001]) +
-                                      diffY * (ptr[n111] - ptr[n101]) +
-                                      diffX * (ptr[n001] - ptr[n000]));
-            } else if (diffY < diffX) {
-                dst[i] = (ptr[n000] + diffZ * (ptr[n100] - ptr[n000]) +
-                                      diffY * (ptr[n111] - ptr[n101]) +
-                                      diffX * (ptr[n101] - ptr[n100]));
-            } else {
-                dst[i] = (ptr[n000] + diffZ * (ptr[n100] - ptr[n000]) +
-                                      diffY * (ptr[n110] - ptr[n100]) +
-                                      diffX * (ptr[n111] - ptr[n110]));
-            }
+            result = p(n000) + diffZ * (p(n111) - p(n011)) +
+                               diffY * (p(n010) - p(n000)) +
+                               diffX * (p(n011) - p(n010));
+        }
+    } else {
+        if (diffZ < diffX) {
+            result = p(n000) + diffZ * (p(n101) - p(n001)) +
+                               diffY * (p(n111) - p(n101)) +
+                               diffX * (p(n001) - p(n000));
+        } else if (diffY < diffX) {
+            result = p(n000) + diffZ * (p(n100) - p(n000)) +
+                               diffY * (p(n111) - p(n101)) +
+                               diffX * (p(n101) - p(n100));
+        } else {
+            result = p(n000) + diffZ * (p(n100) - p(n000)) +
+                               diffY * (p(n110) - p(n100)) +
+                               diffX * (p(n111) - p(n110));
+        }
+    }
+
+    dst[0] = result[0];
+    dst[1] = result[1];
+    dst[2] = result[2];
+}
+
+// Runs the color LUT over a batch of RGBA pixels, leaving alpha alone.
+static void apply_clut(uint32_t* dst, const uint32_t* src, int len,
+                       const SkColorLookUpTable* colorLUT) {
+    for (int i = 0; i < len; i++) {
+        float in[3];
+        float out[3];
+
+        in[0] = (1.0f / 255.0f) * ((src[i] >>  0) & 0xFF);
+        in[1] = (1.0f / 255.0f) * ((src[i] >>  8) & 0xFF);
+        in[2] = (1.0f / 255.0f) * ((src[i] >> 16) & 0xFF);
+
+        interp_3d_clut(out, in, colorLUT);
+
+        // Clamp to 0-1.  The order of the arguments makes sure that NaN clamps to zero.
+        Sk4i bytes = SkNx_cast<int>(Sk4f::Min(Sk4f::Max(Sk4f::Load(out), 0.0f), 1.0f) * 255.0f +
+                                    0.5f);
+        dst[i] = (src[i] & 0xFF000000) | (bytes[2] << 16) | (bytes[1] << 8) | (bytes[0] << 0);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum DstFormat {
+    kRGBA_8888_DstFormat,
+    kBGRA_8888_DstFormat,
+    kF16_DstFormat,
+};
+
+static Sk4f clamp_0_to_1(const Sk4f& x) {
+    // The order of the arguments is important here.  We want to make sure that NaN
+    // clamps to zero.  Note that max(NaN, 0) = 0, while max(0, NaN) = NaN.
+    return Sk4f::Min(Sk4f::Max(x, 0.0f), 1.0f);
+}
+
+// Transforms four pixels at a time.  Each channel of the four pixels lives in its own
+// Sk4f while we apply the matrix, so the math is the same no matter the gamma.  Only the
+// table lookups on the way in and (for 8888) on the way out are done one lane at a time.
+template <DstFormat kDst, SkAlphaType kAlphaType>
+static void xform_4(void* dst, const uint32_t src[4], const float* const srcTables[3],
+                    const float matrix[16], const uint8_t* const dstTables[3],
+                    int dstGammaTableSize) {
+    Sk4f r = Sk4f{srcTables[0][(src[0] >>  0) & 0xFF], srcTables[0][(src[1] >>  0) & 0xFF],
+                  srcTables[0][(src[2] >>  0) & 0xFF], srcTables[0][(src[3] >>  0) & 0xFF]},
+         g = Sk4f{srcTables[1][(src[0] >>  8) & 0xFF], srcTables[1][(src[1] >>  8) & 0xFF],
+                  srcTables[1][(src[2] >>  8) & 0xFF], srcTables[1][(src[3] >>  8) & 0xFF]},
+         b = Sk4f{srcTables[2][(src[0] >> 16) & 0xFF], srcTables[2][(src[1] >> 16) & 0xFF],
+                  srcTables[2][(src[2] >> 16) & 0xFF], srcTables[2][(src[3] >> 16) & 0xFF]};
+    Sk4i alphas = kOpaque_SkAlphaType == kAlphaType
+                ? Sk4i(0xFF)
+                : Sk4i(src[0] >> 24, src[1] >> 24, src[2] >> 24, src[3] >> 24);
+
+    Sk4f dr = clamp_0_to_1(matrix[0]*r + matrix[4]*g + matrix[ 8]*b + matrix[12]),
+         dg = clamp_0_to_1(matrix[1]*r + matrix[5]*g + matrix[ 9]*b + matrix[13]),
+         db = clamp_0_to_1(matrix[2]*r + matrix[6]*g + matrix[10]*b + matrix[14]);
+
+    if (kF16_DstFormat == kDst) {
+        Sk4f a = SkNx_cast<float>(alphas) * (1.0f / 255.0f);
+        if (kPremul_SkAlphaType == kAlphaType) {
+            dr = dr * a;
+            dg = dg * a;
+            db = db * a;
         }
 
-        // Increment the table ptr in order to handle the next component.
-        // Note that this is the how table is designed: all of nXXX
-        // variables are multiples of 3 because there are 3 output
-        // components.
-        ptr++;
+        uint64_t* dst64 = (uint64_t*) dst;
+        for (int i = 0; i < 4; i++) {
+            SkFloatToHalf_01(Sk4f(dr[i], dg[i], db[i], a[i]), &dst64[i]);
+        }
+        return;
+    }
+
+    // Convert to dst gamma.
+    const float scale = (float) (dstGammaTableSize - 1);
+    Sk4i ri = SkNx_cast<int>(scale * dr + 0.5f),
+         gi = SkNx_cast<int>(scale * dg + 0.5f),
+         bi = SkNx_cast<int>(scale * db + 0.5f);
+
+    uint32_t* dst32 = (uint32_t*) dst;
+    for (int i = 0; i < 4; i++) {
+        U8CPU a  = alphas[i],
+              rb = dstTables[0][ri[i]],
+              gb = dstTables[1][gi[i]],
+              bb = dstTables[2][bi[i]];
+        if (kPremul_SkAlphaType == kAlphaType) {
+            rb = SkMulDiv255Round(rb, a);
+            gb = SkMulDiv255Round(gb, a);
+            bb = SkMulDiv255Round(bb, a);
+        }
+        dst32[i] = (kRGBA_8888_DstFormat == kDst) ? SkPackARGB_as_RGBA(a, rb, gb, bb)
+                                                  : SkPackARGB_as_BGRA(a, rb, gb, bb);
     }
 }
 
-void SkDefaultXform::xform_RGB1_8888(uint32_t* dst, const uint32_t* src, uint32_t len) const {
-    while (len-- > 0) {
-        uint8_t r = (*src >>  0) & 0xFF,
-                g = (*src >>  8) & 0xFF,
-                b = (*src >> 16) & 0xFF;
+template <DstFormat kDst, SkAlphaType kAlphaType>
+static void color_xform_RGBA(void* dst, const uint32_t* src, int len,
+                             const float* const srcTables[3], const float matrix[16],
+                             const uint8_t* const dstTables[3], int dstGammaTableSize) {
+    const size_t dstBpp = (kF16_DstFormat == kDst) ? sizeof(uint64_t) : sizeof(uint32_t);
+
+    while (len >= 4) {
+        xform_4<kDst, kAlphaType>(dst, src, srcTables, matrix, dstTables, dstGammaTableSize);
+        dst = SkTAddOffset<void>(dst, 4 * dstBpp);
+        src += 4;
+        len -= 4;
+    }
 
-        if (fColorLUT) {
-            float in[3];
-            float out[3];
+    if (len > 0) {
+        uint32_t srcTail[4] = { 0, 0, 0, 0 };
+        uint64_t dstTail[4];
+        memcpy(srcTail, src, len * sizeof(uint32_t));
+        xform_4<kDst, kAlphaType>(dstTail, srcTail, srcTables, matrix, dstTables,
+                                  dstGammaTableSize);
+        memcpy(dst, dstTail, len * dstBpp);
+    }
+}
 
-            in[0] = byte_to_float(r);
-            in[1] = byte_to_float(g);
-            in[2] = byte_to_float(b);
+template <DstFormat kDst>
+static void color_xform_RGBA(void* dst, const uint32_t* src, int len, SkAlphaType dstAlphaType,
+                             const float* const srcTables[3], const float matrix[16],
+                             const uint8_t* const dstTables[3], int dstGammaTableSize) {
+    switch (dstAlphaType) {
+        case kPremul_SkAlphaType:
+            color_xform_RGBA<kDst, kPremul_SkAlphaType>(dst, src, len, srcTables, matrix,
+                                                        dstTables, dstGammaTableSize);
+            break;
+        case kUnpremul_SkAlphaType:
+            color_xform_RGBA<kDst, kUnpremul_SkAlphaType>(dst, src, len, srcTables, matrix,
+                                                          dstTables, dstGammaTableSize);
+            break;
+        default:
+            color_xform_RGBA<kDst, kOpaque_SkAlphaType>(dst, src, len, srcTables, matrix,
+                                                        dstTables, dstGammaTableSize);
+            break;
+    }
+}
 
-            interp_3d_clut(out, in, fColorLUT.get());
+// Works for any src and dst gamma that can be described by tables.  Transforms the pixels
+// in batches, so that the color LUT (if any) can run ahead of the gamut and gamma math.
+static void color_xform_RGBA(void* dst, const uint32_t* src, int len, SkColorType dstColorType,
+                             SkAlphaType dstAlphaType, const float* const srcTables[3],
+                             const float matrix[16], const uint8_t* const dstTables[3],
+                             int dstGammaTableSize, const SkColorLookUpTable* colorLUT) {
+    const size_t dstBpp = SkColorTypeBytesPerPixel(dstColorType);
+    constexpr int kBatchSize = 64;
+    uint32_t lutStorage[kBatchSize];
+
+    while (len > 0) {
+        const int n = SkTMin(len, kBatchSize);
+        const uint32_t* batch = src;
+        if (colorLUT) {
+            apply_clut(lutStorage, src, n, colorLUT);
+            batch = lutStorage;
+        }
 
-            r = sk_float_round2int(255.0f * clamp_normalized_float(out[0]));
-            g = sk_float_round2int(255.0f * clamp_normalized_float(out[1]));
-            b = sk_float_round2int(255.0f * clamp_normalized_float(out[2]));
+        switch (dstColorType) {
+            case kRGBA_8888_SkColorType:
+                color_xform_RGBA<kRGBA_8888_DstFormat>(dst, batch, n, dstAlphaType, srcTables,
+                                                       matrix, dstTables, dstGammaTableSize);
+                break;
+            case kBGRA_8888_SkColorType:
+                color_xform_RGBA<kBGRA_8888_DstFormat>(dst, batch, n, dstAlphaType, srcTables,
+                                                       matrix, dstTables, dstGammaTableSize);
+                break;
+            case kRGBA_F16_SkColorType:
+                color_xform_RGBA<kF16_DstFormat>(dst, batch, n, dstAlphaType, srcTables,
+                                                 matrix, dstTables, dstGammaTableSize);
+                break;
+            default:
+                SkASSERT(false);
+                return;
         }
 
-        // Convert to linear.
-        float srcFloats[3];
-        srcFloats[0] = fSrcGammaTables[0][r];
-        srcFloats[1] = fSrcGammaTables[1][g];
-        srcFloats[2] = fSrcGammaTables[2][b];
-
-        // Convert to dst gamut.
-        float dstFloats[3];
-        dstFloats[0] = srcFloats[0] * fSrcToDst.getFloat(0, 0) +
-                       srcFloats[1] * fSrcToDst.getFloat(1, 0) +
-                       srcFloats[2] * fSrcToDst.getFloat(2, 0) + fSrcToDst.getFloat(3, 0);
-        dstFloats[1] = srcFloats[0] * fSrcToDst.getFloat(0, 1) +
-                       srcFloats[1] * fSrcToDst.getFloat(1, 1) +
-                       srcFloats[2] * fSrcToDst.getFloat(2, 1) + fSrcToDst.getFloat(3, 1);
-        dstFloats[2] = srcFloats[0] * fSrcToDst.getFloat(0, 2) +
-                       srcFloats[1] * fSrcToDst.getFloat(1, 2) +
-                       srcFloats[2] * fSrcToDst.getFloat(2, 2) + fSrcToDst.getFloat(3, 2);
-
-        // Clamp to 0-1.
-        dstFloats[0] = clamp_normalized_float(dstFloats[0]);
-        dstFloats[1] = clamp_normalized_float(dstFloats[1]);
-        dstFloats[2] = clamp_normalized_float(dstFloats[2]);
-
-        // Convert to dst gamma.
-        r = fDstGammaTables[0][sk_float_round2int((kDstGammaTableSize - 1) * dstFloats[0])];
-        g = fDstGammaTables[1][sk_float_round2int((kDstGammaTableSize - 1) * dstFloats[1])];
-        b = fDstGammaTables[2][sk_float_round2int((kDstGammaTableSize - 1) * dstFloats[2])];
-
-        *dst = SkPackARGB32NoCheck(0xFF, r, g, b);
-
-        dst++;
-        src++;
+        dst = SkTAddOffset<void>(dst, n * dstBpp);
+        src += n;
+        len -= n;
     }
 }
+
+template <SkColorSpace::GammaNamed Gamma>
+static const float* linear_from_named_gamma() {
+    return (SkColorSpace::kSRGB_GammaNamed == Gamma) ? sk_linear_from_srgb : sk_linear_from_2dot2;
+}
+
+template <SkColorSpace::GammaNamed Gamma>
+static const uint8_t* named_gamma_from_linear() {
+    return (SkColorSpace::kSRGB_GammaNamed == Gamma) ? linear_to_srgb : linear_to_2dot2;
+}
+
+template <SkColorSpace::GammaNamed Src, SkColorSpace::GammaNamed Dst>
+void SkFastXform<Src, Dst>::apply(void* dst, const uint32_t* src, int len,
+                                  SkColorType dstColorType, SkAlphaType dstAlphaType) const
+{
+    if (kN32_SkColorType == dstColorType && kOpaque_SkAlphaType == dstAlphaType) {
+        this->xform_RGB1_8888((uint32_t*) dst, src, len);
+        return;
+    }
+
+    const float* srcTables[3];
+    const uint8_t* dstTables[3];
+    srcTables[0] = srcTables[1] = srcTables[2] = linear_from_named_gamma<Src>();
+    dstTables[0] = dstTables[1] = dstTables[2] = named_gamma_from_linear<Dst>();
+    color_xform_RGBA(dst, src, len, dstColorType, dstAlphaType, srcTables, fSrcToDstRGBA,
+                     dstTables, 1024, nullptr);
+}
+
+void SkDefaultXform::xform_RGB1_8888(uint32_t* dst, const uint32_t* src, uint32_t len) const {
+    this->apply(dst, src, len, kN32_SkColorType, kOpaque_SkAlphaType);
+}
+
+void SkDefaultXform::apply(void* dst, const uint32_t* src, int len, SkColorType dstColorType,
+                           SkAlphaType dstAlphaType) const {
+    color_xform_RGBA(dst, src, len, dstColorType, dstAlphaType, fSrcGammaTables, fSrcToDstRGBA,
+                     fDstGammaTables, kDstGammaTableSize, fColorLUT.get());
+}
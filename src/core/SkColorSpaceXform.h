@@ -10,8 +10,9 @@
 
 #include "SkColorSpace.h"
 #include "SkColorSpace_Base.h"
+#include "SkImageInfo.h"
 
-class SkColorSpaceXform : SkNoncopyable {
+class SkColorSpaceXform : public SkRefCnt {
 public:
 
     /**
@@ -24,6 +25,14 @@ public:
     static std::unique_ptr<SkColorSpaceXform> New(const sk_sp<SkColorSpace>& srcSpace,
                                                   const sk_sp<SkColorSpace>& dstSpace);
 
+    /**
+     *  Like New(), but the xform is shared.  Recently used xforms are kept in a process-wide
+     *  cache keyed by the (src, dst) pair, so repeated requests skip building the tables.
+     *  Interned color spaces (see SkColorSpace::NewICC) make these hits the common case.
+     */
+    static sk_sp<SkColorSpaceXform> FindOrNew(const sk_sp<SkColorSpace>& srcSpace,
+                                              const sk_sp<SkColorSpace>& dstSpace);
+
     /**
      *  Apply the color conversion to a src buffer, storing the output in the dst buffer.
      *  The src is opaque and stored in RGBA_8888, and the dst is also opaque and stored
@@ -31,6 +40,20 @@ public:
      */
     virtual void xform_RGB1_8888(uint32_t* dst, const uint32_t* src, uint32_t len) const = 0;
 
+    /**
+     *  Apply the color conversion to a src buffer, storing the output in the dst buffer.
+     *  The src is stored in RGBA_8888 and is unpremultiplied (or opaque).
+     *
+     *  @param dstColorType kRGBA_8888, kBGRA_8888 or kRGBA_F16.  F16 dsts are written
+     *                      in linear space, so the dst gamma is not applied.
+     *  @param dstAlphaType If this is kPremul, the dst is premultiplied.  If this is kOpaque,
+     *                      the src alpha is ignored and the dst is opaque.
+     *
+     *  dst may be the same as src when the dst is 8888.
+     */
+    virtual void apply(void* dst, const uint32_t* src, int len, SkColorType dstColorType,
+                       SkAlphaType dstAlphaType) const = 0;
+
     virtual ~SkColorSpaceXform() {}
 };
 
@@ -40,11 +63,17 @@ public:
 
     void xform_RGB1_8888(uint32_t* dst, const uint32_t* src, uint32_t len) const override;
 
+    void apply(void* dst, const uint32_t* src, int len, SkColorType dstColorType,
+               SkAlphaType dstAlphaType) const override;
+
 private:
     SkFastXform(const SkMatrix44& srcToDst);
 
     float fSrcToDst[12];
 
+    // Used by apply() for anything other than opaque N32 dsts.
+    float fSrcToDstRGBA[16];
+
     friend class SkColorSpaceXform;
 };
 
@@ -56,6 +85,9 @@ public:
 
     void xform_RGB1_8888(uint32_t* dst, const uint32_t* src, uint32_t len) const override;
 
+    void apply(void* dst, const uint32_t* src, int len, SkColorType dstColorType,
+               SkAlphaType dstAlphaType) const override;
+
 private:
     SkDefaultXform(const sk_sp<SkColorSpace>& srcSpace, const SkMatrix44& srcToDst,
                    const sk_sp<SkColorSpace>& dstSpace);
@@ -69,6 +101,7 @@ private:
     float                     fSrcGammaTableStorage[3 * 256];
 
     const SkMatrix44          fSrcToDst;
+    float                     fSrcToDstRGBA[16];
 
     // May contain pointers into storage or pointers into precomputed tables.
     const uint8_t*            fDstGammaTables[3];
@@ -171,6 +171,12 @@ private:
 
     static sk_sp<SkColorSpace> NewRGB(GammaNamed gammaNamed, const SkMatrix44& toXYZD50);
 
+    /**
+     *  Parses an ICC profile without consulting the interned profile cache.  NewICC()
+     *  only calls this the first time it sees a given profile.
+     */
+    static sk_sp<SkColorSpace> ParseICC(const void* input, size_t len);
+
     SkColorSpace_Base(GammaNamed gammaNamed, const SkMatrix44& toXYZ, Named named);
 
     SkColorSpace_Base(sk_sp<SkColorLookUpTable> colorLUT, sk_sp<SkGammas> gammas,
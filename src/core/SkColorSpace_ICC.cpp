@@ -7,9 +7,11 @@
 
 #include "SkColorSpace.h"
 #include "SkColorSpace_Base.h"
+#include "SkChecksum.h"
 #include "SkColorSpacePriv.h"
 #include "SkEndian.h"
 #include "SkFixed.h"
+#include "SkMutex.h"
 #include "SkTemplates.h"
 
 #define return_if_false(pred, msg)                                   \
@@ -678,11 +680,70 @@ bool load_a2b0(SkColorLookUpTable* colorLUT, SkGammaCurve* gammas, SkMatrix44* t
     return true;
 }
 
+// Images tend to share a handful of embedded profiles, so we remember the color spaces we
+// have parsed recently and hand out the same instance when the same bytes come back.
+static constexpr int kICCCacheCount = 32;
+
+struct ICCCacheEntry {
+    uint32_t            fHash;
+    sk_sp<SkData>       fProfile;
+    sk_sp<SkColorSpace> fColorSpace;
+};
+
+SK_DECLARE_STATIC_MUTEX(gICCCacheMutex);
+static ICCCacheEntry* gICCCache;     // Leaked.  Guarded by gICCCacheMutex.
+static int gICCCacheNext;
+
+static sk_sp<SkColorSpace> find_cached_icc(uint32_t hash, const void* input, size_t len) {
+    gICCCacheMutex.assertHeld();
+    if (!gICCCache) {
+        gICCCache = new ICCCacheEntry[kICCCacheCount];
+    }
+    for (int i = 0; i < kICCCacheCount; i++) {
+        const ICCCacheEntry& entry = gICCCache[i];
+        if (entry.fProfile && hash == entry.fHash && len == entry.fProfile->size() &&
+            0 == memcmp(input, entry.fProfile->data(), len)) {
+            return entry.fColorSpace;
+        }
+    }
+    return nullptr;
+}
+
 sk_sp<SkColorSpace> SkColorSpace::NewICC(const void* input, size_t len) {
     if (!input || len < kICCHeaderSize) {
         return_null("Data is null or not large enough to contain an ICC profile");
     }
 
+    const uint32_t hash = SkChecksum::Murmur3(input, len);
+    {
+        SkAutoMutexAcquire lock(gICCCacheMutex);
+        if (sk_sp<SkColorSpace> cached = find_cached_icc(hash, input, len)) {
+            return cached;
+        }
+    }
+
+    // Parse outside of the lock.  If another thread races us to the same profile, keep
+    // whichever result was cached first so that callers still share a single instance.
+    sk_sp<SkColorSpace> colorSpace = SkColorSpace_Base::ParseICC(input, len);
+    if (!colorSpace) {
+        return nullptr;
+    }
+
+    SkAutoMutexAcquire lock(gICCCacheMutex);
+    if (sk_sp<SkColorSpace> cached = find_cached_icc(hash, input, len)) {
+        return cached;
+    }
+    ICCCacheEntry& entry = gICCCache[gICCCacheNext];
+    gICCCacheNext = (gICCCacheNext + 1) % kICCCacheCount;
+    entry.fHash = hash;
+    entry.fProfile = SkData::MakeWithCopy(input, len);
+    entry.fColorSpace = colorSpace;
+    return colorSpace;
+}
+
+sk_sp<SkColorSpace> SkColorSpace_Base::ParseICC(const void* input, size_t len) {
+    SkASSERT(input && len >= kICCHeaderSize);
+
     // Create our own copy of the input.
     void* memory = sk_malloc_throw(len);
     memcpy(memory, input, len);
@@ -10,6 +10,7 @@
 #include "SkDraw.h"
 #include "SkDrawFilter.h"
 #include "SkImage_Base.h"
+#include "SkImageCacherator.h"
 #include "SkImageFilter.h"
 #include "SkImageFilterCache.h"
 #include "SkMetaData.h"
@@ -108,9 +109,7 @@ void SkBaseDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob, SkSc
     SkPaint runPaint = paint;
 
     SkTextBlobRunIterator it(blob);
-    for (;!it.done(); it.next()) {
-        size_t textLen = it.glyphCount() * sizeof(uint16_t);
-        const SkPoint& offset = it.offset();
+    for (int runIndex = 0; !it.done(); it.next(), ++runIndex) {
         // applyFontToPaint() always overwrites the exact same attributes,
         // so it is safe to not re-seed the paint for this reason.
         it.applyFontToPaint(&runPaint);
@@ -123,21 +122,7 @@ void SkBaseDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob, SkSc
 
         runPaint.setFlags(this->filterTextFlags(runPaint));
 
-        switch (it.positioning()) {
-        case SkTextBlob::kDefault_Positioning:
-            this->drawText(draw, it.glyphs(), textLen, x + offset.x(), y + offset.y(), runPaint);
-            break;
-        case SkTextBlob::kHorizontal_Positioning:
-            this->drawPosText(draw, it.glyphs(), textLen, it.pos(), 1,
-                              SkPoint::Make(x, y + offset.y()), runPaint);
-            break;
-        case SkTextBlob::kFull_Positioning:
-            this->drawPosText(draw, it.glyphs(), textLen, it.pos(), 2,
-                              SkPoint::Make(x, y), runPaint);
-            break;
-        default:
-            SkFAIL("unhandled positioning mode");
-        }
+        this->drawTextBlobRun(draw, blob, runIndex, it, x, y, runPaint);
 
         if (drawFilter) {
             // A draw filter may change the paint arbitrarily, so we must re-seed in this case.
@@ -146,11 +131,52 @@ void SkBaseDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob, SkSc
     }
 }
 
+void SkBaseDevice::drawTextBlobRun(const SkDraw& draw, const SkTextBlob*, int,
+                                   const SkTextBlobRunIterator& it, SkScalar x, SkScalar y,
+                                   const SkPaint& runPaint) {
+    size_t textLen = it.glyphCount() * sizeof(uint16_t);
+    const SkPoint& offset = it.offset();
+
+    switch (it.positioning()) {
+    case SkTextBlob::kDefault_Positioning:
+        this->drawText(draw, it.glyphs(), textLen, x + offset.x(), y + offset.y(), runPaint);
+        break;
+    case SkTextBlob::kHorizontal_Positioning:
+        this->drawPosText(draw, it.glyphs(), textLen, it.pos(), 1,
+                          SkPoint::Make(x, y + offset.y()), runPaint);
+        break;
+    case SkTextBlob::kFull_Positioning:
+        this->drawPosText(draw, it.glyphs(), textLen, it.pos(), 2,
+                          SkPoint::Make(x, y), runPaint);
+        break;
+    default:
+        SkFAIL("unhandled positioning mode");
+    }
+}
+
+// Lazy images drawn scaled down (by matrix) can often be decoded straight to a smaller size,
+// rather than decoded in full and filtered down.
+static bool lock_scaled_image(const SkImage* image, const SkMatrix& matrix, const SkPaint& paint,
+                              SkBitmap* bm) {
+    SkImageCacherator* cacher = as_IB(image)->peekCacherator();
+    if (!cacher || kNone_SkFilterQuality == paint.getFilterQuality()) {
+        return false;
+    }
+    // Each axis needs at least as many pixels as it will cover.
+    const SkScalar scale = matrix.getMaxScale();
+    return scale > 0 && scale < 1 && cacher->lockAsScaledBitmap(bm, scale, image);
+}
+
 void SkBaseDevice::drawImage(const SkDraw& draw, const SkImage* image, SkScalar x, SkScalar y,
                              const SkPaint& paint) {
     // Default impl : turns everything into raster bitmap
     SkBitmap bm;
-    if (as_IB(image)->getROPixels(&bm)) {
+    if (lock_scaled_image(image, *draw.fMatrix, paint, &bm)) {
+        SkMatrix matrix = SkMatrix::MakeTrans(x, y);
+        matrix.preScale(SkIntToScalar(image->width()) / bm.width(),
+                        SkIntToScalar(image->height()) / bm.height());
+        this->drawBitmap(draw, bm, matrix, paint);
+    } else if (as_IB(image)->getROPixels(&bm)) {
         this->drawBitmap(draw, bm, SkMatrix::MakeTrans(x, y), paint);
     }
 }
@@ -160,7 +186,17 @@ void SkBaseDevice::drawImageRect(const SkDraw& draw, const SkImage* image, const
                                  SkCanvas::SrcRectConstraint constraint) {
     // Default impl : turns everything into raster bitmap
     SkBitmap bm;
-    if (as_IB(image)->getROPixels(&bm)) {
+    const SkRect bounds = SkRect::MakeIWH(image->width(), image->height());
+    SkMatrix matrix;
+    matrix.setRectToRect(src ? *src : bounds, dst, SkMatrix::kFill_ScaleToFit);
+    matrix.postConcat(*draw.fMatrix);
+    if (lock_scaled_image(image, matrix, paint, &bm)) {
+        const SkMatrix toScaled = SkMatrix::MakeScale(bm.width() / bounds.width(),
+                                                      bm.height() / bounds.height());
+        SkRect scaledSrc;
+        toScaled.mapRect(&scaledSrc, src ? *src : bounds);
+        this->drawBitmapRect(draw, bm, &scaledSrc, dst, paint, constraint);
+    } else if (as_IB(image)->getROPixels(&bm)) {
         this->drawBitmapRect(draw, bm, src, dst, paint, constraint);
     }
 }
@@ -6,12 +6,19 @@
  */
 
 #include "SkDistanceFieldGen.h"
+#include "SkNx.h"
 #include "SkPoint.h"
+#include "SkTaskGroup.h"
+#include "SkTemplates.h"
 
+// The working data is kept in separate planes, so that texels which don't depend on each other
+// can be processed several at a time.
 struct DFData {
-    float   fAlpha;      // alpha value of source texel
-    float   fDistSq;     // distance squared to nearest (so far) edge texel
-    SkPoint fDistVector; // distance vector to nearest (so far) edge texel
+    float*         fAlpha;   // alpha value of source texel
+    float*         fDistSq;  // distance squared to nearest (so far) edge texel
+    float*         fDistX;   // distance vector to nearest (so far) edge texel
+    float*         fDistY;
+    unsigned char* fEdges;   // non-zero for edge texels
 };
 
 enum NeighborFlags {
@@ -63,21 +70,53 @@ static bool found_edge(const unsigned char* imagePtr, int width, int neighborFla
     return false;
 }
 
-static void init_glyph_data(DFData* data, unsigned char* edges, const unsigned char* image,
+// The same test as found_edge(), for 16 texels that have all 8 neighbors.
+static Sk16b found_edges(const unsigned char* imagePtr, int width) {
+    const int offsets[8] = {-1, 1, -width-1, -width, -width+1, width-1, width, width+1 };
+
+    Sk16b currVal = Sk16b::Load(imagePtr);
+    Sk16b currLow = currVal < Sk16b(128);
+    Sk16b currSoft = Sk16b::Min(currLow, Sk16b(0) < currVal);
+    Sk16b edges(0);
+    for (int offset : offsets) {
+        Sk16b neighborVal = Sk16b::Load(imagePtr + offset);
+        Sk16b neighborLow = neighborVal < Sk16b(128);
+        Sk16b neighborSoft = Sk16b::Min(neighborLow, Sk16b(0) < neighborVal);
+        // if sharp transition
+        Sk16b transition = currLow.thenElse(Sk16b(255) - neighborLow, neighborLow);
+        // or both <128 and >0
+        edges = edges.saturatedAdd(transition).saturatedAdd(Sk16b::Min(currSoft, neighborSoft));
+    }
+    return edges;
+}
+
+static void init_glyph_data(DFData* data, const unsigned char* image,
                             int dataWidth, int dataHeight,
                             int imageWidth, int imageHeight,
                             int pad) {
-    data += pad*dataWidth;
-    data += pad;
-    edges += (pad*dataWidth + pad);
+    float* alpha = data->fAlpha + pad*dataWidth + pad;
+    unsigned char* edges = data->fEdges + pad*dataWidth + pad;
 
     for (int j = 0; j < imageHeight; ++j) {
         for (int i = 0; i < imageWidth; ++i) {
-            if (255 == *image) {
-                data->fAlpha = 1.0f;
+            if (255 == image[i]) {
+                alpha[i] = 1.0f;
             } else {
-                data->fAlpha = (*image)*0.00392156862f;  // 1/255
+                alpha[i] = image[i]*0.00392156862f;  // 1/255
             }
+        }
+
+        int i = 0;
+        if (j > 0 && j < imageHeight-1) {
+            // interior texels have all of their neighbors, so can be tested 16 at a time
+            edges[0] = found_edge(image, imageWidth, kAll_NeighborFlags &
+                        ~(kLeft_NeighborFlag|kTopLeft_NeighborFlag|kBottomLeft_NeighborFlag))
+                     ? 255 : 0;
+            for (i = 1; i + 16 <= imageWidth-1; i += 16) {
+                found_edges(image + i, imageWidth).store(edges + i);
+            }
+        }
+        for (; i < imageWidth; ++i) {
             int checkMask = kAll_NeighborFlags;
             if (i == 0) {
                 checkMask &= ~(kLeft_NeighborFlag|kTopLeft_NeighborFlag|kBottomLeft_NeighborFlag);
@@ -91,15 +130,13 @@ static void init_glyph_data(DFData* data, unsigned char* edges, const unsigned c
             if (j == imageHeight-1) {
                 checkMask &= ~(kBottomLeft_NeighborFlag|kBottom_NeighborFlag|kBottomRight_NeighborFlag);
             }
-            if (found_edge(image, imageWidth, checkMask)) {
-                *edges = 255;  // using 255 makes for convenient debug rendering
+            if (found_edge(image + i, imageWidth, checkMask)) {
+                edges[i] = 255;  // using 255 makes for convenient debug rendering
             }
-            ++data;
-            ++image;
-            ++edges;
         }
-        data += 2*pad;
-        edges += 2*pad;
+        image += imageWidth;
+        alpha += dataWidth;
+        edges += dataWidth;
     }
 }
 
@@ -145,170 +182,271 @@ static float edge_distance(const SkPoint& direction, float alpha) {
     return distance;
 }
 
-static void init_distances(DFData* data, unsigned char* edges, int width, int height) {
-    // skip one pixel border
-    DFData* currData = data;
-    DFData* prevData = data - width;
-    DFData* nextData = data + width;
+static void init_distances(DFData* data, int width, int height) {
+    const float* alpha = data->fAlpha;
 
     for (int j = 0; j < height; ++j) {
         for (int i = 0; i < width; ++i) {
-            if (*edges) {
+            const int curr = j*width + i;
+            if (data->fEdges[curr]) {
                 // we should not be in the one-pixel outside band
                 SkASSERT(i > 0 && i < width-1 && j > 0 && j < height-1);
+                const int prev = curr - width;
+                const int next = curr + width;
                 // gradient will point from low to high
                 // +y is down in this case
                 // i.e., if you're outside, gradient points towards edge
                 // if you're inside, gradient points away from edge
                 SkPoint currGrad;
-                currGrad.fX = (prevData+1)->fAlpha - (prevData-1)->fAlpha
-                             + SK_ScalarSqrt2*(currData+1)->fAlpha
-                             - SK_ScalarSqrt2*(currData-1)->fAlpha
-                             + (nextData+1)->fAlpha - (nextData-1)->fAlpha;
-                currGrad.fY = (nextData-1)->fAlpha - (prevData-1)->fAlpha
-                             + SK_ScalarSqrt2*nextData->fAlpha
-                             - SK_ScalarSqrt2*prevData->fAlpha
-                             + (nextData+1)->fAlpha - (prevData+1)->fAlpha;
+                currGrad.fX = alpha[prev+1] - alpha[prev-1]
+                             + SK_ScalarSqrt2*alpha[curr+1]
+                             - SK_ScalarSqrt2*alpha[curr-1]
+                             + alpha[next+1] - alpha[next-1];
+                currGrad.fY = alpha[next-1] - alpha[prev-1]
+                             + SK_ScalarSqrt2*alpha[next]
+                             - SK_ScalarSqrt2*alpha[prev]
+                             + alpha[next+1] - alpha[prev+1];
                 currGrad.setLengthFast(1.0f);
 
                 // init squared distance to edge and distance vector
-                float dist = edge_distance(currGrad, currData->fAlpha);
-                currGrad.scale(dist, &currData->fDistVector);
-                currData->fDistSq = dist*dist;
+                float dist = edge_distance(currGrad, alpha[curr]);
+                data->fDistX[curr] = currGrad.fX * dist;
+                data->fDistY[curr] = currGrad.fY * dist;
+                data->fDistSq[curr] = dist*dist;
             } else {
                 // init distance to "far away"
-                currData->fDistSq = 2000000.f;
-                currData->fDistVector.fX = 1000.f;
-                currData->fDistVector.fY = 1000.f;
+                data->fDistSq[curr] = 2000000.f;
+                data->fDistX[curr] = 1000.f;
+                data->fDistY[curr] = 1000.f;
             }
-            ++currData;
-            ++prevData;
-            ++nextData;
-            ++edges;
         }
     }
 }
 
 // Danielsson's 8SSEDT
+//
+// Each texel takes the closest of the candidates offered by its neighbors, in a fixed order,
+// keeping the earlier one on ties. The neighbors in the row above (or below) are already final
+// when a row is swept, so those candidates are evaluated N texels at a time; only the left and
+// right neighbors need to be visited one after another.
+
+template <int N>
+static void take_if_closer(const SkNx<N, float>& candSq,
+                           const SkNx<N, float>& candX, const SkNx<N, float>& candY,
+                           SkNx<N, float>* distSq, SkNx<N, float>* distX, SkNx<N, float>* distY) {
+    const SkNx<N, float> closer = candSq < *distSq;
+    *distSq = closer.thenElse(candSq, *distSq);
+    *distX = closer.thenElse(candX, *distX);
+    *distY = closer.thenElse(candY, *distY);
+}
+
+// first stage forward pass, upper neighbors
+// (forward in Y)
+template <int N>
+static void F1_above(DFData* data, int curr, int width) {
+    using F = SkNx<N, float>;
+    // edge texels keep their distance, so make them closer than any candidate
+    const F isEdge = SkNx_cast<float>(SkNx<N, uint8_t>::Load(data->fEdges + curr)) > F(0);
+    const F origSq = F::Load(data->fDistSq + curr);
+    F distSq = isEdge.thenElse(F(-1.0f), origSq);
+    F distX = F::Load(data->fDistX + curr);
+    F distY = F::Load(data->fDistY + curr);
 
-// first stage forward pass
-// (forward in Y, forward in X)
-static void F1(DFData* curr, int width) {
     // upper left
-    DFData* check = curr - width-1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*(distVec.fX + distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+    int check = curr - width-1;
+    F checkX = F::Load(data->fDistX + check);
+    F checkY = F::Load(data->fDistY + check);
+    F checkSq = F::Load(data->fDistSq + check) - 2.0f*(checkX + checkY - 1.0f);
+    take_if_closer(checkSq, checkX - 1.0f, checkY - 1.0f, &distSq, &distX, &distY);
 
     // up
     check = curr - width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+    checkX = F::Load(data->fDistX + check);
+    checkY = F::Load(data->fDistY + check);
+    checkSq = F::Load(data->fDistSq + check) - 2.0f*checkY + 1.0f;
+    take_if_closer(checkSq, checkX, checkY - 1.0f, &distSq, &distX, &distY);
 
     // upper right
     check = curr - width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX - distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+    checkX = F::Load(data->fDistX + check);
+    checkY = F::Load(data->fDistY + check);
+    checkSq = F::Load(data->fDistSq + check) + 2.0f*(checkX - checkY + 1.0f);
+    take_if_closer(checkSq, checkX + 1.0f, checkY - 1.0f, &distSq, &distX, &distY);
+
+    isEdge.thenElse(origSq, distSq).store(data->fDistSq + curr);
+    distX.store(data->fDistX + curr);
+    distY.store(data->fDistY + curr);
+}
 
-    // left
-    check = curr - 1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+// second stage backward pass, lower neighbors
+// (backward in Y)
+// These are only combined with the right neighbor's candidate later, so the closest of them is
+// stored in cand*.
+template <int N>
+static void B2_below(const DFData* data, int curr, int width,
+                     float* candSq, float* candX, float* candY) {
+    using F = SkNx<N, float>;
+
+    // bottom left
+    int check = curr + width-1;
+    F checkX = F::Load(data->fDistX + check);
+    F checkY = F::Load(data->fDistY + check);
+    F distSq = F::Load(data->fDistSq + check) - 2.0f*(checkX - checkY - 1.0f);
+    F distX = checkX - 1.0f;
+    F distY = checkY + 1.0f;
+
+    // bottom
+    check = curr + width;
+    checkX = F::Load(data->fDistX + check);
+    checkY = F::Load(data->fDistY + check);
+    F checkSq = F::Load(data->fDistSq + check) + 2.0f*checkY + 1.0f;
+    take_if_closer(checkSq, checkX, checkY + 1.0f, &distSq, &distX, &distY);
+
+    // bottom right
+    check = curr + width+1;
+    checkX = F::Load(data->fDistX + check);
+    checkY = F::Load(data->fDistY + check);
+    checkSq = F::Load(data->fDistSq + check) + 2.0f*(checkX + checkY + 1.0f);
+    take_if_closer(checkSq, checkX + 1.0f, checkY + 1.0f, &distSq, &distX, &distY);
+
+    distSq.store(candSq);
+    distX.store(candX);
+    distY.store(candY);
 }
 
-// second stage forward pass
-// (forward in Y, backward in X)
-static void F2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    float distSq = check->fDistSq;
-    SkPoint distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// left neighbor, for the first stage of both passes
+static void take_left(DFData* data, int curr) {
+    const int check = curr - 1;
+    float distSq = data->fDistSq[check] - 2.0f*data->fDistX[check] + 1.0f;
+    if (distSq < data->fDistSq[curr]) {
+        data->fDistSq[curr] = distSq;
+        data->fDistX[curr] = data->fDistX[check] - 1.0f;
+        data->fDistY[curr] = data->fDistY[check];
     }
 }
 
-// first stage backward pass
-// (backward in Y, forward in X)
-static void B1(DFData* curr, int width) {
-    // left
-    DFData* check = curr - 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// right neighbor, for the second stage of both passes
+static void take_right(DFData* data, int curr) {
+    const int check = curr + 1;
+    float distSq = data->fDistSq[check] + 2.0f*data->fDistX[check] + 1.0f;
+    if (distSq < data->fDistSq[curr]) {
+        data->fDistSq[curr] = distSq;
+        data->fDistX[curr] = data->fDistX[check] + 1.0f;
+        data->fDistY[curr] = data->fDistY[check];
     }
 }
 
-// second stage backward pass
-// (backward in Y, backwards in X)
-static void B2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+static void sweep_distances(DFData* data, int dataWidth, int dataHeight) {
+    // storage for the closest lower neighbor of each texel in a row
+    SkAutoSTMalloc<3*128, float> candStorage(3*dataWidth);
+    float* candSq = candStorage.get();
+    float* candX = candSq + dataWidth;
+    float* candY = candX + dataWidth;
 
-    // bottom left
-    check = curr + width-1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*(distVec.fX - distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    // skip the outer buffer
+    const int rowStart = 1;
+    const int rowEnd = dataWidth-1;
+
+    // forwards in y
+    for (int j = 1; j < dataHeight-1; ++j) {
+        const int row = j*dataWidth;
+        int i = rowStart;
+        for (; i + 4 <= rowEnd; i += 4) {
+            F1_above<4>(data, row + i, dataWidth);
+        }
+        for (; i < rowEnd; ++i) {
+            F1_above<1>(data, row + i, dataWidth);
+        }
+
+        // forwards in x
+        for (i = rowStart; i < rowEnd; ++i) {
+            // don't need to calculate distance for edge pixels
+            if (!data->fEdges[row + i]) {
+                take_left(data, row + i);
+            }
+        }
+
+        // backwards in x
+        for (i = rowEnd-1; i >= rowStart; --i) {
+            if (!data->fEdges[row + i]) {
+                take_right(data, row + i);
+            }
+        }
     }
 
-    // bottom
-    check = curr + width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    // backwards in y
+    // This pass has always visited each row shifted back by two texels, starting with the
+    // last texel of the row above; that only touches the padding, and is kept so that the
+    // generated fields don't change.
+    const int backStart = rowStart - 2;
+    const int backEnd = rowEnd - 2;
+    for (int j = dataHeight-2; j > 0; --j) {
+        const int row = j*dataWidth;
+        int i = backStart;
+        for (; i + 4 <= backEnd; i += 4) {
+            B2_below<4>(data, row + i, dataWidth, candSq + i+2, candX + i+2, candY + i+2);
+        }
+        for (; i < backEnd; ++i) {
+            B2_below<1>(data, row + i, dataWidth, candSq + i+2, candX + i+2, candY + i+2);
+        }
+
+        // forwards in x
+        for (i = backStart; i < backEnd; ++i) {
+            if (!data->fEdges[row + i]) {
+                take_left(data, row + i);
+            }
+        }
+
+        // backwards in x
+        for (i = backEnd-1; i >= backStart; --i) {
+            const int curr = row + i;
+            if (!data->fEdges[curr]) {
+                take_right(data, curr);
+                if (candSq[i+2] < data->fDistSq[curr]) {
+                    data->fDistSq[curr] = candSq[i+2];
+                    data->fDistX[curr] = candX[i+2];
+                    data->fDistY[curr] = candY[i+2];
+                }
+            }
+        }
     }
+}
 
-    // bottom right
-    check = curr + width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX + distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Rather than propagating distances, have every edge texel offer itself to each texel close
+// enough to end up inside the distance field's range.
+static void exact_distances(DFData* data, int dataWidth, int dataHeight) {
+    // edge texels are at most ~0.7 texels from the edge they hold
+    const int kRadius = SK_DistanceFieldMagnitude + 1;
+
+    for (int ej = 1; ej < dataHeight-1; ++ej) {
+        for (int ei = 1; ei < dataWidth-1; ++ei) {
+            const int edge = ej*dataWidth + ei;
+            if (!data->fEdges[edge]) {
+                continue;
+            }
+            const float edgeX = data->fDistX[edge];
+            const float edgeY = data->fDistY[edge];
+            const int top = SkTMax(ej - kRadius, 1);
+            const int bottom = SkTMin(ej + kRadius, dataHeight-2);
+            const int left = SkTMax(ei - kRadius, 1);
+            const int right = SkTMin(ei + kRadius, dataWidth-2);
+            for (int j = top; j <= bottom; ++j) {
+                const float distY = edgeY + (ej - j);
+                for (int i = left; i <= right; ++i) {
+                    const int curr = j*dataWidth + i;
+                    if (data->fEdges[curr]) {
+                        continue;
+                    }
+                    const float distX = edgeX + (ei - i);
+                    const float distSq = distX*distX + distY*distY;
+                    if (distSq < data->fDistSq[curr]) {
+                        data->fDistSq[curr] = distSq;
+                        data->fDistX[curr] = distX;
+                        data->fDistY[curr] = distY;
+                    }
+                }
+            }
+        }
     }
 }
 
@@ -331,13 +469,23 @@ static unsigned char pack_distance_field_val(float dist) {
     // (which represents zero).
     return (unsigned char)SkScalarRoundToInt(dist / (2 * distanceMagnitude) * 256.0f);
 }
+
+// pack_distance_field_val() for 4 distances; the results are in [0, 255].
+template <int distanceMagnitude>
+static Sk4f pack_distance_field_vals(const Sk4f& dist) {
+    Sk4f val = Sk4f::Max(Sk4f::Min(Sk4f(0) - dist, Sk4f(distanceMagnitude * 127.0f / 128.0f)),
+                         Sk4f(-distanceMagnitude));
+    val = val + Sk4f(distanceMagnitude);
+    return (val / (2 * distanceMagnitude) * 256.0f + 0.5f).floor();
+}
 #endif
 
 // assumes a padded 8-bit image and distance field
 // width and height are the original width and height of the image
 static bool generate_distance_field_from_image(unsigned char* distanceField,
                                                const unsigned char* copyPtr,
-                                               int width, int height) {
+                                               int width, int height,
+                                               SkDistanceFieldMethod method) {
     SkASSERT(distanceField);
     SkASSERT(copyPtr);
 
@@ -348,92 +496,52 @@ static bool generate_distance_field_from_image(unsigned char* distanceField,
     // set params for distance field data
     int dataWidth = width + 2*pad;
     int dataHeight = height + 2*pad;
+    int dataCount = dataWidth*dataHeight;
 
     // create zeroed temp DFData+edge storage
-    SkAutoFree storage(sk_calloc_throw(dataWidth*dataHeight*(sizeof(DFData) + 1)));
-    DFData*        dataPtr = (DFData*)storage.get();
-    unsigned char* edgePtr = (unsigned char*)storage.get() + dataWidth*dataHeight*sizeof(DFData);
+    SkAutoFree storage(sk_calloc_throw(dataCount*(4*sizeof(float) + 1)));
+    DFData data;
+    data.fAlpha = (float*)storage.get();
+    data.fDistSq = data.fAlpha + dataCount;
+    data.fDistX = data.fDistSq + dataCount;
+    data.fDistY = data.fDistX + dataCount;
+    data.fEdges = (unsigned char*)(data.fDistY + dataCount);
 
     // copy glyph into distance field storage
-    init_glyph_data(dataPtr, edgePtr, copyPtr,
+    init_glyph_data(&data, copyPtr,
                     dataWidth, dataHeight,
                     width+2, height+2, SK_DistanceFieldPad);
 
     // create initial distance data, particularly at edges
-    init_distances(dataPtr, edgePtr, dataWidth, dataHeight);
+    init_distances(&data, dataWidth, dataHeight);
 
     // now perform Euclidean distance transform to propagate distances
-
-    // forwards in y
-    DFData* currData = dataPtr+dataWidth+1; // skip outer buffer
-    unsigned char* currEdge = edgePtr+dataWidth+1;
-    for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData += dataWidth+1;
-        currEdge += dataWidth+1;
-    }
-
-    // backwards in y
-    currData = dataPtr+dataWidth*(dataHeight-2) - 1; // skip outer buffer
-    currEdge = edgePtr+dataWidth*(dataHeight-2) - 1;
-    for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData -= dataWidth-1;
-        currEdge -= dataWidth-1;
+    if (kExact_SkDistanceFieldMethod == method) {
+        exact_distances(&data, dataWidth, dataHeight);
+    } else {
+        sweep_distances(&data, dataWidth, dataHeight);
     }
 
     // copy results to final distance field data
-    currData = dataPtr + dataWidth+1;
-    currEdge = edgePtr + dataWidth+1;
     unsigned char *dfPtr = distanceField;
     for (int j = 1; j < dataHeight-1; ++j) {
-        for (int i = 1; i < dataWidth-1; ++i) {
+        const int row = j*dataWidth;
+        int i = 1;
+#if !DUMP_EDGE
+        for (; i + 4 <= dataWidth-1; i += 4) {
+            Sk4f dist = Sk4f::Load(data.fDistSq + row + i).sqrt();
+            dist = (Sk4f::Load(data.fAlpha + row + i) > Sk4f(0.5f)).thenElse(Sk4f(0) - dist, dist);
+            SkNx_cast<uint8_t>(pack_distance_field_vals<SK_DistanceFieldMagnitude>(dist))
+                    .store(dfPtr);
+            dfPtr += 4;
+        }
+#endif
+        for (; i < dataWidth-1; ++i) {
+            const int curr = row + i;
 #if DUMP_EDGE
-            float alpha = currData->fAlpha;
+            float alpha = data.fAlpha[curr];
             float edge = 0.0f;
-            if (*currEdge) {
+            if (data.fEdges[curr]) {
                 edge = 0.25f;
             }
             // blend with original image
@@ -442,18 +550,14 @@ static bool generate_distance_field_from_image(unsigned char* distanceField,
             *dfPtr++ = val;
 #else
             float dist;
-            if (currData->fAlpha > 0.5f) {
-                dist = -SkScalarSqrt(currData->fDistSq);
+            if (data.fAlpha[curr] > 0.5f) {
+                dist = -SkScalarSqrt(data.fDistSq[curr]);
             } else {
-                dist = SkScalarSqrt(currData->fDistSq);
+                dist = SkScalarSqrt(data.fDistSq[curr]);
             }
             *dfPtr++ = pack_distance_field_val<SK_DistanceFieldMagnitude>(dist);
 #endif
-            ++currData;
-            ++currEdge;
         }
-        currData += 2;
-        currEdge += 2;
     }
 
     return true;
@@ -462,7 +566,8 @@ static bool generate_distance_field_from_image(unsigned char* distanceField,
 // assumes an 8-bit image and distance field
 bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
                                         const unsigned char* image,
-                                        int width, int height, size_t rowBytes) {
+                                        int width, int height, size_t rowBytes,
+                                        SkDistanceFieldMethod method) {
     SkASSERT(distanceField);
     SkASSERT(image);
 
@@ -484,13 +589,14 @@ bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
     }
     sk_bzero(currDestPtr, (width+2)*sizeof(char));
 
-    return generate_distance_field_from_image(distanceField, copyPtr, width, height);
+    return generate_distance_field_from_image(distanceField, copyPtr, width, height, method);
 }
 
 // assumes a 1-bit image and 8-bit distance field
 bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
                                         const unsigned char* image,
-                                        int width, int height, size_t rowBytes) {
+                                        int width, int height, size_t rowBytes,
+                                        SkDistanceFieldMethod method) {
     SkASSERT(distanceField);
     SkASSERT(image);
 
@@ -518,5 +624,31 @@ bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
     }
     sk_bzero(currDestPtr, (width+2)*sizeof(char));
 
-    return generate_distance_field_from_image(distanceField, copyPtr, width, height);
+    return generate_distance_field_from_image(distanceField, copyPtr, width, height, method);
+}
+
+bool SkGenerateDistanceFields(const SkDistanceFieldRequest requests[], int count,
+                              SkDistanceFieldMethod method) {
+    SkAutoSTMalloc<32, bool> results(count);
+    SkTaskGroup().batch(count, [&](int i) {
+        const SkDistanceFieldRequest& request = requests[i];
+        if (SkMask::kBW_Format == request.fFormat) {
+            results[i] = SkGenerateDistanceFieldFromBWImage(request.fDistanceField,
+                                                            request.fImage,
+                                                            request.fWidth, request.fHeight,
+                                                            request.fRowBytes, method);
+        } else {
+            SkASSERT(SkMask::kA8_Format == request.fFormat);
+            results[i] = SkGenerateDistanceFieldFromA8Image(request.fDistanceField,
+                                                            request.fImage,
+                                                            request.fWidth, request.fHeight,
+                                                            request.fRowBytes, method);
+        }
+    });
+
+    bool success = true;
+    for (int i = 0; i < count; ++i) {
+        success &= results[i];
+    }
+    return success;
 }
@@ -7,6 +7,7 @@
 #ifndef SkDistanceFieldGen_DEFINED
 #define SkDistanceFieldGen_DEFINED
 
+#include "SkMask.h"
 #include "SkTypes.h"
 
 // the max magnitude for the distance field
@@ -25,6 +26,15 @@
 #define SK_DistanceFieldMultiplier   "7.96875"
 #define SK_DistanceFieldThreshold    "0.50196078431"
 
+enum SkDistanceFieldMethod {
+    // Propagates distances from the edge texels with two sweeps over the image (8SSEDT).
+    // Texels far from the nearest edge may be slightly off.
+    kApproximate_SkDistanceFieldMethod,
+    // Measures the distance from every texel to every edge texel within range. Slower, but
+    // exact up to the edge texels' own estimates.
+    kExact_SkDistanceFieldMethod,
+};
+
 /** Given 8-bit mask data, generate the associated distance field
 
  *  @param distanceField     The distance field to be generated. Should already be allocated
@@ -33,10 +43,13 @@
  *  @param w                 Width of the original image.
  *  @param h                 Height of the original image.
  *  @param rowBytes          Size of each row in the image, in bytes
+ *  @param method            How distances away from the edges are computed.
  */
 bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
                                         const unsigned char* image,
-                                        int w, int h, size_t rowBytes);
+                                        int w, int h, size_t rowBytes,
+                                        SkDistanceFieldMethod method =
+                                                kApproximate_SkDistanceFieldMethod);
 
 /** Given 1-bit mask data, generate the associated distance field
 
@@ -46,10 +59,29 @@ bool SkGenerateDistanceFieldFromA8Image(unsigned char* distanceField,
  *  @param w                 Width of the original image.
  *  @param h                 Height of the original image.
  *  @param rowBytes          Size of each row in the image, in bytes
+ *  @param method            How distances away from the edges are computed.
  */
 bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
                                         const unsigned char* image,
-                                        int w, int h, size_t rowBytes);
+                                        int w, int h, size_t rowBytes,
+                                        SkDistanceFieldMethod method =
+                                                kApproximate_SkDistanceFieldMethod);
+
+/** One image for SkGenerateDistanceFields(). fFormat must be kA8_Format or kBW_Format. */
+struct SkDistanceFieldRequest {
+    unsigned char*       fDistanceField;
+    const unsigned char* fImage;
+    int                  fWidth;
+    int                  fHeight;
+    size_t               fRowBytes;
+    SkMask::Format       fFormat;
+};
+
+/** Generate the distance fields for several images, spreading the work across threads.
+ *  Returns false if any of them failed.
+ */
+bool SkGenerateDistanceFields(const SkDistanceFieldRequest requests[], int count,
+                              SkDistanceFieldMethod method = kApproximate_SkDistanceFieldMethod);
 
 /** Given width and height of original image, return size (in bytes) of distance field
  *  @param w                 Width of the original image.
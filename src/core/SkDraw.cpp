@@ -24,10 +24,13 @@
 #include "SkScan.h"
 #include "SkShader.h"
 #include "SkSmallAllocator.h"
+#include "SkTArray.h"
 #include "SkString.h"
 #include "SkStroke.h"
 #include "SkStrokeRec.h"
 #include "SkTemplates.h"
+#include "SkTextBlobRasterCache.h"
+#include "SkTextBlobRunIterator.h"
 #include "SkTextMapStateProc.h"
 #include "SkTLazy.h"
 #include "SkUtils.h"
@@ -1454,16 +1457,21 @@ public:
         , fPaint(paint)
         , fClipBounds(PickClipBounds(draw)) { }
 
+    // Whether the glyph, placed there, would touch the clip bounds, and so needs its image.
+    bool isVisible(const SkGlyph& glyph, SkPoint position, SkPoint rounding) const {
+        position += rounding;
+        if (!InDeviceSpace(position)) {
+            return false;
+        }
+        const int left = SkScalarFloorToInt(position.fX) + glyph.fLeft;
+        const int top  = SkScalarFloorToInt(position.fY) + glyph.fTop;
+        return SkIRect::Intersects(fClipBounds,
+                                   SkIRect::MakeXYWH(left, top, glyph.fWidth, glyph.fHeight));
+    }
+
     void operator()(const SkGlyph& glyph, SkPoint position, SkPoint rounding) {
         position += rounding;
-        // Prevent glyphs from being drawn outside of or straddling the edge of device space.
-        // Comparisons written a little weirdly so that NaN coordinates are treated safely.
-        auto gt = [](float a, int b) { return !(a <= (float)b); };
-        auto lt = [](float a, int b) { return !(a >= (float)b); };
-        if (gt(position.fX, INT_MAX - (INT16_MAX + UINT16_MAX)) ||
-            lt(position.fX, INT_MIN - (INT16_MIN + 0 /*UINT16_MIN*/)) ||
-            gt(position.fY, INT_MAX - (INT16_MAX + UINT16_MAX)) ||
-            lt(position.fY, INT_MIN - (INT16_MIN + 0 /*UINT16_MIN*/))) {
+        if (!InDeviceSpace(position)) {
             return;
         }
 
@@ -1510,6 +1518,17 @@ public:
     }
 
 private:
+    static bool InDeviceSpace(SkPoint position) {
+        // Prevent glyphs from being drawn outside of or straddling the edge of device space.
+        // Comparisons written a little weirdly so that NaN coordinates are treated safely.
+        auto gt = [](float a, int b) { return !(a <= (float)b); };
+        auto lt = [](float a, int b) { return !(a >= (float)b); };
+        return !(gt(position.fX, INT_MAX - (INT16_MAX + UINT16_MAX)) ||
+                 lt(position.fX, INT_MIN - (INT16_MIN + 0 /*UINT16_MIN*/)) ||
+                 gt(position.fY, INT_MAX - (INT16_MAX + UINT16_MAX)) ||
+                 lt(position.fY, INT_MIN - (INT16_MIN + 0 /*UINT16_MIN*/)));
+    }
+
     static bool UsingRegionToDraw(const SkRasterClip* rClip) {
         return rClip->isBW() && !rClip->isRect();
     }
@@ -1593,9 +1612,17 @@ void SkDraw::drawText(const char text[], size_t byteLength,
     SkAAClipBlitterWrapper wrapper(*fRC, blitterChooser.get());
     DrawOneGlyph           drawOneGlyph(*this, paint, cache.get(), wrapper.getBlitter());
 
+    // Place every glyph first, so that the images missing from the strike are made together.
+    SkFindAndPlaceGlyph::ImageBatch batch(cache.get());
     SkFindAndPlaceGlyph::ProcessText(
         paint.getTextEncoding(), text, byteLength,
-        {x, y}, *fMatrix, paint.getTextAlign(), cache.get(), drawOneGlyph);
+        {x, y}, *fMatrix, paint.getTextAlign(), cache.get(),
+        [&](const SkGlyph& glyph, SkPoint position, SkPoint rounding) {
+            if (drawOneGlyph.isVisible(glyph, position, rounding)) {
+                batch(glyph, position, rounding);
+            }
+        });
+    batch.flush(drawOneGlyph);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1674,9 +1701,118 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
     DrawOneGlyph           drawOneGlyph(*this, paint, cache.get(), wrapper.getBlitter());
     SkPaint::Align         textAlignment = paint.getTextAlign();
 
+    SkFindAndPlaceGlyph::ImageBatch batch(cache.get());
     SkFindAndPlaceGlyph::ProcessPosText(
         paint.getTextEncoding(), text, byteLength,
-        offset, *fMatrix, pos, scalarsPerPosition, textAlignment, cache.get(), drawOneGlyph);
+        offset, *fMatrix, pos, scalarsPerPosition, textAlignment, cache.get(),
+        [&](const SkGlyph& glyph, SkPoint position, SkPoint rounding) {
+            if (drawOneGlyph.isVisible(glyph, position, rounding)) {
+                batch(glyph, position, rounding);
+            }
+        });
+    batch.flush(drawOneGlyph);
+}
+
+void SkDraw::drawTextBlobRun(const SkTextBlob* blob, int runIndex,
+                             const SkTextBlobRunIterator& it, SkScalar x, SkScalar y,
+                             const SkPaint& paint) const {
+    SkDEBUGCODE(this->validate();)
+
+    const char* text = reinterpret_cast<const char*>(it.glyphs());
+    const size_t byteLength = it.glyphCount() * sizeof(uint16_t);
+    const SkPoint& runOffset = it.offset();
+    int scalarsPerPosition;
+    SkPoint offset;
+    switch (it.positioning()) {
+        case SkTextBlob::kDefault_Positioning:
+            scalarsPerPosition = 0;
+            offset.set(x + runOffset.x(), y + runOffset.y());
+            break;
+        case SkTextBlob::kHorizontal_Positioning:
+            scalarsPerPosition = 1;
+            offset.set(x, y + runOffset.y());
+            break;
+        default:
+            SkASSERT(SkTextBlob::kFull_Positioning == it.positioning());
+            scalarsPerPosition = 2;
+            offset.set(x, y);
+            break;
+    }
+
+    // Only glyph masks are placed here, and with perspective a move is more than a translation.
+    if (ShouldDrawTextAsPaths(paint, *fMatrix) || fMatrix->hasPerspective()) {
+        if (0 == scalarsPerPosition) {
+            this->drawText(text, byteLength, offset.x(), offset.y(), paint);
+        } else {
+            this->drawPosText(text, byteLength, it.pos(), scalarsPerPosition, offset, paint);
+        }
+        return;
+    }
+
+    // nothing to draw
+    if (fRC->isEmpty()) {
+        return;
+    }
+
+    SkAutoGlyphCache cache(paint, &fDevice->surfaceProps(), this->scalerContextFlags(), fMatrix);
+
+    // The Blitter Choose needs to be live while using the blitter below.
+    SkAutoBlitterChoose    blitterChooser(fDst, *fMatrix, paint);
+    SkAAClipBlitterWrapper wrapper(*fRC, blitterChooser.get());
+    DrawOneGlyph           drawOneGlyph(*this, paint, cache.get(), wrapper.getBlitter());
+    SkPaint::Align         textAlignment = paint.getTextAlign();
+
+    const SkPoint origin = fMatrix->mapXY(x, y);
+    const SkTextBlobRasterCache::Run* run;
+    SkAutoTUnref<SkCachedData> data(SkTextBlobRasterCache::FindAndRef(
+        blob, runIndex, *fMatrix, origin, textAlignment, cache->getDescriptor(),
+        cache->getGeneration(), &run));
+    if (data) {
+        // The glyphs land where they did before, moved by as many pixels as the blob was.
+        const SkVector delta = { SkScalarFloorToScalar(origin.fX) - run->fOrigin.fX,
+                                 SkScalarFloorToScalar(origin.fY) - run->fOrigin.fY };
+        if (!run->fBounds.makeOffset(delta.fX, delta.fY).intersects(
+                SkRect::Make(fRC->getBounds()))) {
+            return;
+        }
+        // The strike's generation matched, so its glyphs have not moved since they were placed.
+        const SkTextBlobRasterCache::Glyph* glyphs = run->glyphs();
+        for (int i = 0; i < run->fCount; ++i) {
+            drawOneGlyph(*glyphs[i].fGlyph, glyphs[i].fPosition + delta, {0, 0});
+        }
+        return;
+    }
+
+    SkSTArray<64, SkTextBlobRasterCache::Glyph, true> glyphs(it.glyphCount());
+    SkRect bounds = SkRect::MakeEmpty();
+    auto placeOneGlyph = [&](const SkGlyph& glyph, SkPoint position, SkPoint rounding) {
+        position += rounding;
+        glyphs.push_back({ position, &glyph });
+        bounds.join(SkRect::MakeXYWH(SkScalarFloorToScalar(position.fX) + glyph.fLeft,
+                                     SkScalarFloorToScalar(position.fY) + glyph.fTop,
+                                     glyph.fWidth, glyph.fHeight));
+        drawOneGlyph(glyph, position, {0, 0});
+    };
+
+    // Every glyph is placed, and its image made, before any is drawn. All of the run's glyphs
+    // are kept, so the images of those outside the clip are made too, for the redraws.
+    SkFindAndPlaceGlyph::ImageBatch batch(cache.get());
+    if (0 == scalarsPerPosition) {
+        SkFindAndPlaceGlyph::ProcessText(
+            paint.getTextEncoding(), text, byteLength,
+            offset, *fMatrix, textAlignment, cache.get(), batch);
+    } else {
+        SkFindAndPlaceGlyph::ProcessPosText(
+            paint.getTextEncoding(), text, byteLength,
+            offset, *fMatrix, it.pos(), scalarsPerPosition, textAlignment, cache.get(), batch);
+    }
+    // The batch hands over the glyphs as the strike holds them after the last was found, so the
+    // pointers kept are good for its current generation.
+    batch.flush(placeOneGlyph);
+
+    SkTextBlobRasterCache::Add(blob, runIndex, *fMatrix, origin, textAlignment,
+                               cache->getDescriptor(), cache->getGeneration(), bounds,
+                               glyphs.begin(), glyphs.count());
 }
 
 #if defined _WIN32
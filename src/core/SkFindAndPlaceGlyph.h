@@ -12,6 +12,7 @@
 #include "SkGlyph.h"
 #include "SkGlyphCache.h"
 #include "SkPaint.h"
+#include "SkTArray.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 #include <utility>
@@ -71,6 +72,12 @@ public:
         SkPaint::Align textAlignment,
         SkGlyphCache* cache, ProcessOneGlyph&& processOneGlyph);
 
+    // ImageBatch defers the glyphs placed by ProcessText or ProcessPosText so that the images
+    // they are missing can be made in one SkGlyphCache::findImages() call, rather than one
+    // findImage() at a time as each glyph is drawn. Pass it as processOneGlyph, then call
+    // flush() with the routine that uses the images.
+    class ImageBatch;
+
 private:
     // UntaggedVariant is a pile of memory that can hold one of the Ts. It provides a way
     // to initialize that memory in a typesafe way.
@@ -582,6 +589,56 @@ private:
     }
 };
 
+class SkFindAndPlaceGlyph::ImageBatch : SkNoncopyable {
+public:
+    explicit ImageBatch(SkGlyphCache* cache)
+        : fCache(cache)
+        , fGeneration(cache->getGeneration()) { }
+
+    void operator()(const SkGlyph& glyph, SkPoint position, SkPoint rounding) {
+        fGlyphs.push_back(&glyph);
+        fPlacements.push_back({ position, rounding, glyph.getGlyphID(),
+                                glyph.getSubXFixed(), glyph.getSubYFixed() });
+    }
+
+    // Make the missing images, then call processOneGlyph with each glyph, in the order they were
+    // placed. processOneGlyph must not look up glyphs that are not in the strike yet.
+    template<typename ProcessOneGlyph>
+    void flush(ProcessOneGlyph&& processOneGlyph) {
+        // Glyphs new to the strike may have moved those found before them. They are all in the
+        // strike now, so finding them again moves nothing.
+        if (fCache->getGeneration() != fGeneration) {
+            for (int i = 0; i < fGlyphs.count(); ++i) {
+                const Placement& placement = fPlacements[i];
+                fGlyphs[i] = &fCache->getGlyphIDMetrics(placement.fID, placement.fSubX,
+                                                        placement.fSubY);
+            }
+        }
+        fCache->findImages(fGlyphs.begin(), fGlyphs.count());
+        for (int i = 0; i < fGlyphs.count(); ++i) {
+            processOneGlyph(*fGlyphs[i], fPlacements[i].fPosition, fPlacements[i].fRounding);
+        }
+        fGlyphs.reset();
+        fPlacements.reset();
+        fGeneration = fCache->getGeneration();
+    }
+
+private:
+    struct Placement {
+        SkPoint  fPosition;
+        SkPoint  fRounding;
+        // What the glyph was found by, to find it again.
+        uint16_t fID;
+        SkFixed  fSubX;
+        SkFixed  fSubY;
+    };
+
+    SkGlyphCache* const                  fCache;
+    uint32_t                             fGeneration;
+    SkSTArray<64, const SkGlyph*, true>  fGlyphs;
+    SkSTArray<64, Placement, true>       fPlacements;
+};
+
 template<typename ProcessOneGlyph>
 inline void SkFindAndPlaceGlyph::ProcessPosText(
     SkPaint::TextEncoding textEncoding, const char text[], size_t byteLength,
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkFontRequestCache_DEFINED
+#define SkFontRequestCache_DEFINED
+
+#include "SkFontStyle.h"
+#include "SkResourceCache.h"
+#include "SkTypeface.h"
+
+/** Remembers which typeface a font manager returned for a request (family name, style and,
+ *  for fallback, languages and character), most recently used first, so that repeated requests
+ *  need not match again. Not thread safe; callers provide their own locking.
+ */
+class SkFontRequestCache {
+public:
+    /** The character of requests for a family and style alone. */
+    static const uint32_t kNoCharacter = 0xFFFFFFFF;
+
+    struct Request : public SkResourceCache::Key {
+    private:
+        Request(const char* name, const SkFontStyle& style, const char* bcp47[], int bcp47Count,
+                uint32_t character, size_t contentLen)
+            : fStyle(style)
+            , fCharacter(character)
+            , fHasFamily(name ? 1 : 0)
+        {
+            /** Pointer to just after the last field of this class. */
+            char* content = const_cast<char*>(SkTAfter<const char>(&this->fHasFamily));
+
+            // No holes.
+            SkASSERT(SkTAddOffset<char>(this, sizeof(SkResourceCache::Key) + keySize) == content);
+
+            // Has a size divisible by size of uint32_t.
+            SkASSERT((content - reinterpret_cast<char*>(this)) % sizeof(uint32_t) == 0);
+
+            // The family name and languages, each with its terminator, padded with zeros.
+            char* end = content;
+            if (name) {
+                end = append_string(end, name);
+            }
+            for (int i = 0; i < bcp47Count; ++i) {
+                end = append_string(end, bcp47[i]);
+            }
+            sk_bzero(end, content + contentLen - end);
+            this->init(nullptr, 0, keySize + contentLen);
+        }
+        static char* append_string(char* dst, const char* str) {
+            size_t len = strlen(str) + 1;
+            memcpy(dst, str, len);
+            return dst + len;
+        }
+        const SkFontStyle fStyle;
+        const uint32_t fCharacter;
+        const uint32_t fHasFamily;
+        /** The sum of the sizes of the fields of this class. */
+        static const size_t keySize = sizeof(fStyle) + sizeof(fCharacter) + sizeof(fHasFamily);
+
+    public:
+        /** @param character the character to find a font for, or kNoCharacter. */
+        static Request* Create(const char* name, const SkFontStyle& style,
+                               const char* bcp47[] = nullptr, int bcp47Count = 0,
+                               uint32_t character = kNoCharacter) {
+            size_t contentLen = name ? strlen(name) + 1 : 0;
+            for (int i = 0; i < bcp47Count; ++i) {
+                contentLen += strlen(bcp47[i]) + 1;
+            }
+            contentLen = SkAlign4(contentLen);
+            char* storage = new char[sizeof(Request) + contentLen];
+            return new (storage) Request(name, style, bcp47, bcp47Count, character, contentLen);
+        }
+        void operator delete(void* storage) {
+            delete[] reinterpret_cast<char*>(storage);
+        }
+    };
+
+private:
+    struct Result : public SkResourceCache::Rec {
+        Result(Request* request, SkTypeface* typeface)
+            : fRequest(request)
+            , fFace(SkSafeRef(typeface)) {}
+
+        const Key& getKey() const override { return *fRequest; }
+        size_t bytesUsed() const override { return fRequest->size() + sizeof(fFace); }
+        const char* getCategory() const override { return "request_cache"; }
+        SkDiscardableMemory* diagnostic_only_getDiscardable() const override { return nullptr; }
+
+        SkAutoTDelete<Request> fRequest;
+        sk_sp<SkTypeface> fFace;
+    };
+
+    SkResourceCache fCachedResults;
+
+public:
+    SkFontRequestCache(size_t maxSize) : fCachedResults(maxSize) {}
+
+    /** Takes ownership of request. It will be deleted when no longer needed.
+     *  The face may be nullptr, to remember that nothing matched. */
+    void add(SkTypeface* face, Request* request) {
+        fCachedResults.add(new Result(request, face));
+    }
+    /** Does not take ownership of request. Returns true if the request was found, in which case
+     *  face is set to a ref of the cached match, or to nullptr if nothing matched. */
+    bool find(const Request& request, sk_sp<SkTypeface>* face) {
+        return fCachedResults.find(request, [](const SkResourceCache::Rec& rec, void* ctx) {
+            const Result& result = static_cast<const Result&>(rec);
+            *static_cast<sk_sp<SkTypeface>*>(ctx) = result.fFace;
+            return true;
+        }, face);
+    }
+    void purgeAll() {
+        fCachedResults.purgeAll();
+    }
+};
+
+#endif
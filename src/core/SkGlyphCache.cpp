@@ -6,13 +6,16 @@
  */
 
 #include "SkGlyphCache.h"
+#include "SkAtomics.h"
 #include "SkGlyphCache_Globals.h"
 #include "SkGraphics.h"
 #include "SkOnce.h"
 #include "SkPath.h"
 #include "SkTemplates.h"
+#include "SkTSort.h"
 #include "SkTraceMemoryDump.h"
 #include "SkTypeface.h"
+#include "SkUtils.h"
 
 #include <cctype>
 
@@ -38,6 +41,11 @@ static SkGlyphCache_Globals& get_globals() {
 #define kMinGlyphImageSize  (16*2)
 #define kMinAllocAmount     ((sizeof(SkGlyph) + kMinGlyphImageSize) * kMinGlyphCount)
 
+static uint32_t next_generation() {
+    static int32_t gGeneration;
+    return sk_atomic_inc(&gGeneration) + 1;
+}
+
 SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkScalerContext* ctx)
     : fDesc(desc->copy())
     , fScalerContext(ctx)
@@ -47,15 +55,26 @@ SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkSca
     SkASSERT(ctx);
 
     fPrev = fNext = nullptr;
+    fGeneration = next_generation();
 
     fScalerContext->getFontMetrics(&fFontMetrics);
 
     fMemoryUsed = sizeof(*this);
 
     fAuxProcList = nullptr;
+
+    fBMPGlyphPages = nullptr;
+
+    fStrikeFile.reset(SkStrikeFile::Make(typeface, *desc, ctx->getEngineVersion()));
+    fStrikeDirty = false;
 }
 
 SkGlyphCache::~SkGlyphCache() {
+    if (fStrikeFile && fStrikeDirty) {
+        SkTDArray<const SkGlyph*> glyphs;
+        fGlyphMap.foreach([&glyphs](SkGlyph* g) { *glyphs.append() = g; });
+        fStrikeFile->write(glyphs);
+    }
     fGlyphMap.foreach ([](SkGlyph* g) {
         if (g->fPathData) {
             delete g->fPathData->fPath;
@@ -88,8 +107,42 @@ SkGlyphCache::CharGlyphRec* SkGlyphCache::getCharGlyphRec(PackedUnicharID packed
 #define VALIDATE()
 #endif
 
+inline uint16_t SkGlyphCache::bmpCharToGlyph(SkUnichar charCode) {
+    SkASSERT((uint32_t)charCode < kBMPCharCount);
+    if (fBMPGlyphPages) {
+        const uint16_t* page = fBMPGlyphPages[charCode >> kBMPPageBits];
+        if (page && page[charCode & kBMPPageMask] != kUnknownGlyphID) {
+            return page[charCode & kBMPPageMask];
+        }
+    }
+    return this->addBMPChar(charCode);
+}
+
+uint16_t SkGlyphCache::addBMPChar(SkUnichar charCode) {
+    if (nullptr == fBMPGlyphPages) {
+        size_t size = kBMPPageCount * sizeof(uint16_t*);
+        fBMPGlyphPages = (uint16_t**)fGlyphAlloc.allocThrow(size);
+        sk_bzero(fBMPGlyphPages, size);
+        fMemoryUsed += size;
+    }
+    uint16_t*& page = fBMPGlyphPages[charCode >> kBMPPageBits];
+    if (nullptr == page) {
+        size_t size = kBMPPageSize * sizeof(uint16_t);
+        page = (uint16_t*)fGlyphAlloc.allocThrow(size);
+        sk_memset16(page, kUnknownGlyphID, kBMPPageSize);
+        fMemoryUsed += size;
+    }
+    uint16_t glyphID = fScalerContext->charToGlyphID(charCode);
+    page[charCode & kBMPPageMask] = glyphID;
+    return glyphID;
+}
+
 uint16_t SkGlyphCache::unicharToGlyph(SkUnichar charCode) {
     VALIDATE();
+    if ((uint32_t)charCode < kBMPCharCount) {
+        return this->bmpCharToGlyph(charCode);
+    }
+
     PackedUnicharID packedUnicharID = SkGlyph::MakeID(charCode);
     const CharGlyphRec& rec = *this->getCharGlyphRec(packedUnicharID);
 
@@ -100,6 +153,18 @@ uint16_t SkGlyphCache::unicharToGlyph(SkUnichar charCode) {
     }
 }
 
+void SkGlyphCache::unicharsToGlyphs(const SkUnichar unichars[], int count, uint16_t glyphs[]) {
+    VALIDATE();
+    for (int i = 0; i < count; ++i) {
+        const SkUnichar charCode = unichars[i];
+        if ((uint32_t)charCode < kBMPCharCount) {
+            glyphs[i] = this->bmpCharToGlyph(charCode);
+        } else {
+            glyphs[i] = this->unicharToGlyph(charCode);
+        }
+    }
+}
+
 SkUnichar SkGlyphCache::glyphToUnichar(uint16_t glyphID) {
     return fScalerContext->glyphIDToChar(glyphID);
 }
@@ -171,7 +236,7 @@ SkGlyph* SkGlyphCache::lookupByPackedGlyphID(PackedGlyphID packedGlyphID, Metric
         glyph = this->allocateNewGlyph(packedGlyphID, type);
     } else {
         if (type == kFull_MetricsType && glyph->isJustAdvance()) {
-           fScalerContext->getMetrics(glyph);
+            this->getMetrics(glyph);
         }
     }
     return glyph;
@@ -184,33 +249,112 @@ SkGlyph* SkGlyphCache::allocateNewGlyph(PackedGlyphID packedGlyphID, MetricsType
     {
         SkGlyph glyph;
         glyph.initGlyphFromCombinedID(packedGlyphID);
+        const size_t tableSize = fGlyphMap.approxBytesUsed();
         glyphPtr = fGlyphMap.set(glyph);
+        if (fGlyphMap.approxBytesUsed() != tableSize) {
+            fGeneration = next_generation();
+        }
     }
 
-    if (kJustAdvance_MetricsType == mtype) {
+    if (fStrikeFile && fStrikeFile->findGlyph(glyphPtr)) {
+        // Stored glyphs always have full metrics.
+    } else if (kJustAdvance_MetricsType == mtype) {
         fScalerContext->getAdvance(glyphPtr);
     } else {
         SkASSERT(kFull_MetricsType == mtype);
-        fScalerContext->getMetrics(glyphPtr);
+        this->getMetrics(glyphPtr);
     }
 
     SkASSERT(glyphPtr->fID != SkGlyph::kImpossibleID);
     return glyphPtr;
 }
 
+void SkGlyphCache::getMetrics(SkGlyph* glyph) {
+    if (fStrikeFile) {
+        if (fStrikeFile->findGlyph(glyph)) {
+            return;
+        }
+        fStrikeDirty = true;
+    }
+    fScalerContext->getMetrics(glyph);
+}
+
+bool SkGlyphCache::findStoredImage(const SkGlyph& glyph) {
+    if (!fStrikeFile) {
+        return false;
+    }
+    // The image is only read, so it can be used straight from the file's mapping.
+    const_cast<SkGlyph&>(glyph).fImage = const_cast<void*>(fStrikeFile->findImage(glyph));
+    if (glyph.fImage) {
+        return true;
+    }
+    fStrikeDirty = true;
+    return false;
+}
+
+SkGlyphCache::ImagePages::~ImagePages() {
+    for (const Page& page : fPages) {
+        sk_free(page.fMemory);
+    }
+    for (void* image : fLargeImages) {
+        sk_free(image);
+    }
+}
+
+void* SkGlyphCache::ImagePages::alloc(size_t size) {
+    size = SkAlign8(size);
+    if (size > kPageSize) {
+        void* image = sk_malloc_flags(size, 0);
+        if (image) {
+            *fLargeImages.append() = image;
+        }
+        return image;
+    }
+
+    for (int i = SkTMax(0, fPages.count() - kOpenPages); i < fPages.count(); i++) {
+        Page& page = fPages[i];
+        if (kPageSize - page.fUsed >= size) {
+            void* image = page.fMemory + page.fUsed;
+            page.fUsed += size;
+            return image;
+        }
+    }
+
+    char* memory = static_cast<char*>(sk_malloc_flags(kPageSize, 0));
+    if (nullptr == memory) {
+        return nullptr;
+    }
+    *fPages.append() = { memory, size };
+    return memory;
+}
+
+bool SkGlyphCache::ImagePages::contains(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    for (const Page& page : fPages) {
+        if (p >= page.fMemory && p < page.fMemory + page.fUsed) {
+            return true;
+        }
+    }
+    for (const void* image : fLargeImages) {
+        if (p == image) {
+            return true;
+        }
+    }
+    return false;
+}
+
 const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
     if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth) {
-        if (nullptr == glyph.fImage) {
+        if (nullptr == glyph.fImage && !this->findStoredImage(glyph)) {
             size_t  size = glyph.computeImageSize();
-            const_cast<SkGlyph&>(glyph).fImage = fGlyphAlloc.alloc(size,
-                                        SkChunkAlloc::kReturnNil_AllocFailType);
+            const_cast<SkGlyph&>(glyph).fImage = fImagePages.alloc(size);
             // check that alloc() actually succeeded
             if (glyph.fImage) {
                 fScalerContext->getImage(glyph);
                 // TODO: the scaler may have changed the maskformat during
                 // getImage (e.g. from AA or LCD to BW) which means we may have
                 // overallocated the buffer. Check if the new computedImageSize
-                // is smaller, and if so, strink the alloc size in fImageAlloc.
+                // is smaller, and if so, strink the alloc size in fImagePages.
                 fMemoryUsed += size;
             }
         }
@@ -218,6 +362,46 @@ const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
     return glyph.fImage;
 }
 
+void SkGlyphCache::findImages(const SkGlyph* const glyphs[], int count) {
+    SkAutoSTArray<64, const SkGlyph*> missing(count);
+    int missingCount = 0;
+    for (int i = 0; i < count; i++) {
+        const SkGlyph& glyph = *glyphs[i];
+        if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth && nullptr == glyph.fImage &&
+            !this->findStoredImage(glyph)) {
+            missing[missingCount++] = &glyph;
+        }
+    }
+    if (0 == missingCount) {
+        return;
+    }
+
+    // Place the subpixel variants of a glyph next to each other in the image pages.
+    SkTQSort(missing.get(), missing.get() + missingCount - 1,
+             [](const SkGlyph* a, const SkGlyph* b) {
+                 return a->getGlyphID() != b->getGlyphID() ? a->getGlyphID() < b->getGlyphID()
+                                                           : a->fID < b->fID;
+             });
+
+    int allocatedCount = 0;
+    for (int i = 0; i < missingCount; i++) {
+        const SkGlyph& glyph = *missing[i];
+        if (i > 0 && missing[i - 1] == &glyph) {
+            continue;  // the same glyph was asked for twice
+        }
+        size_t  size = glyph.computeImageSize();
+        const_cast<SkGlyph&>(glyph).fImage = fImagePages.alloc(size);
+        // check that alloc() actually succeeded
+        if (glyph.fImage) {
+            missing[allocatedCount++] = &glyph;
+            fMemoryUsed += size;
+        }
+    }
+    if (allocatedCount > 0) {
+        fScalerContext->getImages(missing.get(), allocatedCount);
+    }
+}
+
 const SkPath* SkGlyphCache::findPath(const SkGlyph& glyph) {
     if (glyph.fWidth) {
         if (glyph.fPathData == nullptr) {
@@ -491,11 +675,16 @@ size_t SkGlyphCache_Globals::setCacheSizeLimit(size_t newLimit) {
         newLimit = minLimit;
     }
 
-    SkAutoExclusive ac(fLock);
+    size_t prevLimit;
+    SkGlyphCache* purged;
+    {
+        SkAutoExclusive ac(fLock);
 
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
-    this->internalPurge();
+        prevLimit = fCacheSizeLimit;
+        fCacheSizeLimit = newLimit;
+        purged = this->internalPurge();
+    }
+    DeletePurged(purged);
     return prevLimit;
 }
 
@@ -509,17 +698,26 @@ int SkGlyphCache_Globals::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoExclusive ac(fLock);
+    int prevCount;
+    SkGlyphCache* purged;
+    {
+        SkAutoExclusive ac(fLock);
 
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
-    this->internalPurge();
+        prevCount = fCacheCountLimit;
+        fCacheCountLimit = newCount;
+        purged = this->internalPurge();
+    }
+    DeletePurged(purged);
     return prevCount;
 }
 
 void SkGlyphCache_Globals::purgeAll() {
-    SkAutoExclusive ac(fLock);
-    this->internalPurge(fTotalMemoryUsed);
+    SkGlyphCache* purged;
+    {
+        SkAutoExclusive ac(fLock);
+        purged = this->internalPurge(fTotalMemoryUsed);
+    }
+    DeletePurged(purged);
 }
 
 /*  This guy calls the visitor from within the mutext lock, so the visitor
@@ -678,13 +876,25 @@ void SkGlyphCache::VisitAll(Visitor visitor, void* context) {
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkGlyphCache_Globals::attachCacheToHead(SkGlyphCache* cache) {
-    SkAutoExclusive ac(fLock);
+    SkGlyphCache* purged;
+    {
+        SkAutoExclusive ac(fLock);
 
-    this->validate();
-    cache->validate();
+        this->validate();
+        cache->validate();
 
-    this->internalAttachCacheToHead(cache);
-    this->internalPurge();
+        this->internalAttachCacheToHead(cache);
+        purged = this->internalPurge();
+    }
+    DeletePurged(purged);
+}
+
+void SkGlyphCache_Globals::DeletePurged(SkGlyphCache* cache) {
+    while (cache) {
+        SkGlyphCache* next = cache->fNext;
+        delete cache;
+        cache = next;
+    }
 }
 
 SkGlyphCache* SkGlyphCache_Globals::internalGetTail() const {
@@ -697,7 +907,7 @@ SkGlyphCache* SkGlyphCache_Globals::internalGetTail() const {
     return cache;
 }
 
-size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
+SkGlyphCache* SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
     this->validate();
 
     size_t bytesNeeded = 0;
@@ -719,11 +929,12 @@ size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
 
     // early exit
     if (!countNeeded && !bytesNeeded) {
-        return 0;
+        return nullptr;
     }
 
     size_t  bytesFreed = 0;
     int     countFreed = 0;
+    SkGlyphCache* purged = nullptr;
 
     // we start at the tail and proceed backwards, as the linklist is in LRU
     // order, with unimportant entries at the tail.
@@ -735,7 +946,8 @@ size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
         countFreed += 1;
 
         this->internalDetachCache(cache);
-        delete cache;
+        cache->fNext = purged;
+        purged = cache;
         cache = prev;
     }
 
@@ -748,7 +960,7 @@ size_t SkGlyphCache_Globals::internalPurge(size_t minBytesNeeded) {
     }
 #endif
 
-    return bytesFreed;
+    return purged;
 }
 
 void SkGlyphCache_Globals::internalAttachCacheToHead(SkGlyphCache* cache) {
@@ -790,7 +1002,7 @@ void SkGlyphCache::validate() const {
         const SkGlyph* glyph = &fGlyphArray[i];
         SkASSERT(glyph);
         if (glyph->fImage) {
-            SkASSERT(fGlyphAlloc.contains(glyph->fImage));
+            SkASSERT(fImagePages.contains(glyph->fImage));
         }
     }
 #endif
@@ -844,6 +1056,10 @@ int SkGraphics::GetFontCacheCountUsed() {
     return get_globals().getCacheCountUsed();
 }
 
+void SkGraphics::SetFontCacheDirectory(const char* dir) {
+    SkStrikeFile::SetDirectory(dir);
+}
+
 void SkGraphics::PurgeFontCache() {
     get_globals().purgeAll();
     SkTypefaceCache::PurgeAll();
@@ -14,6 +14,7 @@
 #include "SkPaint.h"
 #include "SkTHash.h"
 #include "SkScalerContext.h"
+#include "SkStrikeFile.h"
 #include "SkTemplates.h"
 #include "SkTDArray.h"
 
@@ -61,6 +62,11 @@ public:
     */
     uint16_t unicharToGlyph(SkUnichar);
 
+    /** Return the glyphIDs for count Unichars. Chars in the Basic Multilingual Plane are found in a
+        table indexed by the char, so this is much faster than calling unicharToGlyph() on each.
+    */
+    void unicharsToGlyphs(const SkUnichar unichars[], int count, uint16_t glyphs[]);
+
     /** Map the glyph to its Unicode equivalent. Unmappable glyphs map to a character code of zero.
     */
     SkUnichar glyphToUnichar(uint16_t);
@@ -72,11 +78,22 @@ public:
     /** Return the number of glyphs currently cached. */
     int countCachedGlyphs() const;
 
+    /** Return an ID that changes whenever SkGlyph pointers returned earlier by this cache may
+        have become invalid (adding a glyph can move the others). No two caches share an ID, so
+        a pointer remembered along with the ID is still good if the ID still matches.
+    */
+    uint32_t getGeneration() const { return fGeneration; }
+
     /** Return the image associated with the glyph. If it has not been generated this will
         trigger that.
     */
     const void* findImage(const SkGlyph&);
 
+    /** Generate the images of all of these glyphs that do not have one yet, in one batch.
+        Faster than calling findImage() on each when many are missing, e.g. for a new strike.
+    */
+    void findImages(const SkGlyph* const glyphs[], int count);
+
     /** If the advance axis intersects the glyph's path, append the positions scaled and offset
         to the array (if non-null), and set the count to the updated array length.
     */
@@ -200,6 +217,45 @@ private:
         kHashMask           = kHashCount - 1
     };
 
+    enum {
+        kBMPCharCount       = 0x10000,
+        kBMPPageBits        = 8,
+        kBMPPageSize        = 1 << kBMPPageBits,
+        kBMPPageMask        = kBMPPageSize - 1,
+        kBMPPageCount       = kBMPCharCount >> kBMPPageBits,
+        // No font has this many glyphs, so it marks a char that has not been looked up yet.
+        kUnknownGlyphID     = 0xFFFF
+    };
+
+    // Holds a strike's glyph images in pages of kPageSize bytes, apart from the glyphs and their
+    // paths. A mask goes in the first of the last few pages that has room for it, so masks fill
+    // the gaps left at the ends of pages before new pages are started. Masks too big for a page
+    // get an allocation of their own. Every mask stays put until the strike is deleted.
+    class ImagePages : SkNoncopyable {
+    public:
+        enum {
+            kPageSize  = 4096,
+            // How many of the most recent pages are tried before starting a new one.
+            kOpenPages = 4
+        };
+
+        ~ImagePages();
+
+        // Returns nullptr if memory runs out.
+        void* alloc(size_t size);
+
+        bool contains(const void* ptr) const;
+
+    private:
+        struct Page {
+            char*  fMemory;
+            size_t fUsed;
+        };
+
+        SkTDArray<Page>  fPages;
+        SkTDArray<void*> fLargeImages;
+    };
+
     typedef uint32_t PackedGlyphID;    // glyph-index + subpixel-pos
     typedef uint32_t PackedUnicharID;  // unichar + subpixel-pos
 
@@ -231,11 +287,21 @@ private:
     // using type.
     SkGlyph* allocateNewGlyph(PackedGlyphID packedGlyphID, MetricsType type);
 
+    // Fill in the full metrics for glyph, from the strike file if it has them.
+    void getMetrics(SkGlyph* glyph);
+
+    // Set glyph's image to the one in the strike file, if there is one.
+    bool findStoredImage(const SkGlyph& glyph);
+
     static bool DetachProc(const SkGlyphCache*, void*) { return true; }
 
     // The id arg is a combined id generated by MakeID.
     CharGlyphRec* getCharGlyphRec(PackedUnicharID id);
 
+    // Return the glyphID of a char in the Basic Multilingual Plane, from fBMPGlyphPages.
+    uint16_t bmpCharToGlyph(SkUnichar);
+    uint16_t addBMPChar(SkUnichar);
+
     void invokeAndRemoveAuxProcs();
 
     inline static SkGlyphCache* FindTail(SkGlyphCache* head);
@@ -262,15 +328,27 @@ private:
 
     // Map from a combined GlyphID and sub-pixel position to a SkGlyph.
     SkTHashTable<SkGlyph, PackedGlyphID, SkGlyph::HashTraits> fGlyphMap;
+    // Changed each time fGlyphMap grows, and with it the address of every glyph.
+    uint32_t               fGeneration;
 
     SkChunkAlloc           fGlyphAlloc;
+    ImagePages             fImagePages;
 
     SkAutoTArray<CharGlyphRec> fPackedUnicharIDToPackedGlyphID;
 
+    // The glyphIDs of the Basic Multilingual Plane, in pages of kBMPPageSize chars allocated from
+    // fGlyphAlloc when one of their chars is first looked up. Null until then.
+    uint16_t**             fBMPGlyphPages;
+
     // used to track (approx) how much ram is tied-up in this cache
     size_t                 fMemoryUsed;
 
     AuxProcRec*            fAuxProcList;
+
+    // The on-disk copy of this strike, if there is a font cache directory. fStrikeDirty is set
+    // when the scaler produces anything the file does not have.
+    SkAutoTDelete<SkStrikeFile> fStrikeFile;
+    bool                   fStrikeDirty;
 };
 
 class SkAutoGlyphCache : public std::unique_ptr<SkGlyphCache, SkGlyphCache::AttachCacheFunctor> {
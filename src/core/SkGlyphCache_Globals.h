@@ -80,8 +80,11 @@ private:
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
     // and attempt to purge caches to match.
-    // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0);
+    // Returns the detached caches, linked through fNext, for DeletePurged().
+    SkGlyphCache* internalPurge(size_t minBytesNeeded = 0);
+
+    // Deleting a cache may write its strike file, so this is called after fLock is released.
+    static void DeletePurged(SkGlyphCache*);
 };
 
 #endif
@@ -8,6 +8,7 @@
 
 #include "SkGraphics.h"
 
+#include "SkBitmapCache.h"
 #include "SkBlitter.h"
 #include "SkCanvas.h"
 #include "SkCpu.h"
@@ -78,12 +79,20 @@ void SkGraphics::PurgeAllCaches() {
 static const char kFontCacheLimitStr[] = "font-cache-limit";
 static const size_t kFontCacheLimitLen = sizeof(kFontCacheLimitStr) - 1;
 
+static const char kMipMapAsyncBuildStr[] = "mipmap-async-build";
+static const size_t kMipMapAsyncBuildLen = sizeof(kMipMapAsyncBuildStr) - 1;
+
+static size_t set_mipmap_async_build(size_t enabled) {
+    return SkMipMapCache::SetAsyncBuild(enabled != 0);
+}
+
 static const struct {
     const char* fStr;
     size_t fLen;
     size_t (*fFunc)(size_t);
 } gFlags[] = {
-    { kFontCacheLimitStr, kFontCacheLimitLen, SkGraphics::SetFontCacheLimit }
+    { kFontCacheLimitStr, kFontCacheLimitLen, SkGraphics::SetFontCacheLimit },
+    { kMipMapAsyncBuildStr, kMipMapAsyncBuildLen, set_mipmap_async_build },
 };
 
 /* flags are of the form param; or param=value; */
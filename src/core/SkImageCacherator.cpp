@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "SkAtomics.h"
 #include "SkBitmap.h"
 #include "SkBitmapCache.h"
 #include "SkImage_Base.h"
@@ -13,6 +14,8 @@
 #include "SkNextID.h"
 #include "SkPixelRef.h"
 #include "SkResourceCache.h"
+#include "SkYUVPlanesCache.h"
+#include "SkYUVToRGBA.h"
 
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -98,6 +101,9 @@ bool SkImageCacherator::generateBitmap(SkBitmap* bitmap) {
     const SkImageInfo& genInfo = generator->getInfo();
     if (fInfo.dimensions() == genInfo.dimensions()) {
         SkASSERT(fOrigin.x() == 0 && fOrigin.y() == 0);
+        if (this->generateFromCachedYUV(bitmap, generator->uniqueID(), allocator)) {
+            return true;
+        }
         // fast-case, no copy needed
         return generator->tryGenerateBitmap(bitmap, fInfo, allocator);
     } else {
@@ -116,6 +122,37 @@ bool SkImageCacherator::generateBitmap(SkBitmap* bitmap) {
     }
 }
 
+bool SkImageCacherator::generateFromCachedYUV(SkBitmap* bitmap, uint32_t genID,
+                                              SkBitmap::Allocator* allocator) {
+    // Only opaque N32 output can come straight from YUV.  SkYUVToRGBA() repeats the decoder's
+    // own upsampling and math, so this is the same bitmap a decode would make, and it declines
+    // any planes it cannot convert that way.
+    if (kN32_SkColorType != fInfo.colorType() || kOpaque_SkAlphaType != fInfo.alphaType()) {
+        return false;
+    }
+
+    SkYUVPlanesCache::Info yuvInfo;
+    SkAutoTUnref<SkCachedData> data(SkYUVPlanesCache::FindAndRef(genID, &yuvInfo));
+    if (!data || !bitmap->setInfo(fInfo) || !bitmap->tryAllocPixels(allocator, nullptr)) {
+        bitmap->reset();
+        return false;
+    }
+
+    const void* planes[3];
+    planes[0] = data->data();
+    planes[1] = (const uint8_t*)planes[0] + (yuvInfo.fSizeInfo.fWidthBytes[SkYUVSizeInfo::kY] *
+                                             yuvInfo.fSizeInfo.fSizes[SkYUVSizeInfo::kY].fHeight);
+    planes[2] = (const uint8_t*)planes[1] + (yuvInfo.fSizeInfo.fWidthBytes[SkYUVSizeInfo::kU] *
+                                             yuvInfo.fSizeInfo.fSizes[SkYUVSizeInfo::kU].fHeight);
+    SkPixmap pixmap;
+    if (!bitmap->peekPixels(&pixmap) ||
+            !SkYUVToRGBA(yuvInfo.fSizeInfo, planes, yuvInfo.fColorSpace, pixmap)) {
+        bitmap->reset();
+        return false;
+    }
+    return true;
+}
+
 bool SkImageCacherator::directGeneratePixels(const SkImageInfo& info, void* pixels, size_t rb,
                                              int srcX, int srcY) {
     ScopedGenerator generator(this);
@@ -133,21 +170,59 @@ bool SkImageCacherator::lockAsBitmapOnlyIfAlreadyCached(SkBitmap* bitmap) {
     return SkBitmapCache::Find(fUniqueID, bitmap) && check_output_bitmap(*bitmap, fUniqueID);
 }
 
+static SkAtomic<int32_t> gPrefetched(0),
+                         gAlreadyCached(0),
+                         gHits(0),
+                         gMisses(0);
+
+SkImageCacherator::Stats SkImageCacherator::GetStats() {
+    return { gPrefetched.load(), gAlreadyCached.load(), gHits.load(), gMisses.load() };
+}
+
+void SkImageCacherator::ResetStats() {
+    gPrefetched.store(0);
+    gAlreadyCached.store(0);
+    gHits.store(0);
+    gMisses.store(0);
+}
+
+void SkImageCacherator::addToCache(const SkBitmap& bitmap, const SkImage* client) {
+    SkBitmapCache::Add(fUniqueID, bitmap);
+    if (client) {
+        as_IB(client)->notifyAddedToCache();
+    }
+}
+
+bool SkImageCacherator::prefetch(const SkImage* client) {
+    SkBitmap bitmap;
+    if (this->lockAsBitmapOnlyIfAlreadyCached(&bitmap)) {
+        gAlreadyCached.fetch_add(1);
+        return true;
+    }
+    if (!this->generateBitmap(&bitmap)) {
+        return false;
+    }
+
+    bitmap.pixelRef()->setImmutableWithID(fUniqueID);
+    this->addToCache(bitmap, client);
+    gPrefetched.fetch_add(1);
+    return true;
+}
+
 bool SkImageCacherator::tryLockAsBitmap(SkBitmap* bitmap, const SkImage* client,
                                         SkImage::CachingHint chint) {
     if (this->lockAsBitmapOnlyIfAlreadyCached(bitmap)) {
+        gHits.fetch_add(1);
         return true;
     }
+    gMisses.fetch_add(1);
     if (!this->generateBitmap(bitmap)) {
         return false;
     }
 
     bitmap->pixelRef()->setImmutableWithID(fUniqueID);
     if (SkImage::kAllow_CachingHint == chint) {
-        SkBitmapCache::Add(fUniqueID, *bitmap);
-        if (client) {
-            as_IB(client)->notifyAddedToCache();
-        }
+        this->addToCache(*bitmap, client);
     }
     return true;
 }
@@ -187,10 +262,7 @@ bool SkImageCacherator::lockAsBitmap(SkBitmap* bitmap, const SkImage* client,
 
     bitmap->pixelRef()->setImmutableWithID(fUniqueID);
     if (SkImage::kAllow_CachingHint == chint) {
-        SkBitmapCache::Add(fUniqueID, *bitmap);
-        if (client) {
-            as_IB(client)->notifyAddedToCache();
-        }
+        this->addToCache(*bitmap, client);
     }
     return check_output_bitmap(*bitmap, fUniqueID);
 #else
@@ -198,6 +270,55 @@ bool SkImageCacherator::lockAsBitmap(SkBitmap* bitmap, const SkImage* client,
 #endif
 }
 
+bool SkImageCacherator::lockAsScaledBitmap(SkBitmap* bitmap, SkScalar scale,
+                                           const SkImage* client) {
+    if (!(scale > 0 && scale < 1) || kIndex_8_SkColorType == fInfo.colorType()) {
+        return false;
+    }
+    if (SkBitmapCache::Find(fUniqueID, bitmap)) {
+        bitmap->reset();
+        return false;
+    }
+
+    ScopedGenerator generator(this);
+    // Subsets would need to be mapped into the scaled space; only scale whole images.
+    if (fInfo.dimensions() != generator->getInfo().dimensions()) {
+        return false;
+    }
+    SkImageGenerator::SupportedSizes sizes;
+    if (!generator->computeScaledDimensions(scale, &sizes)) {
+        return false;
+    }
+    const SkISize& size = sizes.fSizes[0];
+    if (size.width() >= fInfo.width() && size.height() >= fInfo.height()) {
+        return false;
+    }
+
+    SkBitmapCacheDesc desc;
+    desc.fImageID = fUniqueID;
+    desc.fWidth = size.width();
+    desc.fHeight = size.height();
+    desc.fBounds = SkIRect::MakeWH(fInfo.width(), fInfo.height());
+    if (SkBitmapCache::FindWH(desc, bitmap)) {
+        return true;
+    }
+
+    SkPixmap pixmap;
+    if (!bitmap->setInfo(fInfo.makeWH(size.width(), size.height())) ||
+            !bitmap->tryAllocPixels(SkResourceCache::GetAllocator(), nullptr) ||
+            !bitmap->peekPixels(&pixmap) || !generator->generateScaledPixels(pixmap)) {
+        bitmap->reset();
+        return false;
+    }
+
+    bitmap->setImmutable();
+    SkBitmapCache::AddWH(desc, *bitmap);
+    if (client) {
+        as_IB(client)->notifyAddedToCache();
+    }
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
 #if SK_SUPPORT_GPU
@@ -39,6 +39,17 @@ public:
     bool lockAsBitmap(SkBitmap*, const SkImage* client,
                       SkImage::CachingHint = SkImage::kAllow_CachingHint);
 
+    /**
+     *  For drawing the image scaled down by scale (0 < scale < 1).  If the generator can decode
+     *  directly to a smaller size that is still at least scale times our dimensions, this
+     *  returns true and sets bitmap to that smaller decode.  Scaled decodes are cached
+     *  separately from the full-size one.
+     *
+     *  Returns false if the full-size bitmap is already cached (it is cheaper to scale that),
+     *  or if the generator cannot scale; the caller should then use lockAsBitmap().
+     */
+    bool lockAsScaledBitmap(SkBitmap*, SkScalar scale, const SkImage* client);
+
     /**
      *  Returns a ref() on the texture produced by this generator. The caller must call unref()
      *  when it is done. Will return nullptr on failure.
@@ -61,6 +72,28 @@ public:
      */
     SkData* refEncoded(GrContext*);
 
+    /**
+     *  Decodes into SkBitmapCache ahead of time, so a later lockAsBitmap() finds the result
+     *  there rather than decoding on the drawing thread.  Safe to call from any thread.
+     *
+     *  If not NULL, the client will be notified (->notifyAddedToCache()) when resources are
+     *  added to the cache on its behalf.
+     */
+    bool prefetch(const SkImage* client);
+
+    /**
+     *  Process-wide counts of how raster locks were satisfied, to judge whether prefetching
+     *  is keeping decodes off the drawing threads.
+     */
+    struct Stats {
+        int32_t fPrefetched;    // Decoded by prefetch().
+        int32_t fAlreadyCached; // prefetch() calls that found the bitmap already cached.
+        int32_t fHits;          // Locks that found the bitmap already cached.
+        int32_t fMisses;        // Locks that had to decode synchronously.
+    };
+    static Stats GetStats();
+    static void ResetStats();
+
     // Only return true if the generate has already been cached.
     bool lockAsBitmapOnlyIfAlreadyCached(SkBitmap*);
     // Call the underlying generator directly
@@ -71,7 +104,11 @@ private:
     SkImageCacherator(SkImageGenerator*, const SkImageInfo&, const SkIPoint&, uint32_t uniqueID);
 
     bool generateBitmap(SkBitmap*);
+    // If the generator's YUV planes are already cached (e.g. from uploading them to the GPU),
+    // converts them rather than decoding again.
+    bool generateFromCachedYUV(SkBitmap*, uint32_t genID, SkBitmap::Allocator*);
     bool tryLockAsBitmap(SkBitmap*, const SkImage*, SkImage::CachingHint);
+    void addToCache(const SkBitmap&, const SkImage* client);
 #if SK_SUPPORT_GPU
     // Returns the texture. If the cacherator is generating the texture and wants to cache it,
     // it should use the passed in key (if the key is valid).
@@ -12,6 +12,7 @@
 #include "SkMathPriv.h"
 #include "SkNx.h"
 #include "SkPM4fPriv.h"
+#include "SkTaskGroup.h"
 #include "SkTypes.h"
 
 //
@@ -92,6 +93,72 @@ struct ColorTypeFilter_F16 {
     }
 };
 
+//
+// WideFilter is the "Type" we pass to the wide downsample template functions, which filter several
+// dst pixels per step.  Load() expands 2N src pixels, split into the even and odd ones so that
+// each lines up with its horizontal neighbor, and Store() compacts N filtered pixels.  Each
+// produces exactly what its ColorTypeFilter would one pixel at a time.
+//
+
+struct WideFilter_565 {
+    typedef ColorTypeFilter_565 Filter;
+    typedef uint16_t Type;
+    typedef Sk4i Wide;
+    static const int N = 4;
+
+    // Each pair of pixels loads as one 32-bit lane, the even one in the low half.  Then each is
+    // spread out as in ColorTypeFilter_565.
+    static Sk4i Expand(const Sk4i& x) {
+        return (x & ~SK_G16_MASK_IN_PLACE) | ((x & SK_G16_MASK_IN_PLACE) << 16);
+    }
+    static void Load(const uint16_t* p, Sk4i* even, Sk4i* odd) {
+        Sk4i x = Sk4i::Load(p);
+        *even = Expand(x & 0xFFFF);
+        *odd  = Expand((x >> 16) & 0xFFFF);
+    }
+    static void Store(uint16_t* d, const Sk4i& x) {
+        SkNx_cast<uint16_t>((x & ~SK_G16_MASK_IN_PLACE) | ((x >> 16) & SK_G16_MASK_IN_PLACE))
+            .store(d);
+    }
+};
+
+struct WideFilter_4444 {
+    typedef ColorTypeFilter_4444 Filter;
+    typedef uint16_t Type;
+    // Four nibbles summed over a 3x3 filter need all 32 bits of a lane, so each pixel takes two:
+    // nibbles 0 and 2 in fLo, 1 and 3 in fHi, each with a byte to itself.
+    typedef SkNx<8, int> Wide;
+    static const int N = 4;
+
+    static void Load(const uint16_t* p, Wide* even, Wide* odd) {
+        Sk4i x  = Sk4i::Load(p),
+             lo = x & 0x0F0F0F0F,
+             hi = (x >> 4) & 0x0F0F0F0F;
+        *even = Wide(lo & 0xFFFF, hi & 0xFFFF);
+        *odd  = Wide(lo >> 16, hi >> 16);
+    }
+    static void Store(uint16_t* d, const Wide& x) {
+        SkNx_cast<uint16_t>((x.fLo & 0x0F0F) | ((x.fHi & 0x0F0F) << 4)).store(d);
+    }
+};
+
+struct WideFilter_8 {
+    typedef ColorTypeFilter_8 Filter;
+    typedef uint8_t Type;
+    typedef Sk16h Wide;
+    static const int N = 16;
+
+    // Each pair of pixels loads widened into one 16-bit lane, the even one in the low byte.
+    static void Load(const uint8_t* p, Sk16h* even, Sk16h* odd) {
+        Sk16h x = Sk16h::Load(p);
+        *even = x & 0xFF;
+        *odd  = x >> 8;
+    }
+    static void Store(uint8_t* d, const Sk16h& x) {
+        SkNx_cast<uint8_t>(x).store(d);
+    }
+};
+
 template <typename T> T add_121(const T& a, const T& b, const T& c) {
     return a + b + b + c;
 }
@@ -291,6 +358,159 @@ template <typename F> void downsample_3_3(void* dst, const void* src, size_t src
     }
 }
 
+//
+//  The wide versions filter N dst pixels per step with a WideFilter, and finish the row with the
+//  one-at-a-time versions above.  (1x2 and 1x3 only ever produce one pixel per row.)  Those with
+//  three columns also read the even pixels one pair over, so they stop a step short of the end.
+//
+
+template <typename W> void downsample_2_1_wide(void* dst, const void* src, size_t srcRB,
+                                               int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const typename W::Type*>(src);
+    auto d = static_cast<typename W::Type*>(dst);
+
+    int i = 0;
+    for (; i + W::N <= count; i += W::N) {
+        typename W::Wide c00, c01;
+        W::Load(p0, &c00, &c01);
+
+        auto c = c00 + c01;
+        W::Store(d, shift_right(c, 1));
+        p0 += 2 * W::N;
+        d += W::N;
+    }
+    if (i < count) {
+        downsample_2_1<typename W::Filter>(d, p0, srcRB, count - i);
+    }
+}
+
+template <typename W> void downsample_2_2_wide(void* dst, const void* src, size_t srcRB,
+                                               int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const typename W::Type*>(src);
+    auto p1 = (const typename W::Type*)((const char*)p0 + srcRB);
+    auto d = static_cast<typename W::Type*>(dst);
+
+    int i = 0;
+    for (; i + W::N <= count; i += W::N) {
+        typename W::Wide c00, c01, c10, c11;
+        W::Load(p0, &c00, &c01);
+        W::Load(p1, &c10, &c11);
+
+        auto c = c00 + c10 + c01 + c11;
+        W::Store(d, shift_right(c, 2));
+        p0 += 2 * W::N;
+        p1 += 2 * W::N;
+        d += W::N;
+    }
+    if (i < count) {
+        downsample_2_2<typename W::Filter>(d, p0, srcRB, count - i);
+    }
+}
+
+template <typename W> void downsample_2_3_wide(void* dst, const void* src, size_t srcRB,
+                                               int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const typename W::Type*>(src);
+    auto p1 = (const typename W::Type*)((const char*)p0 + srcRB);
+    auto p2 = (const typename W::Type*)((const char*)p1 + srcRB);
+    auto d = static_cast<typename W::Type*>(dst);
+
+    int i = 0;
+    for (; i + W::N <= count; i += W::N) {
+        typename W::Wide c00, c01, c10, c11, c20, c21;
+        W::Load(p0, &c00, &c01);
+        W::Load(p1, &c10, &c11);
+        W::Load(p2, &c20, &c21);
+
+        auto c = add_121(c00, c10, c20) + add_121(c01, c11, c21);
+        W::Store(d, shift_right(c, 3));
+        p0 += 2 * W::N;
+        p1 += 2 * W::N;
+        p2 += 2 * W::N;
+        d += W::N;
+    }
+    if (i < count) {
+        downsample_2_3<typename W::Filter>(d, p0, srcRB, count - i);
+    }
+}
+
+template <typename W> void downsample_3_1_wide(void* dst, const void* src, size_t srcRB,
+                                               int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const typename W::Type*>(src);
+    auto d = static_cast<typename W::Type*>(dst);
+
+    int i = 0;
+    for (; i + W::N < count; i += W::N) {
+        typename W::Wide c00, c01, c02, unused;
+        W::Load(p0, &c00, &c01);
+        W::Load(p0 + 2, &c02, &unused);
+
+        auto c = add_121(c00, c01, c02);
+        W::Store(d, shift_right(c, 2));
+        p0 += 2 * W::N;
+        d += W::N;
+    }
+    downsample_3_1<typename W::Filter>(d, p0, srcRB, count - i);
+}
+
+template <typename W> void downsample_3_2_wide(void* dst, const void* src, size_t srcRB,
+                                               int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const typename W::Type*>(src);
+    auto p1 = (const typename W::Type*)((const char*)p0 + srcRB);
+    auto d = static_cast<typename W::Type*>(dst);
+
+    int i = 0;
+    for (; i + W::N < count; i += W::N) {
+        typename W::Wide c00, c01, c02, c10, c11, c12, unused;
+        W::Load(p0, &c00, &c01);
+        W::Load(p0 + 2, &c02, &unused);
+        W::Load(p1, &c10, &c11);
+        W::Load(p1 + 2, &c12, &unused);
+
+        auto c = add_121(c00, c01, c02) + add_121(c10, c11, c12);
+        W::Store(d, shift_right(c, 3));
+        p0 += 2 * W::N;
+        p1 += 2 * W::N;
+        d += W::N;
+    }
+    downsample_3_2<typename W::Filter>(d, p0, srcRB, count - i);
+}
+
+template <typename W> void downsample_3_3_wide(void* dst, const void* src, size_t srcRB,
+                                               int count) {
+    SkASSERT(count > 0);
+    auto p0 = static_cast<const typename W::Type*>(src);
+    auto p1 = (const typename W::Type*)((const char*)p0 + srcRB);
+    auto p2 = (const typename W::Type*)((const char*)p1 + srcRB);
+    auto d = static_cast<typename W::Type*>(dst);
+
+    int i = 0;
+    for (; i + W::N < count; i += W::N) {
+        typename W::Wide c00, c01, c02, c10, c11, c12, c20, c21, c22, unused;
+        W::Load(p0, &c00, &c01);
+        W::Load(p0 + 2, &c02, &unused);
+        W::Load(p1, &c10, &c11);
+        W::Load(p1 + 2, &c12, &unused);
+        W::Load(p2, &c20, &c21);
+        W::Load(p2 + 2, &c22, &unused);
+
+        auto c =
+            add_121(c00, c01, c02) +
+            shift_left(add_121(c10, c11, c12), 1) +
+            add_121(c20, c21, c22);
+        W::Store(d, shift_right(c, 4));
+        p0 += 2 * W::N;
+        p1 += 2 * W::N;
+        p2 += 2 * W::N;
+        d += W::N;
+    }
+    downsample_3_3<typename W::Filter>(d, p0, srcRB, count - i);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 size_t SkMipMap::AllocLevelsSize(int levelCount, size_t pixelSize) {
@@ -304,6 +524,12 @@ size_t SkMipMap::AllocLevelsSize(int levelCount, size_t pixelSize) {
     return sk_64_asS32(size);
 }
 
+// Below this many dst pixels it is cheaper to filter the first level on the calling thread than to
+// hand it out to SkTaskGroup.
+static const int64_t kParallelMinPixels = 256 * 256;
+static const int kMinRowsPerBand = 32;
+static const int kMaxParallelBands = 16;
+
 SkMipMap* SkMipMap::Build(const SkPixmap& src, SkSourceGammaTreatment treatment,
                           SkDiscardableFactoryProc fact) {
     typedef void FilterProc(void*, const void* srcPtr, size_t srcRB, int count);
@@ -348,33 +574,33 @@ SkMipMap* SkMipMap::Build(const SkPixmap& src, SkSourceGammaTreatment treatment,
         case kRGB_565_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_565>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_565>;
-            proc_2_1 = downsample_2_1<ColorTypeFilter_565>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_565>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_565>;
-            proc_3_1 = downsample_3_1<ColorTypeFilter_565>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_565>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_565>;
+            proc_2_1 = downsample_2_1_wide<WideFilter_565>;
+            proc_2_2 = downsample_2_2_wide<WideFilter_565>;
+            proc_2_3 = downsample_2_3_wide<WideFilter_565>;
+            proc_3_1 = downsample_3_1_wide<WideFilter_565>;
+            proc_3_2 = downsample_3_2_wide<WideFilter_565>;
+            proc_3_3 = downsample_3_3_wide<WideFilter_565>;
             break;
         case kARGB_4444_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_4444>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_4444>;
-            proc_2_1 = downsample_2_1<ColorTypeFilter_4444>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_4444>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_4444>;
-            proc_3_1 = downsample_3_1<ColorTypeFilter_4444>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_4444>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_4444>;
+            proc_2_1 = downsample_2_1_wide<WideFilter_4444>;
+            proc_2_2 = downsample_2_2_wide<WideFilter_4444>;
+            proc_2_3 = downsample_2_3_wide<WideFilter_4444>;
+            proc_3_1 = downsample_3_1_wide<WideFilter_4444>;
+            proc_3_2 = downsample_3_2_wide<WideFilter_4444>;
+            proc_3_3 = downsample_3_3_wide<WideFilter_4444>;
             break;
         case kAlpha_8_SkColorType:
         case kGray_8_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_8>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_8>;
-            proc_2_1 = downsample_2_1<ColorTypeFilter_8>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_8>;
-            proc_3_1 = downsample_3_1<ColorTypeFilter_8>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_8>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_8>;
+            proc_2_1 = downsample_2_1_wide<WideFilter_8>;
+            proc_2_2 = downsample_2_2_wide<WideFilter_8>;
+            proc_2_3 = downsample_2_3_wide<WideFilter_8>;
+            proc_3_1 = downsample_3_1_wide<WideFilter_8>;
+            proc_3_2 = downsample_3_2_wide<WideFilter_8>;
+            proc_3_3 = downsample_3_3_wide<WideFilter_8>;
             break;
         case kRGBA_F16_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_F16>;
@@ -480,10 +706,29 @@ SkMipMap* SkMipMap::Build(const SkPixmap& src, SkSourceGammaTreatment treatment,
         void* dstBasePtr = dstPM.writable_addr();
 
         const size_t srcRB = srcPM.rowBytes();
-        for (int y = 0; y < height; y++) {
-            proc(dstBasePtr, srcBasePtr, srcRB, width);
-            srcBasePtr = (char*)srcBasePtr + srcRB * 2; // jump two rows
-            dstBasePtr = (char*)dstBasePtr + dstPM.rowBytes();
+        const size_t dstRB = dstPM.rowBytes();
+        auto filterRows = [=](int startY, int stopY) {
+            const char* srcRow = (const char*)srcBasePtr + startY * srcRB * 2;
+            char* dstRow = (char*)dstBasePtr + startY * dstRB;
+            for (int y = startY; y < stopY; y++) {
+                proc(dstRow, srcRow, srcRB, width);
+                srcRow += srcRB * 2; // jump two rows
+                dstRow += dstRB;
+            }
+        };
+
+        // The first level touches 3/4 of all the pixels we'll ever read, so for large images we
+        // split it into bands of rows and filter them in parallel. Each band only reads its own
+        // src rows (plus the one shared row of a 3-tap filter), so the bands are independent.
+        // Without an SkTaskGroup::Enabler this simply runs the bands inline.
+        const int bands = (0 == i && sk_64_mul(width, height) >= kParallelMinPixels)
+                        ? SkTMin(kMaxParallelBands, height / kMinRowsPerBand) : 1;
+        if (bands > 1) {
+            SkTaskGroup().batch(bands, [=](int band) {
+                filterRows(height * band / bands, height * (band + 1) / bands);
+            });
+        } else {
+            filterRows(0, height);
         }
         srcPM = dstPM;
         addr += height * rowBytes;
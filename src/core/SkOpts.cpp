@@ -71,6 +71,14 @@ namespace SkOpts {
     decltype(grayA_to_rgbA)         grayA_to_rgbA         = sk_default::grayA_to_rgbA;
     decltype(inverted_CMYK_to_RGB1) inverted_CMYK_to_RGB1 = sk_default::inverted_CMYK_to_RGB1;
     decltype(inverted_CMYK_to_BGR1) inverted_CMYK_to_BGR1 = sk_default::inverted_CMYK_to_BGR1;
+    decltype(RGB_to_565)            RGB_to_565            = sk_default::RGB_to_565;
+    decltype(BGR_to_565)            BGR_to_565            = sk_default::BGR_to_565;
+    decltype(gray_to_565)           gray_to_565           = sk_default::gray_to_565;
+    decltype(inverted_CMYK_to_565)  inverted_CMYK_to_565  = sk_default::inverted_CMYK_to_565;
+    decltype(index_to_8888)         index_to_8888         = sk_default::index_to_8888;
+    decltype(index_to_565)          index_to_565          = sk_default::index_to_565;
+    decltype(YUV_to_RGB1)           YUV_to_RGB1           = sk_default::YUV_to_RGB1;
+    decltype(YUV_to_BGR1)           YUV_to_BGR1           = sk_default::YUV_to_BGR1;
 
     decltype(half_to_float) half_to_float = sk_default::half_to_float;
     decltype(float_to_half) float_to_half = sk_default::float_to_half;
@@ -91,7 +99,7 @@ namespace SkOpts {
     void Init_sse41();
     void Init_sse42() {}
     void Init_avx();
-    void Init_avx2() {}
+    void Init_avx2();
 
     static void init() {
     #if defined(SK_CPU_X86) && !defined(SK_BUILD_NO_OPTS)
@@ -8,6 +8,7 @@
 #ifndef SkOpts_DEFINED
 #define SkOpts_DEFINED
 
+#include "SkImageInfo.h"
 #include "SkTextureCompressor.h"
 #include "SkTypes.h"
 #include "SkXfermode.h"
@@ -62,6 +63,25 @@ namespace SkOpts {
                         inverted_CMYK_to_RGB1, // i.e. convert color space
                         inverted_CMYK_to_BGR1; // i.e. convert color space
 
+    // Swizzle input into 565, truncating each channel like SkPack888ToRGB16.
+    typedef void (*Swizzle_565)(uint16_t*, const void*, int);
+    extern Swizzle_565 RGB_to_565,           // i.e. pack
+                       BGR_to_565,           // i.e. swap RB and pack
+                       gray_to_565,          // i.e. expand to color channels and pack
+                       inverted_CMYK_to_565; // i.e. convert color space and pack
+
+    // Expand 8-bit palette indices through a 256-entry color table, as n32 or packed to 565.
+    extern void (*index_to_8888)(uint32_t dst[], const uint8_t src[], int count,
+                                 const uint32_t table[]);
+    extern void (*index_to_565)(uint16_t dst[], const uint8_t src[], int count,
+                                const uint32_t table[]);
+
+    // Convert one Y, U and V sample per pixel into opaque RGBA or BGRA.
+    typedef void (*YUV_to_8888)(uint32_t dst[], const uint8_t y[], const uint8_t u[],
+                                const uint8_t v[], int count, SkYUVColorSpace);
+    extern YUV_to_8888 YUV_to_RGB1,
+                       YUV_to_BGR1;
+
     extern void (*half_to_float)(float[], const uint16_t[], int);
     extern void (*float_to_half)(uint16_t[], const float[], int);
 
@@ -437,6 +437,51 @@ static void DetachDescProc(SkTypeface* typeface, const SkScalerContextEffects& e
     *((SkGlyphCache**)context) = SkGlyphCache::DetachCache(typeface, effects, desc);
 }
 
+// Return the most glyphs that byteLength of text in this encoding can hold.
+static size_t max_glyph_count(SkPaint::TextEncoding encoding, size_t byteLength) {
+    switch (encoding) {
+        case SkPaint::kUTF8_TextEncoding:
+            return byteLength;
+        case SkPaint::kUTF16_TextEncoding:
+        case SkPaint::kGlyphID_TextEncoding:
+            return byteLength >> 1;
+        case SkPaint::kUTF32_TextEncoding:
+            return byteLength >> 2;
+    }
+    SkDEBUGFAIL("unknown text encoding");
+    return 0;
+}
+
+// Convert text that is not glyph IDs to glyph IDs, decoding all of it before looking up all of
+// the glyphs. glyphs[] must have room for max_glyph_count() entries.
+static int chars_to_glyphs(SkGlyphCache* cache, SkPaint::TextEncoding encoding,
+                           const void* text, size_t byteLength, uint16_t glyphs[]) {
+    SkASSERT(SkPaint::kGlyphID_TextEncoding != encoding);
+
+    if (SkPaint::kUTF32_TextEncoding == encoding) {
+        const int count = SkToInt(byteLength >> 2);
+        cache->unicharsToGlyphs((const SkUnichar*)text, count, glyphs);
+        return count;
+    }
+
+    SkAutoSTMalloc<256, SkUnichar> unichars(max_glyph_count(encoding, byteLength));
+    int count;
+    switch (encoding) {
+        case SkPaint::kUTF8_TextEncoding:
+            count = SkUTF8_ToUnichars((const char*)text, byteLength, unichars.get());
+            break;
+        case SkPaint::kUTF16_TextEncoding:
+            count = SkUTF16_ToUnichars((const uint16_t*)text, SkToInt(byteLength >> 1),
+                                       unichars.get());
+            break;
+        default:
+            SkDEBUGFAIL("unknown text encoding");
+            return 0;
+    }
+    cache->unicharsToGlyphs(unichars.get(), count, glyphs);
+    return count;
+}
+
 int SkPaint::textToGlyphs(const void* textData, size_t byteLength, uint16_t glyphs[]) const {
     if (byteLength == 0) {
         return 0;
@@ -470,38 +515,8 @@ int SkPaint::textToGlyphs(const void* textData, size_t byteLength, uint16_t glyp
     }
 
     SkAutoGlyphCache autoCache(*this, nullptr, nullptr);
-    SkGlyphCache*    cache = autoCache.getCache();
-
-    const char* text = (const char*)textData;
-    const char* stop = text + byteLength;
-    uint16_t*   gptr = glyphs;
-
-    switch (this->getTextEncoding()) {
-        case SkPaint::kUTF8_TextEncoding:
-            while (text < stop) {
-                *gptr++ = cache->unicharToGlyph(SkUTF8_NextUnichar(&text));
-            }
-            break;
-        case SkPaint::kUTF16_TextEncoding: {
-            const uint16_t* text16 = (const uint16_t*)text;
-            const uint16_t* stop16 = (const uint16_t*)stop;
-            while (text16 < stop16) {
-                *gptr++ = cache->unicharToGlyph(SkUTF16_NextUnichar(&text16));
-            }
-            break;
-        }
-        case kUTF32_TextEncoding: {
-            const int32_t* text32 = (const int32_t*)text;
-            const int32_t* stop32 = (const int32_t*)stop;
-            while (text32 < stop32) {
-                *gptr++ = cache->unicharToGlyph(*text32++);
-            }
-            break;
-        }
-        default:
-            SkDEBUGFAIL("unknown text encoding");
-    }
-    return SkToInt(gptr - glyphs);
+    return chars_to_glyphs(autoCache.getCache(), this->getTextEncoding(), textData, byteLength,
+                           glyphs);
 }
 
 bool SkPaint::containsText(const void* textData, size_t byteLength) const {
@@ -524,42 +539,13 @@ bool SkPaint::containsText(const void* textData, size_t byteLength) const {
     }
 
     SkAutoGlyphCache autoCache(*this, nullptr, nullptr);
-    SkGlyphCache*    cache = autoCache.getCache();
-
-    switch (this->getTextEncoding()) {
-        case SkPaint::kUTF8_TextEncoding: {
-            const char* text = static_cast<const char*>(textData);
-            const char* stop = text + byteLength;
-            while (text < stop) {
-                if (0 == cache->unicharToGlyph(SkUTF8_NextUnichar(&text))) {
-                    return false;
-                }
-            }
-            break;
-        }
-        case SkPaint::kUTF16_TextEncoding: {
-            const uint16_t* text = static_cast<const uint16_t*>(textData);
-            const uint16_t* stop = text + (byteLength >> 1);
-            while (text < stop) {
-                if (0 == cache->unicharToGlyph(SkUTF16_NextUnichar(&text))) {
-                    return false;
-                }
-            }
-            break;
-        }
-        case SkPaint::kUTF32_TextEncoding: {
-            const int32_t* text = static_cast<const int32_t*>(textData);
-            const int32_t* stop = text + (byteLength >> 2);
-            while (text < stop) {
-                if (0 == cache->unicharToGlyph(*text++)) {
-                    return false;
-                }
-            }
-            break;
-        }
-        default:
-            SkDEBUGFAIL("unknown text encoding");
+    SkAutoSTMalloc<256, uint16_t> glyphs(max_glyph_count(this->getTextEncoding(), byteLength));
+    int count = chars_to_glyphs(autoCache.getCache(), this->getTextEncoding(), textData,
+                                byteLength, glyphs.get());
+    for (int i = 0; i < count; i++) {
+        if (0 == glyphs[i]) {
             return false;
+        }
     }
     return true;
 }
@@ -661,8 +647,9 @@ static const SkGlyph& sk_getAdvance_glyph_next(SkGlyphCache* cache,
     return cache->getGlyphIDAdvance(glyphID);
 }
 
-SkPaint::GlyphCacheProc SkPaint::getGlyphCacheProc(bool needFullMetrics) const {
-    static const GlyphCacheProc gGlyphCacheProcs[] = {
+static SkPaint::GlyphCacheProc get_glyph_cache_proc(SkPaint::TextEncoding encoding,
+                                                    bool isDevKernText, bool needFullMetrics) {
+    static const SkPaint::GlyphCacheProc gGlyphCacheProcs[] = {
         sk_getMetrics_utf8_next,
         sk_getMetrics_utf16_next,
         sk_getMetrics_utf32_next,
@@ -674,9 +661,9 @@ SkPaint::GlyphCacheProc SkPaint::getGlyphCacheProc(bool needFullMetrics) const {
         sk_getAdvance_glyph_next,
     };
 
-    unsigned index = this->getTextEncoding();
+    unsigned index = encoding;
 
-    if (!needFullMetrics && !this->isDevKernText()) {
+    if (!needFullMetrics && !isDevKernText) {
         index += 4;
     }
 
@@ -684,6 +671,10 @@ SkPaint::GlyphCacheProc SkPaint::getGlyphCacheProc(bool needFullMetrics) const {
     return gGlyphCacheProcs[index];
 }
 
+SkPaint::GlyphCacheProc SkPaint::getGlyphCacheProc(bool needFullMetrics) const {
+    return get_glyph_cache_proc(this->getTextEncoding(), this->isDevKernText(), needFullMetrics);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #define TEXT_AS_PATHS_PAINT_FLAGS_TO_IGNORE (   \
@@ -766,6 +757,17 @@ SkScalar SkPaint::measure_text(SkGlyphCache* cache,
                                const char* text, size_t byteLength,
                                int* count, SkRect* bounds) const {
     SkASSERT(count);
+
+    // Look up the glyph IDs of all of the chars at once, then measure those.
+    SkAutoSTMalloc<128, uint16_t> glyphs;
+    if (kGlyphID_TextEncoding != this->getTextEncoding() && byteLength > 0) {
+        glyphs.reset(max_glyph_count(this->getTextEncoding(), byteLength));
+        int glyphCount = chars_to_glyphs(cache, this->getTextEncoding(), text, byteLength,
+                                         glyphs.get());
+        text = (const char*)glyphs.get();
+        byteLength = glyphCount * sizeof(uint16_t);
+    }
+
     if (byteLength == 0) {
         *count = 0;
         if (bounds) {
@@ -774,7 +776,8 @@ SkScalar SkPaint::measure_text(SkGlyphCache* cache,
         return 0;
     }
 
-    GlyphCacheProc glyphCacheProc = this->getGlyphCacheProc(nullptr != bounds);
+    GlyphCacheProc glyphCacheProc = get_glyph_cache_proc(kGlyphID_TextEncoding,
+                                                         this->isDevKernText(), nullptr != bounds);
 
     int xyIndex;
     JoinBoundsProc joinBoundsProc;
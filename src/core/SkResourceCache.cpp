@@ -637,6 +637,7 @@ void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "SkBitmapCache.h"
 #include "SkGraphics.h"
 #include "SkImageFilter.h"
 
@@ -661,6 +662,7 @@ size_t SkGraphics::SetResourceCacheSingleAllocationByteLimit(size_t newLimit) {
 }
 
 void SkGraphics::PurgeResourceCache() {
+    SkMipMapCache::WaitForAsyncBuilds();
     SkImageFilter::PurgeCache();
     return SkResourceCache::PurgeAll();
 }
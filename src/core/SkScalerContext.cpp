@@ -563,6 +563,23 @@ void SkScalerContext::getImage(const SkGlyph& origGlyph) {
     }
 }
 
+void SkScalerContext::getImages(const SkGlyph* const glyphs[], int count) {
+    // Mask filters and path-generated images are post-processed glyph by glyph anyway.
+    if (fMaskFilter || fGenerateImageFromPath) {
+        for (int i = 0; i < count; i++) {
+            this->getImage(*glyphs[i]);
+        }
+        return;
+    }
+    this->generateImages(glyphs, count);
+}
+
+void SkScalerContext::generateImages(const SkGlyph* const glyphs[], int count) {
+    for (int i = 0; i < count; i++) {
+        this->generateImage(*glyphs[i]);
+    }
+}
+
 void SkScalerContext::getPath(const SkGlyph& glyph, SkPath* path) {
     this->internalGetPath(glyph, nullptr, path, nullptr);
 }
@@ -244,9 +244,12 @@ public:
     }
 
     unsigned    getGlyphCount() { return this->generateGlyphCount(); }
+    uint32_t    getEngineVersion() { return this->generateEngineVersion(); }
     void        getAdvance(SkGlyph*);
     void        getMetrics(SkGlyph*);
     void        getImage(const SkGlyph&);
+    // Same as calling getImage() on each glyph, but lets the port set up once for all of them.
+    void        getImages(const SkGlyph* const glyphs[], int count);
     void        getPath(const SkGlyph&, SkPath*);
     void        getFontMetrics(SkPaint::FontMetrics*);
 
@@ -305,6 +308,12 @@ protected:
      */
     virtual void generateImage(const SkGlyph& glyph) = 0;
 
+    /** Generates the contents of fImage for each of the glyphs, as generateImage() does.
+     *  Ports which have per-call setup costs can override this to pay them once per batch.
+     *  The default calls generateImage() for each glyph.
+     */
+    virtual void generateImages(const SkGlyph* const glyphs[], int count);
+
     /** Sets the passed path to the glyph outline.
      *  If this cannot be done the path is set to empty;
      *  this is indistinguishable from a glyph with an empty path.
@@ -331,6 +340,12 @@ protected:
      */
     virtual SkUnichar generateGlyphToChar(uint16_t glyphId);
 
+    /** Returns a number that changes whenever the glyphs this context generates for the same
+     *  Rec may change, e.g. the version of the font engine it uses.
+     *  The default implementation returns 0, meaning the engine's output is not versioned.
+     */
+    virtual uint32_t generateEngineVersion() { return 0; }
+
     void forceGenerateImageFromPath() { fGenerateImageFromPath = true; }
     void forceOffGenerateImageFromPath() { fGenerateImageFromPath = false; }
 
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkChecksum.h"
+#include "SkFontDescriptor.h"
+#include "SkGlyph.h"
+#include "SkMilestone.h"
+#include "SkMutex.h"
+#include "SkOSFile.h"
+#include "SkStrikeFile.h"
+#include "SkTHash.h"
+#include "SkTSort.h"
+#include "SkTime.h"
+#include "SkTypeface.h"
+
+#include <stdio.h>
+
+// Bump this whenever the layout below changes. Files written by another Skia milestone or
+// another version of the font engine are ignored, since either may rasterize differently.
+static const uint32_t kStrikeFileMagic = SkSetFourByteTag('s', 'k', 's', 't');
+static const uint32_t kStrikeFileVersion = 2;
+
+// A file is a Header, the strike's descriptor, fGlyphCount Entries sorted by fID, then the
+// images. Everything is 4-byte aligned so entries and images can be used in place.
+struct SkStrikeFile::Header {
+    uint32_t fMagic;
+    uint32_t fVersion;
+    uint32_t fMilestone;
+    uint32_t fEngineVersion;
+    uint32_t fFontChecksum;
+    uint32_t fDescLength;
+    uint32_t fGlyphCount;
+};
+
+struct SkStrikeFile::Entry {
+    uint32_t fID;
+    float    fAdvanceX, fAdvanceY;
+    uint16_t fWidth, fHeight;
+    int16_t  fTop, fLeft;
+    uint8_t  fMaskFormat;
+    int8_t   fRsbDelta, fLsbDelta;
+    int8_t   fForceBW;
+    uint32_t fImageOffset;  // 0 if the image was not stored
+    uint32_t fImageSize;
+};
+
+SK_DECLARE_STATIC_MUTEX(gStrikeFileMutex);
+static SkString* gStrikeFileDir;
+// Hashing the font data is much more expensive than creating a strike, so remember it.
+static SkTHashMap<SkFontID, uint32_t>* gFontChecksums;
+
+void SkStrikeFile::SetDirectory(const char* dir) {
+    SkAutoMutexAcquire ac(gStrikeFileMutex);
+    delete gStrikeFileDir;
+    gStrikeFileDir = (dir && *dir) ? new SkString(dir) : nullptr;
+}
+
+SkString SkStrikeFile::GetDirectory() {
+    SkAutoMutexAcquire ac(gStrikeFileMutex);
+    return gStrikeFileDir ? *gStrikeFileDir : SkString();
+}
+
+// Hashed in fixed size chunks, so a font gives the same checksum whether it was opened from
+// memory or from a file.
+static bool checksum_font_data(SkTypeface* typeface, uint32_t* checksum) {
+    SkAutoTDelete<SkFontData> data(typeface->createFontData());
+    if (!data || !data->hasStream()) {
+        return false;
+    }
+    SkStreamAsset* stream = data->getStream();
+    if (!stream->rewind()) {
+        return false;
+    }
+
+    static const size_t kChunkSize = 64 * 1024;
+    uint32_t hash = SkChecksum::Murmur3(data->getAxis(), data->getAxisCount() * sizeof(SkFixed),
+                                        data->getIndex());
+    size_t length = 0;
+    if (const char* base = (const char*)stream->getMemoryBase()) {
+        const size_t size = stream->getLength();
+        for (size_t offset = 0; offset < size; offset += kChunkSize) {
+            const size_t bytes = SkTMin(kChunkSize, size - offset);
+            hash = SkChecksum::Murmur3(base + offset, bytes, hash);
+        }
+        length = size;
+    } else {
+        SkAutoTMalloc<char> buffer(kChunkSize);
+        size_t bytes;
+        while ((bytes = stream->read(buffer.get(), kChunkSize)) > 0) {
+            hash = SkChecksum::Murmur3(buffer.get(), bytes, hash);
+            length += bytes;
+        }
+    }
+    if (0 == length) {
+        return false;
+    }
+    *checksum = hash;
+    return true;
+}
+
+SkStrikeFile* SkStrikeFile::Make(SkTypeface* typeface, const SkDescriptor& desc,
+                                 uint32_t engineVersion) {
+    const SkString dir = GetDirectory();
+    if (dir.isEmpty() || 0 == engineVersion) {
+        return nullptr;
+    }
+    // Flattened effects are not guaranteed to be stable from one process to the next.
+    if (desc.findEntry(kPathEffect_SkDescriptorTag, nullptr) ||
+        desc.findEntry(kMaskFilter_SkDescriptorTag, nullptr) ||
+        desc.findEntry(kRasterizer_SkDescriptorTag, nullptr)) {
+        return nullptr;
+    }
+
+    const SkFontID fontID = typeface->uniqueID();
+    uint32_t fontChecksum;
+    bool found;
+    {
+        SkAutoMutexAcquire ac(gStrikeFileMutex);
+        const uint32_t* cached = gFontChecksums ? gFontChecksums->find(fontID) : nullptr;
+        found = cached != nullptr;
+        fontChecksum = found ? *cached : 0;
+    }
+    if (!found) {
+        found = checksum_font_data(typeface, &fontChecksum);
+        SkAutoMutexAcquire ac(gStrikeFileMutex);
+        if (!gFontChecksums) {
+            gFontChecksums = new SkTHashMap<SkFontID, uint32_t>;
+        }
+        // Remember failures too, as 0, so they are not retried for every strike.
+        gFontChecksums->set(fontID, found ? fontChecksum : 0);
+    }
+    if (!found || 0 == fontChecksum) {
+        return nullptr;
+    }
+
+    // The font ID is only unique within this process, so the stored descriptor leaves it out.
+    SkDescriptor* key = desc.copy();
+    SkScalerContextRec* rec =
+            (SkScalerContextRec*)key->findEntry(kRec_SkDescriptorTag, nullptr);
+    if (!rec) {
+        SkDescriptor::Free(key);
+        return nullptr;
+    }
+    rec->fFontID = 0;
+    key->computeChecksum();
+
+    SkString name;
+    name.printf("%08x%08x.strike", fontChecksum, key->getChecksum());
+    return new SkStrikeFile(SkOSPath::Join(dir.c_str(), name.c_str()), key, fontChecksum,
+                            engineVersion);
+}
+
+SkStrikeFile::SkStrikeFile(const SkString& path, SkDescriptor* desc, uint32_t fontChecksum,
+                           uint32_t engineVersion)
+    : fPath(path)
+    , fDesc(desc)
+    , fFontChecksum(fontChecksum)
+    , fEngineVersion(engineVersion)
+    , fEntries(nullptr)
+    , fEntryCount(0)
+    , fMapped(false) {}
+
+SkStrikeFile::~SkStrikeFile() {
+    SkDescriptor::Free(fDesc);
+}
+
+void SkStrikeFile::map() {
+    fMapped = true;
+    sk_sp<SkData> data = SkData::MakeFromFileName(fPath.c_str());
+    if (!data || data->size() < sizeof(Header)) {
+        return;
+    }
+    const Header* header = (const Header*)data->data();
+    if (header->fMagic != kStrikeFileMagic || header->fVersion != kStrikeFileVersion ||
+        header->fMilestone != SK_MILESTONE || header->fEngineVersion != fEngineVersion ||
+        header->fFontChecksum != fFontChecksum || header->fDescLength != fDesc->getLength()) {
+        return;
+    }
+    const size_t entriesOffset = sizeof(Header) + header->fDescLength;
+    if (data->size() < entriesOffset ||
+        (data->size() - entriesOffset) / sizeof(Entry) < header->fGlyphCount) {
+        return;
+    }
+    // Guard against checksum collisions by comparing the whole descriptor.
+    if (*(const SkDescriptor*)(header + 1) != *fDesc) {
+        return;
+    }
+    fEntries = (const Entry*)(data->bytes() + entriesOffset);
+    fEntryCount = header->fGlyphCount;
+    fData = std::move(data);
+}
+
+const SkStrikeFile::Entry* SkStrikeFile::findEntry(uint32_t packedID) const {
+    int lo = 0, hi = fEntryCount - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) >> 1;
+        if (fEntries[mid].fID < packedID) {
+            lo = mid + 1;
+        } else if (fEntries[mid].fID > packedID) {
+            hi = mid - 1;
+        } else {
+            return &fEntries[mid];
+        }
+    }
+    return nullptr;
+}
+
+const void* SkStrikeFile::image(const Entry& entry) const {
+    if (0 == entry.fImageOffset || entry.fImageOffset > fData->size() ||
+        fData->size() - entry.fImageOffset < entry.fImageSize) {
+        return nullptr;
+    }
+    return fData->bytes() + entry.fImageOffset;
+}
+
+bool SkStrikeFile::findGlyph(SkGlyph* glyph) {
+    if (!fMapped) {
+        this->map();
+    }
+    const Entry* entry = this->findEntry(SkGlyph::HashTraits::GetKey(*glyph));
+    if (!entry) {
+        return false;
+    }
+    glyph->fAdvanceX   = entry->fAdvanceX;
+    glyph->fAdvanceY   = entry->fAdvanceY;
+    glyph->fWidth      = entry->fWidth;
+    glyph->fHeight     = entry->fHeight;
+    glyph->fTop        = entry->fTop;
+    glyph->fLeft       = entry->fLeft;
+    glyph->fMaskFormat = entry->fMaskFormat;
+    glyph->fRsbDelta   = entry->fRsbDelta;
+    glyph->fLsbDelta   = entry->fLsbDelta;
+    glyph->fForceBW    = entry->fForceBW;
+    return true;
+}
+
+const void* SkStrikeFile::findImage(const SkGlyph& glyph) {
+    if (!fData) {
+        return nullptr;
+    }
+    const Entry* entry = this->findEntry(SkGlyph::HashTraits::GetKey(glyph));
+    if (!entry || entry->fImageSize != glyph.computeImageSize()) {
+        return nullptr;
+    }
+    return this->image(*entry);
+}
+
+void SkStrikeFile::write(const SkTDArray<const SkGlyph*>& glyphs) {
+    if (!fMapped) {
+        this->map();
+    }
+
+    struct Pending {
+        Entry       fEntry;
+        const void* fImage;
+        bool operator<(const Pending& that) const { return fEntry.fID < that.fEntry.fID; }
+    };
+    SkTDArray<Pending> pending;
+    SkTHashSet<uint32_t> ids;
+    for (const SkGlyph* glyph : glyphs) {
+        if (!glyph->isFullMetrics()) {
+            continue;
+        }
+        Pending* p = pending.append();
+        sk_bzero(&p->fEntry, sizeof(Entry));
+        p->fEntry.fID         = SkGlyph::HashTraits::GetKey(*glyph);
+        p->fEntry.fAdvanceX   = glyph->fAdvanceX;
+        p->fEntry.fAdvanceY   = glyph->fAdvanceY;
+        p->fEntry.fWidth      = glyph->fWidth;
+        p->fEntry.fHeight     = glyph->fHeight;
+        p->fEntry.fTop        = glyph->fTop;
+        p->fEntry.fLeft       = glyph->fLeft;
+        p->fEntry.fMaskFormat = glyph->fMaskFormat;
+        p->fEntry.fRsbDelta   = glyph->fRsbDelta;
+        p->fEntry.fLsbDelta   = glyph->fLsbDelta;
+        p->fEntry.fForceBW    = glyph->fForceBW;
+        p->fImage = glyph->fImage;
+        p->fEntry.fImageSize = glyph->fImage ? SkToU32(glyph->computeImageSize()) : 0;
+        ids.add(p->fEntry.fID);
+    }
+    if (pending.isEmpty()) {
+        return;
+    }
+    for (int i = 0; i < fEntryCount; i++) {
+        if (!ids.contains(fEntries[i].fID)) {
+            Pending* p = pending.append();
+            p->fEntry = fEntries[i];
+            p->fImage = this->image(fEntries[i]);
+            if (!p->fImage) {
+                p->fEntry.fImageSize = 0;
+            }
+        }
+    }
+    SkTQSort(pending.begin(), pending.end() - 1);
+
+    size_t offset = sizeof(Header) + fDesc->getLength() + pending.count() * sizeof(Entry);
+    for (Pending& p : pending) {
+        p.fEntry.fImageOffset = p.fImage ? SkToU32(offset) : 0;
+        offset += SkAlign4(p.fEntry.fImageSize);
+    }
+
+    // Write a private file and rename it over the old one, so other processes only ever see
+    // complete files; any that still have the old one mapped keep their copy.
+    SkString tmpPath;
+    tmpPath.printf("%s.%08x%08x.tmp", fPath.c_str(), SkChecksum::Mix((uint32_t)(intptr_t)this),
+                   (uint32_t)SkTime::GetNSecs());
+    FILE* file = sk_fopen(tmpPath.c_str(), kWrite_SkFILE_Flag);
+    if (!file) {
+        return;
+    }
+    Header header;
+    header.fMagic         = kStrikeFileMagic;
+    header.fVersion       = kStrikeFileVersion;
+    header.fMilestone     = SK_MILESTONE;
+    header.fEngineVersion = fEngineVersion;
+    header.fFontChecksum  = fFontChecksum;
+    header.fDescLength    = fDesc->getLength();
+    header.fGlyphCount    = pending.count();
+    bool ok = sk_fwrite(&header, sizeof(header), file) == sizeof(header) &&
+              sk_fwrite(fDesc, fDesc->getLength(), file) == fDesc->getLength();
+    for (const Pending& p : pending) {
+        ok = ok && sk_fwrite(&p.fEntry, sizeof(Entry), file) == sizeof(Entry);
+    }
+    static const uint32_t kZero = 0;
+    for (const Pending& p : pending) {
+        if (p.fImage) {
+            const size_t padding = SkAlign4(p.fEntry.fImageSize) - p.fEntry.fImageSize;
+            ok = ok && sk_fwrite(p.fImage, p.fEntry.fImageSize, file) == p.fEntry.fImageSize &&
+                 sk_fwrite(&kZero, padding, file) == padding;
+        }
+    }
+    sk_fclose(file);
+    if (!ok || 0 != rename(tmpPath.c_str(), fPath.c_str())) {
+        remove(tmpPath.c_str());
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStrikeFile_DEFINED
+#define SkStrikeFile_DEFINED
+
+#include "SkData.h"
+#include "SkDescriptor.h"
+#include "SkString.h"
+#include "SkTDArray.h"
+
+class SkTypeface;
+struct SkGlyph;
+
+/** \class SkStrikeFile
+
+    The on-disk copy of a strike (see SkGlyphCache). Strikes are stored one per file in the
+    directory given to SkGraphics::SetFontCacheDirectory(), named by a checksum of the font's
+    data and a checksum of the strike's descriptor, so editing or replacing a font file simply
+    stops matching its old strikes. A file holds the full metrics of every glyph that was
+    measured, and the images of every glyph that was drawn, laid out so they can be used
+    directly from a read-only mapping.
+*/
+class SkStrikeFile : SkNoncopyable {
+public:
+    /**
+     *  Returns the strike file for this typeface and descriptor, or nullptr if no cache
+     *  directory is set or the strike can not be persisted (e.g. it has a path effect or mask
+     *  filter, the typeface has no font data, or engineVersion is 0). engineVersion is the
+     *  scaler context's SkScalerContext::getEngineVersion(). The file itself is not read until
+     *  the first call to findGlyph().
+     */
+    static SkStrikeFile* Make(SkTypeface*, const SkDescriptor&, uint32_t engineVersion);
+
+    static void SetDirectory(const char* dir);
+    static SkString GetDirectory();
+
+    ~SkStrikeFile();
+
+    /**
+     *  If the file has this glyph, set its full metrics and return true. The glyph's image, if
+     *  stored, is returned by findImage().
+     */
+    bool findGlyph(SkGlyph*);
+
+    /**
+     *  Returns the stored image for a glyph previously returned by findGlyph(), or nullptr.
+     *  The memory is owned by the strike file and is read-only.
+     */
+    const void* findImage(const SkGlyph&);
+
+    /**
+     *  Replace the file with these glyphs, plus any glyphs in the existing file that are not
+     *  among them. Glyphs with only advances are skipped.
+     */
+    void write(const SkTDArray<const SkGlyph*>&);
+
+private:
+    struct Header;
+    struct Entry;
+
+    SkStrikeFile(const SkString& path, SkDescriptor* desc, uint32_t fontChecksum,
+                 uint32_t engineVersion);
+
+    void map();
+    const Entry* findEntry(uint32_t packedID) const;
+    const void* image(const Entry&) const;
+
+    const SkString          fPath;
+    SkDescriptor* const     fDesc;
+    const uint32_t          fFontChecksum;
+    const uint32_t          fEngineVersion;
+    sk_sp<SkData>           fData;
+    const Entry*            fEntries;
+    int                     fEntryCount;
+    bool                    fMapped;
+};
+
+#endif
@@ -6,6 +6,7 @@
  */
 
 #include "SkLeanWindows.h"
+#include "SkMutex.h"
 #include "SkOnce.h"
 #include "SkSemaphore.h"
 #include "SkSpinlock.h"
@@ -199,7 +200,35 @@ SkTaskGroup::Enabler::Enabler(int threads) {
     }
 }
 
-SkTaskGroup::Enabler::~Enabler() { delete ThreadPool::gGlobal; }
+SK_DECLARE_STATIC_MUTEX(gGlobalGroupsMutex);
+static SkTDArray<SkTaskGroup*>* gGlobalGroups;     // guarded by gGlobalGroupsMutex
+
+SkTaskGroup::Enabler::~Enabler() {
+    // Global groups may still have work queued for our threads.  Wait without the lock held,
+    // since that work may make more global groups.
+    SkTDArray<SkTaskGroup*> groups;
+    {
+        SkAutoMutexAcquire lock(gGlobalGroupsMutex);
+        if (gGlobalGroups) {
+            groups = *gGlobalGroups;
+        }
+    }
+    for (SkTaskGroup* group : groups) {
+        group->wait();
+    }
+    delete ThreadPool::gGlobal;
+    ThreadPool::gGlobal = nullptr;
+}
+
+SkTaskGroup* SkTaskGroup::NewGlobal() {
+    SkTaskGroup* group = new SkTaskGroup;
+    SkAutoMutexAcquire lock(gGlobalGroupsMutex);
+    if (!gGlobalGroups) {
+        gGlobalGroups = new SkTDArray<SkTaskGroup*>;
+    }
+    *gGlobalGroups->append() = group;
+    return group;
+}
 
 SkTaskGroup::SkTaskGroup() : fPending(0) {}
 
@@ -25,6 +25,10 @@ public:
     SkTaskGroup();
     ~SkTaskGroup() { this->wait(); }
 
+    // Returns a new SkTaskGroup that is never destroyed, for work that no caller waits for.
+    // Each Enabler waits for these groups before it shuts down its threads.
+    static SkTaskGroup* NewGlobal();
+
     // Add a task to this SkTaskGroup.  It will likely run on another thread.
     void add(std::function<void(void)> fn);
 
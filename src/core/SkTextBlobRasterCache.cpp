@@ -0,0 +1,175 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDescriptor.h"
+#include "SkMatrix.h"
+#include "SkMutex.h"
+#include "SkTextBlob.h"
+#include "SkTextBlobRasterCache.h"
+
+#ifndef SK_DEFAULT_TEXT_BLOB_RASTER_CACHE_LIMIT
+    #define SK_DEFAULT_TEXT_BLOB_RASTER_CACHE_LIMIT     (1024 * 1024)
+#endif
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+static SkResourceCache* gRasterCache = nullptr;
+
+/** Must hold gMutex when calling. */
+static SkResourceCache* get_cache() {
+    gMutex.assertHeld();
+    if (nullptr == gRasterCache) {
+        gRasterCache = new SkResourceCache(SK_DEFAULT_TEXT_BLOB_RASTER_CACHE_LIMIT);
+    }
+    return gRasterCache;
+}
+
+size_t SkTextBlobRasterCache::GetTotalBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->getTotalBytesUsed();
+}
+
+size_t SkTextBlobRasterCache::GetTotalByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->getTotalByteLimit();
+}
+
+size_t SkTextBlobRasterCache::SetTotalByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setTotalByteLimit(newLimit);
+}
+
+void SkTextBlobRasterCache::PurgeAll() {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->purgeAll();
+}
+
+uint64_t SkTextBlobRasterCache::SharedID(uint32_t blobID) {
+    uint64_t sharedID = SkSetFourByteTag('b', 'l', 'o', 'b');
+    return (sharedID << 32) | blobID;
+}
+
+// The copy of the descriptor follows the glyphs.
+static const SkDescriptor* run_desc(const SkTextBlobRasterCache::Run* run) {
+    return reinterpret_cast<const SkDescriptor*>(run->glyphs() + run->fCount);
+}
+
+namespace {
+static unsigned gTextBlobRunKeyNamespaceLabel;
+
+struct TextBlobRunKey : public SkResourceCache::Key {
+public:
+    TextBlobRunKey(uint32_t blobID, int runIndex, const SkMatrix& matrix, const SkPoint& origin,
+                   SkPaint::Align align, const SkDescriptor& desc, uint32_t generation)
+        : fBlobID(blobID)
+        , fRunIndex(runIndex)
+        , fAlign(align)
+        , fDescChecksum(desc.getChecksum())
+        , fGeneration(generation)
+    {
+        fMatrix[0] = matrix.getScaleX();
+        fMatrix[1] = matrix.getSkewX();
+        fMatrix[2] = matrix.getSkewY();
+        fMatrix[3] = matrix.getScaleY();
+        fSubpixelOrigin.set(origin.fX - SkScalarFloorToScalar(origin.fX),
+                            origin.fY - SkScalarFloorToScalar(origin.fY));
+        this->init(&gTextBlobRunKeyNamespaceLabel, SkTextBlobRasterCache::SharedID(blobID),
+                   sizeof(fBlobID) + sizeof(fRunIndex) + sizeof(fAlign) + sizeof(fDescChecksum) +
+                   sizeof(fGeneration) + sizeof(fMatrix) + sizeof(fSubpixelOrigin));
+    }
+
+    uint32_t    fBlobID;
+    int32_t     fRunIndex;
+    int32_t     fAlign;
+    uint32_t    fDescChecksum;
+    uint32_t    fGeneration;
+    SkScalar    fMatrix[4];
+    SkPoint     fSubpixelOrigin;
+};
+
+struct TextBlobRunRec : public SkResourceCache::Rec {
+    TextBlobRunRec(const TextBlobRunKey& key, SkCachedData* data)
+        : fKey(key)
+        , fData(data)
+    {
+        fData->attachToCacheAndRef();
+    }
+    ~TextBlobRunRec() {
+        fData->detachFromCacheAndUnref();
+    }
+
+    TextBlobRunKey  fKey;
+    SkCachedData*   fData;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fData->size(); }
+    const char* getCategory() const override { return "text-blob-run"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override {
+        return fData->diagnostic_only_getDiscardable();
+    }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const TextBlobRunRec& rec = static_cast<const TextBlobRunRec&>(baseRec);
+        SkCachedData** result = static_cast<SkCachedData**>(contextData);
+
+        SkCachedData* tmpData = rec.fData;
+        tmpData->ref();
+        if (nullptr == tmpData->data()) {
+            tmpData->unref();
+            return false;
+        }
+        *result = tmpData;
+        return true;
+    }
+};
+} // namespace
+
+SkCachedData* SkTextBlobRasterCache::FindAndRef(const SkTextBlob* blob, int runIndex,
+                                                const SkMatrix& matrix, const SkPoint& origin,
+                                                SkPaint::Align align, const SkDescriptor& desc,
+                                                uint32_t generation, const Run** run) {
+    SkCachedData* data = nullptr;
+    TextBlobRunKey key(blob->uniqueID(), runIndex, matrix, origin, align, desc, generation);
+    {
+        SkAutoMutexAcquire am(gMutex);
+        if (!get_cache()->find(key, TextBlobRunRec::Visitor, &data)) {
+            return nullptr;
+        }
+    }
+
+    // The key only has the descriptor's checksum.
+    const Run* found = static_cast<const Run*>(data->data());
+    if (!(*run_desc(found) == desc)) {
+        data->unref();
+        return nullptr;
+    }
+    *run = found;
+    return data;
+}
+
+void SkTextBlobRasterCache::Add(const SkTextBlob* blob, int runIndex, const SkMatrix& matrix,
+                                const SkPoint& origin, SkPaint::Align align,
+                                const SkDescriptor& desc, uint32_t generation,
+                                const SkRect& bounds, const Glyph glyphs[], int count) {
+    const size_t size = sizeof(Run) + count * sizeof(Glyph) + desc.getLength();
+    SkAutoMutexAcquire am(gMutex);
+    SkCachedData* data = get_cache()->newCachedData(size);
+    if (nullptr == data) {
+        return;
+    }
+
+    Run* run = static_cast<Run*>(data->writable_data());
+    run->fOrigin.set(SkScalarFloorToScalar(origin.fX), SkScalarFloorToScalar(origin.fY));
+    run->fBounds = bounds;
+    run->fCount = count;
+    memcpy(const_cast<Glyph*>(run->glyphs()), glyphs, count * sizeof(Glyph));
+    memcpy((void*)run_desc(run), &desc, desc.getLength());
+
+    TextBlobRunKey key(blob->uniqueID(), runIndex, matrix, origin, align, desc, generation);
+    get_cache()->add(new TextBlobRunRec(key, data));
+    data->unref();
+    blob->notifyAddedToCache();
+}
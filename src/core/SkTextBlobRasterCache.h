@@ -0,0 +1,73 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextBlobRasterCache_DEFINED
+#define SkTextBlobRasterCache_DEFINED
+
+#include "SkCachedData.h"
+#include "SkPaint.h"
+#include "SkRect.h"
+#include "SkResourceCache.h"
+
+class SkDescriptor;
+class SkGlyph;
+class SkMatrix;
+class SkTextBlob;
+
+/**
+ *  Remembers where the glyphs of a text blob's runs were placed by the raster backend, so that
+ *  drawing the blob again, unchanged or moved by whole pixels, can skip finding and placing each
+ *  glyph (the raster counterpart of GrTextBlobCache). Entries live in a cache of their own,
+ *  bounded by SK_DEFAULT_TEXT_BLOB_RASTER_CACHE_LIMIT, and are purged when their blob is deleted.
+ */
+class SkTextBlobRasterCache {
+public:
+    /** One glyph of a run, as SkFindAndPlaceGlyph handed it to be drawn. */
+    struct Glyph {
+        SkPoint        fPosition;  // device position, with the rounding term already added
+        const SkGlyph* fGlyph;     // valid while the strike's generation is unchanged
+    };
+
+    /** The placed glyphs of a run, followed in memory by fCount Glyphs. */
+    struct Run {
+        SkPoint  fOrigin;    // blob origin in device space when placed, floored to whole pixels
+        SkRect   fBounds;    // device bounds of the glyph images
+        int      fCount;
+
+        const Glyph* glyphs() const { return reinterpret_cast<const Glyph*>(this + 1); }
+    };
+
+    /**
+     *  On success, return a ref to the SkCachedData that holds the placement of run 'runIndex' of
+     *  the blob, and set run to point to it. A placement is found only if it was made with the same
+     *  strike (desc) at the same generation (SkGlyphCache::getGeneration()), so its glyph pointers
+     *  are still good, the same text alignment and matrix apart from translation, and with the
+     *  blob's device origin at the same fraction of a pixel.
+     *
+     *  On failure, return nullptr.
+     */
+    static SkCachedData* FindAndRef(const SkTextBlob*, int runIndex, const SkMatrix&,
+                                    const SkPoint& origin, SkPaint::Align, const SkDescriptor& desc,
+                                    uint32_t generation, const Run** run);
+
+    /**
+     *  Add the placement of a run, whose glyphs were all found in the strike at generation.
+     */
+    static void Add(const SkTextBlob*, int runIndex, const SkMatrix&, const SkPoint& origin,
+                    SkPaint::Align, const SkDescriptor& desc, uint32_t generation,
+                    const SkRect& bounds, const Glyph glyphs[], int count);
+
+    /** The SkResourceCache shared ID of all of a blob's entries. */
+    static uint64_t SharedID(uint32_t blobID);
+
+    static size_t GetTotalBytesUsed();
+    static size_t GetTotalByteLimit();
+    static size_t SetTotalByteLimit(size_t newLimit);
+    static void PurgeAll();
+};
+
+#endif
@@ -10,6 +10,7 @@
 #include "SkTypefaceCache.h"
 #include "SkAtomics.h"
 #include "SkMutex.h"
+#include "SkSharedMutex.h"
 
 #define TYPEFACE_CACHE_LIMIT    1024
 
@@ -20,13 +21,38 @@ void SkTypefaceCache::add(SkTypeface* face) {
         this->purge(TYPEFACE_CACHE_LIMIT >> 2);
     }
 
-    fTypefaces.emplace_back(SkRef(face));
+    fTypefaces.push_back({ sk_ref_sp(face), 0, false });
+}
+
+void SkTypefaceCache::add(SkTypeface* face, uint32_t hash) {
+    if (fTypefaces.count() >= TYPEFACE_CACHE_LIMIT) {
+        this->purge(TYPEFACE_CACHE_LIMIT >> 2);
+    }
+
+    fTypefaces.push_back({ sk_ref_sp(face), hash, true });
+    SkTDArray<SkTypeface*>* sameHash = fHashedTypefaces.find(hash);
+    if (!sameHash) {
+        sameHash = fHashedTypefaces.set(hash, SkTDArray<SkTypeface*>());
+    }
+    *sameHash->append() = face;
 }
 
 SkTypeface* SkTypefaceCache::findByProcAndRef(FindProc proc, void* ctx) const {
-    for (const sk_sp<SkTypeface>& typeface : fTypefaces) {
-        if (proc(typeface.get(), ctx)) {
-            return SkRef(typeface.get());
+    for (const Rec& rec : fTypefaces) {
+        if (proc(rec.fTypeface.get(), ctx)) {
+            return SkRef(rec.fTypeface.get());
+        }
+    }
+    return nullptr;
+}
+
+SkTypeface* SkTypefaceCache::findByProcAndRef(uint32_t hash, FindProc proc, void* ctx) const {
+    const SkTDArray<SkTypeface*>* sameHash = fHashedTypefaces.find(hash);
+    if (sameHash) {
+        for (SkTypeface* typeface : *sameHash) {
+            if (proc(typeface, ctx)) {
+                return SkRef(typeface);
+            }
         }
     }
     return nullptr;
@@ -36,7 +62,16 @@ void SkTypefaceCache::purge(int numToPurge) {
     int count = fTypefaces.count();
     int i = 0;
     while (i < count) {
-        if (fTypefaces[i]->unique()) {
+        const Rec& rec = fTypefaces[i];
+        if (rec.fTypeface->unique()) {
+            if (rec.fHashed) {
+                SkTDArray<SkTypeface*>* sameHash = fHashedTypefaces.find(rec.fHash);
+                SkASSERT(sameHash);
+                sameHash->removeShuffle(sameHash->find(rec.fTypeface.get()));
+                if (sameHash->isEmpty()) {
+                    fHashedTypefaces.remove(rec.fHash);
+                }
+            }
             fTypefaces.removeShuffle(i);
             --count;
             if (--numToPurge == 0) {
@@ -64,20 +99,33 @@ SkFontID SkTypefaceCache::NewFontID() {
     return sk_atomic_inc(&gFontID) + 1;
 }
 
-SK_DECLARE_STATIC_MUTEX(gMutex);
+static SkSharedMutex& get_mutex() {
+    static SkSharedMutex gMutex;
+    return gMutex;
+}
 
 void SkTypefaceCache::Add(SkTypeface* face) {
-    SkAutoMutexAcquire ama(gMutex);
+    SkAutoExclusive ae(get_mutex());
     Get().add(face);
 }
 
+void SkTypefaceCache::Add(SkTypeface* face, uint32_t hash) {
+    SkAutoExclusive ae(get_mutex());
+    Get().add(face, hash);
+}
+
 SkTypeface* SkTypefaceCache::FindByProcAndRef(FindProc proc, void* ctx) {
-    SkAutoMutexAcquire ama(gMutex);
+    SkAutoSharedMutexShared asms(get_mutex());
     return Get().findByProcAndRef(proc, ctx);
 }
 
+SkTypeface* SkTypefaceCache::FindByProcAndRef(uint32_t hash, FindProc proc, void* ctx) {
+    SkAutoSharedMutexShared asms(get_mutex());
+    return Get().findByProcAndRef(hash, proc, ctx);
+}
+
 void SkTypefaceCache::PurgeAll() {
-    SkAutoMutexAcquire ama(gMutex);
+    SkAutoExclusive ae(get_mutex());
     Get().purgeAll();
 }
 
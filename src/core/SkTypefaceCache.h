@@ -11,6 +11,8 @@
 #define SkTypefaceCache_DEFINED
 
 #include "SkRefCnt.h"
+#include "SkTDArray.h"
+#include "SkTHash.h"
 #include "SkTypeface.h"
 #include "SkTArray.h"
 
@@ -33,6 +35,13 @@ public:
      */
     void add(SkTypeface*);
 
+    /**
+     *  Add a typeface to the cache, filed under hash (e.g. a hash of whatever
+     *  the FindProc compares), so that it can be found by the hashed
+     *  findByProcAndRef() without looking at typefaces with other hashes.
+     */
+    void add(SkTypeface*, uint32_t hash);
+
     /**
      *  Iterate through the cache, calling proc(typeface, ctx) with each
      *  typeface. If proc returns true, then we return that typeface (this
@@ -40,6 +49,12 @@ public:
      */
     SkTypeface* findByProcAndRef(FindProc proc, void* ctx) const;
 
+    /**
+     *  Like findByProcAndRef(proc, ctx), but only calls proc with the
+     *  typefaces that were added with this hash.
+     */
+    SkTypeface* findByProcAndRef(uint32_t hash, FindProc proc, void* ctx) const;
+
     /**
      *  This will unref all of the typefaces in the cache for which the cache
      *  is the only owner. Normally this is handled automatically as needed.
@@ -54,10 +69,14 @@ public:
      */
     static SkFontID NewFontID();
 
-    // These are static wrappers around a global instance of a cache.
+    // These are static wrappers around a global instance of a cache. Finds
+    // only take the cache's lock shared, so they may run concurrently (and
+    // so may their FindProcs).
 
     static void Add(SkTypeface*);
+    static void Add(SkTypeface*, uint32_t hash);
     static SkTypeface* FindByProcAndRef(FindProc proc, void* ctx);
+    static SkTypeface* FindByProcAndRef(uint32_t hash, FindProc proc, void* ctx);
     static void PurgeAll();
 
     /**
@@ -70,7 +89,15 @@ private:
 
     void purge(int count);
 
-    SkTArray<sk_sp<SkTypeface>> fTypefaces;
+    struct Rec {
+        sk_sp<SkTypeface> fTypeface;
+        uint32_t          fHash;
+        bool              fHashed;
+    };
+
+    SkTArray<Rec> fTypefaces;
+    // The typefaces that were added with a hash, by their hash.
+    SkTHashMap<uint32_t, SkTDArray<SkTypeface*>> fHashedTypefaces;
 };
 
 #endif
@@ -120,6 +120,34 @@ SkUnichar SkUTF8_PrevUnichar(const char** ptr) {
     return SkUTF8_NextUnichar(&p);
 }
 
+int SkUTF8_ToUnichars(const char utf8[], size_t byteLength, SkUnichar unichars[]) {
+    SkASSERT(utf8 || 0 == byteLength);
+    SkASSERT(unichars || 0 == byteLength);
+
+    const char* stop = utf8 + byteLength;
+    SkUnichar*  dst = unichars;
+
+    while (utf8 < stop) {
+        // Eight bytes with no high bit set are eight ASCII chars.
+        while (stop - utf8 >= 8) {
+            uint64_t bytes;
+            memcpy(&bytes, utf8, 8);
+            if (bytes & 0x8080808080808080ULL) {
+                break;
+            }
+            for (int i = 0; i < 8; ++i) {
+                dst[i] = (uint8_t)utf8[i];
+            }
+            utf8 += 8;
+            dst += 8;
+        }
+        if (utf8 < stop) {
+            *dst++ = SkUTF8_NextUnichar(&utf8);
+        }
+    }
+    return SkToInt(dst - unichars);
+}
+
 size_t SkUTF8_FromUnichar(SkUnichar uni, char utf8[]) {
     if ((uint32_t)uni > 0x10FFFF) {
         SkDEBUGFAIL("bad unichar");
@@ -229,6 +257,37 @@ SkUnichar SkUTF16_PrevUnichar(const uint16_t** srcPtr) {
     return c;
 }
 
+int SkUTF16_ToUnichars(const uint16_t utf16[], int numberOf16BitValues, SkUnichar unichars[]) {
+    SkASSERT(utf16 || 0 == numberOf16BitValues);
+    SkASSERT(unichars || 0 == numberOf16BitValues);
+
+    const uint16_t* stop = utf16 + numberOf16BitValues;
+    SkUnichar*      dst = unichars;
+
+    while (utf16 < stop) {
+        // Four values with no surrogate among them are four chars.
+        while (stop - utf16 >= 4) {
+            uint64_t values;
+            memcpy(&values, utf16, 8);
+            // A value is a surrogate if its top five bits are 11011. Move each value's top five
+            // bits xor 11011 to its low bits; adding 31 then carries into bit 5 unless they were 0.
+            uint64_t top = ((values ^ 0xD800D800D800D800ULL) >> 11) & 0x001F001F001F001FULL;
+            if (((top + 0x001F001F001F001FULL) & 0x0020002000200020ULL) != 0x0020002000200020ULL) {
+                break;
+            }
+            for (int i = 0; i < 4; ++i) {
+                dst[i] = utf16[i];
+            }
+            utf16 += 4;
+            dst += 4;
+        }
+        if (utf16 < stop) {
+            *dst++ = SkUTF16_NextUnichar(&utf16);
+        }
+    }
+    return SkToInt(dst - unichars);
+}
+
 size_t SkUTF16_FromUnichar(SkUnichar uni, uint16_t dst[]) {
     SkASSERT((unsigned)uni <= 0x10FFFF);
 
@@ -63,6 +63,12 @@ SkUnichar   SkUTF8_ToUnichar(const char utf8[]);
 SkUnichar   SkUTF8_NextUnichar(const char**);
 SkUnichar   SkUTF8_PrevUnichar(const char**);
 
+/** Decode all of the utf8 text into unichars[], which must have room for byteLength entries,
+    and return how many were written. Gives the same result as calling SkUTF8_NextUnichar()
+    until the end of the text, but runs of ASCII are converted several bytes at a time.
+*/
+int         SkUTF8_ToUnichars(const char utf8[], size_t byteLength, SkUnichar unichars[]);
+
 /** Return the number of bytes need to convert a unichar
     into a utf8 sequence. Will be 1..kMaxBytesInUTF8Sequence,
     or 0 if uni is illegal.
@@ -80,6 +86,8 @@ int SkUTF16_CountUnichars(const uint16_t utf16[], int numberOf16BitValues);
 SkUnichar SkUTF16_NextUnichar(const uint16_t**);
 // this guy backs up to the previus unichar value, and returns it (*--p)
 SkUnichar SkUTF16_PrevUnichar(const uint16_t**);
+// Same as SkUTF8_ToUnichars(), for utf16. unichars[] needs room for numberOf16BitValues entries.
+int SkUTF16_ToUnichars(const uint16_t utf16[], int numberOf16BitValues, SkUnichar unichars[]);
 size_t SkUTF16_FromUnichar(SkUnichar uni, uint16_t utf16[] = NULL);
 
 size_t SkUTF16_ToUTF8(const uint16_t utf16[], int numberOf16BitValues,
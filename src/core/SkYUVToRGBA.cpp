@@ -0,0 +1,131 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkOpts.h"
+#include "SkTemplates.h"
+#include "SkYUVToRGBA.h"
+
+// Each decoder widens chroma with its own "fancy" filter, weighting the nearest sample 3:1
+// against its neighbor, but with its own rounding.  Output column x (or row y) takes its
+// nearest sample from x/2 and its neighbor from the side x falls on, clamped at the edges.
+static int far_index(int x, int count) {
+    return SkTPin((x & 1) ? (x >> 1) + 1 : (x >> 1) - 1, 0, count - 1);
+}
+
+// libjpeg-turbo's h2v1_fancy_upsample(), which falls back to replicating samples on rows
+// of two or fewer.
+static void jpeg_h2v1(uint8_t dst[], const uint8_t src[], int srcWidth, int width) {
+    for (int x = 0; x < width; x++) {
+        const int near = src[x >> 1];
+        dst[x] = srcWidth <= 2 ? near
+                               : (3 * near + src[far_index(x, srcWidth)] + 1 + (x & 1)) >> 2;
+    }
+}
+
+// libjpeg-turbo's h2v2_fancy_upsample(), likewise replicating samples on narrow rows.
+static void jpeg_h2v2(uint8_t dst[], const uint8_t near[], const uint8_t far[], int srcWidth,
+                      int width) {
+    if (srcWidth <= 2) {
+        for (int x = 0; x < width; x++) {
+            dst[x] = near[x >> 1];
+        }
+        return;
+    }
+    auto column = [&](int x) { return 3 * near[x] + far[x]; };
+    for (int x = 0; x < width; x++) {
+        dst[x] = (3 * column(x >> 1) + column(far_index(x, srcWidth)) + 7 + (~x & 1)) >> 4;
+    }
+}
+
+// libwebp's UpsampleRgbaLinePair(), which blends the two diagonals first and rounds twice.
+static void webp_h2v2(uint8_t dst[], const uint8_t near[], const uint8_t far[], int srcWidth,
+                      int width) {
+    for (int x = 0; x < width; x++) {
+        const int nearX = x >> 1,
+                  farX = far_index(x, srcWidth);
+        if (nearX == farX) {
+            dst[x] = (3 * near[nearX] + far[nearX] + 2) >> 2;
+        } else {
+            const int diagonal = (near[nearX] + 3 * near[farX] + 3 * far[nearX] + far[farX] + 8)
+                                 >> 3;
+            dst[x] = (diagonal + near[nearX]) >> 1;
+        }
+    }
+}
+
+bool SkYUVToRGBA(const SkYUVSizeInfo& sizeInfo, const void* const planes[3],
+                 SkYUVColorSpace colorSpace, const SkPixmap& dst) {
+    const SkISize& ySize = sizeInfo.fSizes[SkYUVSizeInfo::kY];
+    const SkISize& uSize = sizeInfo.fSizes[SkYUVSizeInfo::kU];
+    const SkISize& vSize = sizeInfo.fSizes[SkYUVSizeInfo::kV];
+    if (dst.info().dimensions() != ySize || ySize.isEmpty() || uSize != vSize) {
+        return false;
+    }
+
+    // Only the subsamplings whose upsampling we repeat exactly.
+    const int width = ySize.width(),
+              height = ySize.height();
+    const SkISize half = SkISize::Make((width + 1) / 2, (height + 1) / 2);
+    enum { k444, k422, k420 } subsampling;
+    if (uSize == ySize && kJPEG_SkYUVColorSpace == colorSpace) {
+        subsampling = k444;
+    } else if (uSize == SkISize::Make(half.width(), height) &&
+               kJPEG_SkYUVColorSpace == colorSpace) {
+        subsampling = k422;
+    } else if (uSize == half && (kJPEG_SkYUVColorSpace == colorSpace ||
+                                 kRec601_SkYUVColorSpace == colorSpace)) {
+        subsampling = k420;
+    } else {
+        return false;
+    }
+
+    SkOpts::YUV_to_8888 proc;
+    switch (dst.colorType()) {
+        case kRGBA_8888_SkColorType: proc = SkOpts::YUV_to_RGB1; break;
+        case kBGRA_8888_SkColorType: proc = SkOpts::YUV_to_BGR1; break;
+        default: return false;
+    }
+    if (kOpaque_SkAlphaType != dst.alphaType()) {
+        return false;
+    }
+
+    // Chroma is widened once per row, so the conversion itself only ever sees one sample of
+    // each per pixel.
+    SkAutoTMalloc<uint8_t> rows(2 * width);
+    uint8_t* uRow = rows.get();
+    uint8_t* vRow = rows.get() + width;
+    auto row = [&](int plane, int y) {
+        return SkTAddOffset<const uint8_t>(planes[plane], y * sizeInfo.fWidthBytes[plane]);
+    };
+    auto upsample = [&](uint8_t* dstRow, int plane, int y) {
+        switch (subsampling) {
+            case k444:
+                return row(plane, y);
+            case k422:
+                jpeg_h2v1(dstRow, row(plane, y), uSize.width(), width);
+                return (const uint8_t*)dstRow;
+            case k420: {
+                const uint8_t* near = row(plane, y >> 1);
+                const uint8_t* far = row(plane, far_index(y, uSize.height()));
+                if (kJPEG_SkYUVColorSpace == colorSpace) {
+                    jpeg_h2v2(dstRow, near, far, uSize.width(), width);
+                } else {
+                    webp_h2v2(dstRow, near, far, uSize.width(), width);
+                }
+                return (const uint8_t*)dstRow;
+            }
+        }
+        return (const uint8_t*)nullptr;
+    };
+
+    for (int y = 0; y < height; y++) {
+        proc(dst.writable_addr32(0, y), row(SkYUVSizeInfo::kY, y),
+             upsample(uRow, SkYUVSizeInfo::kU, y), upsample(vRow, SkYUVSizeInfo::kV, y),
+             width, colorSpace);
+    }
+    return true;
+}
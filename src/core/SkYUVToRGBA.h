@@ -0,0 +1,22 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkYUVToRGBA_DEFINED
+#define SkYUVToRGBA_DEFINED
+
+#include "SkPixmap.h"
+#include "SkYUVSizeInfo.h"
+
+// The inverse of SkRGBAToYUV, done on the CPU.  dst must be opaque RGBA or BGRA 8888 and the
+// size of the Y plane.  The result matches the decoder that made the planes exactly: chroma is
+// upsampled and converted as libjpeg-turbo does for kJPEG_SkYUVColorSpace (unsubsampled, H2V1
+// or H2V2) and as libwebp does for kRec601_SkYUVColorSpace (H2V2).  Returns false for anything
+// else, so callers can decode instead.
+bool SkYUVToRGBA(const SkYUVSizeInfo&, const void* const planes[3], SkYUVColorSpace,
+                 const SkPixmap& dst);
+
+#endif
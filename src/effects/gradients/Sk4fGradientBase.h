@@ -40,8 +40,14 @@ protected:
         bool     fZeroRamp;
     };
 
+    // Implementations may emit NaN for pixels which should not be drawn (transparent black).
     virtual void mapTs(int x, int y, SkScalar ts[], int count) const = 0;
 
+    // Vectorized mapTs() helper: maps the dst points (x + i + .5, y + .5), i in [0..count),
+    // to gradient space four at a time, and stores tproc(xs, ys) into ts.
+    template <typename TProc>
+    void mapTs4(int x, int y, SkScalar ts[], int count, const TProc& tproc) const;
+
     void buildIntervals(const SkGradientShaderBase&, const ContextRec&, bool reverse);
 
     SkSTArray<8, Interval, true> fIntervals;
@@ -70,4 +76,55 @@ private:
                            int count) const;
 };
 
+template <typename TProc>
+void SkGradientShaderBase::
+GradientShaderBase4fContext::mapTs4(int x, int y, SkScalar ts[], int count,
+                                    const TProc& tproc) const {
+    SkASSERT(count > 0);
+
+    const SkScalar sy = y + SK_ScalarHalf;
+    SkScalar sx = x + SK_ScalarHalf;
+    SkScalar tmp[4];
+
+    if (fDstToPosClass != kPerspective_MatrixClass) {
+        // kLinear_MatrixClass, kFixedStepInX_MatrixClass => fixed dpt per scanline
+        SkPoint pt;
+        fDstToPosProc(fDstToPos, sx, sy, &pt);
+        const SkVector step = fDstToPos.fixedStepInX(sy);
+
+        const Sk4f steps(0, 1, 2, 3);
+        const Sk4f dx4 = Sk4f(4 * step.x()),
+                   dy4 = Sk4f(4 * step.y());
+        Sk4f xs = Sk4f(pt.x()) + steps * step.x(),
+             ys = Sk4f(pt.y()) + steps * step.y();
+
+        while (count >= 4) {
+            tproc(xs, ys).store(ts);
+            xs = xs + dx4;
+            ys = ys + dy4;
+            ts += 4;
+            count -= 4;
+        }
+
+        if (count > 0) {
+            tproc(xs, ys).store(tmp);
+            memcpy(ts, tmp, count * sizeof(SkScalar));
+        }
+    } else {
+        SkPoint pts[4] = { {0, 0}, {0, 0}, {0, 0}, {0, 0} };
+        while (count > 0) {
+            const int n = SkTMin(count, 4);
+            for (int i = 0; i < n; ++i) {
+                fDstToPosProc(fDstToPos, sx, sy, &pts[i]);
+                sx += SK_Scalar1;
+            }
+            tproc(Sk4f(pts[0].x(), pts[1].x(), pts[2].x(), pts[3].x()),
+                  Sk4f(pts[0].y(), pts[1].y(), pts[2].y(), pts[3].y())).store(tmp);
+            memcpy(ts, tmp, n * sizeof(SkScalar));
+            ts += n;
+            count -= n;
+        }
+    }
+}
+
 #endif // Sk4fGradientBase_DEFINED
@@ -9,6 +9,7 @@
 #include "SkGradientShaderPriv.h"
 #include "SkLinearGradient.h"
 #include "SkRadialGradient.h"
+#include "SkResourceCache.h"
 #include "SkTwoPointConicalGradient.h"
 #include "SkSweepGradient.h"
 
@@ -269,6 +270,18 @@ bool SkGradientShaderBase::isOpaque() const {
     return fColorsAreOpaque;
 }
 
+// define to test the 4f gradient path
+// #define FORCE_4F_CONTEXT
+
+bool SkGradientShaderBase::Use4fContext(const ContextRec& rec, uint32_t gradFlags) {
+#ifdef FORCE_4F_CONTEXT
+    return true;
+#else
+    return rec.fPreferredDstType == ContextRec::kPM4f_DstType
+        || SkToBool(gradFlags & kForce4fContext_PrivateFlag);
+#endif
+}
+
 static unsigned rounded_divide(unsigned numer, unsigned denom) {
     return (numer + (denom >> 1)) / denom;
 }
@@ -321,13 +334,23 @@ SkGradientShaderBase::GradientShaderCache::GradientShaderCache(
         U8CPU alpha, bool dither, const SkGradientShaderBase& shader)
     : fCacheAlpha(alpha)
     , fCacheDither(dither)
-    , fShader(shader)
+    , fColorCount(shader.fColorCount)
+    , fGradFlags(shader.fGradFlags)
+    , fColors(shader.fColorCount)
 {
     // Only initialize the cache in getCache16/32.
     fCache16 = nullptr;
     fCache32 = nullptr;
     fCache16Storage = nullptr;
     fCache32PixelRef = nullptr;
+
+    memcpy(fColors.get(), shader.fOrigColors, fColorCount * sizeof(SkColor));
+    if (fColorCount > 2) {
+        fPos.reset(fColorCount);
+        for (int i = 0; i < fColorCount; ++i) {
+            fPos[i] = shader.fRecs[i].fPos;
+        }
+    }
 }
 
 SkGradientShaderBase::GradientShaderCache::~GradientShaderCache() {
@@ -556,19 +579,19 @@ void SkGradientShaderBase::GradientShaderCache::initCache16(GradientShaderCache*
     SkASSERT(nullptr == cache->fCache16Storage);
     cache->fCache16Storage = (uint16_t*)sk_malloc_throw(allocSize);
     cache->fCache16 = cache->fCache16Storage;
-    if (cache->fShader.fColorCount == 2) {
-        Build16bitCache(cache->fCache16, cache->fShader.fOrigColors[0],
-                        cache->fShader.fOrigColors[1], kCache16Count, cache->fCacheDither);
+    if (cache->fColorCount == 2) {
+        Build16bitCache(cache->fCache16, cache->fColors[0],
+                        cache->fColors[1], kCache16Count, cache->fCacheDither);
     } else {
-        Rec* rec = cache->fShader.fRecs;
+        const SkFixed* pos = cache->fPos.get();
         int prevIndex = 0;
-        for (int i = 1; i < cache->fShader.fColorCount; i++) {
-            int nextIndex = SkFixedToFFFF(rec[i].fPos) >> kCache16Shift;
+        for (int i = 1; i < cache->fColorCount; i++) {
+            int nextIndex = SkFixedToFFFF(pos[i]) >> kCache16Shift;
             SkASSERT(nextIndex < kCache16Count);
 
             if (nextIndex > prevIndex)
-                Build16bitCache(cache->fCache16 + prevIndex, cache->fShader.fOrigColors[i-1],
-                                cache->fShader.fOrigColors[i], nextIndex - prevIndex + 1,
+                Build16bitCache(cache->fCache16 + prevIndex, cache->fColors[i-1],
+                                cache->fColors[i], nextIndex - prevIndex + 1,
                                 cache->fCacheDither);
             prevIndex = nextIndex;
         }
@@ -588,26 +611,129 @@ void SkGradientShaderBase::GradientShaderCache::initCache32(GradientShaderCache*
     SkASSERT(nullptr == cache->fCache32PixelRef);
     cache->fCache32PixelRef = SkMallocPixelRef::NewAllocate(info, 0, nullptr);
     cache->fCache32 = (SkPMColor*)cache->fCache32PixelRef->getAddr();
-    if (cache->fShader.fColorCount == 2) {
-        Build32bitCache(cache->fCache32, cache->fShader.fOrigColors[0],
-                        cache->fShader.fOrigColors[1], kCache32Count, cache->fCacheAlpha,
-                        cache->fShader.fGradFlags, cache->fCacheDither);
+    if (cache->fColorCount == 2) {
+        Build32bitCache(cache->fCache32, cache->fColors[0],
+                        cache->fColors[1], kCache32Count, cache->fCacheAlpha,
+                        cache->fGradFlags, cache->fCacheDither);
     } else {
-        Rec* rec = cache->fShader.fRecs;
+        const SkFixed* pos = cache->fPos.get();
         int prevIndex = 0;
-        for (int i = 1; i < cache->fShader.fColorCount; i++) {
-            int nextIndex = SkFixedToFFFF(rec[i].fPos) >> kCache32Shift;
+        for (int i = 1; i < cache->fColorCount; i++) {
+            int nextIndex = SkFixedToFFFF(pos[i]) >> kCache32Shift;
             SkASSERT(nextIndex < kCache32Count);
 
             if (nextIndex > prevIndex)
-                Build32bitCache(cache->fCache32 + prevIndex, cache->fShader.fOrigColors[i-1],
-                                cache->fShader.fOrigColors[i], nextIndex - prevIndex + 1,
-                                cache->fCacheAlpha, cache->fShader.fGradFlags, cache->fCacheDither);
+                Build32bitCache(cache->fCache32 + prevIndex, cache->fColors[i-1],
+                                cache->fColors[i], nextIndex - prevIndex + 1,
+                                cache->fCacheAlpha, cache->fGradFlags, cache->fCacheDither);
             prevIndex = nextIndex;
         }
     }
 }
 
+namespace {
+static unsigned gGradientCacheKeyNamespaceLabel;
+
+struct GradientCacheKey : public SkResourceCache::Key {
+public:
+    // Gradients with more stops than this are not shared.
+    static const int kMaxStops = 16;
+
+    GradientCacheKey(U8CPU alpha, bool dither, uint32_t gradFlags,
+                     const SkColor colors[], const SkFixed pos[], int count)
+        : fAlphaAndDither(alpha | (dither << 8))
+        , fGradFlags(gradFlags)
+        , fCount(count) {
+        SkASSERT(count >= 2 && count <= kMaxStops);
+
+        for (int i = 0; i < count; ++i) {
+            fStops[i].fColor = colors[i];
+            // Two-stop tables only depend on the colors.
+            fStops[i].fPos = pos ? pos[i] : 0;
+        }
+
+        // Only the used stops are part of the key.
+        this->init(&gGradientCacheKeyNamespaceLabel, 0,
+                   sizeof(fAlphaAndDither) + sizeof(fGradFlags) + sizeof(fCount) +
+                   count * sizeof(Stop));
+    }
+
+private:
+    struct Stop {
+        SkColor fColor;
+        SkFixed fPos;
+    };
+
+    uint32_t fAlphaAndDither;
+    uint32_t fGradFlags;
+    int32_t  fCount;
+    Stop     fStops[kMaxStops];
+};
+
+struct GradientCacheRec : public SkResourceCache::Rec {
+    GradientCacheRec(const GradientCacheKey& key,
+                     SkGradientShaderBase::GradientShaderCache* cache)
+        : fKey(key)
+        , fCache(SkRef(cache)) {}
+
+    GradientCacheKey                                           fKey;
+    SkAutoTUnref<SkGradientShaderBase::GradientShaderCache>    fCache;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override {
+        // Account for the tables up front, since they are built lazily: 4 rows of 32bit
+        // entries and 2 rows of 16bit entries.
+        return sizeof(*this) + sizeof(SkGradientShaderBase::GradientShaderCache)
+             + SkGradientShaderBase::kCache32Count * 4 * sizeof(SkPMColor)
+             + SkGradientShaderBase::kCache16Count * 2 * sizeof(uint16_t);
+    }
+    const char* getCategory() const override { return "gradient-cache"; }
+    SkDiscardableMemory* diagnostic_only_getDiscardable() const override { return nullptr; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextCache) {
+        const GradientCacheRec& rec = static_cast<const GradientCacheRec&>(baseRec);
+        SkAutoTUnref<SkGradientShaderBase::GradientShaderCache>* result =
+            reinterpret_cast<SkAutoTUnref<SkGradientShaderBase::GradientShaderCache>*>(
+                contextCache);
+
+        result->reset(SkRef(rec.fCache.get()));
+
+        // The tables are owned by the cache object, so they can't be purged from under us.
+        return true;
+    }
+};
+
+} // namespace
+
+/*
+ *  Identical gradients (same stops, flags, alpha and dither) share one cache through
+ *  SkResourceCache, so recreating a gradient doesn't rebuild its tables.
+ */
+SkGradientShaderBase::GradientShaderCache* SkGradientShaderBase::refSharedCache(U8CPU alpha,
+                                                                                bool dither) const {
+    if (fColorCount > GradientCacheKey::kMaxStops) {
+        return new GradientShaderCache(alpha, dither, *this);
+    }
+
+    SkAutoSTMalloc<GradientCacheKey::kMaxStops, SkFixed> pos;
+    if (fColorCount > 2) {
+        pos.reset(fColorCount);
+        for (int i = 0; i < fColorCount; ++i) {
+            pos[i] = fRecs[i].fPos;
+        }
+    }
+
+    const GradientCacheKey key(alpha, dither, fGradFlags, fOrigColors,
+                               fColorCount > 2 ? pos.get() : nullptr, fColorCount);
+    SkAutoTUnref<GradientShaderCache> cache;
+    if (!SkResourceCache::Find(key, GradientCacheRec::Visitor, &cache)) {
+        cache.reset(new GradientShaderCache(alpha, dither, *this));
+        SkResourceCache::Add(new GradientCacheRec(key, cache));
+    }
+
+    return cache.release();
+}
+
 /*
  *  The gradient holds a cache for the most recent value of alpha. Successive
  *  callers with the same alpha value will share the same cache.
@@ -616,7 +742,7 @@ SkGradientShaderBase::GradientShaderCache* SkGradientShaderBase::refCache(U8CPU
                                                                           bool dither) const {
     SkAutoMutexAcquire ama(fCacheMutex);
     if (!fCache || fCache->getAlpha() != alpha || fCache->getDither() != dither) {
-        fCache.reset(new GradientShaderCache(alpha, dither, *this));
+        fCache.reset(this->refSharedCache(alpha, dither));
     }
     // Increment the ref counter inside the mutex to ensure the returned pointer is still valid.
     // Otherwise, the pointer may have been overwritten on a different thread before the object's
@@ -114,6 +114,8 @@ public:
     virtual ~SkGradientShaderBase();
 
     // The cache is initialized on-demand when getCache16/32 is called.
+    // Caches are shared (via SkResourceCache) between shaders with identical color stops, so
+    // they keep their own copy of the stops rather than referencing the shader.
     class GradientShaderCache : public SkRefCnt {
     public:
         GradientShaderCache(U8CPU alpha, bool dither, const SkGradientShaderBase& shader);
@@ -139,7 +141,10 @@ public:
                                               // value.
         const bool        fCacheDither;       // The dither flag used when we computed the cache.
 
-        const SkGradientShaderBase& fShader;
+        const int                 fColorCount;
+        const uint32_t            fGradFlags;
+        SkAutoSTMalloc<8, SkColor> fColors;
+        SkAutoSTMalloc<8, SkFixed> fPos;        // Only valid when fColorCount > 2.
 
         // Make sure we only initialize the caches once.
         SkOnce fCache16InitOnce,
@@ -210,9 +215,17 @@ public:
 
     uint32_t getGradFlags() const { return fGradFlags; }
 
+    enum {
+        // Temp flag for testing the 4f impl.
+        kForce4fContext_PrivateFlag     = 1 << 7,
+    };
+
 protected:
     class GradientShaderBase4fContext;
 
+    // Returns true if the 4f context should be used for the given rec/flags.
+    static bool Use4fContext(const ContextRec&, uint32_t gradFlags);
+
     SkGradientShaderBase(SkReadBuffer& );
     void flatten(SkWriteBuffer&) const override;
     SK_TO_STRING_OVERRIDE()
@@ -261,9 +274,12 @@ private:
     bool        fColorsAreOpaque;
 
     GradientShaderCache* refCache(U8CPU alpha, bool dither) const;
+    GradientShaderCache* refSharedCache(U8CPU alpha, bool dither) const;
     mutable SkMutex                           fCacheMutex;
     mutable SkAutoTUnref<GradientShaderCache> fCache;
 
+    friend class GradientCacheTest;
+
     void initCommon();
 
     typedef SkShader INHERITED;
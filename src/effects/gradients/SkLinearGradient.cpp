@@ -9,9 +9,6 @@
 #include "SkLinearGradient.h"
 #include "SkRefCnt.h"
 
-// define to test the 4f gradient path
-// #define FORCE_4F_CONTEXT
-
 static const float kInv255Float = 1.0f / 255;
 
 static inline int repeat_8bits(int x) {
@@ -38,15 +35,6 @@ static SkMatrix pts_to_unit_matrix(const SkPoint pts[2]) {
     return matrix;
 }
 
-static bool use_4f_context(const SkShader::ContextRec& rec, uint32_t flags) {
-#ifdef FORCE_4F_CONTEXT
-    return true;
-#else
-    return rec.fPreferredDstType == SkShader::ContextRec::kPM4f_DstType
-        || SkToBool(flags & SkLinearGradient::kForce4fContext_PrivateFlag);
-#endif
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 
 SkLinearGradient::SkLinearGradient(const SkPoint pts[2], const Descriptor& desc)
@@ -74,13 +62,13 @@ void SkLinearGradient::flatten(SkWriteBuffer& buffer) const {
 }
 
 size_t SkLinearGradient::onContextSize(const ContextRec& rec) const {
-    return use_4f_context(rec, fGradFlags)
+    return Use4fContext(rec, fGradFlags)
         ? sizeof(LinearGradient4fContext)
         : sizeof(LinearGradientContext);
 }
 
 SkShader::Context* SkLinearGradient::onCreateContext(const ContextRec& rec, void* storage) const {
-    return use_4f_context(rec, fGradFlags)
+    return Use4fContext(rec, fGradFlags)
         ? static_cast<SkShader::Context*>(new (storage) LinearGradient4fContext(*this, rec))
         : static_cast<SkShader::Context*>(new (storage) LinearGradientContext(*this, rec));
 }
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "Sk4fGradientBase.h"
 #include "SkRadialGradient.h"
 #include "SkNx.h"
 
@@ -39,12 +40,36 @@ SkRadialGradient::SkRadialGradient(const SkPoint& center, SkScalar radius, const
     , fRadius(radius) {
 }
 
-size_t SkRadialGradient::onContextSize(const ContextRec&) const {
-    return sizeof(RadialGradientContext);
+class SkRadialGradient::
+RadialGradient4fContext final : public GradientShaderBase4fContext {
+public:
+    RadialGradient4fContext(const SkRadialGradient& shader, const ContextRec& rec)
+        : INHERITED(shader, rec) {
+        this->buildIntervals(shader, rec, false);
+    }
+
+protected:
+    void mapTs(int x, int y, SkScalar ts[], int count) const override {
+        // The unit matrix maps the radius to 1, so t is simply the distance to the center.
+        this->mapTs4(x, y, ts, count, [](const Sk4f& xs, const Sk4f& ys) {
+            return (xs * xs + ys * ys).sqrt();
+        });
+    }
+
+private:
+    using INHERITED = GradientShaderBase4fContext;
+};
+
+size_t SkRadialGradient::onContextSize(const ContextRec& rec) const {
+    return Use4fContext(rec, fGradFlags)
+        ? sizeof(RadialGradient4fContext)
+        : sizeof(RadialGradientContext);
 }
 
 SkShader::Context* SkRadialGradient::onCreateContext(const ContextRec& rec, void* storage) const {
-    return new (storage) RadialGradientContext(*this, rec);
+    return Use4fContext(rec, fGradFlags)
+        ? static_cast<SkShader::Context*>(new (storage) RadialGradient4fContext(*this, rec))
+        : static_cast<SkShader::Context*>(new (storage) RadialGradientContext(*this, rec));
 }
 
 SkRadialGradient::RadialGradientContext::RadialGradientContext(
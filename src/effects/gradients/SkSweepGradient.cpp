@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "Sk4fGradientBase.h"
 #include "SkSweepGradient.h"
 
 static SkMatrix translate(SkScalar dx, SkScalar dy) {
@@ -44,12 +45,60 @@ void SkSweepGradient::flatten(SkWriteBuffer& buffer) const {
     buffer.writePoint(fCenter);
 }
 
-size_t SkSweepGradient::onContextSize(const ContextRec&) const {
-    return sizeof(SweepGradientContext);
+// Vectorized atan2(y, x) / 2PI, mapped to [0..1).
+//
+// Uses a minimax polynomial approximation of atan() on [0..1] (max error ~1e-5 rad, well below
+// the 1/256 quantization of the legacy table lookup), followed by octant reconstruction.
+static Sk4f sweep_t(const Sk4f& y, const Sk4f& x) {
+    static const float kInv2PI = 0.159154943f;
+
+    const Sk4f ax = x.abs(),
+               ay = y.abs();
+    const Sk4f mx = Sk4f::Max(ax, ay),
+               mn = Sk4f::Min(ax, ay);
+    // atan(a) for a in [0..1], pre-scaled by 1/2PI; a = 0 for the degenerate (0, 0) point.
+    const Sk4f a = (mx == Sk4f(0)).thenElse(Sk4f(0), mn / mx);
+    const Sk4f s = a * a;
+    Sk4f t = (((s * (-0.0464964749f * kInv2PI) + 0.15931422f * kInv2PI) * s
+                   - 0.327622764f * kInv2PI) * s + kInv2PI) * a;
+
+    t = (ay > ax).thenElse(0.25f - t, t);
+    t = (x < Sk4f(0)).thenElse(0.5f - t, t);
+    t = (y < Sk4f(0)).thenElse(1.0f - t, t);
+
+    // Snap the 1.0 edge (y == -0) back to the start of the range.
+    return (t >= Sk4f(1)).thenElse(Sk4f(0), t);
+}
+
+class SkSweepGradient::
+SweepGradient4fContext final : public GradientShaderBase4fContext {
+public:
+    SweepGradient4fContext(const SkSweepGradient& shader, const ContextRec& rec)
+        : INHERITED(shader, rec) {
+        this->buildIntervals(shader, rec, false);
+    }
+
+protected:
+    void mapTs(int x, int y, SkScalar ts[], int count) const override {
+        this->mapTs4(x, y, ts, count, [](const Sk4f& xs, const Sk4f& ys) {
+            return sweep_t(ys, xs);
+        });
+    }
+
+private:
+    using INHERITED = GradientShaderBase4fContext;
+};
+
+size_t SkSweepGradient::onContextSize(const ContextRec& rec) const {
+    return Use4fContext(rec, fGradFlags)
+        ? sizeof(SweepGradient4fContext)
+        : sizeof(SweepGradientContext);
 }
 
 SkShader::Context* SkSweepGradient::onCreateContext(const ContextRec& rec, void* storage) const {
-    return new (storage) SweepGradientContext(*this, rec);
+    return Use4fContext(rec, fGradFlags)
+        ? static_cast<SkShader::Context*>(new (storage) SweepGradient4fContext(*this, rec))
+        : static_cast<SkShader::Context*>(new (storage) SweepGradientContext(*this, rec));
 }
 
 SkSweepGradient::SweepGradientContext::SweepGradientContext(
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "Sk4fGradientBase.h"
 #include "SkTwoPointConicalGradient.h"
 #include "SkTwoPointConicalGradient_gpu.h"
 
@@ -211,13 +212,82 @@ bool SkTwoPointConicalGradient::isOpaque() const {
     return false;
 }
 
-size_t SkTwoPointConicalGradient::onContextSize(const ContextRec&) const {
-    return sizeof(TwoPointConicalGradientContext);
+// Vectorized equivalent of TwoPtRadialContext::nextT(): solves the quadratic for four
+// points at a time, and yields NaN for the points which should not be drawn.
+static Sk4f twopoint_t(const TwoPtRadial& rec, const Sk4f& x, const Sk4f& y) {
+    const Sk4f relX = x - rec.fCenterX,
+               relY = y - rec.fCenterY;
+    const Sk4f B = (relX * rec.fDCenterX + relY * rec.fDCenterY + rec.fRDR) * -2,
+               C = relX * relX + relY * relY - rec.fRadius2;
+
+    Sk4f t, valid;
+    if (rec.fA == 0) {
+        valid = B != Sk4f(0);
+        t = (Sk4f(0) - C) / B;
+    } else {
+        const Sk4f R = B * B - C * (4 * rec.fA);
+        valid = R >= Sk4f(0);
+
+        const Sk4f sqrtR = R.sqrt();
+        const Sk4f Q = (B < Sk4f(0)).thenElse(B - sqrtR, B + sqrtR) * -0.5f;
+        const Sk4f Qzero = Q == Sk4f(0);
+        const Sk4f r0 = Qzero.thenElse(Sk4f(0), Q / rec.fA),
+                   r1 = Qzero.thenElse(Sk4f(0), C / Q);
+
+        // Prefer the bigger t value (smaller if flipped) if both give a radius(t) >= 0.
+        const Sk4f tmin = Sk4f::Min(r0, r1),
+                   tmax = Sk4f::Max(r0, r1);
+        const Sk4f t0 = rec.fFlipped ? tmin : tmax,
+                   t1 = rec.fFlipped ? tmax : tmin;
+        t = (t0 * rec.fDRadius + rec.fRadius >= Sk4f(0)).thenElse(t0, t1);
+    }
+
+    // Keep t within the legacy (fixed point) range.
+    t = Sk4f::Min(Sk4f::Max(t, Sk4f(-32767)), Sk4f(32767));
+    t = valid.thenElse(t, Sk4f(SK_ScalarNaN));
+
+    // NaN fails the radius test too, so it stays NaN.
+    return (t * rec.fDRadius + rec.fRadius >= Sk4f(0)).thenElse(t, Sk4f(SK_ScalarNaN));
+}
+
+class SkTwoPointConicalGradient::
+TwoPointConical4fContext final : public GradientShaderBase4fContext {
+public:
+    TwoPointConical4fContext(const SkTwoPointConicalGradient& shader, const ContextRec& rec)
+        : INHERITED(shader, rec)
+        , fRec(shader.fRec) {
+        // in general, we might discard based on computed-radius, so clear
+        // this flag (todo: sometimes we can detect that we never discard...)
+        fFlags &= ~kOpaqueAlpha_Flag;
+
+        this->buildIntervals(shader, rec, false);
+    }
+
+protected:
+    void mapTs(int x, int y, SkScalar ts[], int count) const override {
+        this->mapTs4(x, y, ts, count, [this](const Sk4f& xs, const Sk4f& ys) {
+            return twopoint_t(fRec, xs, ys);
+        });
+    }
+
+private:
+    using INHERITED = GradientShaderBase4fContext;
+
+    const TwoPtRadial& fRec;
+};
+
+size_t SkTwoPointConicalGradient::onContextSize(const ContextRec& rec) const {
+    return Use4fContext(rec, fGradFlags)
+        ? sizeof(TwoPointConical4fContext)
+        : sizeof(TwoPointConicalGradientContext);
 }
 
 SkShader::Context* SkTwoPointConicalGradient::onCreateContext(const ContextRec& rec,
                                                               void* storage) const {
-    return new (storage) TwoPointConicalGradientContext(*this, rec);
+    return Use4fContext(rec, fGradFlags)
+        ? static_cast<SkShader::Context*>(new (storage) TwoPointConical4fContext(*this, rec))
+        : static_cast<SkShader::Context*>(new (storage) TwoPointConicalGradientContext(*this,
+                                                                                        rec));
 }
 
 SkTwoPointConicalGradient::TwoPointConicalGradientContext::TwoPointConicalGradientContext(
@@ -5,16 +5,17 @@
  * found in the LICENSE file.
  */
 
+#include "SkChecksum.h"
 #include "SkFontConfigInterface.h"
 #include "SkFontConfigTypeface.h"
 #include "SkFontDescriptor.h"
 #include "SkFontMgr.h"
+#include "SkFontRequestCache.h"
 #include "SkFontStyle.h"
 #include "SkMutex.h"
 #include "SkString.h"
 #include "SkTypeface.h"
 #include "SkTypefaceCache.h"
-#include "SkResourceCache.h"
 
 SkStreamAsset* SkTypeface_FCI::onOpenStream(int* ttcIndex) const {
     *ttcIndex =  this->getIdentity().fTTCIndex;
@@ -48,84 +49,6 @@ public:
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class SkFontRequestCache {
-public:
-    struct Request : public SkResourceCache::Key {
-    private:
-        Request(const char* name, size_t nameLen, const SkFontStyle& style) : fStyle(style) {
-            /** Pointer to just after the last field of this class. */
-            char* content = const_cast<char*>(SkTAfter<const char>(&this->fStyle));
-
-            // No holes.
-            SkASSERT(SkTAddOffset<char>(this, sizeof(SkResourceCache::Key) + keySize) == content);
-
-            // Has a size divisible by size of uint32_t.
-            SkASSERT((content - reinterpret_cast<char*>(this)) % sizeof(uint32_t) == 0);
-
-            size_t contentLen = SkAlign4(nameLen);
-            sk_careful_memcpy(content, name, nameLen);
-            sk_bzero(content + nameLen, contentLen - nameLen);
-            this->init(nullptr, 0, keySize + contentLen);
-        }
-        const SkFontStyle fStyle;
-        /** The sum of the sizes of the fields of this class. */
-        static const size_t keySize = sizeof(fStyle);
-
-    public:
-        static Request* Create(const char* name, const SkFontStyle& style) {
-            size_t nameLen = name ? strlen(name) : 0;
-            size_t contentLen = SkAlign4(nameLen);
-            char* storage = new char[sizeof(Request) + contentLen];
-            return new (storage) Request(name, nameLen, style);
-        }
-        void operator delete(void* storage) {
-            delete[] reinterpret_cast<char*>(storage);
-        }
-    };
-
-
-private:
-    struct Result : public SkResourceCache::Rec {
-        Result(Request* request, SkTypeface* typeface)
-            : fRequest(request)
-            , fFace(SkSafeRef(typeface)) {}
-        Result(Result&&) = default;
-        Result& operator=(Result&&) = default;
-
-        const Key& getKey() const override { return *fRequest; }
-        size_t bytesUsed() const override { return fRequest->size() + sizeof(fFace); }
-        const char* getCategory() const override { return "request_cache"; }
-        SkDiscardableMemory* diagnostic_only_getDiscardable() const override { return nullptr; }
-
-        SkAutoTDelete<Request> fRequest;
-        SkAutoTUnref<SkTypeface> fFace;
-    };
-
-    SkResourceCache fCachedResults;
-
-public:
-    SkFontRequestCache(size_t maxSize) : fCachedResults(maxSize) {}
-
-    /** Takes ownership of request. It will be deleted when no longer needed. */
-    void add(SkTypeface* face, Request* request) {
-        fCachedResults.add(new Result(request, face));
-    }
-    /** Does not take ownership of request. */
-    SkTypeface* findAndRef(Request* request) {
-        SkTypeface* face = nullptr;
-        fCachedResults.find(*request, [](const SkResourceCache::Rec& rec, void* context) -> bool {
-            const Result& result = static_cast<const Result&>(rec);
-            SkTypeface** face = static_cast<SkTypeface**>(context);
-
-            *face = result.fFace;
-            return true;
-        }, &face);
-        return SkSafeRef(face);
-    }
-};
-
-///////////////////////////////////////////////////////////////////////////////
-
 static bool find_by_FontIdentity(SkTypeface* cachedTypeface, void* ctx) {
     typedef SkFontConfigInterface::FontIdentity FontIdentity;
     SkTypeface_FCI* cachedFCTypeface = static_cast<SkTypeface_FCI*>(cachedTypeface);
@@ -134,6 +57,10 @@ static bool find_by_FontIdentity(SkTypeface* cachedTypeface, void* ctx) {
     return cachedFCTypeface->getIdentity() == *identity;
 }
 
+static uint32_t hash_FontIdentity(const SkFontConfigInterface::FontIdentity& identity) {
+    return SkChecksum::Mix(identity.fID) ^ SkChecksum::Mix(identity.fTTCIndex);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class SkFontMgr_FCI : public SkFontMgr {
@@ -218,9 +145,9 @@ protected:
         // Check if this request is already in the request cache.
         using Request = SkFontRequestCache::Request;
         SkAutoTDelete<Request> request(Request::Create(requestedFamilyName, requestedStyle));
-        SkTypeface* face = fCache.findAndRef(request);
-        if (face) {
-            return face;
+        sk_sp<SkTypeface> cached;
+        if (fCache.find(*request, &cached)) {
+            return cached.release();
         }
 
         SkFontConfigInterface::FontIdentity identity;
@@ -233,11 +160,12 @@ protected:
         }
 
         // Check if a typeface with this FontIdentity is already in the FontIdentity cache.
-        face = fTFCache.findByProcAndRef(find_by_FontIdentity, &identity);
+        const uint32_t identityHash = hash_FontIdentity(identity);
+        SkTypeface* face = fTFCache.findByProcAndRef(identityHash, find_by_FontIdentity, &identity);
         if (!face) {
             face = SkTypeface_FCI::Create(fFCI, identity, outFamilyName, outStyle);
             // Add this FontIdentity to the FontIdentity cache.
-            fTFCache.add(face);
+            fTFCache.add(face, identityHash);
         }
         // Add this request to the request cache.
         fCache.add(face, request.release());
@@ -170,6 +170,28 @@ void GrAtlasTextBlob::regenInBatch(GrDrawBatch::Target* target,
         } else {
             strike = info->strike();
         }
+
+        // Make the images of the glyphs that may need uploading together, before the first
+        // is added to the atlas.
+        SkGlyphCache* cache = lazyCache->get();
+        SkSTArray<64, const SkGlyph*, true> skGlyphs;
+        uint32_t generation;
+        do {
+            // Finding a glyph new to the strike may move the others, so look again until none
+            // was new.
+            generation = cache->getGeneration();
+            skGlyphs.reset();
+            for (int glyphIdx = 0; glyphIdx < glyphCount; glyphIdx++) {
+                GrGlyph* glyph = fGlyphs[glyphIdx + info->glyphStartIndex()];
+                if (regenGlyphs || !fontCache->hasGlyph(glyph)) {
+                    GrGlyph::PackedID id = glyph->fPackedID;
+                    skGlyphs.push_back(&cache->getGlyphIDMetrics(GrGlyph::UnpackID(id),
+                                                                 GrGlyph::UnpackFixedX(id),
+                                                                 GrGlyph::UnpackFixedY(id)));
+                }
+            }
+        } while (cache->getGeneration() != generation);
+        cache->findImages(skGlyphs.begin(), skGlyphs.count());
     }
 
     bool brokenRun = false;
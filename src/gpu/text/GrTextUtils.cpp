@@ -58,10 +58,13 @@ void GrTextUtils::DrawBmpText(GrAtlasTextBlob* blob, int runIndex,
 
     SkGlyphCache* cache = blob->setupCache(runIndex, props, scalerContextFlags, skPaint,
                                            &viewMatrix);
+    // Place every glyph first, so that the images missing from the strike are made together.
+    SkFindAndPlaceGlyph::ImageBatch batch(cache);
     SkFindAndPlaceGlyph::ProcessText(
         skPaint.getTextEncoding(), text, byteLength,
         {x, y}, viewMatrix, skPaint.getTextAlign(),
-        cache,
+        cache, batch);
+    batch.flush(
         [&](const SkGlyph& glyph, SkPoint position, SkPoint rounding) {
             position += rounding;
             BmpAppendGlyph(
@@ -98,10 +101,12 @@ void GrTextUtils::DrawBmpPosText(GrAtlasTextBlob* blob, int runIndex,
     SkGlyphCache* cache = blob->setupCache(runIndex, props, scalerContextFlags, skPaint,
                                            &viewMatrix);
 
+    SkFindAndPlaceGlyph::ImageBatch batch(cache);
     SkFindAndPlaceGlyph::ProcessPosText(
         skPaint.getTextEncoding(), text, byteLength,
         offset, viewMatrix, pos, scalarsPerPosition,
-        skPaint.getTextAlign(), cache,
+        skPaint.getTextAlign(), cache, batch);
+    batch.flush(
         [&](const SkGlyph& glyph, SkPoint position, SkPoint rounding) {
             position += rounding;
             BmpAppendGlyph(
@@ -349,6 +354,22 @@ void GrTextUtils::DrawDFPosText(GrAtlasTextBlob* blob, int runIndex,
 
     const char* stop = text + byteLength;
 
+    // Make the images missing from the strike together, before the glyphs are appended.
+    {
+        SkSTArray<64, const SkGlyph*, true> glyphs;
+        uint32_t generation;
+        do {
+            // Finding a glyph new to the strike may move the others, so look again until none
+            // was new.
+            generation = cache->getGeneration();
+            glyphs.reset();
+            for (const char* cursor = text; cursor < stop;) {
+                glyphs.push_back(&glyphCacheProc(cache, &cursor));
+            }
+        } while (cache->getGeneration() != generation);
+        cache->findImages(glyphs.begin(), glyphs.count());
+    }
+
     if (SkPaint::kLeft_Align == dfPaint.getTextAlign()) {
         while (text < stop) {
             const char* lastText = text;
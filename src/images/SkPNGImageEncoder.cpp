@@ -6,18 +6,26 @@
  */
 
 #include "SkImageEncoder.h"
+#include "SkAtomics.h"
 #include "SkColor.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
 #include "SkMath.h"
 #include "SkRTConf.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 #include "transform_scanline.h"
 
 #include "png.h"
 
+#ifdef ZLIB_INCLUDE
+    #include ZLIB_INCLUDE
+#else
+    #include "zlib.h"
+#endif
+
 /* These were dropped in libpng >= 1.4 */
 #ifndef png_infopp_NULL
 #define png_infopp_NULL nullptr
@@ -162,7 +170,293 @@ static inline int pack_palette(SkColorTable* ctable,
     return num_trans;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Parallel IDAT encoding.  Each strip of rows is filtered and deflated on its own,
+// primed with the last 32K of the previous strip's filtered bytes as its dictionary.
+// Every strip but the last ends with a sync flush, which leaves the raw deflate data
+// byte aligned and without a final block, so the strips can simply be concatenated
+// behind one zlib header and followed by the combined adler32.
+
+// Keep strips large enough that the flush and dictionary overhead stays small, and
+// small enough that we only ever hold a few of them at once.
+static constexpr size_t kMinStripBytes = 256 * 1024;
+static constexpr size_t kMaxStripBytes = 4 * 1024 * 1024;
+static constexpr size_t kDeflateWindowBytes = 32 * 1024;
+
+static int zlib_strategy(SkPNGEncoderOptions::ZLibStrategy strategy, bool filtered) {
+    switch (strategy) {
+        case SkPNGEncoderOptions::kFiltered_ZLibStrategy:
+            return Z_FILTERED;
+        case SkPNGEncoderOptions::kHuffmanOnly_ZLibStrategy:
+            return Z_HUFFMAN_ONLY;
+        case SkPNGEncoderOptions::kRLE_ZLibStrategy:
+            return Z_RLE;
+        case SkPNGEncoderOptions::kFixed_ZLibStrategy:
+            return Z_FIXED;
+        default:
+            // Match libpng, which prefers Z_FILTERED whenever rows are filtered.
+            return filtered ? Z_FILTERED : Z_DEFAULT_STRATEGY;
+    }
+}
+
+static inline uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = SkTAbs(p - a);
+    int pb = SkTAbs(p - b);
+    int pc = SkTAbs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+/*  Write the filter type byte for 'filter' (one of the PNG_FILTER_VALUE_ values),
+    followed by the filtered 'row', into 'dst'. 'prev' is the unfiltered row above.
+*/
+static void filter_row(int filter, const uint8_t* SK_RESTRICT row,
+                       const uint8_t* SK_RESTRICT prev, int rowBytes, int bpp,
+                       uint8_t* SK_RESTRICT dst) {
+    *dst++ = filter;
+    int i = 0;
+    switch (filter) {
+        case PNG_FILTER_VALUE_SUB:
+            for (; i < bpp; i++) { dst[i] = row[i]; }
+            for (; i < rowBytes; i++) { dst[i] = row[i] - row[i - bpp]; }
+            break;
+        case PNG_FILTER_VALUE_UP:
+            for (; i < rowBytes; i++) { dst[i] = row[i] - prev[i]; }
+            break;
+        case PNG_FILTER_VALUE_AVG:
+            for (; i < bpp; i++) { dst[i] = row[i] - (prev[i] >> 1); }
+            for (; i < rowBytes; i++) { dst[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1); }
+            break;
+        case PNG_FILTER_VALUE_PAETH:
+            for (; i < bpp; i++) { dst[i] = row[i] - prev[i]; }
+            for (; i < rowBytes; i++) {
+                dst[i] = row[i] - paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+            }
+            break;
+        default:
+            memcpy(dst, row, rowBytes);
+            break;
+    }
+}
+
+// The same "minimum sum of absolute differences" heuristic that libpng uses.
+static uint32_t filter_cost(const uint8_t* filtered, int rowBytes) {
+    uint32_t cost = 0;
+    for (int i = 1; i <= rowBytes; i++) {
+        cost += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    }
+    return cost;
+}
+
+/*  Filter 'row' with whichever of the allowed filters looks cheapest to compress,
+    writing rowBytes + 1 bytes to 'dst'. 'scratch' must be just as large.
+*/
+static void filter_best_row(int filterFlags, const uint8_t* row, const uint8_t* prev,
+                            int rowBytes, int bpp, uint8_t* dst, uint8_t* scratch) {
+    static const int gFilters[] = {
+        PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH,
+    };
+
+    int onlyFilter = -1;
+    int filterCount = 0;
+    for (int i = 0; i < (int)SK_ARRAY_COUNT(gFilters); i++) {
+        if (filterFlags & gFilters[i]) {
+            onlyFilter = i;
+            filterCount++;
+        }
+    }
+    if (filterCount <= 1) {
+        filter_row(filterCount ? onlyFilter : PNG_FILTER_VALUE_NONE, row, prev, rowBytes, bpp,
+                   dst);
+        return;
+    }
+
+    uint32_t bestCost = 0xFFFFFFFF;
+    uint8_t* best = nullptr;
+    for (int i = 0; i < (int)SK_ARRAY_COUNT(gFilters); i++) {
+        if (filterFlags & gFilters[i]) {
+            uint8_t* candidate = (best == dst) ? scratch : dst;
+            filter_row(i, row, prev, rowBytes, bpp, candidate);
+            uint32_t cost = filter_cost(candidate, rowBytes);
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = candidate;
+            }
+        }
+    }
+    if (best != dst) {
+        memcpy(dst, best, rowBytes + 1);
+    }
+}
+
+namespace {
+
+struct PNGStripInfo {
+    const SkBitmap*            fBitmap;
+    transform_scanline_proc    fProc;
+    int                        fRowBytes;   // bytes in one unfiltered png row
+    int                        fBpp;        // bytes per complete pixel, as png filters see it
+    int                        fFilterFlags;
+    int                        fLevel;
+    int                        fStrategy;
+};
+
+struct PNGStrip {
+    sk_sp<SkData> fData;
+    uLong         fAdler;
+    size_t        fLength;                 // filtered (uncompressed) bytes in the strip
+};
+
+}  // namespace
+
+/*  Filter and deflate rows [startY, stopY), storing raw deflate data in strip->fData.
+    Returns false if zlib fails.
+*/
+static bool encode_strip(const PNGStripInfo& info, int startY, int stopY, bool isLast,
+                         PNGStrip* strip) {
+    const SkBitmap& bitmap = *info.fBitmap;
+    const int rowBytes = info.fRowBytes;
+    const size_t filteredRowBytes = rowBytes + 1;
+
+    SkAutoTMalloc<uint8_t> rowStorage(2 * rowBytes + 2 * filteredRowBytes);
+    uint8_t* prev = rowStorage.get();
+    uint8_t* curr = prev + rowBytes;
+    uint8_t* filtered = curr + rowBytes;
+    uint8_t* scratch = filtered + filteredRowBytes;
+
+    auto transform = [&](int y, uint8_t* dst) {
+        info.fProc((const char*)bitmap.getAddr(0, y), bitmap.width(), (char*)dst);
+    };
+    auto filter = [&](int y) {
+        transform(y, curr);
+        filter_best_row(info.fFilterFlags, curr, prev, rowBytes, info.fBpp, filtered, scratch);
+        SkTSwap(prev, curr);
+    };
+
+    // Re-filter the rows that end the previous strip to rebuild its window.
+    const int dictRows = SkTMin<int>(startY, SkToInt((kDeflateWindowBytes + filteredRowBytes - 1)
+                                                     / filteredRowBytes));
+    const int firstY = startY - dictRows;
+    if (firstY > 0) {
+        transform(firstY - 1, prev);
+    } else {
+        memset(prev, 0, rowBytes);
+    }
+    SkAutoTMalloc<uint8_t> dict(dictRows * filteredRowBytes);
+    for (int y = firstY; y < startY; y++) {
+        filter(y);
+        memcpy(dict.get() + (y - firstY) * filteredRowBytes, filtered, filteredRowBytes);
+    }
+
+    z_stream zstream;
+    memset(&zstream, 0, sizeof(zstream));
+    if (Z_OK != deflateInit2(&zstream, info.fLevel, Z_DEFLATED, -MAX_WBITS, 8, info.fStrategy)) {
+        return false;
+    }
+    if (dictRows > 0) {
+        const size_t dictBytes = SkTMin(dictRows * filteredRowBytes, kDeflateWindowBytes);
+        const uint8_t* dictStart = dict.get() + dictRows * filteredRowBytes - dictBytes;
+        if (Z_OK != deflateSetDictionary(&zstream, dictStart, SkToUInt(dictBytes))) {
+            deflateEnd(&zstream);
+            return false;
+        }
+    }
+
+    SkDynamicMemoryWStream out;
+    uint8_t outBuffer[4096];
+    uLong adler = adler32(0, nullptr, 0);
+    bool success = true;
+    for (int y = startY; y < stopY && success; y++) {
+        filter(y);
+        adler = adler32(adler, filtered, SkToUInt(filteredRowBytes));
+
+        const int flush = (y + 1 < stopY) ? Z_NO_FLUSH : (isLast ? Z_FINISH : Z_SYNC_FLUSH);
+        zstream.next_in = filtered;
+        zstream.avail_in = SkToUInt(filteredRowBytes);
+        do {
+            zstream.next_out = outBuffer;
+            zstream.avail_out = sizeof(outBuffer);
+            int result = deflate(&zstream, flush);
+            if (Z_STREAM_ERROR == result) {
+                success = false;
+                break;
+            }
+            out.write(outBuffer, sizeof(outBuffer) - zstream.avail_out);
+        } while (0 == zstream.avail_out);
+    }
+    deflateEnd(&zstream);
+
+    strip->fData.reset(out.copyToData());
+    strip->fAdler = adler;
+    strip->fLength = (stopY - startY) * filteredRowBytes;
+    return success;
+}
+
+static void write_be32(uint8_t* dst, uint32_t value) {
+    dst[0] = (value >> 24) & 0xFF;
+    dst[1] = (value >> 16) & 0xFF;
+    dst[2] = (value >>  8) & 0xFF;
+    dst[3] = (value >>  0) & 0xFF;
+}
+
+/*  Encode the whole image as IDAT chunks, fThreadCount strips at a time.
+    Returns false if we could not compress the image.
+*/
+static bool write_idat_in_parallel(png_structp png_ptr, const PNGStripInfo& info,
+                                   int rowsPerStrip, int threadCount) {
+    const int height = info.fBitmap->height();
+    const int stripCount = (height + rowsPerStrip - 1) / rowsPerStrip;
+
+    // The zlib header.  FLEVEL is informational, but match what zlib would write.
+    const int levelFlags = (info.fStrategy >= Z_HUFFMAN_ONLY || info.fLevel < 2) ? 0 :
+                           info.fLevel < 6 ? 1 : info.fLevel == 6 ? 2 : 3;
+    uint32_t header = ((Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8) | (levelFlags << 6);
+    header += 31 - (header % 31);
+    const uint8_t zlibHeader[2] = { (uint8_t)(header >> 8), (uint8_t)(header & 0xFF) };
+    png_write_chunk(png_ptr, (png_const_bytep)"IDAT", zlibHeader, sizeof(zlibHeader));
+
+    uLong adler = adler32(0, nullptr, 0);
+    SkAutoTArray<PNGStrip> strips(threadCount);
+    for (int first = 0; first < stripCount; first += threadCount) {
+        const int count = SkTMin(threadCount, stripCount - first);
+        SkAtomic<bool> failed(false);
+        SkTaskGroup().batch(count, [&](int i) {
+            const int startY = (first + i) * rowsPerStrip;
+            const int stopY = SkTMin(startY + rowsPerStrip, height);
+            if (!encode_strip(info, startY, stopY, stopY == height, &strips[i])) {
+                failed.store(true);
+            }
+        });
+        if (failed.load()) {
+            return false;
+        }
+
+        for (int i = 0; i < count; i++) {
+            png_write_chunk(png_ptr, (png_const_bytep)"IDAT",
+                            strips[i].fData->bytes(), strips[i].fData->size());
+            adler = adler32_combine(adler, strips[i].fAdler, strips[i].fLength);
+            strips[i].fData.reset();
+        }
+    }
+
+    uint8_t adlerBytes[4];
+    write_be32(adlerBytes, SkToU32(adler));
+    png_write_chunk(png_ptr, (png_const_bytep)"IDAT", adlerBytes, sizeof(adlerBytes));
+    png_write_chunk(png_ptr, (png_const_bytep)"IEND", nullptr, 0);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 class SkPNGImageEncoder : public SkImageEncoder {
+public:
+    SkPNGImageEncoder(const SkPNGEncoderOptions& options = SkPNGEncoderOptions())
+        : fOptions(options)
+    {}
+
 protected:
     bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) override;
 private:
@@ -171,6 +465,8 @@ private:
                   int bitDepth, SkColorType ct,
                   png_color_8& sig_bit);
 
+    const SkPNGEncoderOptions fOptions;
+
     typedef SkImageEncoder INHERITED;
 };
 
@@ -312,12 +608,44 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
 #ifdef PNG_sBIT_SUPPORTED
     png_set_sBIT(png_ptr, info_ptr, &sig_bit);
 #endif
+
+    // Leave the default filters to libpng, which skips filtering for palette images.
+    const bool isPalette = SkToBool(colorType & PNG_COLOR_MASK_PALETTE);
+    int filterFlags = fOptions.fFilterFlags;
+    if (SkPNGEncoderOptions::kAll_FilterFlag == filterFlags) {
+        filterFlags = isPalette ? PNG_FILTER_NONE : PNG_ALL_FILTERS;
+    } else {
+        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filterFlags);
+    }
+    const int level = SkTPin(fOptions.fZLibLevel, 0, 9);
+    const int strategy = zlib_strategy(fOptions.fZLibStrategy, PNG_FILTER_NONE != filterFlags);
+    png_set_compression_level(png_ptr, level);
+    png_set_compression_strategy(png_ptr, strategy);
+
     png_write_info(png_ptr, info_ptr);
 
+    transform_scanline_proc proc = choose_proc(ct, hasAlpha);
+
+    const int channels = isPalette ? 1 : (colorType & PNG_COLOR_MASK_ALPHA) ? 4 : 3;
+    const int threadCount = fOptions.fThreadCount;
+    const size_t filteredRowBytes = bitmap.width() * channels + 1;
+    const int minRowsPerStrip = SkTMax(SkToInt(kMinStripBytes / filteredRowBytes), 1);
+    const int maxRowsPerStrip = SkTMax(SkToInt(kMaxStripBytes / filteredRowBytes),
+                                       minRowsPerStrip);
+    if (threadCount > 1 && bitmap.height() > minRowsPerStrip) {
+        const int rowsPerStrip = SkTPin((bitmap.height() + threadCount - 1) / threadCount,
+                                        minRowsPerStrip, maxRowsPerStrip);
+        const PNGStripInfo info = {
+            &bitmap, proc, bitmap.width() * channels, channels, filterFlags, level, strategy,
+        };
+        bool success = write_idat_in_parallel(png_ptr, info, rowsPerStrip, threadCount);
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return success;
+    }
+
     const char* srcImage = (const char*)bitmap.getPixels();
     SkAutoSTMalloc<1024, char> rowStorage(bitmap.width() << 2);
     char* storage = rowStorage.get();
-    transform_scanline_proc proc = choose_proc(ct, hasAlpha);
 
     for (int y = 0; y < bitmap.height(); y++) {
         png_bytep row_ptr = (png_bytep)storage;
@@ -335,6 +663,10 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
 
 ///////////////////////////////////////////////////////////////////////////////
 DEFINE_ENCODER_CREATOR(PNGImageEncoder);
+
+SkImageEncoder* CreatePNGImageEncoder(const SkPNGEncoderOptions& options) {
+    return new SkPNGImageEncoder(options);
+}
 ///////////////////////////////////////////////////////////////////////////////
 
 SkImageEncoder* sk_libpng_efactory(SkImageEncoder::Type t) {
@@ -274,6 +274,7 @@ public:
     SkNx operator + (const SkNx& o) const { return vaddq_u16(fVec, o.fVec); }
     SkNx operator - (const SkNx& o) const { return vsubq_u16(fVec, o.fVec); }
     SkNx operator * (const SkNx& o) const { return vmulq_u16(fVec, o.fVec); }
+    SkNx operator & (const SkNx& o) const { return vandq_u16(fVec, o.fVec); }
 
     SkNx operator << (int bits) const { SHIFT16(vshlq_n_u16, fVec, bits); }
     SkNx operator >> (int bits) const { SHIFT16(vshrq_n_u16, fVec, bits); }
@@ -386,6 +387,7 @@ public:
     SkNx operator - (const SkNx& o) const { return vsubq_s32(fVec, o.fVec); }
     SkNx operator * (const SkNx& o) const { return vmulq_s32(fVec, o.fVec); }
 
+    SkNx operator & (const SkNx& o) const { return vandq_s32(fVec, o.fVec); }
     SkNx operator | (const SkNx& o) const { return vorrq_s32(fVec, o.fVec); }
 
     SkNx operator << (int bits) const { SHIFT32(vshlq_n_s32, fVec, bits); }
@@ -450,4 +452,12 @@ template<> inline Sk4b SkNx_cast<uint8_t, uint16_t>(const Sk4h& src) {
     return vmovn_u16(vcombine_u16(src.fVec, src.fVec));
 }
 
+template<> inline Sk16b SkNx_cast<uint8_t, uint16_t>(const Sk16h& src) {
+    return vcombine_u8(vmovn_u16(src.fLo.fVec), vmovn_u16(src.fHi.fVec));
+}
+
+template<> inline Sk4h SkNx_cast<uint16_t, int>(const Sk4i& src) {
+    return vmovn_u32(vreinterpretq_u32_s32(src.fVec));
+}
+
 #endif//SkNx_neon_DEFINED
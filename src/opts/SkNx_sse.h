@@ -156,6 +156,7 @@ public:
                                   _mm_shuffle_epi32(mul31, _MM_SHUFFLE(0,0,2,0)));
     }
 
+    SkNx operator & (const SkNx& o) const { return _mm_and_si128(fVec, o.fVec); }
     SkNx operator | (const SkNx& o) const { return _mm_or_si128(fVec, o.fVec); }
 
     SkNx operator << (int bits) const { return _mm_slli_epi32(fVec, bits); }
@@ -214,6 +215,7 @@ public:
     SkNx operator + (const SkNx& o) const { return _mm_add_epi16(fVec, o.fVec); }
     SkNx operator - (const SkNx& o) const { return _mm_sub_epi16(fVec, o.fVec); }
     SkNx operator * (const SkNx& o) const { return _mm_mullo_epi16(fVec, o.fVec); }
+    SkNx operator & (const SkNx& o) const { return _mm_and_si128(fVec, o.fVec); }
 
     SkNx operator << (int bits) const { return _mm_slli_epi16(fVec, bits); }
     SkNx operator >> (int bits) const { return _mm_srli_epi16(fVec, bits); }
@@ -377,4 +379,15 @@ template<> /*static*/ inline Sk4b SkNx_cast<uint8_t, uint16_t>(const Sk4h& src)
     return _mm_packus_epi16(src.fVec, src.fVec);
 }
 
+template<> /*static*/ inline Sk16b SkNx_cast<uint8_t, uint16_t>(const Sk16h& src) {
+    // Like the Sk4h version, this expects src to already fit in 8 bits.
+    return _mm_packus_epi16(src.fLo.fVec, src.fHi.fVec);
+}
+
+template<> /*static*/ inline Sk4h SkNx_cast<uint16_t, int>(const Sk4i& src) {
+    // Keep the low 16 bits of each lane, sign extended so the signed pack can't saturate.
+    __m128i lo = _mm_srai_epi32(_mm_slli_epi32(src.fVec, 16), 16);
+    return _mm_packs_epi32(lo, lo);
+}
+
 #endif//SkNx_sse_DEFINED
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkOpts.h"
+#define SK_OPTS_NS sk_avx2
+#include "SkSwizzler_opts.h"
+
+namespace SkOpts {
+    void Init_avx2() {
+        RGBA_to_BGRA          = sk_avx2::RGBA_to_BGRA;
+        RGBA_to_rgbA          = sk_avx2::RGBA_to_rgbA;
+        RGBA_to_bgrA          = sk_avx2::RGBA_to_bgrA;
+        RGB_to_RGB1           = sk_avx2::RGB_to_RGB1;
+        RGB_to_BGR1           = sk_avx2::RGB_to_BGR1;
+        gray_to_RGB1          = sk_avx2::gray_to_RGB1;
+        grayA_to_RGBA         = sk_avx2::grayA_to_RGBA;
+        grayA_to_rgbA         = sk_avx2::grayA_to_rgbA;
+        inverted_CMYK_to_RGB1 = sk_avx2::inverted_CMYK_to_RGB1;
+        inverted_CMYK_to_BGR1 = sk_avx2::inverted_CMYK_to_BGR1;
+        RGB_to_565            = sk_avx2::RGB_to_565;
+        BGR_to_565            = sk_avx2::BGR_to_565;
+        gray_to_565           = sk_avx2::gray_to_565;
+        inverted_CMYK_to_565  = sk_avx2::inverted_CMYK_to_565;
+        index_to_8888         = sk_avx2::index_to_8888;
+        index_to_565          = sk_avx2::index_to_565;
+        YUV_to_RGB1           = sk_avx2::YUV_to_RGB1;
+        YUV_to_BGR1           = sk_avx2::YUV_to_BGR1;
+    }
+}
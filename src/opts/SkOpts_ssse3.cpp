@@ -28,5 +28,13 @@ namespace SkOpts {
         grayA_to_rgbA         = sk_ssse3::grayA_to_rgbA;
         inverted_CMYK_to_RGB1 = sk_ssse3::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = sk_ssse3::inverted_CMYK_to_BGR1;
+        RGB_to_565            = sk_ssse3::RGB_to_565;
+        BGR_to_565            = sk_ssse3::BGR_to_565;
+        gray_to_565           = sk_ssse3::gray_to_565;
+        inverted_CMYK_to_565  = sk_ssse3::inverted_CMYK_to_565;
+        index_to_8888         = sk_ssse3::index_to_8888;
+        index_to_565          = sk_ssse3::index_to_565;
+        YUV_to_RGB1           = sk_ssse3::YUV_to_RGB1;
+        YUV_to_BGR1           = sk_ssse3::YUV_to_BGR1;
     }
 }
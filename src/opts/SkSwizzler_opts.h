@@ -166,6 +166,44 @@ static void inverted_CMYK_to_BGR1_portable(uint32_t* dst, const void* vsrc, int
     }
 }
 
+static inline uint16_t pack_565(uint8_t r, uint8_t g, uint8_t b) {
+    return (uint16_t)((r >> 3) << 11 | (g >> 2) << 5 | (b >> 3));
+}
+
+static void RGB_to_565_portable(uint16_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*)vsrc;
+    for (int i = 0; i < count; i++) {
+        dst[i] = pack_565(src[0], src[1], src[2]);
+        src += 3;
+    }
+}
+
+static void BGR_to_565_portable(uint16_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*)vsrc;
+    for (int i = 0; i < count; i++) {
+        dst[i] = pack_565(src[2], src[1], src[0]);
+        src += 3;
+    }
+}
+
+static void gray_to_565_portable(uint16_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*)vsrc;
+    for (int i = 0; i < count; i++) {
+        dst[i] = pack_565(src[i], src[i], src[i]);
+    }
+}
+
+static void inverted_CMYK_to_565_portable(uint16_t dst[], const void* vsrc, int count) {
+    const uint32_t* src = (const uint32_t*)vsrc;
+    for (int i = 0; i < count; i++) {
+        uint8_t k = src[i] >> 24,
+                y = src[i] >> 16,
+                m = src[i] >>  8,
+                c = src[i] >>  0;
+        dst[i] = pack_565((c*k+127)/255, (m*k+127)/255, (y*k+127)/255);
+    }
+}
+
 #if defined(SK_ARM_HAS_NEON)
 
 // Rounded divide by 255, (x + 127) / 255
@@ -490,6 +528,88 @@ static void inverted_CMYK_to_BGR1(uint32_t dst[], const void* src, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+// Pack 8 pixels of 8-bit r, g, b into 565.
+static uint16x8_t pack_565(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    // Shift each channel to the top of a 16-bit lane, then shift-right-and-insert
+    // the next channel below the bits we have already kept.
+    uint16x8_t rgb = vshll_n_u8(r, 8);
+    rgb = vsriq_n_u16(rgb, vshll_n_u8(g, 8), 5);
+    rgb = vsriq_n_u16(rgb, vshll_n_u8(b, 8), 11);
+    return rgb;
+}
+
+template <bool kSwapRB>
+static void pack_565_should_swaprb(uint16_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*) vsrc;
+    while (count >= 8) {
+        // Load 8 pixels.
+        uint8x8x3_t rgb = vld3_u8(src);
+
+        uint8x8_t r = kSwapRB ? rgb.val[2] : rgb.val[0],
+                  g = rgb.val[1],
+                  b = kSwapRB ? rgb.val[0] : rgb.val[2];
+
+        // Store 8 pixels.
+        vst1q_u16(dst, pack_565(r, g, b));
+        src += 8*3;
+        dst += 8;
+        count -= 8;
+    }
+
+    // Call portable code to finish up the tail of [0,8) pixels.
+    auto proc = kSwapRB ? BGR_to_565_portable : RGB_to_565_portable;
+    proc(dst, src, count);
+}
+
+static void RGB_to_565(uint16_t dst[], const void* src, int count) {
+    pack_565_should_swaprb<false>(dst, src, count);
+}
+
+static void BGR_to_565(uint16_t dst[], const void* src, int count) {
+    pack_565_should_swaprb<true>(dst, src, count);
+}
+
+static void gray_to_565(uint16_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*) vsrc;
+    while (count >= 16) {
+        // Load 16 pixels.
+        uint8x16_t grays = vld1q_u8(src);
+
+        uint8x8_t lo = vget_low_u8(grays),
+                  hi = vget_high_u8(grays);
+
+        // Store 16 pixels.
+        vst1q_u16(dst + 0, pack_565(lo, lo, lo));
+        vst1q_u16(dst + 8, pack_565(hi, hi, hi));
+        src += 16;
+        dst += 16;
+        count -= 16;
+    }
+
+    gray_to_565_portable(dst, src, count);
+}
+
+static void inverted_CMYK_to_565(uint16_t dst[], const void* vsrc, int count) {
+    auto src = (const uint32_t*)vsrc;
+    while (count >= 8) {
+        // Load 8 cmyk pixels.
+        uint8x8x4_t pixels = vld4_u8((const uint8_t*) src);
+
+        uint8x8_t k = pixels.val[3],
+                  y = pixels.val[2],
+                  m = pixels.val[1],
+                  c = pixels.val[0];
+
+        // Scale to r, g, b and store 8 pixels.
+        vst1q_u16(dst, pack_565(scale(c, k), scale(m, k), scale(y, k)));
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+
+    inverted_CMYK_to_565_portable(dst, src, count);
+}
+
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
 
 // Scale a byte by another.
@@ -797,6 +917,107 @@ static void inverted_CMYK_to_BGR1(uint32_t dst[], const void* src, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+// Pack 8 RGBX pixels (r in the low byte) into 565.
+static __m128i pack_565(__m128i lo, __m128i hi) {
+    auto pack4 = [](__m128i px) {
+        __m128i r = _mm_slli_epi32(_mm_and_si128(px, _mm_set1_epi32(0x0000F8)),  8),
+                g = _mm_srli_epi32(_mm_and_si128(px, _mm_set1_epi32(0x00FC00)),  5),
+                b = _mm_srli_epi32(_mm_and_si128(px, _mm_set1_epi32(0xF80000)), 19);
+        return _mm_or_si128(r, _mm_or_si128(g, b));
+    };
+
+    // Keep the low 16 bits of each 32-bit lane.
+    const uint8_t X = 0xFF; // Used a placeholder.  Shuffling with X writes zero.
+    const __m128i narrow = _mm_setr_epi8(0,1, 4,5, 8,9, 12,13, X,X, X,X, X,X, X,X);
+    return _mm_unpacklo_epi64(_mm_shuffle_epi8(pack4(lo), narrow),
+                              _mm_shuffle_epi8(pack4(hi), narrow));
+}
+
+template <bool kSwapRB>
+static void pack_565_should_swaprb(uint16_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*) vsrc;
+
+    __m128i expand;
+    const uint8_t X = 0xFF; // Used a placeholder.  The value of X is irrelevant.
+    if (kSwapRB) {
+        expand = _mm_setr_epi8(2,1,0,X, 5,4,3,X, 8,7,6,X, 11,10,9,X);
+    } else {
+        expand = _mm_setr_epi8(0,1,2,X, 3,4,5,X, 6,7,8,X, 9,10,11,X);
+    }
+
+    while (count >= 10) {
+        // Load two vectors of four pixels each.  The second load reads a few bytes past the
+        // eighth pixel, which is why we stop while there are still ten pixels left.
+        __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (src +  0)), expand),
+                hi = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (src + 12)), expand);
+
+        // Store 8 pixels.
+        _mm_storeu_si128((__m128i*) dst, pack_565(lo, hi));
+
+        src += 8*3;
+        dst += 8;
+        count -= 8;
+    }
+
+    // Call portable code to finish up the tail of [0,10) pixels.
+    auto proc = kSwapRB ? BGR_to_565_portable : RGB_to_565_portable;
+    proc(dst, src, count);
+}
+
+static void RGB_to_565(uint16_t dst[], const void* src, int count) {
+    pack_565_should_swaprb<false>(dst, src, count);
+}
+
+static void BGR_to_565(uint16_t dst[], const void* src, int count) {
+    pack_565_should_swaprb<true>(dst, src, count);
+}
+
+static void gray_to_565(uint16_t dst[], const void* vsrc, int count) {
+    const uint8_t* src = (const uint8_t*) vsrc;
+
+    auto pack8 = [](__m128i g) {
+        __m128i r = _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xF8)), 8),
+                G = _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xFC)), 3),
+                b = _mm_srli_epi16(g, 3);
+        return _mm_or_si128(r, _mm_or_si128(G, b));
+    };
+
+    const __m128i zeros = _mm_setzero_si128();
+    while (count >= 16) {
+        __m128i grays = _mm_loadu_si128((const __m128i*) src);
+
+        _mm_storeu_si128((__m128i*) (dst + 0), pack8(_mm_unpacklo_epi8(grays, zeros)));
+        _mm_storeu_si128((__m128i*) (dst + 8), pack8(_mm_unpackhi_epi8(grays, zeros)));
+
+        src += 16;
+        dst += 16;
+        count -= 16;
+    }
+
+    gray_to_565_portable(dst, src, count);
+}
+
+static void inverted_CMYK_to_565(uint16_t dst[], const void* vsrc, int count) {
+    auto src = (const uint32_t*)vsrc;
+
+    // Convert to RGB1 a batch at a time, then pack that down to 565.
+    uint32_t rgb[64];
+    while (count >= 8) {
+        int n = SkTMin(count & ~7, (int)SK_ARRAY_COUNT(rgb));
+        inverted_cmyk_to<kRGB1>(rgb, src, n);
+        for (int i = 0; i < n; i += 8) {
+            __m128i lo = _mm_loadu_si128((const __m128i*) (rgb + i + 0)),
+                    hi = _mm_loadu_si128((const __m128i*) (rgb + i + 4));
+            _mm_storeu_si128((__m128i*) (dst + i), pack_565(lo, hi));
+        }
+        src += n;
+        dst += n;
+        count -= n;
+    }
+
+    inverted_CMYK_to_565_portable(dst, src, count);
+}
+
 #else
 
 static void RGBA_to_rgbA(uint32_t* dst, const void* src, int count) {
@@ -839,7 +1060,209 @@ static void inverted_CMYK_to_BGR1(uint32_t dst[], const void* src, int count) {
     inverted_CMYK_to_BGR1_portable(dst, src, count);
 }
 
+static void RGB_to_565(uint16_t dst[], const void* src, int count) {
+    RGB_to_565_portable(dst, src, count);
+}
+
+static void BGR_to_565(uint16_t dst[], const void* src, int count) {
+    BGR_to_565_portable(dst, src, count);
+}
+
+static void gray_to_565(uint16_t dst[], const void* src, int count) {
+    gray_to_565_portable(dst, src, count);
+}
+
+static void inverted_CMYK_to_565(uint16_t dst[], const void* src, int count) {
+    inverted_CMYK_to_565_portable(dst, src, count);
+}
+
+#endif
+
+// Palette expansion is shared by every ISA; only the 8-wide body below needs AVX2 gathers.
+static void index_to_8888(uint32_t dst[], const uint8_t src[], int count,
+                          const uint32_t table[]) {
+    int i = 0;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    for (; i + 8 <= count; i += 8) {
+        __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i),
+                            _mm256_i32gather_epi32((const int*)table, idx, 4));
+    }
+#endif
+    // Batch four lookups at a time, so their loads can overlap.
+    for (; i + 4 <= count; i += 4) {
+        uint32_t c0 = table[src[i + 0]],
+                 c1 = table[src[i + 1]],
+                 c2 = table[src[i + 2]],
+                 c3 = table[src[i + 3]];
+        dst[i + 0] = c0;
+        dst[i + 1] = c1;
+        dst[i + 2] = c2;
+        dst[i + 3] = c3;
+    }
+    for (; i < count; i++) {
+        dst[i] = table[src[i]];
+    }
+}
+
+static void index_to_565(uint16_t dst[], const uint8_t src[], int count,
+                         const uint32_t table[]) {
+    int i = 0;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    const __m256i mask5 = _mm256_set1_epi32(0x1F),
+                  mask6 = _mm256_set1_epi32(0x3F);
+    for (; i + 8 <= count; i += 8) {
+        __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+        __m256i c = _mm256_i32gather_epi32((const int*)table, idx, 4);
+
+        // Truncate like SkPixel32ToPixel16().
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(c, SK_R32_SHIFT + 3), mask5),
+                g = _mm256_and_si256(_mm256_srli_epi32(c, SK_G32_SHIFT + 2), mask6),
+                b = _mm256_and_si256(_mm256_srli_epi32(c, SK_B32_SHIFT + 3), mask5);
+        __m256i p = _mm256_or_si256(_mm256_slli_epi32(r, SK_R16_SHIFT),
+                    _mm256_or_si256(_mm256_slli_epi32(g, SK_G16_SHIFT),
+                                    _mm256_slli_epi32(b, SK_B16_SHIFT)));
+
+        // Pack 32-bit lanes down to 16 bits; packus works per 128-bit lane, so fix the order.
+        p = _mm256_permute4x64_epi64(_mm256_packus_epi32(p, p), 0x08);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm256_castsi256_si128(p));
+    }
+    if (i == count) {
+        return;
+    }
+#endif
+    // Long runs are cheaper through a converted table than converting every pixel.
+    if (count - i < 256) {
+        for (; i < count; i++) {
+            dst[i] = SkPixel32ToPixel16(table[src[i]]);
+        }
+        return;
+    }
+    uint16_t table565[256];
+    for (int j = 0; j < 256; j++) {
+        table565[j] = SkPixel32ToPixel16(table[j]);
+    }
+    for (; i < count; i++) {
+        dst[i] = table565[src[i]];
+    }
+}
+
+// Converts one Y, U and V sample per pixel, so chroma must already be upsampled.  Both color
+// spaces repeat their decoder's fixed point math exactly: libjpeg-turbo's 16.16 tables for
+// kJPEG_SkYUVColorSpace and libwebp's 14-bit VP8YUVToR/G/B() for kRec601_SkYUVColorSpace.
+template <bool kSwapRB>
+static void YUV_to_RGB1_(uint32_t dst[], const uint8_t y[], const uint8_t u[],
+                         const uint8_t v[], int count, SkYUVColorSpace colorSpace) {
+    SkASSERT(kJPEG_SkYUVColorSpace == colorSpace || kRec601_SkYUVColorSpace == colorSpace);
+    const bool jpeg = kJPEG_SkYUVColorSpace == colorSpace;
+    int i = 0;
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+    const __m128i zero   = _mm_setzero_si128(),
+                  opaque = _mm_set1_epi8((char)0xFF);
+
+    // libjpeg-turbo adds (k * (c - 128) + 0.5) >> 16 to Y.  Its coefficients don't fit in 16
+    // bits, so we take out a whole multiple of c - 128 and multiply-add the rest in 32 bits.
+    const __m128i bias   = _mm_set1_epi16(128),
+                  two    = _mm_set1_epi16(2),
+                  half   = _mm_set1_epi32(1 << 15),
+                  vToR   = _mm_setr_epi16(26345, 1 << 14, 26345, 1 << 14,
+                                          26345, 1 << 14, 26345, 1 << 14),
+                  uvToG  = _mm_setr_epi16(-22554, 18734, -22554, 18734,
+                                          -22554, 18734, -22554, 18734),
+                  uToB   = _mm_setr_epi16(-14942, 1 << 14, -14942, 1 << 14,
+                                          -14942, 1 << 14, -14942, 1 << 14);
+    auto jpeg_term = [&](const __m128i& a, const __m128i& b, const __m128i& k, bool addHalf) {
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), k),
+                hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), k);
+        if (addHalf) {
+            lo = _mm_add_epi32(lo, half);
+            hi = _mm_add_epi32(hi, half);
+        }
+        return _mm_packs_epi32(_mm_srai_epi32(lo, 16), _mm_srai_epi32(hi, 16));
+    };
+
+    // libwebp keeps 14 bits, multiplying 8.8 samples and keeping the high 16 bits.
+    const __m128i yScale = _mm_set1_epi16(19077),
+                  vToR8  = _mm_set1_epi16(26149),
+                  uToG8  = _mm_set1_epi16(6419),
+                  vToG8  = _mm_set1_epi16(13320),
+                  uToB8  = _mm_set1_epi16((short)33050),
+                  rOff   = _mm_set1_epi16(14234),
+                  gOff   = _mm_set1_epi16(8708),
+                  bOff   = _mm_set1_epi16(17685);
+
+    for (; i + 8 <= count; i += 8) {
+        const __m128i y8 = _mm_loadl_epi64((const __m128i*)(y + i)),
+                      u8 = _mm_loadl_epi64((const __m128i*)(u + i)),
+                      v8 = _mm_loadl_epi64((const __m128i*)(v + i));
+        __m128i R, G, B;
+        if (jpeg) {
+            const __m128i Y = _mm_unpacklo_epi8(y8, zero),
+                          U = _mm_sub_epi16(_mm_unpacklo_epi8(u8, zero), bias),
+                          V = _mm_sub_epi16(_mm_unpacklo_epi8(v8, zero), bias);
+            // 91881 = 65536 + 26345, -46802 = -65536 + 18734, 116130 = 2 * 65536 - 14942.
+            R = _mm_add_epi16(_mm_add_epi16(Y, V), jpeg_term(V, two, vToR, false));
+            G = _mm_add_epi16(_mm_sub_epi16(Y, V), jpeg_term(U, V, uvToG, true));
+            B = _mm_add_epi16(_mm_add_epi16(Y, _mm_add_epi16(U, U)),
+                              jpeg_term(U, two, uToB, false));
+        } else {
+            const __m128i Y = _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, y8), yScale),
+                          U = _mm_unpacklo_epi8(zero, u8),
+                          V = _mm_unpacklo_epi8(zero, v8);
+            // R and G fit in signed 16 bits.  B can reach 34238, so it stays unsigned, where
+            // saturating at zero is the same as clamping.
+            R = _mm_srai_epi16(_mm_sub_epi16(_mm_add_epi16(Y, _mm_mulhi_epu16(V, vToR8)),
+                                             rOff), 6);
+            G = _mm_srai_epi16(_mm_add_epi16(_mm_sub_epi16(_mm_sub_epi16(Y,
+                                                 _mm_mulhi_epu16(U, uToG8)),
+                                                 _mm_mulhi_epu16(V, vToG8)), gOff), 6);
+            B = _mm_srli_epi16(_mm_subs_epu16(_mm_adds_epu16(Y, _mm_mulhi_epu16(U, uToB8)),
+                                              bOff), 6);
+        }
+        if (kSwapRB) {
+            SkTSwap(R, B);
+        }
+
+        __m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(R, R), _mm_packus_epi16(G, G)),
+                ba = _mm_unpacklo_epi8(_mm_packus_epi16(B, B), opaque);
+        _mm_storeu_si128((__m128i*)(dst + i + 0), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_unpackhi_epi16(rg, ba));
+    }
 #endif
+    auto mulhi = [](int x, int k) { return (x * k) >> 8; };
+    for (; i < count; i++) {
+        int r, g, b;
+        if (jpeg) {
+            const int U = u[i] - 128,
+                      V = v[i] - 128;
+            r = SkTPin(y[i] + ((91881 * V + (1 << 15)) >> 16), 0, 255);
+            g = SkTPin(y[i] + ((-22554 * U - 46802 * V + (1 << 15)) >> 16), 0, 255);
+            b = SkTPin(y[i] + ((116130 * U + (1 << 15)) >> 16), 0, 255);
+        } else {
+            const int Y = mulhi(y[i], 19077);
+            r = SkTPin((Y + mulhi(v[i], 26149) - 14234) >> 6, 0, 255);
+            g = SkTPin((Y - mulhi(u[i], 6419) - mulhi(v[i], 13320) + 8708) >> 6, 0, 255);
+            b = SkTPin((Y + mulhi(u[i], 33050) - 17685) >> 6, 0, 255);
+        }
+        if (kSwapRB) {
+            SkTSwap(r, b);
+        }
+        dst[i] = (uint32_t)0xFF << 24
+               | (uint32_t)   b << 16
+               | (uint32_t)   g <<  8
+               | (uint32_t)   r <<  0;
+    }
+}
+
+static void YUV_to_RGB1(uint32_t dst[], const uint8_t y[], const uint8_t u[], const uint8_t v[],
+                        int count, SkYUVColorSpace colorSpace) {
+    YUV_to_RGB1_<false>(dst, y, u, v, count, colorSpace);
+}
+
+static void YUV_to_BGR1(uint32_t dst[], const uint8_t y[], const uint8_t u[], const uint8_t v[],
+                        int count, SkYUVColorSpace colorSpace) {
+    YUV_to_RGB1_<true>(dst, y, u, v, count, colorSpace);
+}
 
 }
 
@@ -143,8 +143,25 @@ private:
 
 struct SkFaceRec;
 
+// Scaler contexts open faces of their own, in one of a few libraries they share. Before 2.5.6,
+// FreeType could not use two faces of one library at once, and it still needs the opening and
+// closing of faces serialized, so each scaler context holds its library's fMutex while it uses
+// its face. Scaler contexts in different libraries generate glyphs in parallel.
+#ifndef SK_FREETYPE_LIBRARY_POOL_SIZE
+#   define SK_FREETYPE_LIBRARY_POOL_SIZE 4
+#endif
+
+struct PooledFreeTypeLibrary : SkNoncopyable {
+    PooledFreeTypeLibrary() : fUsers(0) {}
+
+    FreeTypeLibrary fLibrary;
+    SkMutex fMutex;
+    int fUsers;     // scaler contexts with a face in fLibrary, guarded by gFTMutex
+};
+
 SK_DECLARE_STATIC_MUTEX(gFTMutex);
 static FreeTypeLibrary* gFTLibrary;
+static PooledFreeTypeLibrary* gFTLibraryPool[SK_FREETYPE_LIBRARY_POOL_SIZE];
 static SkFaceRec* gFaceRecHead;
 
 // Private to ref_ft_library and unref_ft_library
@@ -174,7 +191,45 @@ static void unref_ft_library() {
         SkASSERT(nullptr != gFTLibrary);
         delete gFTLibrary;
         SkDEBUGCODE(gFTLibrary = nullptr;)
+        for (PooledFreeTypeLibrary*& pooled : gFTLibraryPool) {
+            SkASSERT(nullptr == pooled || 0 == pooled->fUsers);
+            delete pooled;
+            pooled = nullptr;
+        }
+    }
+}
+
+// Caller must lock gFTMutex before calling this function.
+static PooledFreeTypeLibrary* ref_pooled_ft_library() {
+    gFTMutex.assertHeld();
+
+    // Use the least used library, making another only if every existing one is in use.
+    PooledFreeTypeLibrary* leastUsed = nullptr;
+    for (PooledFreeTypeLibrary*& pooled : gFTLibraryPool) {
+        if (nullptr == pooled) {
+            if (nullptr == leastUsed || leastUsed->fUsers > 0) {
+                pooled = new PooledFreeTypeLibrary;
+                leastUsed = pooled;
+            }
+            break;
+        }
+        if (nullptr == leastUsed || pooled->fUsers < leastUsed->fUsers) {
+            leastUsed = pooled;
+        }
     }
+    if (!leastUsed->fLibrary.library()) {
+        return nullptr;
+    }
+    ++leastUsed->fUsers;
+    return leastUsed;
+}
+
+// Caller must lock gFTMutex before calling this function.
+static void unref_pooled_ft_library(PooledFreeTypeLibrary* pooled) {
+    gFTMutex.assertHeld();
+    SkASSERT(pooled->fUsers > 0);
+
+    --pooled->fUsers;
 }
 
 class SkScalerContext_FreeType : public SkScalerContext_FreeType_Base {
@@ -192,12 +247,19 @@ protected:
     void generateAdvance(SkGlyph* glyph) override;
     void generateMetrics(SkGlyph* glyph) override;
     void generateImage(const SkGlyph& glyph) override;
+    void generateImages(const SkGlyph* const glyphs[], int count) override;
     void generatePath(const SkGlyph& glyph, SkPath* path) override;
     void generateFontMetrics(SkPaint::FontMetrics*) override;
     SkUnichar generateGlyphToChar(uint16_t glyph) override;
+    uint32_t generateEngineVersion() override;
 
 private:
-    FT_Face     fFace;              // reference to shared face in gFaceRecHead
+    // Each scaler context opens its own face on the typeface's shared font data, in a pooled
+    // library, so glyphs for different strikes can be generated in parallel without gFTMutex.
+    // A scaler context is only ever used by one thread at a time.
+    PooledFreeTypeLibrary* fLibrary;
+    SkFaceRec*  fFaceRec;           // reference to shared font data in gFaceRecHead
+    FT_Face     fFace;              // our own face, opened in fLibrary
     FT_Size     fFTSize;            // our own copy
     FT_Int      fStrikeIndex;
     FT_F26Dot6  fScaleX, fScaleY;
@@ -211,12 +273,12 @@ private:
     SkMatrix    fMatrix22Scalar;
 
     FT_Error setupSize();
+    // Like generateImage, but assumes setupSize() has already succeeded.
+    void generateImageWithSize(const SkGlyph& glyph);
     void getBBoxForCurrentGlyph(SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock gFTMutex before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock gFTMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph);
 };
@@ -228,12 +290,15 @@ struct SkFaceRec {
     SkFaceRec* fNext;
     FT_Face fFace;
     FT_StreamRec fFTStream;
-    SkAutoTDelete<SkStreamAsset> fSkStream;
+    SkAutoTDelete<SkFontData> fData;
+    // The font data, if the stream is not already in memory.  Scaler contexts open their own
+    // faces from memory, since they cannot share the stream's position.
+    sk_sp<SkData> fCopy;
     uint32_t fRefCnt;
     uint32_t fFontID;
 
-    // assumes ownership of the stream, will delete when its done
-    SkFaceRec(SkStreamAsset* strm, uint32_t fontID);
+    // assumes ownership of the data (which must have a stream), will delete when its done
+    SkFaceRec(SkFontData* data, uint32_t fontID);
 };
 
 extern "C" {
@@ -256,12 +321,12 @@ extern "C" {
     static void sk_ft_stream_close(FT_Stream) {}
 }
 
-SkFaceRec::SkFaceRec(SkStreamAsset* stream, uint32_t fontID)
-        : fNext(nullptr), fSkStream(stream), fRefCnt(1), fFontID(fontID)
+SkFaceRec::SkFaceRec(SkFontData* data, uint32_t fontID)
+        : fNext(nullptr), fData(data), fRefCnt(1), fFontID(fontID)
 {
     sk_bzero(&fFTStream, sizeof(fFTStream));
-    fFTStream.size = fSkStream->getLength();
-    fFTStream.descriptor.pointer = fSkStream;
+    fFTStream.size = fData->getStream()->getLength();
+    fFTStream.descriptor.pointer = fData->getStream();
     fFTStream.read  = sk_ft_stream_io;
     fFTStream.close = sk_ft_stream_close;
 }
@@ -297,9 +362,50 @@ static void ft_face_setup_axes(FT_Face face, const SkFontData& data) {
     }
 }
 
+// Opens a face on the rec's font data.  If memory is nullptr, the face reads the rec's stream.
+static FT_Face open_ft_face(FT_Library library, const SkFaceRec* rec, const SkData* memory) {
+    FT_Open_Args args;
+    memset(&args, 0, sizeof(args));
+    SkStreamAsset* stream = rec->fData->getStream();
+    const void* memoryBase = stream->getMemoryBase();
+    if (memory) {
+        args.flags = FT_OPEN_MEMORY;
+        args.memory_base = memory->bytes();
+        args.memory_size = memory->size();
+    } else if (memoryBase) {
+        args.flags = FT_OPEN_MEMORY;
+        args.memory_base = (const FT_Byte*)memoryBase;
+        args.memory_size = stream->getLength();
+    } else {
+        args.flags = FT_OPEN_STREAM;
+        args.stream = const_cast<FT_StreamRec*>(&rec->fFTStream);
+    }
+
+    FT_Face face;
+    FT_Error err = FT_Open_Face(library, &args, rec->fData->getIndex(), &face);
+    if (err) {
+        SkDEBUGF(("ERROR: unable to open font '%x'\n", rec->fFontID));
+        return nullptr;
+    }
+    SkASSERT(face);
+
+    ft_face_setup_axes(face, *rec->fData);
+
+    // FreeType will set the charmap to the "most unicode" cmap if it exists.
+    // If there are no unicode cmaps, the charmap is set to nullptr.
+    // However, "symbol" cmaps should also be considered "fallback unicode" cmaps
+    // because they are effectively private use area only (even if they aren't).
+    // This is the last on the fallback list at
+    // https://developer.apple.com/fonts/TrueType-Reference-Manual/RM06/Chap6cmap.html
+    if (!face->charmap) {
+        FT_Select_Charmap(face, FT_ENCODING_MS_SYMBOL);
+    }
+    return face;
+}
+
 // Will return 0 on failure
 // Caller must lock gFTMutex before calling this function.
-static FT_Face ref_ft_face(const SkTypeface* typeface) {
+static SkFaceRec* ref_ft_face_rec(const SkTypeface* typeface) {
     gFTMutex.assertHeld();
 
     const SkFontID fontID = typeface->uniqueID();
@@ -308,7 +414,7 @@ static FT_Face ref_ft_face(const SkTypeface* typeface) {
         if (rec->fFontID == fontID) {
             SkASSERT(rec->fFace);
             rec->fRefCnt += 1;
-            return rec->fFace;
+            return rec;
         }
         rec = rec->fNext;
     }
@@ -318,44 +424,43 @@ static FT_Face ref_ft_face(const SkTypeface* typeface) {
         return nullptr;
     }
 
-    // this passes ownership of stream to the rec
-    rec = new SkFaceRec(data->detachStream(), fontID);
-
-    FT_Open_Args args;
-    memset(&args, 0, sizeof(args));
-    const void* memoryBase = rec->fSkStream->getMemoryBase();
-    if (memoryBase) {
-        args.flags = FT_OPEN_MEMORY;
-        args.memory_base = (const FT_Byte*)memoryBase;
-        args.memory_size = rec->fSkStream->getLength();
-    } else {
-        args.flags = FT_OPEN_STREAM;
-        args.stream = &rec->fFTStream;
-    }
-
-    FT_Error err = FT_Open_Face(gFTLibrary->library(), &args, data->getIndex(), &rec->fFace);
-    if (err) {
-        SkDEBUGF(("ERROR: unable to open font '%x'\n", fontID));
+    // this passes ownership of data to the rec
+    rec = new SkFaceRec(data.release(), fontID);
+    rec->fFace = open_ft_face(gFTLibrary->library(), rec, nullptr);
+    if (!rec->fFace) {
         delete rec;
         return nullptr;
     }
-    SkASSERT(rec->fFace);
-
-    ft_face_setup_axes(rec->fFace, *data);
-
-    // FreeType will set the charmap to the "most unicode" cmap if it exists.
-    // If there are no unicode cmaps, the charmap is set to nullptr.
-    // However, "symbol" cmaps should also be considered "fallback unicode" cmaps
-    // because they are effectively private use area only (even if they aren't).
-    // This is the last on the fallback list at
-    // https://developer.apple.com/fonts/TrueType-Reference-Manual/RM06/Chap6cmap.html
-    if (!rec->fFace->charmap) {
-        FT_Select_Charmap(rec->fFace, FT_ENCODING_MS_SYMBOL);
-    }
 
     rec->fNext = gFaceRecHead;
     gFaceRecHead = rec;
-    return rec->fFace;
+    return rec;
+}
+
+// Will return 0 on failure
+// Caller must lock gFTMutex before calling this function.
+static FT_Face ref_ft_face(const SkTypeface* typeface) {
+    SkFaceRec* rec = ref_ft_face_rec(typeface);
+    return rec ? rec->fFace : nullptr;
+}
+
+// Returns the rec's font data in memory, copying it out of the stream if needed.
+// Caller must lock gFTMutex before calling this function.
+static sk_sp<SkData> ft_face_rec_memory(SkFaceRec* rec) {
+    gFTMutex.assertHeld();
+
+    SkStreamAsset* stream = rec->fData->getStream();
+    if (const void* memoryBase = stream->getMemoryBase()) {
+        return SkData::MakeWithoutCopy(memoryBase, stream->getLength());
+    }
+    if (!rec->fCopy) {
+        // The shared face also reads this stream, but only while gFTMutex is held.
+        if (!stream->rewind()) {
+            return nullptr;
+        }
+        rec->fCopy = SkData::MakeFromStream(stream, stream->getLength());
+    }
+    return rec->fCopy;
 }
 
 // Caller must lock gFTMutex before calling this function.
@@ -795,19 +900,43 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
                                                    const SkScalerContextEffects& effects,
                                                    const SkDescriptor* desc)
     : SkScalerContext_FreeType_Base(typeface, effects, desc)
+    , fLibrary(nullptr)
+    , fFaceRec(nullptr)
     , fFace(nullptr)
     , fFTSize(nullptr)
     , fStrikeIndex(-1)
 {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    sk_sp<SkData> fontMemory;
+    {
+        SkAutoMutexAcquire  ac(gFTMutex);
 
-    if (!ref_ft_library()) {
-        sk_throw();
+        if (!ref_ft_library()) {
+            sk_throw();
+        }
+        fLibrary = ref_pooled_ft_library();
+        if (nullptr == fLibrary) {
+            return;
+        }
+
+        // load the font file
+        fFaceRec = ref_ft_face_rec(typeface);
+        if (nullptr == fFaceRec) {
+            SkDEBUGF(("Could not create FT_Face.\n"));
+            return;
+        }
+        fontMemory = ft_face_rec_memory(fFaceRec);
+        if (nullptr == fontMemory) {
+            SkDEBUGF(("Could not read font data.\n"));
+            return;
+        }
     }
 
-    // load the font file
-    using UnrefFTFace = SkFunctionWrapper<void, skstd::remove_pointer_t<FT_Face>, unref_ft_face>;
-    std::unique_ptr<skstd::remove_pointer_t<FT_Face>, UnrefFTFace> ftFace(ref_ft_face(typeface));
+    // Open our own face in the pooled library, which no other thread uses while we hold its lock.
+    // fFaceRec keeps fontMemory alive for as long as we use it.
+    SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
+    using DoneFTFace = SkFunctionWrapper<FT_Error, skstd::remove_pointer_t<FT_Face>, FT_Done_Face>;
+    std::unique_ptr<skstd::remove_pointer_t<FT_Face>, DoneFTFace> ftFace(
+            open_ft_face(fLibrary->fLibrary.library(), fFaceRec, fontMemory.get()));
     if (nullptr == ftFace) {
         SkDEBUGF(("Could not create FT_Face.\n"));
         return;
@@ -944,7 +1073,7 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
         }
     } else {
         SkDEBUGF(("unknown kind of font \"%s\" size %f?\n",
-                            fFace->family_name,     SkFDot6ToScalar(fScaleY)));
+                            ftFace->family_name,    SkFDot6ToScalar(fScaleY)));
     }
 
     fFTSize = ftSize.release();
@@ -953,24 +1082,35 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
 }
 
 SkScalerContext_FreeType::~SkScalerContext_FreeType() {
+    if (fLibrary != nullptr) {
+        SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
+
+        if (fFTSize != nullptr) {
+            FT_Done_Size(fFTSize);
+        }
+
+        if (fFace != nullptr) {
+            FT_Done_Face(fFace);
+        }
+    }
+
     SkAutoMutexAcquire  ac(gFTMutex);
 
-    if (fFTSize != nullptr) {
-        FT_Done_Size(fFTSize);
+    if (fLibrary != nullptr) {
+        unref_pooled_ft_library(fLibrary);
     }
 
-    if (fFace != nullptr) {
-        unref_ft_face(fFace);
+    if (fFaceRec != nullptr) {
+        unref_ft_face(fFaceRec->fFace);
     }
 
     unref_ft_library();
 }
 
-/*  We call this before each use of the fFace, since we may be sharing
-    this face with other context (at different sizes).
+/*  We call this before each use of the fFace, to be sure our size and transform are the
+    ones in effect.
 */
 FT_Error SkScalerContext_FreeType::setupSize() {
-    gFTMutex.assertHeld();
     FT_Error err = FT_Activate_Size(fFTSize);
     if (err != 0) {
         SkDEBUGF(("SkScalerContext_FreeType::FT_Activate_Size(%s %s, 0x%x, 0x%x) returned 0x%x\n",
@@ -990,12 +1130,13 @@ unsigned SkScalerContext_FreeType::generateGlyphCount() {
 }
 
 uint16_t SkScalerContext_FreeType::generateCharToGlyph(SkUnichar uni) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
     return SkToU16(FT_Get_Char_Index( fFace, uni ));
 }
 
 SkUnichar SkScalerContext_FreeType::generateGlyphToChar(uint16_t glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
+
     // iterate through each cmap entry, looking for matching glyph indices
     FT_UInt glyphIndex;
     SkUnichar charCode = FT_Get_First_Char( fFace, &glyphIndex );
@@ -1010,6 +1151,12 @@ SkUnichar SkScalerContext_FreeType::generateGlyphToChar(uint16_t glyph) {
     return 0;
 }
 
+uint32_t SkScalerContext_FreeType::generateEngineVersion() {
+    FT_Int major, minor, patch;
+    FT_Library_Version(fFace->glyph->library, &major, &minor, &patch);
+    return SkSetFourByteTag('F', SkToU8(major), SkToU8(minor), SkToU8(patch));
+}
+
 static SkScalar SkFT_FixedToScalar(FT_Fixed x) {
   return SkFixedToScalar(x);
 }
@@ -1019,8 +1166,7 @@ void SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
     * which are very cheap to compute with some font formats...
     */
     if (fDoLinearMetrics) {
-        SkAutoMutexAcquire  ac(gFTMutex);
-
+        SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
         if (this->setupSize()) {
             glyph->zeroMetrics();
             return;
@@ -1102,11 +1248,11 @@ bool SkScalerContext_FreeType::getCBoxForLetter(char letter, FT_BBox* bbox) {
 void SkScalerContext_FreeType::updateGlyphIfLCD(SkGlyph* glyph) {
     if (isLCD(fRec)) {
         if (fLCDIsVert) {
-            glyph->fHeight += gFTLibrary->lcdExtra();
-            glyph->fTop -= gFTLibrary->lcdExtra() >> 1;
+            glyph->fHeight += fLibrary->fLibrary.lcdExtra();
+            glyph->fTop -= fLibrary->fLibrary.lcdExtra() >> 1;
         } else {
-            glyph->fWidth += gFTLibrary->lcdExtra();
-            glyph->fLeft -= gFTLibrary->lcdExtra() >> 1;
+            glyph->fWidth += fLibrary->fLibrary.lcdExtra();
+            glyph->fLeft -= fLibrary->fLibrary.lcdExtra() >> 1;
         }
     }
 }
@@ -1123,7 +1269,7 @@ inline void scaleGlyphMetrics(SkGlyph& glyph, SkScalar scale) {
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
 
     glyph->fRsbDelta = 0;
     glyph->fLsbDelta = 0;
@@ -1231,13 +1377,30 @@ static void clear_glyph_image(const SkGlyph& glyph) {
 }
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
-
+    SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
     if (this->setupSize()) {
         clear_glyph_image(glyph);
         return;
     }
+    this->generateImageWithSize(glyph);
+}
 
+void SkScalerContext_FreeType::generateImages(const SkGlyph* const glyphs[], int count) {
+    SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
+
+    // Activate our size and transform once for the whole batch.
+    if (this->setupSize()) {
+        for (int i = 0; i < count; i++) {
+            clear_glyph_image(*glyphs[i]);
+        }
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        this->generateImageWithSize(*glyphs[i]);
+    }
+}
+
+void SkScalerContext_FreeType::generateImageWithSize(const SkGlyph& glyph) {
     FT_Error err = FT_Load_Glyph(fFace, glyph.getGlyphID(), fLoadGlyphFlags);
     if (err != 0) {
         SkDEBUGF(("SkScalerContext_FreeType::generateImage: FT_Load_Glyph(glyph:%d width:%d height:%d rb:%d flags:%d) returned 0x%x\n",
@@ -1252,10 +1415,9 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
 
 
 void SkScalerContext_FreeType::generatePath(const SkGlyph& glyph, SkPath* path) {
-    SkAutoMutexAcquire  ac(gFTMutex);
-
     SkASSERT(path);
 
+    SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
     if (this->setupSize()) {
         path->reset();
         return;
@@ -1293,8 +1455,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkPaint::FontMetrics* metrics
         return;
     }
 
-    SkAutoMutexAcquire ac(gFTMutex);
-
+    SkAutoMutexAcquire libraryLock(fLibrary->fMutex);
     if (this->setupSize()) {
         sk_bzero(metrics, sizeof(*metrics));
         return;
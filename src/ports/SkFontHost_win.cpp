@@ -10,6 +10,7 @@
 
 #include "SkAdvancedTypefaceMetrics.h"
 #include "SkBase64.h"
+#include "SkChecksum.h"
 #include "SkColorPriv.h"
 #include "SkData.h"
 #include "SkDescriptor.h"
@@ -313,6 +314,11 @@ static bool FindByLogFont(SkTypeface* face, void* ctx) {
     return !memcmp(&lface->fLogFont, lf, sizeof(LOGFONT));
 }
 
+/** Hashes all of the LOGFONT that FindByLogFont compares. */
+static uint32_t hash_LogFont(const LOGFONT& lf) {
+    return SkChecksum::Murmur3(&lf, sizeof(LOGFONT));
+}
+
 /**
  *  This guy is public. It first searches the cache, and if a match is not found,
  *  it creates a new face.
@@ -320,10 +326,11 @@ static bool FindByLogFont(SkTypeface* face, void* ctx) {
 SkTypeface* SkCreateTypefaceFromLOGFONT(const LOGFONT& origLF) {
     LOGFONT lf = origLF;
     make_canonical(&lf);
-    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(FindByLogFont, &lf);
+    const uint32_t hash = hash_LogFont(lf);
+    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(hash, FindByLogFont, &lf);
     if (nullptr == face) {
         face = LogFontTypeface::Create(lf);
-        SkTypefaceCache::Add(face);
+        SkTypefaceCache::Add(face, hash);
     }
     return face;
 }
@@ -5,6 +5,8 @@
  * found in the LICENSE file.
  */
 
+#include "SkChecksum.h"
+#include "SkData.h"
 #include "SkFontDescriptor.h"
 #include "SkFontHost_FreeType_common.h"
 #include "SkFontMgr.h"
@@ -15,15 +17,25 @@
 #include "SkStream.h"
 #include "SkString.h"
 #include "SkTArray.h"
+#include "SkTHash.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
+#include "SkTime.h"
 #include "SkTypeface.h"
 #include "SkTypefaceCache.h"
 #include "SkTypes.h"
 
 #include <limits>
 #include <memory>
+#include <stdio.h>
 
-class SkData;
+#if defined(SK_BUILD_FOR_WIN)
+#   include <process.h>
+static int get_process_id() { return _getpid(); }
+#else
+#   include <unistd.h>
+static int get_process_id() { return getpid(); }
+#endif
 
 /** The base SkTypeface implementation for the custom font manager. */
 class SkTypeface_Custom : public SkTypeface_FreeType {
@@ -333,15 +345,48 @@ private:
 
 class DirectorySystemFontLoader : public SkFontMgr_Custom::SystemFontLoader {
 public:
-    DirectorySystemFontLoader(const char* dir) : fBaseDirectory(dir) { }
+    DirectorySystemFontLoader(const char* dir, const char* indexPath)
+        : fBaseDirectory(dir), fIndexPath(indexPath) { }
 
     void loadSystemFonts(const SkTypeface_FreeType::Scanner& scanner,
                          SkFontMgr_Custom::Families* families) const override
     {
-        load_directory_fonts(scanner, fBaseDirectory, ".ttf", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".ttc", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".otf", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".pfb", families);
+        SkTArray<FontFile> files;
+        find_directory_fonts(fBaseDirectory, ".ttf", &files);
+        find_directory_fonts(fBaseDirectory, ".ttc", &files);
+        find_directory_fonts(fBaseDirectory, ".otf", &files);
+        find_directory_fonts(fBaseDirectory, ".pfb", &files);
+
+        // Only fonts that were added or changed since the index was written need to be opened.
+        SkTArray<FontFile*> toScan;
+        const int indexed = this->readIndex(&files);
+        for (FontFile& file : files) {
+            if (!file.fScanned) {
+                toScan.push_back(&file);
+            }
+        }
+        scan_fonts(scanner, toScan);
+        if (!toScan.empty() || indexed != files.count()) {
+            this->writeIndex(files);
+        }
+
+        for (const FontFile& file : files) {
+            for (int faceIndex = 0; faceIndex < file.fFaces.count(); ++faceIndex) {
+                const Face& face = file.fFaces[faceIndex];
+                if (!face.fValid) {
+                    continue;
+                }
+                SkFontStyleSet_Custom* addTo = find_family(*families, face.fName.c_str());
+                if (nullptr == addTo) {
+                    addTo = new SkFontStyleSet_Custom(face.fName);
+                    families->push_back().reset(addTo);
+                }
+                addTo->appendTypeface(sk_make_sp<SkTypeface_File>(face.fStyle, face.fIsFixedPitch,
+                                                                  true, face.fName,
+                                                                  file.fPath.c_str(),
+                                                                  faceIndex));
+            }
+        }
 
         if (families->empty()) {
             SkFontStyleSet_Custom* family = new SkFontStyleSet_Custom(SkString());
@@ -351,6 +396,21 @@ public:
     }
 
 private:
+    struct Face {
+        bool fValid;
+        SkString fName;
+        SkFontStyle fStyle;
+        bool fIsFixedPitch;
+    };
+
+    struct FontFile {
+        SkString fPath;
+        size_t fSize;
+        int64_t fModified;
+        bool fScanned;
+        SkTArray<Face> fFaces;
+    };
+
     static SkFontStyleSet_Custom* find_family(SkFontMgr_Custom::Families& families,
                                               const char familyName[])
     {
@@ -362,63 +422,259 @@ private:
         return nullptr;
     }
 
-    static void load_directory_fonts(const SkTypeface_FreeType::Scanner& scanner,
-                                     const SkString& directory, const char* suffix,
-                                     SkFontMgr_Custom::Families* families)
+    static void find_directory_fonts(const SkString& directory, const char* suffix,
+                                     SkTArray<FontFile>* files)
     {
         SkOSFile::Iter iter(directory.c_str(), suffix);
         SkString name;
 
         while (iter.next(&name, false)) {
-            SkString filename(SkOSPath::Join(directory.c_str(), name.c_str()));
-            SkAutoTDelete<SkStream> stream(SkStream::NewFromFile(filename.c_str()));
-            if (!stream.get()) {
-                SkDebugf("---- failed to open <%s>\n", filename.c_str());
-                continue;
+            FontFile& file = files->push_back();
+            file.fPath = SkOSPath::Join(directory.c_str(), name.c_str());
+            file.fScanned = false;
+            if (!sk_stat(file.fPath.c_str(), &file.fSize, &file.fModified)) {
+                file.fSize = 0;
+                file.fModified = 0;
             }
+        }
 
-            int numFaces;
-            if (!scanner.recognizedFont(stream, &numFaces)) {
-                SkDebugf("---- failed to open <%s> as a font\n", filename.c_str());
+        SkOSFile::Iter dirIter(directory.c_str());
+        while (dirIter.next(&name, true)) {
+            if (name.startsWith(".")) {
                 continue;
             }
+            SkString dirname(SkOSPath::Join(directory.c_str(), name.c_str()));
+            find_directory_fonts(dirname, suffix, files);
+        }
+    }
 
-            for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
-                bool isFixedPitch;
-                SkString realname;
-                SkFontStyle style = SkFontStyle(); // avoid uninitialized warning
-                if (!scanner.scanFont(stream, faceIndex, &realname, &style, &isFixedPitch, nullptr)) {
-                    SkDebugf("---- failed to open <%s> <%d> as a font\n",
-                             filename.c_str(), faceIndex);
-                    continue;
-                }
+    static void scan_font(const SkTypeface_FreeType::Scanner& scanner, FontFile* file) {
+        file->fScanned = true;
+        SkAutoTDelete<SkStream> stream(SkStream::NewFromFile(file->fPath.c_str()));
+        if (!stream.get()) {
+            SkDebugf("---- failed to open <%s>\n", file->fPath.c_str());
+            return;
+        }
 
-                SkFontStyleSet_Custom* addTo = find_family(*families, realname.c_str());
-                if (nullptr == addTo) {
-                    addTo = new SkFontStyleSet_Custom(realname);
-                    families->push_back().reset(addTo);
-                }
-                addTo->appendTypeface(sk_make_sp<SkTypeface_File>(style, isFixedPitch, true,
-                                                                  realname, filename.c_str(),
-                                                                  faceIndex));
+        int numFaces;
+        if (!scanner.recognizedFont(stream, &numFaces)) {
+            SkDebugf("---- failed to open <%s> as a font\n", file->fPath.c_str());
+            return;
+        }
+
+        file->fFaces.reset(numFaces);
+        for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
+            Face& face = file->fFaces[faceIndex];
+            face.fStyle = SkFontStyle(); // avoid uninitialized warning
+            face.fValid = scanner.scanFont(stream, faceIndex, &face.fName, &face.fStyle,
+                                           &face.fIsFixedPitch, nullptr);
+            if (!face.fValid) {
+                SkDebugf("---- failed to open <%s> <%d> as a font\n",
+                         file->fPath.c_str(), faceIndex);
             }
         }
+    }
 
-        SkOSFile::Iter dirIter(directory.c_str());
-        while (dirIter.next(&name, true)) {
-            if (name.startsWith(".")) {
-                continue;
+    // A Scanner serializes its work, so each task gets its own.
+    static void scan_fonts(const SkTypeface_FreeType::Scanner& scanner,
+                           const SkTArray<FontFile*>& files)
+    {
+        static const int kFilesPerTask = 16;
+        if (files.count() <= kFilesPerTask) {
+            for (FontFile* file : files) {
+                scan_font(scanner, file);
             }
-            SkString dirname(SkOSPath::Join(directory.c_str(), name.c_str()));
-            load_directory_fonts(scanner, dirname, suffix, families);
+            return;
+        }
+        const int taskCount = (files.count() + kFilesPerTask - 1) / kFilesPerTask;
+        SkTaskGroup().batch(taskCount, [&files](int task) {
+            SkTypeface_FreeType::Scanner taskScanner;
+            const int stop = SkTMin((task + 1) * kFilesPerTask, files.count());
+            for (int i = task * kFilesPerTask; i < stop; ++i) {
+                scan_font(taskScanner, files[i]);
+            }
+        });
+    }
+
+    static const uint32_t kIndexVersion = 1;
+
+    // Unlike SkStream's readers these fail on a short read instead of asserting, since the
+    // index may have been truncated.
+    static bool read_u32(SkStream* stream, uint32_t* value) {
+        return stream->read(value, sizeof(*value)) == sizeof(*value);
+    }
+
+    static bool read_bool(SkStream* stream, bool* value) {
+        uint8_t byte;
+        if (stream->read(&byte, 1) != 1 || byte > 1) {
+            return false;
+        }
+        *value = SkToBool(byte);
+        return true;
+    }
+
+    // Reads what SkWStream::writePackedUInt() wrote.
+    static bool read_packed_uint(SkStream* stream, size_t* value) {
+        uint8_t byte;
+        if (stream->read(&byte, 1) != 1) {
+            return false;
+        }
+        if (0xFE == byte) {
+            uint16_t value16;
+            if (stream->read(&value16, sizeof(value16)) != sizeof(value16)) {
+                return false;
+            }
+            *value = value16;
+        } else if (0xFF == byte) {
+            uint32_t value32;
+            if (!read_u32(stream, &value32)) {
+                return false;
+            }
+            *value = value32;
+        } else {
+            *value = byte;
+        }
+        return true;
+    }
+
+    static bool read_string(SkStream* stream, SkString* string) {
+        size_t length;
+        if (!read_packed_uint(stream, &length) ||
+            length > stream->getLength() - stream->getPosition()) {
+            return false;
+        }
+        string->resize(length);
+        return stream->read(string->writable_str(), length) == length;
+    }
+
+    static bool read_entry(SkStream* stream, FontFile* entry) {
+        size_t size, numFaces;
+        uint32_t modifiedLo, modifiedHi;
+        if (!read_string(stream, &entry->fPath) ||
+            !read_packed_uint(stream, &size) ||
+            !read_u32(stream, &modifiedLo) ||
+            !read_u32(stream, &modifiedHi) ||
+            !read_packed_uint(stream, &numFaces) ||
+            numFaces > stream->getLength() - stream->getPosition()) {
+            return false;
+        }
+        entry->fSize = size;
+        entry->fModified = (int64_t)((uint64_t)modifiedHi << 32 | modifiedLo);
+        for (size_t f = 0; f < numFaces; ++f) {
+            Face& face = entry->fFaces.push_back();
+            size_t weight, width, slant;
+            if (!read_bool(stream, &face.fValid) ||
+                !read_string(stream, &face.fName) ||
+                !read_packed_uint(stream, &weight) ||
+                !read_packed_uint(stream, &width) ||
+                !read_packed_uint(stream, &slant) ||
+                !read_bool(stream, &face.fIsFixedPitch)) {
+                return false;
+            }
+            face.fStyle = SkFontStyle(SkToInt(weight), SkToInt(width), (SkFontStyle::Slant)slant);
+        }
+        return true;
+    }
+
+    static bool write_string(SkWStream* stream, const SkString& string) {
+        return stream->writePackedUInt(string.size()) &&
+               stream->write(string.c_str(), string.size());
+    }
+
+    // Fills in the faces of every file the index has an up to date entry for, and returns how
+    // many entries the index has.
+    int readIndex(SkTArray<FontFile>* files) const {
+        if (fIndexPath.isEmpty()) {
+            return 0;
+        }
+        sk_sp<SkData> data = SkData::MakeFromFileName(fIndexPath.c_str());
+        if (!data) {
+            return 0;
+        }
+        SkTHashMap<SkString, FontFile*> byPath;
+        for (FontFile& file : *files) {
+            byPath.set(file.fPath, &file);
+        }
+
+        // Any short read means the index is damaged, so none of it is trusted.
+        SkMemoryStream stream(std::move(data));
+        uint32_t version;
+        size_t count;
+        if (!read_u32(&stream, &version) || version != kIndexVersion ||
+            !read_packed_uint(&stream, &count) ||
+            count > stream.getLength() - stream.getPosition()) {
+            return 0;
+        }
+        SkTArray<FontFile> entries(SkToInt(count));
+        for (size_t i = 0; i < count; ++i) {
+            if (!read_entry(&stream, &entries.push_back())) {
+                return 0;
+            }
+        }
+
+        for (FontFile& entry : entries) {
+            FontFile** found = byPath.find(entry.fPath);
+            if (found && (*found)->fSize == entry.fSize && (*found)->fModified == entry.fModified) {
+                (*found)->fFaces = std::move(entry.fFaces);
+                (*found)->fScanned = true;
+            }
+        }
+        return entries.count();
+    }
+
+    void writeIndex(const SkTArray<FontFile>& files) const {
+        if (fIndexPath.isEmpty()) {
+            return;
+        }
+        // Write to a file of our own and move it into place, so a concurrent reader never sees
+        // half of it and concurrent writers never write into each other's.
+        SkString tmpPath;
+        tmpPath.printf("%s.%d.%08x.tmp", fIndexPath.c_str(), get_process_id(),
+                       SkChecksum::Mix((uint32_t)(intptr_t)this ^ (uint32_t)SkTime::GetNSecs()));
+        bool ok;
+        {
+            SkFILEWStream stream(tmpPath.c_str());
+            if (!stream.isValid()) {
+                return;
+            }
+            ok = stream.write32(kIndexVersion) && stream.writePackedUInt(files.count());
+            for (int i = 0; ok && i < files.count(); ++i) {
+                const FontFile& file = files[i];
+                ok = write_string(&stream, file.fPath) &&
+                     stream.writePackedUInt(file.fSize) &&
+                     stream.write32((uint32_t)file.fModified) &&
+                     stream.write32((uint32_t)((uint64_t)file.fModified >> 32)) &&
+                     stream.writePackedUInt(file.fFaces.count());
+                for (int f = 0; ok && f < file.fFaces.count(); ++f) {
+                    const Face& face = file.fFaces[f];
+                    ok = stream.writeBool(face.fValid) &&
+                         write_string(&stream, face.fName) &&
+                         stream.writePackedUInt(face.fStyle.weight()) &&
+                         stream.writePackedUInt(face.fStyle.width()) &&
+                         stream.writePackedUInt(face.fStyle.slant()) &&
+                         stream.writeBool(face.fIsFixedPitch);
+                }
+            }
+            // Hand everything to the OS before the rename; a failed write closes the stream.
+            stream.flush();
+            ok = ok && stream.isValid();
+        }
+        // Never move a partial index into place.
+        if (!ok || 0 != rename(tmpPath.c_str(), fIndexPath.c_str())) {
+            remove(tmpPath.c_str());
         }
     }
 
     SkString fBaseDirectory;
+    SkString fIndexPath;
 };
 
 SK_API SkFontMgr* SkFontMgr_New_Custom_Directory(const char* dir) {
-    return new SkFontMgr_Custom(DirectorySystemFontLoader(dir));
+    return new SkFontMgr_Custom(DirectorySystemFontLoader(dir, nullptr));
+}
+
+SK_API SkFontMgr* SkFontMgr_New_Custom_Directory(const char* dir, const char* indexPath) {
+    return new SkFontMgr_Custom(DirectorySystemFontLoader(dir, indexPath));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -13,5 +13,9 @@
 #endif
 
 SkFontMgr* SkFontMgr::Factory() {
+#ifdef SK_FONT_INDEX_PATH
+    return SkFontMgr_New_Custom_Directory(SK_FONT_FILE_PREFIX, SK_FONT_INDEX_PATH);
+#else
     return SkFontMgr_New_Custom_Directory(SK_FONT_FILE_PREFIX);
+#endif
 }
@@ -10,11 +10,13 @@
 #include "SkFontDescriptor.h"
 #include "SkFontHost_FreeType_common.h"
 #include "SkFontMgr.h"
+#include "SkFontRequestCache.h"
 #include "SkFontStyle.h"
 #include "SkMath.h"
 #include "SkMutex.h"
 #include "SkOSFile.h"
 #include "SkRefCnt.h"
+#include "SkSharedMutex.h"
 #include "SkStream.h"
 #include "SkString.h"
 #include "SkTDArray.h"
@@ -623,30 +625,93 @@ class SkFontMgr_fontconfig : public SkFontMgr {
         return FcTrue == FcPatternEqual(cshFace->fPattern, ctxPattern);
     }
 
-    mutable SkMutex fTFCacheMutex;
+    /** Held shared to find typefaces in fTFCache, exclusive to add them. */
+    mutable SkSharedMutex fTFCacheMutex;
     mutable SkTypefaceCache fTFCache;
     /** Creates a typeface using a typeface cache.
      *  @param pattern a complete pattern from FcFontRenderPrepare.
      */
     SkTypeface* createTypefaceFromFcPattern(FcPattern* pattern) const {
         FCLocker::AssertHeld();
-        SkAutoMutexAcquire ama(fTFCacheMutex);
-        SkTypeface* face = fTFCache.findByProcAndRef(FindByFcPattern, pattern);
+        // Equal patterns have equal hashes.
+        const uint32_t hash = FcPatternHash(pattern);
+        {
+            SkAutoSharedMutexShared asms(fTFCacheMutex);
+            if (SkTypeface* face = fTFCache.findByProcAndRef(hash, FindByFcPattern, pattern)) {
+                return face;
+            }
+        }
+        SkAutoExclusive ae(fTFCacheMutex);
+        // It may have been added since the shared find.
+        SkTypeface* face = fTFCache.findByProcAndRef(hash, FindByFcPattern, pattern);
         if (nullptr == face) {
             FcPatternReference(pattern);
             face = SkTypeface_fontconfig::Create(pattern);
             if (face) {
-                fTFCache.add(face);
+                fTFCache.add(face, hash);
             }
         }
         return face;
     }
 
+    /** Identifies the fonts of a config. Adding application fonts or rebuilding the font sets
+     *  changes the sets or their counts, after which earlier matches may be stale.
+     */
+    struct FontSetsID {
+        FcFontSet* fSets[2];
+        int fCounts[2];
+
+        /** Does not need FCLocker: given a config, FcConfigGetFonts only reads its fields. Only
+         *  a null config makes it touch fontconfig's global state.
+         */
+        void set(FcConfig* config) {
+            static const FcSetName fcNameSet[] = { FcSetSystem, FcSetApplication };
+            for (int setIndex = 0; setIndex < (int)SK_ARRAY_COUNT(fcNameSet); ++setIndex) {
+                // Return value of FcConfigGetFonts must not be destroyed.
+                fSets[setIndex] = config ? FcConfigGetFonts(config, fcNameSet[setIndex]) : nullptr;
+                fCounts[setIndex] = fSets[setIndex] ? fSets[setIndex]->nfont : 0;
+            }
+        }
+        bool operator==(const FontSetsID& that) const {
+            return !memcmp(this, &that, sizeof(*this));
+        }
+    };
+
+    // Matches made since the config's fonts last changed. Matches are looked up before taking
+    // FCLocker, and fMatchCacheMutex is held only to look up and add them, not while matching.
+    static const size_t kMatchCacheMaxSize = 1 << 15;
+    mutable SkMutex fMatchCacheMutex;
+    mutable SkFontRequestCache fMatchCache;
+    mutable FontSetsID fMatchCacheFontSets;
+
+    /** Forgets all cached matches if the config's fonts changed since they were made, then
+     *  looks up the request. */
+    bool findMatch(const SkFontRequestCache::Request& request, sk_sp<SkTypeface>* face) const {
+        FontSetsID current;
+        current.set(fFC);
+        SkAutoMutexAcquire ama(fMatchCacheMutex);
+        if (!(current == fMatchCacheFontSets)) {
+            fMatchCache.purgeAll();
+            fMatchCacheFontSets = current;
+        }
+        return fMatchCache.find(request, face);
+    }
+
+    /** Takes ownership of request. */
+    void addMatch(SkTypeface* face, SkFontRequestCache::Request* request) const {
+        SkAutoMutexAcquire ama(fMatchCacheMutex);
+        fMatchCache.add(face, request);
+    }
+
 public:
     /** Takes control of the reference to 'config'. */
     explicit SkFontMgr_fontconfig(FcConfig* config)
         : fFC(config ? config : FcInitLoadConfigAndFonts())
-        , fFamilyNames(GetFamilyNames(fFC)) { }
+        , fFamilyNames(GetFamilyNames(fFC))
+        , fMatchCache(kMatchCacheMaxSize)
+    {
+        fMatchCacheFontSets.set(fFC);
+    }
 
     virtual ~SkFontMgr_fontconfig() {
         // Hold the lock while unrefing the config.
@@ -776,7 +841,43 @@ protected:
     virtual SkTypeface* onMatchFamilyStyle(const char familyName[],
                                            const SkFontStyle& style) const override
     {
+        SkAutoTDelete<SkFontRequestCache::Request> request(
+                SkFontRequestCache::Request::Create(familyName, style));
+        sk_sp<SkTypeface> face;
+        if (this->findMatch(*request, &face)) {
+            return face.release();
+        }
+
         FCLocker lock;
+        face.reset(this->matchFamilyStyleUncached(familyName, style));
+        this->addMatch(face.get(), request.release());
+        return face.release();
+    }
+
+    virtual SkTypeface* onMatchFamilyStyleCharacter(const char familyName[],
+                                                    const SkFontStyle& style,
+                                                    const char* bcp47[],
+                                                    int bcp47Count,
+                                                    SkUnichar character) const override
+    {
+        // Matches are remembered per character. A font matched for one character may have its
+        // neighbors too, but fontconfig could rank another font first for them.
+        SkAutoTDelete<SkFontRequestCache::Request> request(SkFontRequestCache::Request::Create(
+                familyName, style, bcp47, bcp47Count, character));
+        sk_sp<SkTypeface> face;
+        if (this->findMatch(*request, &face)) {
+            return face.release();
+        }
+
+        FCLocker lock;
+        face.reset(this->matchFamilyStyleCharacterUncached(familyName, style, bcp47, bcp47Count,
+                                                           character));
+        this->addMatch(face.get(), request.release());
+        return face.release();
+    }
+
+    SkTypeface* matchFamilyStyleUncached(const char familyName[], const SkFontStyle& style) const {
+        FCLocker::AssertHeld();
 
         SkAutoFcPattern pattern;
         FcPatternAddString(pattern, FC_FAMILY, (FcChar8*)familyName);
@@ -811,13 +912,13 @@ protected:
         return createTypefaceFromFcPattern(font);
     }
 
-    virtual SkTypeface* onMatchFamilyStyleCharacter(const char familyName[],
-                                                    const SkFontStyle& style,
-                                                    const char* bcp47[],
-                                                    int bcp47Count,
-                                                    SkUnichar character) const override
+    SkTypeface* matchFamilyStyleCharacterUncached(const char familyName[],
+                                                  const SkFontStyle& style,
+                                                  const char* bcp47[],
+                                                  int bcp47Count,
+                                                  SkUnichar character) const
     {
-        FCLocker lock;
+        FCLocker::AssertHeld();
 
         SkAutoFcPattern pattern;
         if (familyName) {
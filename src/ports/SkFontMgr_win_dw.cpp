@@ -13,6 +13,7 @@
 #include "SkFontMgr.h"
 #include "SkHRESULT.h"
 #include "SkMutex.h"
+#include "SkSharedMutex.h"
 #include "SkStream.h"
 #include "SkTScopedComPtr.h"
 #include "SkTypeface.h"
@@ -319,7 +320,8 @@ private:
 #endif
     SkTScopedComPtr<IDWriteFontCollection> fFontCollection;
     SkSMallocWCHAR fLocaleName;
-    mutable SkMutex fTFCacheMutex;
+    /** Held shared to find typefaces in fTFCache, exclusive to add them. */
+    mutable SkSharedMutex fTFCacheMutex;
     mutable SkTypefaceCache fTFCache;
 
     friend class SkFontStyleSet_DirectWrite;
@@ -459,8 +461,15 @@ SkTypeface* SkFontMgr_DirectWrite::createTypefaceFromDWriteFont(
         IDWriteFontFace* fontFace,
         IDWriteFont* font,
         IDWriteFontFamily* fontFamily) const {
-    SkAutoMutexAcquire ama(fTFCacheMutex);
     ProtoDWriteTypeface spec = { fontFace, font, fontFamily };
+    {
+        SkAutoSharedMutexShared asms(fTFCacheMutex);
+        if (SkTypeface* face = fTFCache.findByProcAndRef(FindByDWriteFont, &spec)) {
+            return face;
+        }
+    }
+    SkAutoExclusive ae(fTFCacheMutex);
+    // It may have been added since the shared find.
     SkTypeface* face = fTFCache.findByProcAndRef(FindByDWriteFont, &spec);
     if (nullptr == face) {
         face = DWriteFontTypeface::Create(fFactory.get(), fontFace, font, fontFamily);
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCanvas.h"
+#include "SkImageCacherator.h"
+#include "SkImagePrefetcher.h"
+#include "SkImage_Base.h"
+#include "SkPicture.h"
+#include "SkTArray.h"
+#include "SkTaskGroup.h"
+
+namespace {
+
+// Plays back a picture without drawing anything, just noting the images it would draw.
+class ImageCollector : public SkCanvas {
+public:
+    ImageCollector(const SkRect& bounds, SkTArray<sk_sp<SkImage>>* images)
+        : INHERITED(SkScalarCeilToInt(bounds.width()), SkScalarCeilToInt(bounds.height()))
+        , fImages(images) {}
+
+protected:
+    void onDrawImage(const SkImage* image, SkScalar, SkScalar, const SkPaint*) override {
+        this->collect(image);
+    }
+    void onDrawImageRect(const SkImage* image, const SkRect*, const SkRect&, const SkPaint*,
+                         SrcRectConstraint) override {
+        this->collect(image);
+    }
+    void onDrawImageNine(const SkImage* image, const SkIRect&, const SkRect&,
+                         const SkPaint*) override {
+        this->collect(image);
+    }
+    void onDrawAtlas(const SkImage* image, const SkRSXform[], const SkRect[], const SkColor[],
+                     int, SkXfermode::Mode, const SkRect*, const SkPaint*) override {
+        this->collect(image);
+    }
+
+private:
+    void collect(const SkImage* image) {
+        if (!image || !image->isLazyGenerated()) {
+            return;
+        }
+        for (const sk_sp<SkImage>& seen : *fImages) {
+            if (seen->uniqueID() == image->uniqueID()) {
+                return;
+            }
+        }
+        fImages->push_back(sk_ref_sp(const_cast<SkImage*>(image)));
+    }
+
+    SkTArray<sk_sp<SkImage>>* fImages;
+
+    typedef SkCanvas INHERITED;
+};
+
+}  // namespace
+
+SkImagePrefetcher::SkImagePrefetcher() : fTasks(new SkTaskGroup) {}
+
+SkImagePrefetcher::~SkImagePrefetcher() {
+    this->wait();
+}
+
+void SkImagePrefetcher::prefetch(sk_sp<SkImage> image) {
+    if (!image || !as_IB(image)->peekCacherator()) {
+        return;
+    }
+    fTasks->add([image]() {
+        as_IB(image)->peekCacherator()->prefetch(image.get());
+    });
+}
+
+void SkImagePrefetcher::prefetch(const SkPicture* picture) {
+    if (!picture) {
+        return;
+    }
+    SkTArray<sk_sp<SkImage>> images;
+    ImageCollector collector(picture->cullRect(), &images);
+    picture->playback(&collector);
+    for (sk_sp<SkImage>& image : images) {
+        this->prefetch(std::move(image));
+    }
+}
+
+void SkImagePrefetcher::wait() {
+    fTasks->wait();
+}
+
+SkImagePrefetcher::Stats SkImagePrefetcher::GetStats() {
+    const SkImageCacherator::Stats stats = SkImageCacherator::GetStats();
+    return { stats.fPrefetched, stats.fAlreadyCached, stats.fHits, stats.fMisses };
+}
+
+void SkImagePrefetcher::ResetStats() {
+    SkImageCacherator::ResetStats();
+}
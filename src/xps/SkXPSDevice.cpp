@@ -2241,6 +2241,15 @@ void SkXPSDevice::drawPosText(const SkDraw& d,
                   paint));
 }
 
+void SkXPSDevice::drawTextBlobRun(const SkDraw& d,
+                                  const SkTextBlob* blob, int runIndex,
+                                  const SkTextBlobRunIterator& it,
+                                  SkScalar x, SkScalar y,
+                                  const SkPaint& paint) {
+    // Not the raster layout cache: runs go through drawText and drawPosText above.
+    this->SkBaseDevice::drawTextBlobRun(d, blob, runIndex, it, x, y, paint);
+}
+
 void SkXPSDevice::drawDevice(const SkDraw& d, SkBaseDevice* dev,
                              int x, int y,
                              const SkPaint&) {
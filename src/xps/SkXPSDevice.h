@@ -122,6 +122,13 @@ protected:
         const SkScalar pos[], int scalarsPerPos,
         const SkPoint& offset, const SkPaint& paint) override;
 
+    void drawTextBlobRun(
+        const SkDraw&,
+        const SkTextBlob*, int runIndex,
+        const SkTextBlobRunIterator&,
+        SkScalar x, SkScalar y,
+        const SkPaint& paint) override;
+
     virtual void drawVertices(
         const SkDraw&,
         SkCanvas::VertexMode,
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkBitmap.h"
+#include "SkBitmapRegionDecoder.h"
+#include "SkStream.h"
+#include "Test.h"
+
+static SkBitmapRegionDecoder* make_brd(const char* path,
+                                       SkBitmapRegionDecoder::Strategy strategy) {
+    SkStreamAsset* stream = GetResourceAsStream(path);
+    if (!stream) {
+        return nullptr;
+    }
+    return SkBitmapRegionDecoder::Create(stream, strategy);
+}
+
+// Each decoder tags its bitmaps with its own color space, so compare everything else.
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.dimensions() != b.dimensions() || a.colorType() != b.colorType() ||
+            a.alphaType() != b.alphaType()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); y++) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Regions whose origins are multiples of the sample size are assembled from cached tiles,
+// but should be indistinguishable from a direct decode.
+DEF_TEST(BitmapRegionDecoder_Tiled, r) {
+    const char* path = "mandrill_512.png";
+    SkAutoTDelete<SkBitmapRegionDecoder> direct(
+            make_brd(path, SkBitmapRegionDecoder::kAndroidCodec_Strategy));
+    SkAutoTDelete<SkBitmapRegionDecoder> tiled(
+            make_brd(path, SkBitmapRegionDecoder::kAndroidCodecTiled_Strategy));
+    if (!direct || !tiled) {
+        SkDebugf("Missing resource '%s'\n", path);
+        return;
+    }
+
+    // Pan around, including off the edges, so later regions overlap cached tiles.
+    const SkIRect regions[] = {
+        SkIRect::MakeXYWH(  0,   0, 200, 200),
+        SkIRect::MakeXYWH(100,  60, 200, 200),
+        SkIRect::MakeXYWH(200, 240, 312, 272),
+        SkIRect::MakeXYWH(-40, 400, 200, 200),
+        SkIRect::MakeXYWH(  0,   0, 512, 512),
+        SkIRect::MakeXYWH(400, -20, 160, 100),
+    };
+    for (int sampleSize : { 1, 2, 4 }) {
+        for (int pass = 0; pass < 2; pass++) {
+            for (const SkIRect& region : regions) {
+                SkBitmap expected, actual;
+                REPORTER_ASSERT(r, direct->decodeRegion(&expected, nullptr, region, sampleSize,
+                                                        kN32_SkColorType, false));
+                REPORTER_ASSERT(r, tiled->decodeRegion(&actual, nullptr, region, sampleSize,
+                                                       kN32_SkColorType, false));
+                REPORTER_ASSERT(r, equal_pixels(expected, actual));
+            }
+        }
+    }
+}
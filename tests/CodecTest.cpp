@@ -8,6 +8,7 @@
 #include "Resources.h"
 #include "SkAndroidCodec.h"
 #include "SkBitmap.h"
+#include "SkBitmapScaler.h"
 #include "SkCodec.h"
 #include "SkCodecImageGenerator.h"
 #include "SkData.h"
@@ -654,6 +655,62 @@ static void test_invalid(skiatest::Reporter* r, const char path[]) {
     REPORTER_ASSERT(r, nullptr == codec);
 }
 
+// JPEGs that cannot be sampled by a power of two are scaled by n/8 while decoding and then
+// resized, so they should look like a resize of the full decode.
+DEF_TEST(Codec_JpegNativeScaleThenResize, r) {
+    const char* path = "mandrill_512_q075.jpg";
+    SkAutoTDelete<SkStream> stream(resource(path));
+    if (!stream) {
+        SkDebugf("Missing resource '%s'\n", path);
+        return;
+    }
+    SkAutoTDelete<SkAndroidCodec> codec(SkAndroidCodec::NewFromStream(stream.release()));
+    REPORTER_ASSERT(r, codec);
+
+    SkBitmap full;
+    full.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType));
+    REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                       codec->getAndroidPixels(full.info(), full.getPixels(), full.rowBytes()));
+
+    SkIRect subsets[] = { SkIRect::MakeSize(full.dimensions()),
+                          SkIRect::MakeXYWH(100, 60, 250, 301) };
+    for (SkIRect subset : subsets) {
+        for (int sampleSize : { 3, 5, 6, 7, 12 }) {
+            SkAndroidCodec::AndroidOptions options;
+            options.fSampleSize = sampleSize;
+            options.fSubset = &subset;
+            const SkISize size = codec->getSampledSubsetDimensions(sampleSize, subset);
+            SkBitmap scaled;
+            scaled.allocPixels(full.info().makeWH(size.width(), size.height()));
+            REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getAndroidPixels(
+                    scaled.info(), scaled.getPixels(), scaled.rowBytes(), &options));
+
+            SkBitmap fullSubset, expected;
+            full.extractSubset(&fullSubset, subset);
+            SkAutoLockPixels alp(fullSubset);
+            SkPixmap src, dst;
+            expected.allocPixels(scaled.info());
+            REPORTER_ASSERT(r, fullSubset.peekPixels(&src) && expected.peekPixels(&dst));
+            REPORTER_ASSERT(r, SkBitmapScaler::Resize(dst, src, SkBitmapScaler::RESIZE_BOX));
+
+            // DCT scaling and box filtering are both averages, so they should agree closely.
+            // Subsets may be misaligned by a fraction of a pixel, which mandrill exaggerates.
+            uint64_t totalDiff = 0;
+            for (int y = 0; y < size.height(); y++) {
+                for (int x = 0; x < size.width(); x++) {
+                    SkPMColor a = *scaled.getAddr32(x, y),
+                              b = *expected.getAddr32(x, y);
+                    totalDiff += SkTAbs((int) SkGetPackedR32(a) - (int) SkGetPackedR32(b)) +
+                                 SkTAbs((int) SkGetPackedG32(a) - (int) SkGetPackedG32(b)) +
+                                 SkTAbs((int) SkGetPackedB32(a) - (int) SkGetPackedB32(b));
+                }
+            }
+            const uint64_t meanDiff = totalDiff / (3 * size.width() * size.height());
+            REPORTER_ASSERT(r, meanDiff < 12);
+        }
+    }
+}
+
 DEF_TEST(Codec_Empty, r) {
     // Test images that should not be able to create a codec
     test_invalid(r, "empty_images/zero-dims.gif");
@@ -958,6 +1015,47 @@ DEF_TEST(Codec_webp_peek, r) {
     test_info(r, codec.get(), codec->getInfo(), SkCodec::kSuccess, nullptr);
 }
 
+// Memory-backed streams are handed to the decoding library in place, rather than copied in
+// through a buffer.  Both ways should produce the same pixels, for complete and truncated data.
+DEF_TEST(Codec_memoryBacked, r) {
+    for (const char* path : { "mandrill_512_q075.jpg", "CMYK.jpg", "color_wheel.webp",
+                              "yellow_rose.webp" }) {
+        SkString fullPath(GetResourcePath(path));
+        auto data = SkData::MakeFromFileName(fullPath.c_str());
+        if (!data) {
+            SkDebugf("Missing resource '%s'\n", path);
+            continue;
+        }
+
+        for (size_t length : { data->size(), data->size() / 2 }) {
+            auto truncated = SkData::MakeSubset(data.get(), 0, length);
+            SkAutoTDelete<SkCodec> buffered(SkCodec::NewFromStream(
+                                            new NotAssetMemStream(truncated.get())));
+            SkAutoTDelete<SkCodec> inPlace(SkCodec::NewFromData(truncated.get()));
+            if (!buffered || !inPlace) {
+                ERRORF(r, "Failed to create codecs for '%s'", path);
+                continue;
+            }
+
+            SkBitmap bm;
+            bm.allocPixels(buffered->getInfo().makeColorType(kN32_SkColorType));
+            bm.eraseColor(SK_ColorTRANSPARENT);
+            const SkCodec::Result result = buffered->getPixels(bm.info(), bm.getPixels(),
+                                                               bm.rowBytes());
+            REPORTER_ASSERT(r, SkCodec::kSuccess == result ||
+                               SkCodec::kIncompleteInput == result);
+            SkMD5::Digest digest;
+            md5(bm, &digest);
+
+            // Incomplete decodes fill the remaining rows themselves.
+            bm.eraseColor(SK_ColorTRANSPARENT);
+            REPORTER_ASSERT(r, result == inPlace->getPixels(bm.info(), bm.getPixels(),
+                                                            bm.rowBytes()));
+            compare_to_good_digest(r, digest, bm);
+        }
+    }
+}
+
 // SkCodec's wbmp decoder was initially unnecessarily restrictive.
 // It required the second byte to be zero. The wbmp specification allows
 // a couple of bits to be 1 (so long as they do not overlap with 0x9F).
@@ -1012,3 +1110,182 @@ DEF_TEST(Codec_wbmp_max_size, r) {
 
     REPORTER_ASSERT(r, !codec);
 }
+
+static void decode_frame(skiatest::Reporter* r, SkCodec* codec, size_t frame, bool hasPriorFrame,
+                         SkBitmap* bm) {
+    SkCodec::Options options;
+    options.fFrameIndex = frame;
+    options.fHasPriorFrame = hasPriorFrame;
+    const SkCodec::Result result = codec->getPixels(bm->info(), bm->getPixels(), bm->rowBytes(),
+                                                    &options, nullptr, nullptr);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+}
+
+static void test_frames(skiatest::Reporter* r, SkStream* stream) {
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromStream(stream));
+    REPORTER_ASSERT(r, codec);
+    if (!codec) {
+        return;
+    }
+
+    // animated_frames.gif keeps, restores to the background and restores to the previous
+    // frame, with transparent pixels, interlacing and a frame that stands alone.
+    const size_t kNone = SkCodec::kNone;
+    const struct {
+        size_t                  fRequiredFrame;
+        size_t                  fDuration;
+        SkCodec::DisposalMethod fDisposalMethod;
+    } gExpected[] = {
+        { kNone, 100, SkCodec::kKeep_DisposalMethod            },
+        { 0,     200, SkCodec::kKeep_DisposalMethod            },
+        { 1,     300, SkCodec::kRestoreBGColor_DisposalMethod  },
+        { 1,     400, SkCodec::kRestorePrevious_DisposalMethod },
+        { 1,     500, SkCodec::kKeep_DisposalMethod            },
+        { kNone, 600, SkCodec::kKeep_DisposalMethod            },
+        { 5,     700, SkCodec::kKeep_DisposalMethod            },
+    };
+    const size_t frameCount = SK_ARRAY_COUNT(gExpected);
+    REPORTER_ASSERT(r, codec->getFrameCount() == frameCount);
+    const std::vector<SkCodec::FrameInfo> frameInfo = codec->getFrameInfo();
+    REPORTER_ASSERT(r, frameInfo.size() == frameCount);
+    if (frameInfo.size() != frameCount) {
+        return;
+    }
+
+    const SkImageInfo info = codec->getInfo().makeColorType(kN32_SkColorType)
+                                             .makeAlphaType(kPremul_SkAlphaType);
+    SkBitmap frames[frameCount];
+    for (size_t i = 0; i < frameCount; i++) {
+        REPORTER_ASSERT(r, frameInfo[i].fRequiredFrame == gExpected[i].fRequiredFrame);
+        REPORTER_ASSERT(r, frameInfo[i].fDuration == gExpected[i].fDuration);
+        REPORTER_ASSERT(r, frameInfo[i].fDisposalMethod == gExpected[i].fDisposalMethod);
+
+        // Decoding a frame along with the frames it depends on should match blending it
+        // onto its required frame.
+        frames[i].allocPixels(info);
+        decode_frame(r, codec, i, false, &frames[i]);
+        const size_t requiredFrame = frameInfo[i].fRequiredFrame;
+        if (kNone != requiredFrame) {
+            SkBitmap blended;
+            REPORTER_ASSERT(r, frames[requiredFrame].copyTo(&blended));
+            decode_frame(r, codec, i, true, &blended);
+            REPORTER_ASSERT(r, 0 == memcmp(frames[i].getPixels(), blended.getPixels(),
+                                           frames[i].getSize()));
+        }
+    }
+
+    const SkPMColor red   = SkPreMultiplyColor(SK_ColorRED);
+    const SkPMColor green = SkPreMultiplyColor(SK_ColorGREEN);
+    const SkPMColor blue  = SkPreMultiplyColor(SK_ColorBLUE);
+    const SkPMColor clear = SK_ColorTRANSPARENT;
+    const struct {
+        size_t    fFrame;
+        int       fX, fY;
+        SkPMColor fColor;
+    } gPixels[] = {
+        { 1,  4,  4, green },  // Opaque pixels of the frame
+        { 1,  5,  4, red   },  // Transparent pixels show the prior frame
+        { 3,  0,  0, clear },  // The prior frame was restored to the background
+        { 3,  8,  4, green },  // but not outside of its rectangle.
+        { 3, 12, 12, green },
+        { 4,  2,  2, blue  },
+        { 4,  4,  2, clear },
+        { 4, 12, 12, red   },  // The prior frame was restored to the one before it
+        { 6,  0,  0, green },
+        { 6,  0,  4, red   },  // Interlaced rows land where they belong
+        { 6,  0,  5, green },
+        { 6,  0, 10, red   },
+        { 6,  0, 11, green },
+    };
+    for (const auto& pixel : gPixels) {
+        REPORTER_ASSERT(r, *frames[pixel.fFrame].getAddr32(pixel.fX, pixel.fY) == pixel.fColor);
+    }
+
+    // Frames past the end are rejected.
+    SkBitmap bm;
+    bm.allocPixels(info);
+    SkCodec::Options options;
+    options.fFrameIndex = frameCount;
+    REPORTER_ASSERT(r, SkCodec::kInvalidParameters == codec->getPixels(info, bm.getPixels(),
+            bm.rowBytes(), &options, nullptr, nullptr));
+
+    // Scanline decodes only support the first frame.
+    options.fFrameIndex = 1;
+    REPORTER_ASSERT(r, SkCodec::kUnimplemented == codec->startScanlineDecode(info, &options,
+            nullptr, nullptr));
+    options.fFrameIndex = 0;
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->startScanlineDecode(info, &options,
+            nullptr, nullptr));
+    REPORTER_ASSERT(r, info.height() == codec->getScanlines(bm.getPixels(), info.height(),
+            bm.rowBytes()));
+    REPORTER_ASSERT(r, 0 == memcmp(frames[0].getPixels(), bm.getPixels(), bm.getSize()));
+}
+
+DEF_TEST(Codec_frames, r) {
+    const char* path = "animated_frames.gif";
+    SkAutoTDelete<SkStream> stream(resource(path));
+    if (!stream) {
+        SkDebugf("Missing resource '%s'\n", path);
+        return;
+    }
+    sk_sp<SkData> data = SkCopyStreamToData(stream);
+
+    // Seek straight to each frame, and walk through the stream when we cannot.
+    test_frames(r, new SkMemoryStream(data));
+    test_frames(r, new NotAssetMemStream(data.get()));
+
+    // A still image is a single frame.
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromStream(resource("mandrill_512.png")));
+    REPORTER_ASSERT(r, codec && 1 == codec->getFrameCount() && codec->getFrameInfo().empty());
+}
+
+// animated_frames.webp holds the composited frames of animated_frames.gif, losslessly
+// re-encoded into sub-rectangles that blend onto the frames before them.
+DEF_TEST(Codec_webp_frames, r) {
+    SkAutoTDelete<SkCodec> gif(SkCodec::NewFromStream(resource("animated_frames.gif")));
+    SkAutoTDelete<SkCodec> webp(SkCodec::NewFromStream(resource("animated_frames.webp")));
+    if (!gif || !webp) {
+        SkDebugf("Missing resources for Codec_webp_frames\n");
+        return;
+    }
+
+    const size_t frameCount = gif->getFrameCount();
+    REPORTER_ASSERT(r, webp->getFrameCount() == frameCount);
+    const std::vector<SkCodec::FrameInfo> frameInfo = webp->getFrameInfo();
+    REPORTER_ASSERT(r, frameInfo.size() == frameCount);
+    if (frameInfo.size() != frameCount) {
+        return;
+    }
+
+    const SkImageInfo info = gif->getInfo().makeColorType(kN32_SkColorType)
+                                           .makeAlphaType(kPremul_SkAlphaType);
+    std::vector<SkBitmap> frames(frameCount);
+    for (size_t i = 0; i < frameCount; i++) {
+        REPORTER_ASSERT(r, frameInfo[i].fDuration == 100 * (i + 1));
+
+        SkBitmap expected;
+        expected.allocPixels(info);
+        decode_frame(r, gif, i, false, &expected);
+        frames[i].allocPixels(info);
+        decode_frame(r, webp, i, false, &frames[i]);
+        REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), frames[i].getPixels(),
+                                       expected.getSize()));
+
+        const size_t requiredFrame = frameInfo[i].fRequiredFrame;
+        if (SkCodec::kNone != requiredFrame) {
+            REPORTER_ASSERT(r, requiredFrame < i);
+            SkBitmap blended;
+            REPORTER_ASSERT(r, frames[requiredFrame].copyTo(&blended));
+            decode_frame(r, webp, i, true, &blended);
+            REPORTER_ASSERT(r, 0 == memcmp(frames[i].getPixels(), blended.getPixels(),
+                                           frames[i].getSize()));
+        }
+    }
+
+    SkBitmap bm;
+    bm.allocPixels(info);
+    SkCodec::Options options;
+    options.fFrameIndex = 1;
+    REPORTER_ASSERT(r, SkCodec::kUnimplemented == webp->startScanlineDecode(info, &options,
+            nullptr, nullptr));
+}
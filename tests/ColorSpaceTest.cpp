@@ -203,3 +203,25 @@ DEF_TEST(ColorSpace_Serialize, r) {
     test_serialize(r, SkColorSpace::NewICC(monitorData->data(), monitorData->size()).get(), false);
 }
 
+
+DEF_TEST(ColorSpace_InternICC, r) {
+    sk_sp<SkData> monitorData = SkData::MakeFromFileName(
+            GetResourcePath("monitor_profiles/HP_ZR30w.icc").c_str());
+    if (!monitorData) {
+        return;
+    }
+
+    // Equal profiles share an instance, even when the bytes live in different buffers.
+    sk_sp<SkData> copy = SkData::MakeWithCopy(monitorData->data(), monitorData->size());
+    sk_sp<SkColorSpace> space = SkColorSpace::NewICC(monitorData->data(), monitorData->size());
+    sk_sp<SkColorSpace> same = SkColorSpace::NewICC(copy->data(), copy->size());
+    REPORTER_ASSERT(r, space);
+    REPORTER_ASSERT(r, space.get() == same.get());
+
+    // A different profile does not.
+    sk_sp<SkData> newMonitorData = as_CSB(space)->writeToICC();
+    sk_sp<SkColorSpace> other = SkColorSpace::NewICC(newMonitorData->data(),
+                                                     newMonitorData->size());
+    REPORTER_ASSERT(r, other);
+    REPORTER_ASSERT(r, space.get() != other.get());
+}
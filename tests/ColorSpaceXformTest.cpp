@@ -11,6 +11,7 @@
 #include "SkColorSpace.h"
 #include "SkColorSpace_Base.h"
 #include "SkColorSpaceXform.h"
+#include "SkHalf.h"
 #include "Test.h"
 
 class ColorSpaceXformTest {
@@ -25,6 +26,16 @@ public:
 
         return SkColorSpaceXform::New(srcSpace, dstSpace);
     }
+
+    static std::unique_ptr<SkColorSpaceXform> CreateLUTXform(sk_sp<SkColorLookUpTable> colorLUT,
+                                                             const sk_sp<SkGammas>& gammas) {
+        sk_sp<SkColorSpace> srcSpace(
+                new SkColorSpace_Base(std::move(colorLUT), gammas, SkMatrix::I(), nullptr));
+        sk_sp<SkColorSpace> dstSpace(
+                new SkColorSpace_Base(nullptr, gammas, SkMatrix::I(), nullptr));
+
+        return SkColorSpaceXform::New(srcSpace, dstSpace);
+    }
 };
 
 static bool almost_equal(int x, int y) {
@@ -59,6 +70,16 @@ static void test_xform(skiatest::Reporter* r, const sk_sp<SkGammas>& gammas) {
         REPORTER_ASSERT(r, almost_equal(((srcPixels[i] >> 24) & 0xFF),
                                         SkGetPackedA32(dstPixels[i])));
     }
+
+    // The batched path should give the same answer for unpremul dsts, on both sides of
+    // its four pixel stride.
+    for (int len = 1; len <= width; len++) {
+        uint32_t unpremulPixels[width];
+        xform->apply(unpremulPixels, srcPixels, len, kN32_SkColorType, kUnpremul_SkAlphaType);
+        for (int i = 0; i < len; i++) {
+            REPORTER_ASSERT(r, unpremulPixels[i] == dstPixels[i]);
+        }
+    }
 }
 
 DEF_TEST(ColorSpaceXform_TableGamma, r) {
@@ -113,3 +134,153 @@ DEF_TEST(ColorSpaceXform_ExponentialGamma, r) {
             sk_make_sp<SkGammas>(std::move(red), std::move(green), std::move(blue));
     test_xform(r, gammas);
 }
+
+static sk_sp<SkGammas> srgb_gammas() {
+    SkGammaCurve red, green, blue;
+    red.fNamed = green.fNamed = blue.fNamed = SkColorSpace::kSRGB_GammaNamed;
+    return sk_make_sp<SkGammas>(std::move(red), std::move(green), std::move(blue));
+}
+
+DEF_TEST(ColorSpaceXform_IdentityLUT, r) {
+    // A 2x2x2 grid that maps every input to itself.
+    sk_sp<SkColorLookUpTable> colorLUT = sk_make_sp<SkColorLookUpTable>();
+    colorLUT->fInputChannels = colorLUT->fOutputChannels = 3;
+    colorLUT->fGridPoints[0] = colorLUT->fGridPoints[1] = colorLUT->fGridPoints[2] = 2;
+    colorLUT->fTable = std::unique_ptr<float[]>(new float[2 * 2 * 2 * 3]);
+    for (int x = 0; x < 2; x++) {
+        for (int y = 0; y < 2; y++) {
+            for (int z = 0; z < 2; z++) {
+                float* entry = &colorLUT->fTable[3 * (4*x + 2*y + z)];
+                entry[0] = (float) x;
+                entry[1] = (float) y;
+                entry[2] = (float) z;
+            }
+        }
+    }
+
+    std::unique_ptr<SkColorSpaceXform> xform =
+            ColorSpaceXformTest::CreateLUTXform(std::move(colorLUT), srgb_gammas());
+    REPORTER_ASSERT(r, xform);
+
+    constexpr int width = 7;
+    constexpr uint32_t srcPixels[width] = {
+            0xFFABCDEF, 0xFF146829, 0xFF382759, 0xFF184968, 0xFFDE8271, 0xFF000102, 0xFFFFFFFF, };
+    uint32_t dstPixels[width];
+    xform->apply(dstPixels, srcPixels, width, kRGBA_8888_SkColorType, kOpaque_SkAlphaType);
+    for (int i = 0; i < width; i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            REPORTER_ASSERT(r, almost_equal((srcPixels[i] >> shift) & 0xFF,
+                                            (dstPixels[i] >> shift) & 0xFF));
+        }
+    }
+}
+
+DEF_TEST(ColorSpaceXform_PremulAndF16, r) {
+    sk_sp<SkColorSpace> srgb = SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named);
+    std::unique_ptr<SkColorSpaceXform> xform = SkColorSpaceXform::New(srgb, srgb);
+    REPORTER_ASSERT(r, xform);
+
+    // Unpremul white at half alpha, opaque sRGB mid-gray, transparent red.
+    constexpr int width = 3;
+    constexpr uint32_t srcPixels[width] = { 0x80FFFFFF, 0xFF808080, 0x000000FF, };
+
+    uint32_t premul[width];
+    xform->apply(premul, srcPixels, width, kRGBA_8888_SkColorType, kPremul_SkAlphaType);
+    REPORTER_ASSERT(r, almost_equal(0x80, (premul[0] >> 24) & 0xFF));
+    REPORTER_ASSERT(r, almost_equal(0x80, (premul[0] >>  0) & 0xFF));
+    REPORTER_ASSERT(r, almost_equal(0x80, (premul[1] >>  0) & 0xFF));
+    REPORTER_ASSERT(r, 0 == premul[2]);
+
+    // F16 is linear, so sRGB 0x80 should come out at about 0.216.
+    uint64_t f16[width];
+    xform->apply(f16, srcPixels, width, kRGBA_F16_SkColorType, kPremul_SkAlphaType);
+    Sk4f white = SkHalfToFloat_01(f16[0]),
+         gray  = SkHalfToFloat_01(f16[1]),
+         clear = SkHalfToFloat_01(f16[2]);
+    REPORTER_ASSERT(r, SkScalarNearlyEqual(white[0], 128 / 255.0f, 0.01f));
+    REPORTER_ASSERT(r, SkScalarNearlyEqual(white[3], 128 / 255.0f, 0.01f));
+    REPORTER_ASSERT(r, SkScalarNearlyEqual(gray[1], 0.216f, 0.01f));
+    REPORTER_ASSERT(r, SkScalarNearlyEqual(gray[3], 1.0f));
+    REPORTER_ASSERT(r, 0.0f == clear[0] && 0.0f == clear[3]);
+}
+
+DEF_TEST(ColorSpaceXform_Codec, r) {
+    SkAutoTDelete<SkStream> stream(GetResourceAsStream("icc-v2-gbr.jpg"));
+    if (!stream) {
+        return;
+    }
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromStream(stream.release()));
+    REPORTER_ASSERT(r, codec && codec->getColorSpace());
+    if (!codec || !codec->getColorSpace()) {
+        return;
+    }
+
+    // Decoding in the encoded color space leaves the colors alone, while asking for sRGB
+    // converts them, but only when the client opts in.
+    const SkImageInfo encodedInfo = codec->getInfo().makeColorType(kRGBA_8888_SkColorType);
+    SkBitmap encoded, unconverted, srgb, linear;
+    encoded.allocPixels(encodedInfo);
+    srgb.allocPixels(encodedInfo.makeColorSpace(
+            SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named)));
+    unconverted.allocPixels(srgb.info());
+    linear.allocPixels(encodedInfo.makeColorType(kRGBA_F16_SkColorType));
+    SkCodec::Options convert;
+    convert.fConvertColorSpace = true;
+    REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                       codec->getPixels(encoded.info(), encoded.getPixels(), encoded.rowBytes()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                       codec->getPixels(unconverted.info(), unconverted.getPixels(),
+                                        unconverted.rowBytes()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                       codec->getPixels(srgb.info(), srgb.getPixels(), srgb.rowBytes(), &convert,
+                                        nullptr, nullptr));
+    REPORTER_ASSERT(r, !memcmp(encoded.getPixels(), unconverted.getPixels(), encoded.getSize()));
+    REPORTER_ASSERT(r, memcmp(encoded.getPixels(), srgb.getPixels(), encoded.getSize()));
+
+    // F16 can only be reached through the conversion.
+    REPORTER_ASSERT(r, SkCodec::kInvalidConversion ==
+                       codec->getPixels(linear.info(), linear.getPixels(), linear.rowBytes()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                       codec->getPixels(linear.info(), linear.getPixels(), linear.rowBytes(),
+                                        &convert, nullptr, nullptr));
+
+    // Scanline decodes should match full decodes, with and without the conversion.
+    SkBitmap scanlines;
+    scanlines.allocPixels(srgb.info());
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->startScanlineDecode(srgb.info(), &convert,
+                                                                       nullptr, nullptr));
+    REPORTER_ASSERT(r, srgb.height() == codec->getScanlines(scanlines.getPixels(), srgb.height(),
+                                                            scanlines.rowBytes()));
+    REPORTER_ASSERT(r, !memcmp(srgb.getPixels(), scanlines.getPixels(), srgb.getSize()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->startScanlineDecode(srgb.info()));
+    REPORTER_ASSERT(r, srgb.height() == codec->getScanlines(scanlines.getPixels(), srgb.height(),
+                                                            scanlines.rowBytes()));
+    REPORTER_ASSERT(r, !memcmp(encoded.getPixels(), scanlines.getPixels(), encoded.getSize()));
+}
+
+DEF_TEST(ColorSpaceXform_Shared, r) {
+    sk_sp<SkData> data = SkData::MakeFromFileName(
+            GetResourcePath("monitor_profiles/HP_ZR30w.icc").c_str());
+    if (!data) {
+        return;
+    }
+    sk_sp<SkColorSpace> srcSpace = SkColorSpace::NewICC(data->data(), data->size());
+    sk_sp<SkColorSpace> srgb = SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named);
+    sk_sp<SkColorSpace> adobe = SkColorSpace::NewNamed(SkColorSpace::kAdobeRGB_Named);
+
+    sk_sp<SkColorSpaceXform> xform = SkColorSpaceXform::FindOrNew(srcSpace, srgb);
+    REPORTER_ASSERT(r, xform);
+    REPORTER_ASSERT(r, xform == SkColorSpaceXform::FindOrNew(srcSpace, srgb));
+    REPORTER_ASSERT(r, xform != SkColorSpaceXform::FindOrNew(srcSpace, adobe));
+    REPORTER_ASSERT(r, xform != SkColorSpaceXform::FindOrNew(srgb, srcSpace));
+
+    // The shared xform behaves just like a freshly built one.
+    std::unique_ptr<SkColorSpaceXform> fresh = SkColorSpaceXform::New(srcSpace, srgb);
+    uint32_t src[64], dst0[64], dst1[64];
+    for (int i = 0; i < 64; i++) {
+        src[i] = 0xFF000000 | (i * 0x040302);
+    }
+    xform->xform_RGB1_8888(dst0, src, 64);
+    fresh->xform_RGB1_8888(dst1, src, 64);
+    REPORTER_ASSERT(r, 0 == memcmp(dst0, dst1, sizeof(dst0)));
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkChecksum.h"
+#include "SkDistanceFieldGen.h"
+#include "SkRandom.h"
+#include "SkTemplates.h"
+#include "Test.h"
+
+// A soft-edged disc, the kind of image a glyph mask has.
+static void draw_disc(uint8_t* image, int width, int height, float radius) {
+    const float cx = 0.5f*width, cy = 0.5f*height;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float d = SkScalarSqrt((x - cx)*(x - cx) + (y - cy)*(y - cy)) - radius;
+            image[y*width + x] = SkScalarRoundToInt(255*SkScalarPin(0.5f - d, 0, 1));
+        }
+    }
+}
+
+DEF_TEST(DistanceFieldGen_Batch, reporter) {
+    SkRandom rand;
+    const int kCount = 20;
+    SkDistanceFieldRequest requests[kCount];
+    SkAutoTMalloc<uint8_t> images[kCount];
+    SkAutoTMalloc<uint8_t> fields[kCount];
+    for (int i = 0; i < kCount; ++i) {
+        int width = 1 + rand.nextULessThan(40);
+        int height = 1 + rand.nextULessThan(40);
+        SkMask::Format format = (i & 1) ? SkMask::kBW_Format : SkMask::kA8_Format;
+        size_t rowBytes = SkMask::kBW_Format == format ? (width + 7) >> 3 : width;
+        images[i].reset(rowBytes*height);
+        if (SkMask::kBW_Format == format) {
+            for (size_t j = 0; j < rowBytes*height; ++j) {
+                images[i][j] = rand.nextU();
+            }
+        } else {
+            draw_disc(images[i].get(), width, height, rand.nextRangeF(1, 20));
+        }
+        fields[i].reset(SkComputeDistanceFieldSize(width, height));
+        requests[i] = { fields[i].get(), images[i].get(), width, height, rowBytes, format };
+    }
+
+    for (SkDistanceFieldMethod method : { kApproximate_SkDistanceFieldMethod,
+                                          kExact_SkDistanceFieldMethod }) {
+        REPORTER_ASSERT(reporter, SkGenerateDistanceFields(requests, kCount, method));
+        for (int i = 0; i < kCount; ++i) {
+            const SkDistanceFieldRequest& r = requests[i];
+            size_t size = SkComputeDistanceFieldSize(r.fWidth, r.fHeight);
+            SkAutoTMalloc<uint8_t> expected(size);
+            if (SkMask::kBW_Format == r.fFormat) {
+                SkGenerateDistanceFieldFromBWImage(expected.get(), r.fImage, r.fWidth, r.fHeight,
+                                                   r.fRowBytes, method);
+            } else {
+                SkGenerateDistanceFieldFromA8Image(expected.get(), r.fImage, r.fWidth, r.fHeight,
+                                                   r.fRowBytes, method);
+            }
+            REPORTER_ASSERT(reporter, !memcmp(expected.get(), r.fDistanceField, size));
+        }
+    }
+}
+
+// The two methods should agree closely for glyph-like images. (The approximate method never
+// revisits the rightmost two columns on its way back up, so those are left out.)
+DEF_TEST(DistanceFieldGen_Exact, reporter) {
+    const int kWidth = 40, kHeight = 30;
+    const int kFieldWidth = kWidth + 2*SK_DistanceFieldPad;
+    const int kFieldHeight = kHeight + 2*SK_DistanceFieldPad;
+    uint8_t image[kWidth*kHeight];
+    uint8_t approximate[kFieldWidth*kFieldHeight];
+    uint8_t exact[kFieldWidth*kFieldHeight];
+
+    for (float radius : { 2.5f, 7.0f, 12.25f }) {
+        draw_disc(image, kWidth, kHeight, radius);
+        REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromA8Image(approximate, image,
+                                                                     kWidth, kHeight, kWidth));
+        REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromA8Image(exact, image,
+                                                                     kWidth, kHeight, kWidth,
+                                                                     kExact_SkDistanceFieldMethod));
+        int maxDiff = 0;
+        for (int y = 0; y < kFieldHeight; ++y) {
+            for (int x = 0; x < kFieldWidth - 2; ++x) {
+                int i = y*kFieldWidth + x;
+                maxDiff = SkTMax(maxDiff, SkTAbs(approximate[i] - exact[i]));
+            }
+        }
+        REPORTER_ASSERT(reporter, maxDiff <= 8);
+        // the edge texels are shared, so the distance at the center is the same
+        int center = (kFieldHeight/2)*kFieldWidth + kFieldWidth/2;
+        REPORTER_ASSERT(reporter, approximate[center] == exact[center]);
+    }
+}
+
+// Glyph masks at a few sizes, drawn with four coverage levels: ' ' none, '.' a third, '+' two
+// thirds and '#' full.
+static const char* gGlyphA[] = {
+    "  .+##+.    ",
+    " +#+..+#+   ",
+    " .+    ##   ",
+    "       ##   ",
+    "  .+#####   ",
+    " +#+.  ##   ",
+    " ##    ##   ",
+    " ##   +##   ",
+    " +#+.+###.  ",
+    "  .+#+.+##+ ",
+};
+static const char* gGlyphG[] = {
+    "   .+###+.##",
+    "  +#+...+###",
+    " .##     .##",
+    " ##.      ##",
+    " ##       ##",
+    " ##.      ##",
+    " .##     .##",
+    "  +#+...+###",
+    "   .+###+.##",
+    "          ##",
+    " .       +#+",
+    " +#+...+##+.",
+    "  .+###+.   ",
+};
+static const char* gGlyphW[] = {
+    "##.         .##",
+    "+#+         +#+",
+    ".##    .    ##.",
+    " ##.  +#+  .## ",
+    " +#+  ###  +#+ ",
+    " .##..#+#..##. ",
+    "  ##++#.#++##  ",
+    "  +####.####+  ",
+    "  .###+ +###.  ",
+    "   ###   ###   ",
+    "   +#+   +#+   ",
+};
+static const char* gDot[] = {
+    ".+.",
+    "+#+",
+    ".+.",
+};
+
+static uint8_t glyph_coverage(char c) {
+    switch (c) {
+        case '#': return 255;
+        case '+': return 170;
+        case '.': return 85;
+        default:  return 0;
+    }
+}
+
+// The vectorized generator should give exactly the fields the scalar one did. The expected
+// checksums are of the fields that the scalar code (before it was vectorized) generated for
+// these masks. The masks' rows are padded, and the BW masks are covered where the A8 masks
+// are more than half covered.
+DEF_TEST(DistanceFieldGen_Golden, reporter) {
+    static const struct {
+        const char** fRows;
+        int          fHeight;
+        uint32_t     fA8Checksum;
+        uint32_t     fBWChecksum;
+    } gRec[] = {
+        { gGlyphA, SK_ARRAY_COUNT(gGlyphA), 0x09246977, 0xaae370de },
+        { gGlyphG, SK_ARRAY_COUNT(gGlyphG), 0x8f3aa37d, 0x777904e1 },
+        { gGlyphW, SK_ARRAY_COUNT(gGlyphW), 0x0eef5753, 0xba0b2f61 },
+        { gDot,    SK_ARRAY_COUNT(gDot),    0x87727111, 0x8322957f },
+    };
+
+    for (const auto& rec : gRec) {
+        const int width = SkToInt(strlen(rec.fRows[0]));
+        const int height = rec.fHeight;
+        const size_t a8RowBytes = width + 3;
+        const size_t bwRowBytes = (width + 7)/8 + 1;
+        SkAutoTMalloc<uint8_t> a8(a8RowBytes*height);
+        SkAutoTMalloc<uint8_t> bw(bwRowBytes*height);
+        memset(a8.get(), 0xAA, a8RowBytes*height);
+        sk_bzero(bw.get(), bwRowBytes*height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const uint8_t coverage = glyph_coverage(rec.fRows[y][x]);
+                a8[y*a8RowBytes + x] = coverage;
+                if (coverage > 128) {
+                    bw[y*bwRowBytes + (x >> 3)] |= 0x80 >> (x & 7);
+                }
+            }
+        }
+
+        const size_t size = SkComputeDistanceFieldSize(width, height);
+        SkAutoTMalloc<uint8_t> field(size);
+        REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromA8Image(field.get(), a8.get(),
+                                                                     width, height, a8RowBytes));
+        REPORTER_ASSERT(reporter, SkChecksum::Murmur3(field.get(), size) == rec.fA8Checksum);
+        REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromBWImage(field.get(), bw.get(),
+                                                                     width, height, bwRowBytes));
+        REPORTER_ASSERT(reporter, SkChecksum::Murmur3(field.get(), size) == rec.fBWChecksum);
+    }
+}
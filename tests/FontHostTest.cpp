@@ -6,11 +6,17 @@
  */
 
 #include "Resources.h"
+#include "SkCanvas.h"
+#include "SkData.h"
 #include "SkEndian.h"
 #include "SkFontStream.h"
+#include "SkGlyphCache.h"
+#include "SkGraphics.h"
 #include "SkOSFile.h"
 #include "SkPaint.h"
 #include "SkStream.h"
+#include "SkTSort.h"
+#include "SkTaskGroup.h"
 #include "SkTypeface.h"
 #include "Test.h"
 
@@ -306,6 +312,229 @@ static void test_advances(skiatest::Reporter* reporter) {
     }
 }
 
+static void draw_text_at_size(const SkPaint& paint, int size, SkBitmap* bm) {
+    const char text[] = "Hamburgefons";
+    bm->allocN32Pixels(size * 8, size * 2);
+    bm->eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(*bm);
+    SkPaint sizedPaint(paint);
+    sizedPaint.setTextSize(SkIntToScalar(size));
+    canvas.drawText(text, strlen(text), 0, SkIntToScalar(size), sizedPaint);
+}
+
+// Glyphs for different sizes may be scaled on several threads at once.  They should come out
+// the same as when scaled one at a time.
+DEF_TEST(FontHost_threaded, reporter) {
+    static const int kSizes = 12;
+
+    SkString path = GetResourcePath("fonts/Em.ttf");
+    sk_sp<SkTypeface> typefaces[] = {
+        MakeResourceAsTypeface("fonts/Distortable.ttf"),
+        // Not in memory, so each scaler makes its own copy of the font data.
+        SkTypeface::MakeFromStream(new SkFILEStream(path.c_str())),
+    };
+    for (const sk_sp<SkTypeface>& typeface : typefaces) {
+        if (!typeface) {
+            INFOF(reporter, "Could not load font.\n");
+            continue;
+        }
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setTypeface(typeface);
+
+        SkBitmap expected[kSizes];
+        for (int i = 0; i < kSizes; i++) {
+            draw_text_at_size(paint, 10 + i, &expected[i]);
+        }
+
+        SkGraphics::PurgeFontCache();
+        SkBitmap actual[kSizes];
+        SkTaskGroup().batch(kSizes, [&](int i) {
+            draw_text_at_size(paint, 10 + i, &actual[i]);
+        });
+
+        for (int i = 0; i < kSizes; i++) {
+            REPORTER_ASSERT(reporter, 0 == memcmp(expected[i].getPixels(), actual[i].getPixels(),
+                                                  expected[i].getSize()));
+        }
+    }
+}
+
+static void glyph_images(const SkPaint& paint, const char text[], bool batch,
+                         SkTArray<sk_sp<SkData>>* images) {
+    SkGraphics::PurgeFontCache();
+    SkAutoGlyphCacheNoGamma autoCache(paint, nullptr, nullptr);
+    SkGlyphCache* cache = autoCache.getCache();
+
+    const int count = SkToInt(strlen(text));
+    SkAutoTArray<const SkGlyph*> glyphs(count);
+    // Adding glyphs to the cache can move the ones already in it, so all of them are added
+    // before any is kept.
+    for (bool keep : { false, true }) {
+        for (int i = 0; i < count; i++) {
+            // With subpixel text, ask for each glyph at several offsets.
+            const SkFixed subX = paint.isSubpixelText() ? (i * SK_Fixed1 / 3) & 0xFFFF : 0;
+            const SkGlyph& glyph = cache->getUnicharMetrics(text[i], subX, 0);
+            if (keep) {
+                glyphs[i] = &glyph;
+            }
+        }
+    }
+    if (!batch) {
+        for (int i = 0; i < count; i++) {
+            cache->findImage(*glyphs[i]);
+        }
+    }
+    if (batch) {
+        cache->findImages(glyphs.get(), count);
+    }
+
+    for (int i = 0; i < count; i++) {
+        const SkGlyph& glyph = *glyphs[i];
+        images->push_back(glyph.fImage ? SkData::MakeWithCopy(glyph.fImage,
+                                                              glyph.computeImageSize())
+                                       : SkData::MakeEmpty());
+    }
+}
+
+// Generating a batch of glyph images should match generating them one at a time.
+DEF_TEST(FontHost_batchImages, reporter) {
+    const char text[] = "Hamburgefons, Hamburgefons!";
+    // FreeType's subpixel LCD masks can leave padding bytes unwritten, so they are not compared.
+    static const struct { bool fLCD, fSubpixel; } gRec[] = {
+        { false, false }, { true, false }, { false, true },
+    };
+    for (const auto& rec : gRec) {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setLCDRenderText(rec.fLCD);
+        paint.setSubpixelText(rec.fSubpixel);
+        paint.setTextSize(17);
+        paint.setTypeface(MakeResourceAsTypeface("fonts/Em.ttf"));
+
+        SkTArray<sk_sp<SkData>> expected, actual;
+        glyph_images(paint, text, false, &expected);
+        glyph_images(paint, text, true, &actual);
+        REPORTER_ASSERT(reporter, expected.count() == actual.count());
+        for (int i = 0; i < expected.count(); i++) {
+            REPORTER_ASSERT(reporter, expected[i]->equals(actual[i].get()));
+        }
+    }
+}
+
+// Small glyph images should be packed into a few shared pages, not given an allocation each.
+DEF_TEST(FontHost_imagePages, reporter) {
+    const int kGlyphCount = 32;
+    const int kSubpixelCount = 4;
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setSubpixelText(true);
+    paint.setTextSize(11);
+    paint.setTypeface(MakeResourceAsTypeface("fonts/Roboto2-Regular_NoEmbed.ttf"));
+
+    SkGraphics::PurgeFontCache();
+    SkAutoGlyphCacheNoGamma autoCache(paint, nullptr, nullptr);
+    SkGlyphCache* cache = autoCache.getCache();
+
+    const int count = kGlyphCount * kSubpixelCount;
+    SkAutoTArray<const SkGlyph*> glyphs(count);
+    for (bool keep : { false, true }) {
+        for (int i = 0; i < count; i++) {
+            const SkFixed subX = (i % kSubpixelCount) * SK_Fixed1 / kSubpixelCount;
+            const SkGlyph& glyph = cache->getGlyphIDMetrics(1 + i / kSubpixelCount, subX, 0);
+            if (keep) {
+                glyphs[i] = &glyph;
+            }
+        }
+    }
+    cache->findImages(glyphs.get(), count);
+
+    struct Image {
+        const char* fStart;
+        const char* fEnd;
+        bool operator<(const Image& that) const { return fStart < that.fStart; }
+    };
+    SkTDArray<Image> images;
+    size_t totalSize = 0;
+    for (int i = 0; i < count; i++) {
+        const SkGlyph& glyph = *glyphs[i];
+        if (glyph.fWidth > 0 && glyph.fImage) {
+            const char* start = static_cast<const char*>(glyph.fImage);
+            const size_t size = SkAlign8(glyph.computeImageSize());
+            *images.append() = { start, start + size };
+            totalSize += size;
+        }
+    }
+    REPORTER_ASSERT(reporter, images.count() > kGlyphCount);
+    if (images.isEmpty()) {
+        return;
+    }
+    SkTQSort(images.begin(), images.end() - 1);
+
+    // Count the runs of images that follow each other in memory. There should be no more than
+    // one per page the images need, plus one for each page whose end did not fit the next image.
+    int runs = 1;
+    for (int i = 1; i < images.count(); i++) {
+        REPORTER_ASSERT(reporter, images[i].fStart >= images[i - 1].fEnd);
+        if (images[i].fStart != images[i - 1].fEnd) {
+            runs++;
+        }
+    }
+    const int pages = SkToInt((totalSize + 4095) / 4096);
+    REPORTER_ASSERT(reporter, runs <= 2 * pages);
+}
+
+static int count_strike_files(const char* dir, bool deleteFiles) {
+    int count = 0;
+    SkOSFile::Iter iter(dir, ".strike");
+    SkString name;
+    while (iter.next(&name)) {
+        if (deleteFiles) {
+            remove(SkOSPath::Join(dir, name.c_str()).c_str());
+        }
+        count++;
+    }
+    return count;
+}
+
+// Strikes written to the font cache directory when they are purged should be read back, and
+// give the same glyphs, the next time they are needed.
+DEF_TEST(FontHost_strikeFile, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString dir = SkOSPath::Join(tmpDir.c_str(), "strikes");
+    sk_mkdir(dir.c_str());
+    count_strike_files(dir.c_str(), true);
+
+    const char text[] = "Hamburgefons, Hamburgefons!";
+    SkGraphics::SetFontCacheDirectory(dir.c_str());
+    for (bool lcd : { false, true }) {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setLCDRenderText(lcd);
+        paint.setTextSize(17);
+        paint.setTypeface(MakeResourceAsTypeface("fonts/Em.ttf"));
+
+        SkTArray<sk_sp<SkData>> expected, stored, merged;
+        glyph_images(paint, text, false, &expected);
+        glyph_images(paint, text, true, &stored);
+        glyph_images(paint, "Hamburgefons, Hamburgefons?", false, &merged);
+        REPORTER_ASSERT(reporter, expected.count() == stored.count());
+        for (int i = 0; i < expected.count(); i++) {
+            REPORTER_ASSERT(reporter, expected[i]->equals(stored[i].get()));
+            REPORTER_ASSERT(reporter, expected[i]->equals(merged[i].get()) ||
+                                      text[i] == '!');
+        }
+    }
+    SkGraphics::PurgeFontCache();
+    SkGraphics::SetFontCacheDirectory(nullptr);
+
+    REPORTER_ASSERT(reporter, count_strike_files(dir.c_str(), true) >= 2);
+}
+
 DEF_TEST(FontHost, reporter) {
     test_tables(reporter);
     test_fontstream(reporter);
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkData.h"
+#include "SkFontMgr.h"
+#include "SkFontMgr_custom.h"
+#include "SkOSFile.h"
+#include "SkStream.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+#include <stdio.h>
+
+static bool copy_file(const char* from, const char* to) {
+    sk_sp<SkData> data = SkData::MakeFromFileName(from);
+    SkFILEWStream stream(to);
+    return data && stream.isValid() && stream.write(data->data(), data->size());
+}
+
+static void check_same_fonts(skiatest::Reporter* reporter, SkFontMgr* expected,
+                             SkFontMgr* actual) {
+    REPORTER_ASSERT(reporter, expected->countFamilies() == actual->countFamilies());
+    for (int i = 0; i < SkTMin(expected->countFamilies(), actual->countFamilies()); ++i) {
+        SkString expectedName, actualName;
+        expected->getFamilyName(i, &expectedName);
+        actual->getFamilyName(i, &actualName);
+        REPORTER_ASSERT(reporter, expectedName == actualName);
+
+        SkAutoTUnref<SkFontStyleSet> expectedSet(expected->createStyleSet(i));
+        SkAutoTUnref<SkFontStyleSet> actualSet(actual->createStyleSet(i));
+        REPORTER_ASSERT(reporter, expectedSet->count() == actualSet->count());
+        for (int j = 0; j < SkTMin(expectedSet->count(), actualSet->count()); ++j) {
+            SkFontStyle expectedStyle, actualStyle;
+            expectedSet->getStyle(j, &expectedStyle, nullptr);
+            actualSet->getStyle(j, &actualStyle, nullptr);
+            REPORTER_ASSERT(reporter, expectedStyle == actualStyle);
+
+            sk_sp<SkTypeface> expectedFace(expectedSet->createTypeface(j));
+            sk_sp<SkTypeface> actualFace(actualSet->createTypeface(j));
+            REPORTER_ASSERT(reporter, expectedFace->isFixedPitch() == actualFace->isFixedPitch());
+        }
+    }
+}
+
+// A manager built from its index should find the same fonts as one which opens every file,
+// and should notice files that changed since the index was written.
+DEF_TEST(FontMgrCustom_Index, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    const char* fonts[] = { "Distortable.ttf", "Em.ttf", "Funkster.ttf", "test.ttc" };
+
+    // Enough files that the scan is split across several tasks.
+    SkString dir = SkOSPath::Join(tmpDir.c_str(), "fontmgr_custom");
+    sk_mkdir(dir.c_str());
+    for (int copy = 0; copy < 6; ++copy) {
+        SkString subdir = SkOSPath::Join(dir.c_str(), SkStringPrintf("%d", copy).c_str());
+        sk_mkdir(subdir.c_str());
+        for (const char* font : fonts) {
+            SkString from = GetResourcePath(SkOSPath::Join("fonts", font).c_str());
+            if (!copy_file(from.c_str(), SkOSPath::Join(subdir.c_str(), font).c_str())) {
+                ERRORF(reporter, "Could not copy %s.\n", from.c_str());
+                return;
+            }
+        }
+    }
+    SkString index = SkOSPath::Join(tmpDir.c_str(), "fontmgr_custom.index");
+    remove(index.c_str());
+
+    sk_sp<SkFontMgr> scanned(SkFontMgr_New_Custom_Directory(dir.c_str()));
+    sk_sp<SkFontMgr> indexing(SkFontMgr_New_Custom_Directory(dir.c_str(), index.c_str()));
+    REPORTER_ASSERT(reporter, sk_exists(index.c_str()));
+    sk_sp<SkFontMgr> indexed(SkFontMgr_New_Custom_Directory(dir.c_str(), index.c_str()));
+    check_same_fonts(reporter, scanned.get(), indexing.get());
+    check_same_fonts(reporter, scanned.get(), indexed.get());
+
+    // Replace one of the fonts with another, which changes its size.
+    SkString changed = SkOSPath::Join(SkOSPath::Join(dir.c_str(), "3").c_str(), "Em.ttf");
+    SkString from = GetResourcePath("fonts/Funkster.ttf");
+    REPORTER_ASSERT(reporter, copy_file(from.c_str(), changed.c_str()));
+    scanned.reset(SkFontMgr_New_Custom_Directory(dir.c_str()));
+    indexed.reset(SkFontMgr_New_Custom_Directory(dir.c_str(), index.c_str()));
+    check_same_fonts(reporter, scanned.get(), indexed.get());
+
+    // Each rewrite goes through its own temporary file, which is moved into place.
+    SkOSFile::Iter iter(tmpDir.c_str(), ".tmp");
+    SkString name;
+    while (iter.next(&name)) {
+        REPORTER_ASSERT(reporter, !name.startsWith("fontmgr_custom.index."));
+    }
+
+    // A truncated index is thrown away and rewritten from a full scan.  Copy the index, since
+    // the file is mapped and about to be truncated.
+    sk_sp<SkData> full = SkData::MakeFromFileName(index.c_str());
+    REPORTER_ASSERT(reporter, full);
+    if (!full) {
+        return;
+    }
+    full = SkData::MakeWithCopy(full->data(), full->size());
+    const size_t lengths[] = { 0, 3, full->size() / 3, full->size() / 2, full->size() - 1 };
+    for (size_t length : lengths) {
+        {
+            SkFILEWStream stream(index.c_str());
+            REPORTER_ASSERT(reporter, stream.write(full->data(), length));
+        }
+        indexed.reset(SkFontMgr_New_Custom_Directory(dir.c_str(), index.c_str()));
+        check_same_fonts(reporter, scanned.get(), indexed.get());
+        sk_sp<SkData> rewritten = SkData::MakeFromFileName(index.c_str());
+        REPORTER_ASSERT(reporter, rewritten && rewritten->equals(full.get()));
+    }
+}
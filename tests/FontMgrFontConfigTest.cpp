@@ -0,0 +1,104 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkFontMgr.h"
+#include "SkFontMgr_fontconfig.h"
+#include "SkOSFile.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+#include <fontconfig/fontconfig.h>
+
+static SkString font_path(const char* font) {
+    return GetResourcePath(SkOSPath::Join("fonts", font).c_str());
+}
+
+/** A config which knows only the given resource fonts, with none of the system's. */
+static FcConfig* config_with_fonts(const char* fonts[], int count) {
+    FcConfig* config = FcConfigCreate();
+    for (int i = 0; i < count; ++i) {
+        FcConfigAppFontAddFile(config, (const FcChar8*)font_path(fonts[i]).c_str());
+    }
+    return config;
+}
+
+static bool has_character(SkTypeface* face, SkUnichar character) {
+    uint16_t glyph = 0;
+    face->charsToGlyphs(&character, SkTypeface::kUTF32_Encoding, &glyph, 1);
+    return glyph != 0;
+}
+
+static bool same_font(SkTypeface* a, SkTypeface* b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    SkString aFamily, bFamily;
+    a->getFamilyName(&aFamily);
+    b->getFamilyName(&bFamily);
+    return aFamily == bFamily && a->fontStyle() == b->fontStyle();
+}
+
+// Matches are cached, so they must come out the same every time and the same as a manager which
+// has not cached anything, whatever was matched before them, and adding fonts must be noticed.
+DEF_TEST(FontMgrFontConfig_MatchCache, reporter) {
+    // Funkster, HangingS and ReallyBigA share some of their characters.
+    const char* fonts[] = { "Funkster.ttf", "HangingS.ttf", "ReallyBigA.ttf" };
+    const char* addedFont = "Em.ttf";
+
+    SkString addedFamily;
+    {
+        sk_sp<SkFontMgr> added(SkFontMgr_New_FontConfig(config_with_fonts(&addedFont, 1)));
+        if (added->countFamilies() != 1) {
+            ERRORF(reporter, "Could not load %s.\n", addedFont);
+            return;
+        }
+        added->getFamilyName(0, &addedFamily);
+    }
+
+    FcConfig* config = config_with_fonts(fonts, SK_ARRAY_COUNT(fonts));
+    sk_sp<SkFontMgr> mgr(SkFontMgr_New_FontConfig(config));
+    REPORTER_ASSERT(reporter, mgr->countFamilies() == SK_ARRAY_COUNT(fonts));
+
+    const SkFontStyle style;
+    for (int i = 0; i < mgr->countFamilies(); ++i) {
+        SkString family;
+        mgr->getFamilyName(i, &family);
+        sk_sp<SkTypeface> first(mgr->matchFamilyStyle(family.c_str(), style));
+        sk_sp<SkTypeface> second(mgr->matchFamilyStyle(family.c_str(), style));
+        REPORTER_ASSERT(reporter, first);
+        REPORTER_ASSERT(reporter, first == second);
+    }
+
+    // Walk down, then up, so each character follows both of its neighbors.
+    const SkUnichar kFirst = 0x20, kLast = 0x17F;
+    for (int pass = 0; pass < 2; ++pass) {
+        int found = 0;
+        for (SkUnichar i = kFirst; i <= kLast; ++i) {
+            const SkUnichar character = pass ? i : kFirst + kLast - i;
+            sk_sp<SkTypeface> face(mgr->matchFamilyStyleCharacter(nullptr, style, nullptr, 0,
+                                                                  character));
+            if (face) {
+                REPORTER_ASSERT(reporter, has_character(face.get(), character));
+                ++found;
+            }
+            sk_sp<SkFontMgr> uncached(SkFontMgr_New_FontConfig(
+                    config_with_fonts(fonts, SK_ARRAY_COUNT(fonts))));
+            sk_sp<SkTypeface> expected(uncached->matchFamilyStyleCharacter(nullptr, style,
+                                                                           nullptr, 0, character));
+            REPORTER_ASSERT(reporter, same_font(face.get(), expected.get()));
+        }
+        REPORTER_ASSERT(reporter, found > 0);
+    }
+
+    // A family which did not match must match once its font is added.
+    sk_sp<SkTypeface> missing(mgr->matchFamilyStyle(addedFamily.c_str(), style));
+    REPORTER_ASSERT(reporter, !missing);
+    FcConfigAppFontAddFile(config, (const FcChar8*)font_path(addedFont).c_str());
+    sk_sp<SkTypeface> present(mgr->matchFamilyStyle(addedFamily.c_str(), style));
+    REPORTER_ASSERT(reporter, present);
+}
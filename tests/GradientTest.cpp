@@ -9,10 +9,14 @@
 #include "SkColorPriv.h"
 #include "SkColorShader.h"
 #include "SkGradientShader.h"
+#include "SkResourceCache.h"
 #include "SkShader.h"
 #include "SkSurface.h"
 #include "SkTemplates.h"
 #include "Test.h"
+#include "gradients/SkGradientShaderPriv.h"
+
+#include <functional>
 
 // https://code.google.com/p/chromium/issues/detail?id=448299
 // Giant (inverse) matrix causes overflow when converting/computing using 32.32
@@ -253,6 +257,125 @@ static void test_clamping_overflow(skiatest::Reporter*) {
     // Passes if we don't trigger asserts.
 }
 
+// The 4f contexts should closely match the legacy (cache-based) contexts.
+static void test_4f_matches_legacy(skiatest::Reporter* reporter) {
+    const SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE, 0x80FFFFFF };
+    const int count = SK_ARRAY_COUNT(colors);
+    const SkPoint center = SkPoint::Make(50, 50);
+
+    const std::function<sk_sp<SkShader>(uint32_t)> factories[] = {
+        [&](uint32_t flags) {
+            return SkGradientShader::MakeRadial(center, 30, colors, nullptr, count,
+                                                SkShader::kClamp_TileMode, flags, nullptr);
+        },
+        [&](uint32_t flags) {
+            return SkGradientShader::MakeSweep(center.x(), center.y(), colors, nullptr, count,
+                                               flags, nullptr);
+        },
+        [&](uint32_t flags) {
+            return SkGradientShader::MakeTwoPointConical(SkPoint::Make(40, 45), 5,
+                                                         SkPoint::Make(60, 55), 35,
+                                                         colors, nullptr, count,
+                                                         SkShader::kClamp_TileMode, flags,
+                                                         nullptr);
+        },
+        [&](uint32_t flags) {
+            return SkGradientShader::MakeTwoPointConical(SkPoint::Make(15, 15), 5,
+                                                         SkPoint::Make(75, 75), 20,
+                                                         colors, nullptr, count,
+                                                         SkShader::kClamp_TileMode, flags,
+                                                         nullptr);
+        },
+    };
+
+    for (const auto& factory : factories) {
+        SkBitmap legacy, ctx4f;
+        for (SkBitmap* bm : { &legacy, &ctx4f }) {
+            bm->allocN32Pixels(100, 100);
+            bm->eraseColor(SK_ColorTRANSPARENT);
+
+            SkPaint paint;
+            paint.setShader(factory(bm == &ctx4f
+                                    ? SkGradientShaderBase::kForce4fContext_PrivateFlag : 0));
+
+            SkCanvas canvas(*bm);
+            canvas.rotate(10);
+            canvas.drawPaint(paint);
+        }
+
+        int maxDiff = 0;
+        for (int y = 0; y < 100; ++y) {
+            for (int x = 0; x < 100; ++x) {
+                const SkPMColor c0 = *legacy.getAddr32(x, y),
+                                c1 = *ctx4f.getAddr32(x, y);
+                for (int shift = 0; shift < 32; shift += 8) {
+                    const int diff = SkTAbs((int)((c0 >> shift) & 0xFF) -
+                                            (int)((c1 >> shift) & 0xFF));
+                    maxDiff = SkTMax(maxDiff, diff);
+                }
+            }
+        }
+        REPORTER_ASSERT(reporter, maxDiff <= 8);
+    }
+}
+
+class GradientCacheTest {
+public:
+    static SkGradientShaderBase::GradientShaderCache* RefCache(const sk_sp<SkShader>& shader) {
+        return static_cast<const SkGradientShaderBase*>(shader.get())->refCache(0xFF, true);
+    }
+};
+
+// Gradient color tables are shared between identical shaders, and may outlive any of them.
+static void test_shared_cache(skiatest::Reporter* reporter) {
+    const SkPoint pts[] = {{ 0, 0 }, { 64, 0 }};
+    const SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE };
+    const SkScalar pos[] = { 0, 0.25f, 1 };
+
+    // Equivalent gradients resolve to the same cache, even with different tile modes; others
+    // do not.
+    {
+        SkResourceCache::PurgeAll();
+        sk_sp<SkShader> shader0 = SkGradientShader::MakeLinear(pts, colors, pos,
+                                                               SK_ARRAY_COUNT(colors),
+                                                               SkShader::kClamp_TileMode);
+        sk_sp<SkShader> shader1 = SkGradientShader::MakeLinear(pts, colors, pos,
+                                                               SK_ARRAY_COUNT(colors),
+                                                               SkShader::kRepeat_TileMode);
+        const SkColor otherColors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorWHITE };
+        sk_sp<SkShader> other = SkGradientShader::MakeLinear(pts, otherColors, pos,
+                                                             SK_ARRAY_COUNT(otherColors),
+                                                             SkShader::kClamp_TileMode);
+        SkAutoTUnref<SkGradientShaderBase::GradientShaderCache> cache0(
+                GradientCacheTest::RefCache(shader0));
+        SkAutoTUnref<SkGradientShaderBase::GradientShaderCache> cache1(
+                GradientCacheTest::RefCache(shader1));
+        SkAutoTUnref<SkGradientShaderBase::GradientShaderCache> otherCache(
+                GradientCacheTest::RefCache(other));
+        REPORTER_ASSERT(reporter, cache0.get() == cache1.get());
+        REPORTER_ASSERT(reporter, cache0.get() != otherCache.get());
+    }
+
+    auto draw = [&](SkBitmap* bm) {
+        bm->allocN32Pixels(64, 1);
+        SkPaint paint;
+        paint.setShader(SkGradientShader::MakeLinear(pts, colors, pos, SK_ARRAY_COUNT(colors),
+                                                     SkShader::kClamp_TileMode));
+        SkCanvas canvas(*bm);
+        canvas.drawPaint(paint);
+        // The shader (and its reference to the table) goes away here.
+    };
+
+    SkBitmap bm0, bm1, bm2;
+    draw(&bm0);
+    draw(&bm1);
+    SkResourceCache::PurgeAll();
+    draw(&bm2);
+
+    REPORTER_ASSERT(reporter, !memcmp(bm0.getPixels(), bm1.getPixels(), bm0.getSize()));
+    REPORTER_ASSERT(reporter, !memcmp(bm0.getPixels(), bm2.getPixels(), bm0.getSize()));
+}
+
 DEF_TEST(Gradient, reporter) {
     TestGradientShaders(reporter);
     TestConstantGradient(reporter);
@@ -261,4 +384,6 @@ DEF_TEST(Gradient, reporter) {
     test_linear_fuzz(reporter);
     test_two_point_conical_zero_radius(reporter);
     test_clamping_overflow(reporter);
+    test_4f_matches_legacy(reporter);
+    test_shared_cache(reporter);
 }
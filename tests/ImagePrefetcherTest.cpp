@@ -0,0 +1,68 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkCanvas.h"
+#include "SkImageCacherator.h"
+#include "SkImagePrefetcher.h"
+#include "SkImage_Base.h"
+#include "SkPictureRecorder.h"
+#include "SkSurface.h"
+#include "Test.h"
+
+static bool is_cached(const sk_sp<SkImage>& image) {
+    SkBitmap bitmap;
+    return as_IB(image)->peekCacherator()->lockAsBitmapOnlyIfAlreadyCached(&bitmap);
+}
+
+DEF_TEST(ImagePrefetcher, r) {
+    const char* paths[] = { "mandrill_32.png", "mandrill_16.png", "color_wheel.png" };
+    sk_sp<SkImage> images[SK_ARRAY_COUNT(paths)];
+    for (size_t i = 0; i < SK_ARRAY_COUNT(paths); i++) {
+        images[i] = GetResourceAsImage(paths[i]);
+        if (!images[i]) {
+            INFOF(r, "Missing resource '%s'\n", paths[i]);
+            return;
+        }
+        REPORTER_ASSERT(r, images[i]->isLazyGenerated() && !is_cached(images[i]));
+    }
+
+    // Draw the first image directly, and the rest from a nested picture.
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(100, 100));
+    canvas->drawImage(images[1].get(), 32, 0);
+    canvas->drawImageRect(images[2].get(), SkRect::MakeXYWH(64, 0, 16, 16), nullptr);
+    sk_sp<SkPicture> inner(recorder.finishRecordingAsPicture());
+    canvas = recorder.beginRecording(SkRect::MakeWH(100, 100));
+    canvas->drawImage(images[0].get(), 0, 0);
+    canvas->drawPicture(inner);
+    canvas->drawImage(images[0].get(), 0, 32);
+    sk_sp<SkPicture> picture(recorder.finishRecordingAsPicture());
+
+    // Other tests may be decoding at the same time, so only check for at least our share.
+    const SkImagePrefetcher::Stats before = SkImagePrefetcher::GetStats();
+    {
+        SkImagePrefetcher prefetcher;
+        prefetcher.prefetch(picture.get());
+        prefetcher.wait();
+        for (const sk_sp<SkImage>& image : images) {
+            REPORTER_ASSERT(r, is_cached(image));
+        }
+
+        // Asking again finds them already decoded.
+        prefetcher.prefetch(images[0]);
+    }
+    const SkImagePrefetcher::Stats prefetched = SkImagePrefetcher::GetStats();
+    REPORTER_ASSERT(r, prefetched.fPrefetched - before.fPrefetched >= 3);
+    REPORTER_ASSERT(r, prefetched.fAlreadyCached - before.fAlreadyCached >= 1);
+
+    // Playback should not have to decode anything.
+    auto surface(SkSurface::MakeRasterN32Premul(100, 100));
+    surface->getCanvas()->drawPicture(picture);
+    const SkImagePrefetcher::Stats drawn = SkImagePrefetcher::GetStats();
+    REPORTER_ASSERT(r, drawn.fHits - prefetched.fHits >= 4);
+}
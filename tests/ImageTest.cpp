@@ -9,18 +9,23 @@
 #include <initializer_list>
 #include <vector>
 #include "DMGpuSupport.h"
+#include "Resources.h"
 
 #include "SkAutoPixmapStorage.h"
 #include "SkBitmap.h"
+#include "SkBitmapCache.h"
 #include "SkCanvas.h"
 #include "SkData.h"
+#include "SkImageCacherator.h"
 #include "SkImageEncoder.h"
 #include "SkImageGenerator.h"
 #include "SkImage_Base.h"
+#include "SkMipMap.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
 #include "SkPixelSerializer.h"
 #include "SkRRect.h"
+#include "SkResourceCache.h"
 #include "SkStream.h"
 #include "SkSurface.h"
 #include "SkUtils.h"
@@ -365,11 +370,93 @@ DEF_TEST(image_newfrombitmap, reporter) {
     }
 }
 
+// Drawing a lazy JPEG scaled down should decode it at the smaller size, and cache that
+// without ever decoding (or caching) the full-size image.
+DEF_TEST(Image_ScaledDecode, reporter) {
+    sk_sp<SkImage> image(GetResourceAsImage("mandrill_512_q075.jpg"));
+    if (!image) {
+        INFOF(reporter, "Missing resource\n");
+        return;
+    }
+    SkImageCacherator* cacher = as_IB(image)->peekCacherator();
+    REPORTER_ASSERT(reporter, cacher);
+
+    auto surface(SkSurface::MakeRasterN32Premul(64, 64));
+    SkPaint paint;
+    paint.setFilterQuality(kMedium_SkFilterQuality);
+    surface->getCanvas()->scale(0.125f, 0.125f);
+    surface->getCanvas()->drawImage(image, 0, 0, &paint);
+
+    SkBitmap bitmap;
+    REPORTER_ASSERT(reporter, !SkBitmapCache::Find(image->uniqueID(), &bitmap));
+    if (!cacher->lockAsScaledBitmap(&bitmap, 0.125f, image.get())) {
+        ERRORF(reporter, "Expected a scaled decode");
+        return;
+    }
+    REPORTER_ASSERT(reporter, bitmap.width() == 64 && bitmap.height() == 64);
+
+    // The scaled decode maps 1:1 onto the surface.
+    SkAutoLockPixels alp(bitmap);
+    SkPMColor drawn;
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(1, 1);
+    REPORTER_ASSERT(reporter, surface->readPixels(info, &drawn, sizeof(drawn), 32, 32));
+    REPORTER_ASSERT(reporter, drawn == *bitmap.getAddr32(32, 32));
+
+    // Not drawing scaled down at all should not use it.
+    REPORTER_ASSERT(reporter, !cacher->lockAsScaledBitmap(&bitmap, 1, image.get()));
+
+    // A scale between eighths rounds up, so the decode is never smaller than it is drawn.
+    REPORTER_ASSERT(reporter, cacher->lockAsScaledBitmap(&bitmap, 0.3f, image.get()));
+    REPORTER_ASSERT(reporter, bitmap.width() == 192 && bitmap.height() == 192);
+
+    // Other formats could only be sampled, which drops pixels, so they are decoded in full.
+    sk_sp<SkImage> png(GetResourceAsImage("mandrill_512.png"));
+    if (png) {
+        SkImageCacherator* pngCacher = as_IB(png)->peekCacherator();
+        REPORTER_ASSERT(reporter, pngCacher &&
+                                  !pngCacher->lockAsScaledBitmap(&bitmap, 0.125f, png.get()));
+    }
+}
+
+// A lazy JPEG drawn at less than 1/16 of its size is still decoded at 1/8 at the smallest, which
+// is too large to filter with bilerp alone, so medium quality mips that decode.
+DEF_TEST(Image_ScaledDecodeMipMap, reporter) {
+    sk_sp<SkImage> image(GetResourceAsImage("mandrill_512_q075.jpg"));
+    if (!image) {
+        INFOF(reporter, "Missing resource\n");
+        return;
+    }
+    SkResourceCache::PurgeAll();
+
+    auto surface(SkSurface::MakeRasterN32Premul(16, 16));
+    SkPaint paint;
+    paint.setFilterQuality(kMedium_SkFilterQuality);
+    const SkMatrix localMatrix = SkMatrix::MakeScale(1.0f / 32, 1.0f / 32);
+    paint.setShader(image->makeShader(SkShader::kClamp_TileMode, SkShader::kClamp_TileMode,
+                                      &localMatrix));
+    surface->getCanvas()->drawPaint(paint);
+
+    SkBitmap bitmap;
+    REPORTER_ASSERT(reporter, !SkBitmapCache::Find(image->uniqueID(), &bitmap));
+    SkImageCacherator* cacher = as_IB(image)->peekCacherator();
+    if (!cacher || !cacher->lockAsScaledBitmap(&bitmap, 1.0f / 32, image.get())) {
+        ERRORF(reporter, "Expected a scaled decode");
+        return;
+    }
+    REPORTER_ASSERT(reporter, bitmap.width() == 64 && bitmap.height() == 64);
+
+    const SkBitmapCacheDesc desc = SkBitmapCacheDesc::Make(bitmap);
+    SkAutoTUnref<const SkMipMap> mip(SkMipMapCache::FindAndRef(desc,
+                                                               SkSourceGammaTreatment::kIgnore));
+    if (!mip) {
+        mip.reset(SkMipMapCache::FindAndRef(desc, SkSourceGammaTreatment::kRespect));
+    }
+    REPORTER_ASSERT(reporter, mip);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 #if SK_SUPPORT_GPU
 
-#include "SkBitmapCache.h"
-
 /*
  *  This tests the caching (and preemptive purge) of the raster equivalent of a gpu-image.
  *  We cache it for performance when drawing into a raster surface.
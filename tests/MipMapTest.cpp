@@ -6,6 +6,8 @@
  */
 
 #include "SkBitmap.h"
+#include "SkBitmapCache.h"
+#include "SkGraphics.h"
 #include "SkMipMap.h"
 #include "SkRandom.h"
 #include "Test.h"
@@ -202,3 +204,168 @@ DEF_TEST(MipMap_ComputeLevelSize, reporter) {
         REPORTER_ASSERT(reporter, currentTest.fExpectedMipMapLevelSize == levelSize);
     }
 }
+
+// Large images have their first level filtered in bands of rows, possibly on other threads.
+// Each band should match building that strip of the image on its own.
+DEF_TEST(MipMap_ParallelFirstLevel, reporter) {
+    const int kW = 1024, kH = 1024, kStripH = 64;
+
+    SkBitmap bm;
+    bm.allocN32Pixels(kW, kH);
+    SkRandom rand;
+    for (int y = 0; y < kH; ++y) {
+        for (int x = 0; x < kW; ++x) {
+            *bm.getAddr32(x, y) = SkPreMultiplyColor(rand.nextU());
+        }
+    }
+
+    SkAutoTUnref<SkMipMap> mm(SkMipMap::Build(bm, SkSourceGammaTreatment::kIgnore, nullptr));
+    SkMipMap::Level level;
+    REPORTER_ASSERT(reporter, mm->getLevel(0, &level));
+
+    for (int y = 0; y < kH; y += kStripH) {
+        SkPixmap strip;
+        const bool peeked = bm.peekPixels(&strip);
+        REPORTER_ASSERT(reporter, peeked);
+        const bool extracted = strip.extractSubset(&strip, SkIRect::MakeXYWH(0, y, kW, kStripH));
+        REPORTER_ASSERT(reporter, extracted);
+        SkAutoTUnref<SkMipMap> stripMM(SkMipMap::Build(strip, SkSourceGammaTreatment::kIgnore,
+                                                       nullptr));
+        SkMipMap::Level stripLevel;
+        REPORTER_ASSERT(reporter, stripMM->getLevel(0, &stripLevel));
+        for (int row = 0; row < kStripH / 2; ++row) {
+            REPORTER_ASSERT(reporter, !memcmp(level.fPixmap.addr32(0, y / 2 + row),
+                                              stripLevel.fPixmap.addr32(0, row),
+                                              kW / 2 * sizeof(uint32_t)));
+        }
+    }
+}
+
+// 565, 4444, A8 and G8 are filtered several pixels at a time.  Every level should still match
+// filtering each channel of the level above one pixel at a time.
+DEF_TEST(MipMap_WideFilters, reporter) {
+    struct Channel { int fShift, fBits; };
+    const struct {
+        SkColorType fColorType;
+        int         fChannelCount;
+        Channel     fChannels[4];
+    } kFormats[] = {
+        { kRGB_565_SkColorType,   3, { { 11, 5 }, { 5, 6 }, { 0, 5 } } },
+        { kARGB_4444_SkColorType, 4, { { 12, 4 }, { 8, 4 }, { 4, 4 }, { 0, 4 } } },
+        { kAlpha_8_SkColorType,   1, { { 0, 8 } } },
+        { kGray_8_SkColorType,    1, { { 0, 8 } } },
+    };
+
+    // Each dst pixel weighs 1 src pixel, 2 at 1:1, or 3 at 1:2:1, per direction.
+    auto taps = [](int srcSize, int weights[3]) {
+        if (1 == srcSize) {
+            weights[0] = 1;
+            return 0;
+        }
+        weights[0] = 1;
+        weights[1] = srcSize & 1 ? 2 : 1;
+        weights[2] = srcSize & 1 ? 1 : 0;
+        return srcSize & 1 ? 2 : 1;
+    };
+
+    SkRandom rand;
+    for (const auto& format : kFormats) {
+        const int bpp = SkColorTypeBytesPerPixel(format.fColorType);
+        auto get = [bpp](const SkPixmap& pm, int x, int y) {
+            return 2 == bpp ? *pm.addr16(x, y) : *pm.addr8(x, y);
+        };
+
+        for (int width : { 1, 2, 3, 8, 9, 31, 32, 33, 34, 35, 64, 65, 70, 71, 200 }) {
+            for (int height : { 1, 2, 3, 6, 7 }) {
+                SkBitmap bm;
+                bm.allocPixels(SkImageInfo::Make(width, height, format.fColorType,
+                                                 kPremul_SkAlphaType));
+                for (int y = 0; y < height; ++y) {
+                    for (int x = 0; x < bm.rowBytes(); ++x) {
+                        ((uint8_t*)bm.getAddr(0, y))[x] = rand.nextU() & 0xFF;
+                    }
+                }
+                if (width <= 1 && height <= 1) {
+                    continue;
+                }
+                SkAutoTUnref<SkMipMap> mm(SkMipMap::Build(bm, SkSourceGammaTreatment::kIgnore,
+                                                          nullptr));
+                REPORTER_ASSERT(reporter, mm);
+
+                SkPixmap src;
+                REPORTER_ASSERT(reporter, bm.peekPixels(&src));
+                int mismatches = 0;
+                for (int i = 0; i < mm->countLevels(); ++i) {
+                    SkMipMap::Level level;
+                    REPORTER_ASSERT(reporter, mm->getLevel(i, &level));
+                    const SkPixmap& dst = level.fPixmap;
+
+                    int wx[3], wy[3];
+                    const int shift = taps(src.width(), wx) + taps(src.height(), wy);
+                    const int cols = src.width()  == 1 ? 1 : 2 + (src.width()  & 1),
+                              rows = src.height() == 1 ? 1 : 2 + (src.height() & 1);
+                    for (int y = 0; y < dst.height(); ++y) {
+                        for (int x = 0; x < dst.width(); ++x) {
+                            int expected = 0;
+                            for (int c = 0; c < format.fChannelCount; ++c) {
+                                const Channel& ch = format.fChannels[c];
+                                int sum = 0;
+                                for (int j = 0; j < rows; ++j) {
+                                    for (int k = 0; k < cols; ++k) {
+                                        const int p = get(src, 2 * x + k, 2 * y + j);
+                                        sum += wx[k] * wy[j] * ((p >> ch.fShift) &
+                                                                ((1 << ch.fBits) - 1));
+                                    }
+                                }
+                                expected |= (sum >> shift) << ch.fShift;
+                            }
+                            mismatches += get(dst, x, y) != expected;
+                        }
+                    }
+                    src = dst;
+                }
+                REPORTER_ASSERT(reporter, 0 == mismatches);
+            }
+        }
+    }
+}
+
+DEF_TEST(MipMap_AsyncBuild, reporter) {
+    SkBitmap bm;
+    make_bitmap(&bm, 600, 600);
+    const SkBitmapCacheDesc desc = SkBitmapCacheDesc::Make(bm);
+    const SkSourceGammaTreatment treatment = SkSourceGammaTreatment::kIgnore;
+
+    bool wasAsync = SkMipMapCache::SetAsyncBuild(true);
+    REPORTER_ASSERT(reporter, SkMipMapCache::IsAsyncBuild());
+
+    // Asking twice should only schedule one build.
+    SkMipMapCache::AddAsync(bm, treatment);
+    SkMipMapCache::AddAsync(bm, treatment);
+    SkMipMapCache::WaitForAsyncBuilds();
+
+    SkAutoTUnref<const SkMipMap> mm(SkMipMapCache::FindAndRef(desc, treatment));
+    REPORTER_ASSERT(reporter, mm);
+    if (mm) {
+        REPORTER_ASSERT(reporter, mm->countLevels() == SkMipMap::ComputeLevelCount(600, 600));
+    }
+
+    SkMipMapCache::SetAsyncBuild(wasAsync);
+}
+
+// Purging waits for pending builds, so none can land in the cache afterwards.
+DEF_TEST(MipMap_AsyncBuildPurge, reporter) {
+    SkBitmap bm;
+    make_bitmap(&bm, 600, 600);
+    const SkBitmapCacheDesc desc = SkBitmapCacheDesc::Make(bm);
+    const SkSourceGammaTreatment treatment = SkSourceGammaTreatment::kIgnore;
+
+    bool wasAsync = SkMipMapCache::SetAsyncBuild(true);
+    SkMipMapCache::AddAsync(bm, treatment);
+    SkGraphics::PurgeResourceCache();
+
+    SkAutoTUnref<const SkMipMap> mm(SkMipMapCache::FindAndRef(desc, treatment));
+    REPORTER_ASSERT(reporter, !mm);
+
+    SkMipMapCache::SetAsyncBuild(wasAsync);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCodec.h"
+#include "SkData.h"
+#include "SkImageEncoder.h"
+#include "SkRandom.h"
+#include "SkStream.h"
+#include "Test.h"
+
+// Tall enough that the parallel encoder splits it into several strips.
+static void make_bitmap(SkBitmap* bm, SkColorType ct, SkAlphaType at) {
+    bm->allocPixels(SkImageInfo::Make(300, 1500, ct, at));
+    SkBitmap n32;
+    n32.allocN32Pixels(bm->width(), bm->height());
+    SkRandom rand;
+    for (int y = 0; y < n32.height(); y++) {
+        for (int x = 0; x < n32.width(); x++) {
+            // Smooth gradients with a little noise, so every filter has something to do.
+            U8CPU a = kOpaque_SkAlphaType == at ? 0xFF : (x + y) & 0xFF;
+            U8CPU r = (x + (rand.nextU() & 3)) & 0xFF;
+            U8CPU g = (y + (rand.nextU() & 3)) & 0xFF;
+            U8CPU b = (x * y) & 0xFF;
+            *n32.getAddr32(x, y) = SkPreMultiplyARGB(a, r, g, b);
+        }
+    }
+    n32.readPixels(bm->info(), bm->getPixels(), bm->rowBytes(), 0, 0);
+}
+
+static bool decode(SkData* data, SkColorType ct, SkAlphaType at, SkBitmap* dst) {
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(data));
+    if (!codec) {
+        return false;
+    }
+    const SkImageInfo info = codec->getInfo().makeColorType(ct).makeAlphaType(at);
+    dst->allocPixels(info);
+    return SkCodec::kSuccess == codec->getPixels(info, dst->getPixels(), dst->rowBytes());
+}
+
+// Decoded bitmaps are tagged with a color space, so compare everything else.
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.dimensions() != b.dimensions() || a.colorType() != b.colorType()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); y++) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DEF_TEST(PNGImageEncoder_Options, r) {
+    const struct {
+        SkColorType fColorType;
+        SkAlphaType fAlphaType;
+        bool        fLossless;
+    } gFormats[] = {
+        { kN32_SkColorType,       kOpaque_SkAlphaType, true  },
+        { kRGB_565_SkColorType,   kOpaque_SkAlphaType, true  },
+        { kN32_SkColorType,       kPremul_SkAlphaType, false },
+        { kARGB_4444_SkColorType, kPremul_SkAlphaType, false },
+    };
+
+    for (auto format : gFormats) {
+        SkBitmap src;
+        make_bitmap(&src, format.fColorType, format.fAlphaType);
+        const SkColorType decodeType = kRGB_565_SkColorType == format.fColorType
+                                     ? kRGB_565_SkColorType : kN32_SkColorType;
+
+        // Everything should decode to the same pixels as the default, serial encode.
+        SkAutoTUnref<SkData> reference(SkImageEncoder::EncodeData(src, SkImageEncoder::kPNG_Type,
+                                                                  100));
+        SkBitmap expected;
+        REPORTER_ASSERT(r, reference && decode(reference, decodeType, format.fAlphaType,
+                                               &expected));
+        if (format.fLossless) {
+            REPORTER_ASSERT(r, equal_pixels(src, expected));
+        }
+
+        for (int threads : { 1, 3, 8 }) {
+            for (int level : { 0, 1, 9 }) {
+                for (int filters : { (int)SkPNGEncoderOptions::kAll_FilterFlag,
+                                     (int)SkPNGEncoderOptions::kNone_FilterFlag,
+                                     (int)SkPNGEncoderOptions::kPaeth_FilterFlag,
+                                     SkPNGEncoderOptions::kSub_FilterFlag |
+                                     SkPNGEncoderOptions::kUp_FilterFlag }) {
+                    SkPNGEncoderOptions options;
+                    options.fThreadCount = threads;
+                    options.fZLibLevel = level;
+                    options.fFilterFlags = filters;
+                    options.fZLibStrategy =
+                            (SkPNGEncoderOptions::ZLibStrategy)((threads + level) % 5);
+
+                    SkAutoTDelete<SkImageEncoder> encoder(CreatePNGImageEncoder(options));
+                    SkAutoTUnref<SkData> data(encoder->encodeData(src, 100));
+                    SkBitmap decoded;
+                    REPORTER_ASSERT(r, data && decode(data, decodeType, format.fAlphaType,
+                                                      &decoded));
+                    REPORTER_ASSERT(r, equal_pixels(expected, decoded));
+                }
+            }
+        }
+    }
+}
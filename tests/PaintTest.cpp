@@ -115,6 +115,53 @@ DEF_TEST(Paint_cmap, reporter) {
     }
 }
 
+// Each encoding of the same text should give the same glyphs, and measure the same as them.
+DEF_TEST(Paint_textToGlyphs, reporter) {
+    static const int NCHARS = 300;
+
+    SkUnichar src[NCHARS];
+    SkRandom rand;
+    for (int i = 0; i < NCHARS; ++i) {
+        switch (rand.nextU() % 4) {
+            case 0:  src[i] = rand.nextRangeU(0x80, 0xD7FF);    break;
+            case 1:  src[i] = rand.nextRangeU(0x10000, 0x10FFFF); break;
+            default: src[i] = rand.nextRangeU(' ', 0x7E);       break;
+        }
+    }
+
+    SkPaint paint;
+    paint.setTextEncoding(SkPaint::kUTF32_TextEncoding);
+    uint16_t glyphs[NCHARS];
+    REPORTER_ASSERT(reporter, NCHARS == paint.textToGlyphs(src, sizeof(src), glyphs));
+
+    SkPaint glyphPaint;
+    glyphPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    SkRect glyphBounds;
+    const SkScalar glyphWidth = glyphPaint.measureText(glyphs, sizeof(glyphs), &glyphBounds);
+
+    static const struct {
+        size_t (*fSeedTextProc)(const SkUnichar[], void* dst, int count);
+        SkPaint::TextEncoding   fEncoding;
+    } gRec[] = {
+        { uni_to_utf8,  SkPaint::kUTF8_TextEncoding },
+        { uni_to_utf16, SkPaint::kUTF16_TextEncoding },
+        { uni_to_utf32, SkPaint::kUTF32_TextEncoding },
+    };
+    for (size_t k = 0; k < SK_ARRAY_COUNT(gRec); ++k) {
+        SkUnichar text[NCHARS];  // used for utf8, utf16, utf32 storage
+        size_t len = gRec[k].fSeedTextProc(src, text, NCHARS);
+        paint.setTextEncoding(gRec[k].fEncoding);
+
+        uint16_t textGlyphs[NCHARS];
+        REPORTER_ASSERT(reporter, NCHARS == paint.textToGlyphs(text, len, textGlyphs));
+        REPORTER_ASSERT(reporter, !memcmp(glyphs, textGlyphs, sizeof(glyphs)));
+
+        SkRect bounds;
+        REPORTER_ASSERT(reporter, glyphWidth == paint.measureText(text, len, &bounds));
+        REPORTER_ASSERT(reporter, glyphBounds == bounds);
+    }
+}
+
 // temparary api for bicubic, just be sure we can set/clear it
 DEF_TEST(Paint_filterQuality, reporter) {
     SkPaint p0, p1;
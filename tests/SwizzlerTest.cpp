@@ -5,6 +5,8 @@
  * found in the LICENSE file.
  */
 
+#include "SkCodecPriv.h"
+#include "SkRandom.h"
 #include "SkSwizzle.h"
 #include "SkSwizzler.h"
 #include "Test.h"
@@ -167,3 +169,198 @@ DEF_TEST(PublicSwizzleOpts, r) {
     SkSwapRB(&dst, &src, 1);
     REPORTER_ASSERT(r, dst == 0xFA04B0CE);
 }
+
+DEF_TEST(SwizzleOpts_565, r) {
+    // Non-multiples of every SIMD width, so the tails get exercised too.
+    static const int kWidth = 1023;
+    uint8_t src[4 * kWidth];
+    SkRandom rand;
+    for (int i = 0; i < 4 * kWidth; i++) {
+        src[i] = rand.nextU() & 0xFF;
+    }
+
+    uint16_t dst[kWidth];
+    for (int count : { 1, 7, 15, 16, 17, 63, kWidth }) {
+        SkOpts::RGB_to_565(dst, src, count);
+        for (int i = 0; i < count; i++) {
+            REPORTER_ASSERT(r, dst[i] == SkPack888ToRGB16(src[3*i+0], src[3*i+1], src[3*i+2]));
+        }
+
+        SkOpts::BGR_to_565(dst, src, count);
+        for (int i = 0; i < count; i++) {
+            REPORTER_ASSERT(r, dst[i] == SkPack888ToRGB16(src[3*i+2], src[3*i+1], src[3*i+0]));
+        }
+
+        SkOpts::gray_to_565(dst, src, count);
+        for (int i = 0; i < count; i++) {
+            REPORTER_ASSERT(r, dst[i] == SkPack888ToRGB16(src[i], src[i], src[i]));
+        }
+
+        SkOpts::inverted_CMYK_to_565(dst, src, count);
+        for (int i = 0; i < count; i++) {
+            const uint8_t* cmyk = src + 4*i;
+            REPORTER_ASSERT(r, dst[i] == SkPack888ToRGB16(SkMulDiv255Round(cmyk[0], cmyk[3]),
+                                                          SkMulDiv255Round(cmyk[1], cmyk[3]),
+                                                          SkMulDiv255Round(cmyk[2], cmyk[3])));
+        }
+    }
+}
+
+DEF_TEST(SwizzleOpts_index, r) {
+    SkRandom rand;
+    uint32_t table[256];
+    for (int i = 0; i < 256; i++) {
+        table[i] = rand.nextU();
+    }
+    static const int kWidth = 1023;
+    uint8_t src[kWidth];
+    for (int i = 0; i < kWidth; i++) {
+        src[i] = rand.nextU() & 0xFF;
+    }
+
+    // Counts on either side of 256, where 565 switches to converting the table up front.
+    uint32_t dst32[kWidth];
+    uint16_t dst16[kWidth];
+    for (int count : { 1, 7, 8, 9, 255, 256, 263, kWidth }) {
+        SkOpts::index_to_8888(dst32, src, count, table);
+        SkOpts::index_to_565(dst16, src, count, table);
+        for (int i = 0; i < count; i++) {
+            REPORTER_ASSERT(r, dst32[i] == table[src[i]]);
+            REPORTER_ASSERT(r, dst16[i] == SkPixel32ToPixel16(table[src[i]]));
+        }
+    }
+}
+
+// The YUV conversions must match the decoders that made the planes bit for bit.  These are
+// libjpeg-turbo's ycc_rgb_convert() tables and libwebp's VP8YUVToR/G/B(), written out plainly.
+static uint32_t yuv_to_rgba(int y, int u, int v, SkYUVColorSpace colorSpace) {
+    int r, g, b;
+    if (kJPEG_SkYUVColorSpace == colorSpace) {
+        const int32_t fix_r = 91881, fix_gu = 22554, fix_gv = 46802, fix_b = 116130;
+        u -= 128;
+        v -= 128;
+        r = y + ((fix_r * v + 32768) >> 16);
+        g = y + ((-fix_gu * u + (-fix_gv * v + 32768)) >> 16);
+        b = y + ((fix_b * u + 32768) >> 16);
+    } else {
+        auto mulhi = [](int x, int k) { return (x * k) >> 8; };
+        auto clip = [](int x) { return (x & ~16383) == 0 ? x >> 6 : x < 0 ? 0 : 255; };
+        r = clip(mulhi(y, 19077) + mulhi(v, 26149) - 14234);
+        g = clip(mulhi(y, 19077) - mulhi(u, 6419) - mulhi(v, 13320) + 8708);
+        b = clip(mulhi(y, 19077) + mulhi(u, 33050) - 17685);
+    }
+    return SkPackARGB_as_RGBA(0xFF, SkTPin(r, 0, 255), SkTPin(g, 0, 255), SkTPin(b, 0, 255));
+}
+
+DEF_TEST(SwizzleOpts_YUV, r) {
+    // Every Y, U and V, with rows long enough for the SIMD paths.
+    uint8_t y[256], u[256], v[256];
+    uint32_t rgba[256];
+    for (int i = 0; i < 256; i++) {
+        y[i] = i;
+    }
+    for (SkYUVColorSpace cs : { kJPEG_SkYUVColorSpace, kRec601_SkYUVColorSpace }) {
+        int mismatches = 0;
+        for (int U = 0; U < 256; U++) {
+            for (int V = 0; V < 256; V++) {
+                memset(u, U, sizeof(u));
+                memset(v, V, sizeof(v));
+                SkOpts::YUV_to_RGB1(rgba, y, u, v, 256, cs);
+                for (int i = 0; i < 256; i++) {
+                    mismatches += rgba[i] != yuv_to_rgba(i, U, V, cs);
+                }
+            }
+        }
+        REPORTER_ASSERT(r, 0 == mismatches);
+    }
+
+    // Random rows of lengths that exercise the scalar tails, in both orders.
+    static const int kWidth = 1023;
+    uint8_t ry[kWidth], ru[kWidth], rv[kWidth];
+    SkRandom rand;
+    for (int i = 0; i < kWidth; i++) {
+        ry[i] = rand.nextU() & 0xFF;
+        ru[i] = rand.nextU() & 0xFF;
+        rv[i] = rand.nextU() & 0xFF;
+    }
+    uint32_t rrgba[kWidth], rbgra[kWidth];
+    for (SkYUVColorSpace cs : { kJPEG_SkYUVColorSpace, kRec601_SkYUVColorSpace }) {
+        for (int count : { 1, 7, 8, 9, kWidth }) {
+            SkOpts::YUV_to_RGB1(rrgba, ry, ru, rv, count, cs);
+            SkOpts::YUV_to_BGR1(rbgra, ry, ru, rv, count, cs);
+            for (int i = 0; i < count; i++) {
+                REPORTER_ASSERT(r, rrgba[i] == yuv_to_rgba(ry[i], ru[i], rv[i], cs));
+                REPORTER_ASSERT(r, rbgra[i] == SkSwizzle_RB(rrgba[i]));
+            }
+        }
+    }
+}
+
+// Sampled swizzles either gather pixels for the optimized procs or use the slow procs.
+// Either way, they should pick exactly the same pixels as a full swizzle.
+DEF_TEST(SwizzlerSampled, r) {
+    typedef SkEncodedInfo Info;
+    const struct {
+        Info::Color fColor;
+        Info::Alpha fAlpha;
+        int         fBitsPerComponent;
+        SkColorType fColorType;
+    } gConfigs[] = {
+        { Info::kGray_Color,         Info::kOpaque_Alpha,   1, kN32_SkColorType },
+        { Info::kGray_Color,         Info::kOpaque_Alpha,   1, kGray_8_SkColorType },
+        { Info::kGray_Color,         Info::kOpaque_Alpha,   1, kRGB_565_SkColorType },
+        { Info::kGray_Color,         Info::kOpaque_Alpha,   8, kN32_SkColorType },
+        { Info::kGray_Color,         Info::kOpaque_Alpha,   8, kRGB_565_SkColorType },
+        { Info::kGrayAlpha_Color,    Info::kUnpremul_Alpha, 8, kN32_SkColorType },
+        { Info::kPalette_Color,      Info::kOpaque_Alpha,   1, kIndex_8_SkColorType },
+        { Info::kPalette_Color,      Info::kOpaque_Alpha,   2, kN32_SkColorType },
+        { Info::kPalette_Color,      Info::kOpaque_Alpha,   4, kRGB_565_SkColorType },
+        { Info::kPalette_Color,      Info::kOpaque_Alpha,   8, kN32_SkColorType },
+        { Info::kPalette_Color,      Info::kOpaque_Alpha,   8, kRGB_565_SkColorType },
+        { Info::kRGB_Color,          Info::kOpaque_Alpha,   8, kN32_SkColorType },
+        { Info::kRGB_Color,          Info::kOpaque_Alpha,   8, kRGB_565_SkColorType },
+        { Info::kRGBA_Color,         Info::kUnpremul_Alpha, 8, kN32_SkColorType },
+        { Info::kBGR_Color,          Info::kOpaque_Alpha,   8, kRGB_565_SkColorType },
+        { Info::kBGRA_Color,         Info::kUnpremul_Alpha, 8, kN32_SkColorType },
+        { Info::kInvertedCMYK_Color, Info::kOpaque_Alpha,   8, kN32_SkColorType },
+        { Info::kInvertedCMYK_Color, Info::kOpaque_Alpha,   8, kRGB_565_SkColorType },
+    };
+
+    static const int kWidth = 301;
+    SkRandom rand;
+    uint8_t src[4 * kWidth];
+    for (int i = 0; i < 4 * kWidth; i++) {
+        src[i] = rand.nextU() & 0xFF;
+    }
+    SkPMColor ctable[256];
+    for (int i = 0; i < 256; i++) {
+        ctable[i] = rand.nextU() | 0xFF000000;
+    }
+
+    for (auto config : gConfigs) {
+        const Info encodedInfo = Info::Make(config.fColor, config.fAlpha,
+                                            config.fBitsPerComponent);
+        const SkAlphaType alphaType = Info::kOpaque_Alpha == config.fAlpha
+                                    ? kOpaque_SkAlphaType : kPremul_SkAlphaType;
+        const SkImageInfo info = SkImageInfo::Make(kWidth, 1, config.fColorType, alphaType);
+        const int bpp = info.bytesPerPixel();
+
+        SkAutoTDelete<SkSwizzler> full(SkSwizzler::CreateSwizzler(encodedInfo, ctable, info,
+                                                                  SkCodec::Options()));
+        REPORTER_ASSERT(r, full);
+        uint8_t expected[4 * kWidth];
+        full->swizzle(expected, src);
+
+        for (int sampleX : { 2, 3, 4, 7 }) {
+            SkAutoTDelete<SkSwizzler> sampled(SkSwizzler::CreateSwizzler(encodedInfo, ctable,
+                                                                         info, SkCodec::Options()));
+            const int width = sampled->setSampleX(sampleX);
+            uint8_t actual[4 * kWidth];
+            sampled->swizzle(actual, src);
+            for (int x = 0; x < width; x++) {
+                const int srcX = get_start_coord(sampleX) + x * sampleX;
+                REPORTER_ASSERT(r, !memcmp(actual + x * bpp, expected + srcX * bpp, bpp));
+            }
+        }
+    }
+}
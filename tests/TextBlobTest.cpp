@@ -5,8 +5,11 @@
  * found in the LICENSE file.
  */
 
+#include "SkCanvas.h"
+#include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkPoint.h"
+#include "SkTextBlobRasterCache.h"
 #include "SkTextBlobRunIterator.h"
 #include "SkTypeface.h"
 
@@ -349,3 +352,155 @@ DEF_TEST(TextBlob_builder, reporter) {
 DEF_TEST(TextBlob_paint, reporter) {
     TextBlobTester::TestPaintProps(reporter);
 }
+
+// Draws the blob's runs one at a time, without going through the raster blob cache.
+static void draw_runs(SkCanvas* canvas, const SkTextBlob* blob, SkScalar x, SkScalar y,
+                      const SkPaint& paint) {
+    SkPaint runPaint = paint;
+    for (SkTextBlobRunIterator it(blob); !it.done(); it.next()) {
+        it.applyFontToPaint(&runPaint);
+        size_t len = it.glyphCount() * sizeof(uint16_t);
+        const SkPoint& offset = it.offset();
+        switch (it.positioning()) {
+            case SkTextBlob::kDefault_Positioning:
+                canvas->drawText(it.glyphs(), len, x + offset.x(), y + offset.y(), runPaint);
+                break;
+            case SkTextBlob::kHorizontal_Positioning:
+                canvas->save();
+                canvas->translate(x, y);
+                canvas->drawPosTextH(it.glyphs(), len, it.pos(), offset.y(), runPaint);
+                canvas->restore();
+                break;
+            case SkTextBlob::kFull_Positioning:
+                canvas->save();
+                canvas->translate(x, y);
+                canvas->drawPosText(it.glyphs(), len, (const SkPoint*)it.pos(), runPaint);
+                canvas->restore();
+                break;
+        }
+    }
+}
+
+// Redrawing a blob, which places its glyphs from the raster blob cache, should draw exactly
+// what drawing its runs as plain text does.
+DEF_TEST(TextBlob_rasterCache, reporter) {
+    SkPaint font;
+    font.setTextSize(13);
+    font.setAntiAlias(true);
+    font.setSubpixelText(true);
+    font.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+    SkTextBlobBuilder builder;
+    const int kCount = 8;
+    const SkTextBlobBuilder::RunBuffer& run1 = builder.allocRun(font, kCount, 3, 12);
+    const SkTextBlobBuilder::RunBuffer& run2 = builder.allocRunPosH(font, kCount, 30);
+    font.setTextSize(21);
+    font.setSubpixelText(false);
+    const SkTextBlobBuilder::RunBuffer& run3 = builder.allocRunPos(font, kCount);
+    for (int i = 0; i < kCount; ++i) {
+        run1.glyphs[i] = run2.glyphs[i] = run3.glyphs[i] = 40 + 3*i;
+        run2.pos[i] = 9.3f*i + 0.25f;
+        run3.pos[2*i] = 11.6f*i;
+        run3.pos[2*i + 1] = 55 + 0.7f*i;
+    }
+    SkAutoTUnref<const SkTextBlob> blob(builder.build());
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(120, 90);
+    actual.allocN32Pixels(120, 90);
+    SkCanvas expectedCanvas(expected), actualCanvas(actual);
+
+    const SkPoint origins[] = { {10, 5}, {10, 5}, {14, 8}, {10.4f, 5.7f}, {-20, 40} };
+    const SkScalar scales[] = { 1, 1.5f };
+    SkPaint paint;
+    for (SkScalar scale : scales) {
+        for (const SkPoint& origin : origins) {
+            for (bool clip : { false, true }) {
+                expected.eraseColor(SK_ColorWHITE);
+                actual.eraseColor(SK_ColorWHITE);
+                for (SkCanvas* canvas : { &expectedCanvas, &actualCanvas }) {
+                    canvas->save();
+                    canvas->translate(0.5f, 0);
+                    canvas->scale(scale, scale);
+                    if (clip) {
+                        canvas->clipRect(SkRect::MakeLTRB(20, 0, 60, 40));
+                    }
+                }
+                draw_runs(&expectedCanvas, blob, origin.x(), origin.y(), paint);
+                actualCanvas.drawTextBlob(blob, origin.x(), origin.y(), paint);
+                expectedCanvas.restore();
+                actualCanvas.restore();
+
+                REPORTER_ASSERT(reporter, !memcmp(expected.getPixels(), actual.getPixels(),
+                                                  expected.getSize()));
+            }
+        }
+    }
+}
+
+// Glyphs added to a strike after a run was placed can move the glyphs the placement points to.
+// Redrawing the run must find them where they are now.
+DEF_TEST(TextBlob_rasterCacheStrikeGrowth, reporter) {
+    SkGraphics::PurgeFontCache();
+    SkTextBlobRasterCache::PurgeAll();
+
+    SkPaint font;
+    font.setTextSize(17);
+    font.setAntiAlias(true);
+    font.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+    SkTextBlobBuilder builder;
+    const int kCount = 4;
+    const SkTextBlobBuilder::RunBuffer& run = builder.allocRun(font, kCount, 0, 0);
+    for (int i = 0; i < kCount; ++i) {
+        run.glyphs[i] = 36 + i;
+    }
+    SkAutoTUnref<const SkTextBlob> blob(builder.build());
+
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(80, 30);
+    actual.allocN32Pixels(80, 30);
+    SkCanvas expectedCanvas(expected), actualCanvas(actual);
+    expected.eraseColor(SK_ColorWHITE);
+    draw_runs(&expectedCanvas, blob, 5, 20, SkPaint());
+
+    uint16_t others[200];
+    for (int i = 0; i < 200; ++i) {
+        others[i] = 50 + i;
+    }
+    for (int pass = 0; pass < 3; ++pass) {
+        actual.eraseColor(SK_ColorWHITE);
+        actualCanvas.drawTextBlob(blob, 5, 20, SkPaint());
+        REPORTER_ASSERT(reporter, !memcmp(expected.getPixels(), actual.getPixels(),
+                                          expected.getSize()));
+
+        // Fill the strike with more glyphs, growing it.
+        actualCanvas.drawText(others, sizeof(others) * (pass + 1) / 3, 0, 0, font);
+    }
+}
+
+// The placements are kept in a cache of their own, which stays within its limit.
+DEF_TEST(TextBlob_rasterCacheLimit, reporter) {
+    const size_t kLimit = 4096;
+    const size_t oldLimit = SkTextBlobRasterCache::SetTotalByteLimit(kLimit);
+
+    SkPaint font;
+    font.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(60, 20);
+    SkCanvas canvas(bitmap);
+    SkAutoTUnref<const SkTextBlob> blobs[100];
+    for (int i = 0; i < 100; ++i) {
+        SkTextBlobBuilder builder;
+        const SkTextBlobBuilder::RunBuffer& run = builder.allocRun(font, 8, 0, 0);
+        for (int j = 0; j < 8; ++j) {
+            run.glyphs[j] = 40 + j;
+        }
+        blobs[i].reset(builder.build());
+        canvas.drawTextBlob(blobs[i], 5, 15, SkPaint());
+        REPORTER_ASSERT(reporter, SkTextBlobRasterCache::GetTotalBytesUsed() > 0);
+        REPORTER_ASSERT(reporter, SkTextBlobRasterCache::GetTotalBytesUsed() <= kLimit);
+    }
+
+    SkTextBlobRasterCache::SetTotalByteLimit(oldLimit);
+}
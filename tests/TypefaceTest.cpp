@@ -95,3 +95,29 @@ DEF_TEST(TypefaceCache, reporter) {
     }
     REPORTER_ASSERT(reporter, t1->unique());
 }
+
+static bool find_by_id(SkTypeface* face, void* ctx) {
+    return face->uniqueID() == *static_cast<SkFontID*>(ctx);
+}
+
+// A hashed find should only look at the typefaces added with its hash.
+DEF_TEST(TypefaceCache_hashed, reporter) {
+    SkTypefaceCache cache;
+    for (SkFontID id = 1; id <= 8; ++id) {
+        sk_sp<SkTypeface> face(SkEmptyTypeface::Create(id));
+        cache.add(face.get(), id % 3);
+    }
+    REPORTER_ASSERT(reporter, count(reporter, cache) == 8);
+
+    for (SkFontID id = 1; id <= 8; ++id) {
+        sk_sp<SkTypeface> found(cache.findByProcAndRef(id % 3, find_by_id, &id));
+        REPORTER_ASSERT(reporter, found && found->uniqueID() == id);
+        found.reset(cache.findByProcAndRef((id + 1) % 3, find_by_id, &id));
+        REPORTER_ASSERT(reporter, !found);
+    }
+
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, count(reporter, cache) == 0);
+    SkFontID id = 1;
+    REPORTER_ASSERT(reporter, !cache.findByProcAndRef(id % 3, find_by_id, &id));
+}
@@ -183,6 +183,39 @@ static void test_utf16(skiatest::Reporter* reporter) {
     }
 }
 
+// The bulk decoders should match decoding one char at a time, across runs of ASCII of every
+// length and alignment.
+static void test_to_unichars(skiatest::Reporter* reporter) {
+    static const SkUnichar gNonASCII[] = {
+        0x80, 0x7FF, 0x800, 0xD7FF, 0xE000, 0xFFFF, 0x10000, 0x10FFFF
+    };
+
+    SkRandom rand;
+    for (int i = 0; i < 100; ++i) {
+        SkUnichar src[64];
+        int count = rand.nextRangeU(1, SK_ARRAY_COUNT(src));
+        for (int j = 0; j < count; ++j) {
+            src[j] = rand.nextU() % 8 ? rand.nextRangeU(1, 0x7F)
+                                      : gNonASCII[rand.nextU() % SK_ARRAY_COUNT(gNonASCII)];
+        }
+
+        char utf8[SK_ARRAY_COUNT(src) * kMaxBytesInUTF8Sequence];
+        uint16_t utf16[SK_ARRAY_COUNT(src) * 2];
+        size_t utf8Length = 0;
+        int utf16Count = 0;
+        for (int j = 0; j < count; ++j) {
+            utf8Length += SkUTF8_FromUnichar(src[j], utf8 + utf8Length);
+            utf16Count += SkToInt(SkUTF16_FromUnichar(src[j], utf16 + utf16Count));
+        }
+
+        SkUnichar dst[SK_ARRAY_COUNT(utf8)];
+        REPORTER_ASSERT(reporter, count == SkUTF8_ToUnichars(utf8, utf8Length, dst));
+        REPORTER_ASSERT(reporter, !memcmp(src, dst, count * sizeof(SkUnichar)));
+        REPORTER_ASSERT(reporter, count == SkUTF16_ToUnichars(utf16, utf16Count, dst));
+        REPORTER_ASSERT(reporter, !memcmp(src, dst, count * sizeof(SkUnichar)));
+    }
+}
+
 DEF_TEST(Utils, reporter) {
     static const struct {
         const char* fUtf8;
@@ -215,6 +248,7 @@ DEF_TEST(Utils, reporter) {
     }
 
     test_utf16(reporter);
+    test_to_unichars(reporter);
     test_search(reporter);
     test_autounref(reporter);
     test_autostarray(reporter);
@@ -5,11 +5,13 @@
  * found in the LICENSE file.
  */
 
+#include "SkBitmap.h"
 #include "SkCodec.h"
 #include "Resources.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
 #include "SkYUVSizeInfo.h"
+#include "SkYUVToRGBA.h"
 #include "Test.h"
 
 static SkStreamAsset* resource(const char path[]) {
@@ -19,7 +21,8 @@ static SkStreamAsset* resource(const char path[]) {
 
 static void codec_yuv(skiatest::Reporter* reporter,
                   const char path[],
-                  SkISize expectedSizes[3]) {
+                  SkISize expectedSizes[3],
+                  SkYUVColorSpace expectedColorSpace = kJPEG_SkYUVColorSpace) {
     SkAutoTDelete<SkStream> stream(resource(path));
     if (!stream) {
         INFOF(reporter, "Missing resource '%s'\n", path);
@@ -58,7 +61,7 @@ static void codec_yuv(skiatest::Reporter* reporter,
             (uint32_t) SkAlign8(info.fSizes[SkYUVSizeInfo::kU].width()));
     REPORTER_ASSERT(reporter, info.fWidthBytes[SkYUVSizeInfo::kV] ==
             (uint32_t) SkAlign8(info.fSizes[SkYUVSizeInfo::kV].width()));
-    REPORTER_ASSERT(reporter, kJPEG_SkYUVColorSpace == colorSpace);
+    REPORTER_ASSERT(reporter, expectedColorSpace == colorSpace);
 
     // Allocate the memory for the YUV decode
     size_t totalBytes =
@@ -129,3 +132,74 @@ DEF_TEST(Jpeg_YUV_Codec, r) {
     // A PNG should fail.
     codec_yuv(r, "arrow.png", nullptr);
 }
+
+DEF_TEST(Webp_YUV_Codec, r) {
+    // Lossy WebPs always subsample chroma, rounding up.
+    SkISize sizes[3];
+    sizes[0].set(400, 301);
+    sizes[1].set(200, 151);
+    sizes[2].set(200, 151);
+    codec_yuv(r, "yellow_rose_opaque.webp", sizes, kRec601_SkYUVColorSpace);
+
+    // Lossy with alpha should fail.
+    codec_yuv(r, "yellow_rose.webp", nullptr);
+    // Lossless should fail.
+    codec_yuv(r, "color_wheel.webp", nullptr);
+}
+
+// Converting the planes on the CPU should exactly match the codec's own conversion.
+static void check_yuv_to_rgba(skiatest::Reporter* r, const char* path) {
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromStream(resource(path)));
+    if (!codec) {
+        INFOF(r, "Missing resource '%s'\n", path);
+        return;
+    }
+
+    SkYUVSizeInfo info;
+    SkYUVColorSpace colorSpace;
+    if (!codec->queryYUV8(&info, &colorSpace)) {
+        // The codec may not be built with YUV support.
+        return;
+    }
+    SkAutoMalloc storage(3 * info.fWidthBytes[SkYUVSizeInfo::kY] *
+                         info.fSizes[SkYUVSizeInfo::kY].height());
+    void* planes[3];
+    for (int i = 0; i < 3; i++) {
+        planes[i] = SkTAddOffset<void>(storage.get(),
+                i * info.fWidthBytes[SkYUVSizeInfo::kY] * info.fSizes[SkYUVSizeInfo::kY].height());
+    }
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getYUV8Planes(info, planes));
+
+    for (SkColorType colorType : { kRGBA_8888_SkColorType, kBGRA_8888_SkColorType }) {
+        const SkImageInfo dstInfo = codec->getInfo().makeColorType(colorType);
+        SkBitmap expected;
+        expected.allocPixels(dstInfo);
+        REPORTER_ASSERT(r, SkCodec::kSuccess ==
+                codec->getPixels(expected.info(), expected.getPixels(), expected.rowBytes()));
+
+        SkBitmap actual;
+        actual.allocPixels(dstInfo);
+        SkPixmap pixmap;
+        REPORTER_ASSERT(r, actual.peekPixels(&pixmap));
+        REPORTER_ASSERT(r, SkYUVToRGBA(info, planes, colorSpace, pixmap));
+
+        int mismatches = 0;
+        for (int y = 0; y < expected.height(); y++) {
+            mismatches += memcmp(expected.getAddr32(0, y), actual.getAddr32(0, y),
+                                 4 * expected.width()) != 0;
+        }
+        if (mismatches) {
+            ERRORF(r, "%s: %d rows differ from the codec\n", path, mismatches);
+        }
+    }
+}
+
+DEF_TEST(YUVToRGBA, r) {
+    // H1V1, H2V1 and H2V2 (with odd dimensions and with chroma just wide enough to be
+    // upsampled smoothly) JPEGs, and a lossy WebP.
+    for (const char* path : { "mandrill_h1v1.jpg", "mandrill_h2v1.jpg", "cropped_mandrill.jpg",
+                              "randPixels.jpg", "brickwork-texture.jpg",
+                              "yellow_rose_opaque.webp" }) {
+        check_yuv_to_rgba(r, path);
+    }
+}